@@ -15,3 +15,16 @@ EXECUTE_PROCESS( COMMAND cp -av ${CMAKE_BINARY_DIR}/../Tools/IccJpegDump/iccJpeg
 EXECUTE_PROCESS( COMMAND cp -av ${CMAKE_BINARY_DIR}/../Tools/wxProfileDump/iccDumpProfileGui ${CMAKE_CURRENT_LIST_DIR}/../../../Testing/ || echo "")
 EXECUTE_PROCESS( COMMAND echo "run ${CMAKE_BINARY_DIR}/../../Build/Cmake/Testing/test.sh")
 EXECUTE_PROCESS( COMMAND ${CMAKE_CURRENT_LIST_DIR}/../../../Build/Cmake/Testing/test.sh ${CMAKE_CURRENT_LIST_DIR}/../../../Testing)
+
+# Compare every SIMD level against the scalar kernels using the profiles created by test.sh
+FILE( GLOB_RECURSE TEST_PROFILES ${CMAKE_CURRENT_LIST_DIR}/../../../Testing/*.icc )
+EXECUTE_PROCESS( COMMAND ${SIMD_CONFORMANCE} ${TEST_PROFILES} RESULT_VARIABLE SIMD_RESULT )
+IF( NOT SIMD_RESULT EQUAL 0 )
+  MESSAGE( FATAL_ERROR "iccSimdConformance failed" )
+ENDIF()
+
+# Check fixed point interpolation against the float path for synthetic links and the same profiles
+EXECUTE_PROCESS( COMMAND ${FIXED_INTERP_TEST} ${TEST_PROFILES} RESULT_VARIABLE FIXED_RESULT )
+IF( NOT FIXED_RESULT EQUAL 0 )
+  MESSAGE( FATAL_ERROR "iccFixedInterpTest failed" )
+ENDIF()
@@ -80,6 +80,7 @@
 #include "IccStructBasic.h"
 #include "IccUtil.h"
 #include "IccArrayFactory.h"
+#include "IccNamedColorIndex.h"
 
 #ifndef __min
 #include <algorithm>
@@ -230,15 +231,38 @@ CIccArrayNamedColor::CIccArrayNamedColor(CIccTagArray *pTagArray)
   m_csDevice = icSigUnknownData;
   m_pZeroTint = NULL;
   m_csSpectralPcs = icSigNoSpectralData;
+
+  m_pColors = NULL;
+  m_nColors = 0;
+  m_pPcsIndex = NULL;
+  m_pSpectralIndex = NULL;
 }
 
 
 CIccArrayNamedColor::~CIccArrayNamedColor()
 {
+  ResetIndex();
   delete m_list;
 }
 
 
+void CIccArrayNamedColor::ResetIndex()
+{
+  if (m_pColors)
+    free(m_pColors);
+  m_pColors = NULL;
+  m_nColors = 0;
+
+  if (m_pPcsIndex)
+    delete m_pPcsIndex;
+  m_pPcsIndex = NULL;
+
+  if (m_pSpectralIndex)
+    delete m_pSpectralIndex;
+  m_pSpectralIndex = NULL;
+}
+
+
 IIccArray* CIccArrayNamedColor::NewCopy(CIccTagArray *pTagArray) const
 {
   CIccArrayNamedColor *rv = new CIccArrayNamedColor(pTagArray);
@@ -289,6 +313,7 @@ bool CIccArrayNamedColor::Begin()
   m_pZeroTint = (CIccStructNamedColor*)icGetTagStructHandlerOfType(m_pTag->GetIndex(0), icSigTintZeroStruct);
 
   m_list->clear();
+  ResetIndex();
 
   int i, n=m_pTag->GetSize();
   for (i=1; i<n; i++) {
@@ -300,9 +325,107 @@ bool CIccArrayNamedColor::Begin()
     }
   }
 
+  if (n<2)
+    return true;
+
+  //Index the full tint PCS (as Lab) and spectral values of each named color
+  m_pColors = (CIccStructNamedColor**)malloc((n-1)*sizeof(CIccStructNamedColor*));
+  icUInt32Number *pIds = (icUInt32Number*)malloc((n-1)*sizeof(icUInt32Number));
+  icFloatNumber *pLab = (icFloatNumber*)malloc((n-1)*3*sizeof(icFloatNumber));
+  icFloatNumber *pSpec = m_nSpectralSamples ? (icFloatNumber*)malloc((size_t)(n-1)*m_nSpectralSamples*sizeof(icFloatNumber)) : NULL;
+
+  if (!m_pColors || !pIds || !pLab || (m_nSpectralSamples && !pSpec)) {
+    if (pIds)
+      free(pIds);
+    if (pLab)
+      free(pLab);
+    if (pSpec)
+      free(pSpec);
+    ResetIndex();
+    return false;
+  }
+
+  icUInt32Number nLab=0, nSpec=0;
+
+  for (i=1; i<n; i++) {
+    CIccStructNamedColor *pNamedColor = (CIccStructNamedColor*)icGetTagStructHandlerOfType(m_pTag->GetIndex(i), icSigNamedColorStruct);
+    if (!pNamedColor)
+      continue;
+
+    icUInt32Number nId = m_nColors++;
+    m_pColors[nId] = pNamedColor;
+
+    if (m_nPcsSamples==3 && GetColorValues(pLab + nLab*3, pNamedColor, icSigNmclPcsDataMbr, 3)) {
+      if (m_csPcs != icSigLabData)
+        icXYZtoLab(pLab + nLab*3, pLab + nLab*3);
+      pIds[nLab++] = nId;
+    }
+  }
+
+  if (nLab) {
+    m_pPcsIndex = new CIccKdTree();
+    if (!m_pPcsIndex->Build(3, nLab, pLab, pIds)) {
+      delete m_pPcsIndex;
+      m_pPcsIndex = NULL;
+    }
+  }
+
+  if (pSpec) {
+    for (icUInt32Number j=0; j<m_nColors; j++) {
+      if (GetColorValues(pSpec + (size_t)nSpec*m_nSpectralSamples, m_pColors[j], icSigNmclSpectralDataMbr, m_nSpectralSamples))
+        pIds[nSpec++] = j;
+    }
+
+    if (nSpec) {
+      m_pSpectralIndex = new CIccKdTree();
+      if (!m_pSpectralIndex->Build(m_nSpectralSamples, nSpec, pSpec, pIds)) {
+        delete m_pSpectralIndex;
+        m_pSpectralIndex = NULL;
+      }
+    }
+    free(pSpec);
+  }
+
+  free(pIds);
+  free(pLab);
+
   return true;
 }
 
+/**
+ ****************************************************************************
+ * Name: CIccArrayNamedColor::GetColorValues
+ * 
+ * Purpose: Gets the full tint values of a named color member
+ * 
+ * Args: 
+ *  dstColor = location for nSamples values,
+ *  pColor = named color,
+ *  sig = member signature,
+ *  nSamples = number of values in each tint of the member
+ * 
+ * Return: 
+ *  true if the member has at least one tint of nSamples values
+ *****************************************************************************
+ */
+bool CIccArrayNamedColor::GetColorValues(icFloatNumber *dstColor, const CIccStructNamedColor *pColor,
+                                         icNamedColorlMemberSignature sig, icUInt32Number nSamples) const
+{
+  if (!pColor || !nSamples)
+    return false;
+
+  CIccTag *pTag = pColor->GetElem(sig);
+  if (!pTag || !pTag->IsNumArrayType())
+    return false;
+
+  CIccTagNumArray *v = (CIccTagNumArray*)pTag;
+  icUInt32Number sampleCount = v->GetNumValues()/nSamples;
+  if (!sampleCount)
+    return false;
+
+  return v->GetValues(dstColor, (sampleCount-1)*nSamples, nSamples);
+}
+
 CIccStructNamedColor* CIccArrayNamedColor::FindColor(const icChar *szColor) const
 {
   std::string name(szColor);
@@ -350,6 +473,20 @@ CIccStructNamedColor* CIccArrayNamedColor::FindDeviceColor(const icFloatNumber *
   return NULL;
 }
 
+/**
+ ****************************************************************************
+ * Name: CIccArrayNamedColor::FindPcsColor
+ * 
+ * Purpose: Finds the named color with the full tint PCS value nearest to pPCS
+ * 
+ * Args: 
+ *  pPCS = PCS color,
+ *  dMinDE = the minimum deltaE (tolerance)
+ * 
+ * Return: 
+ *  the nearest named color with a deltaE less than dMinDE, or NULL
+ *****************************************************************************
+ */
 CIccStructNamedColor* CIccArrayNamedColor::FindPcsColor(const icFloatNumber *pPCS, icFloatNumber dMinDE/*=1000.0*/) const
 {
   icFloatNumber dCalcDE, dLeastDE=dMinDE;
@@ -363,24 +500,30 @@ CIccStructNamedColor* CIccArrayNamedColor::FindPcsColor(const icFloatNumber *pPC
     memcpy(pLabIn, pPCS, 3*sizeof(icFloatNumber));
   }
 
+  if (m_pPcsIndex) {
+    icInt32Number nId = m_pPcsIndex->FindNearest(pLabIn, &dCalcDE);
+
+    if (nId>=0 && dCalcDE<dMinDE)
+      return m_pColors[nId];
+
+    return NULL;
+  }
+
+  if (m_nPcsSamples!=3)
+    return NULL;
+
   icUInt32Number tagSize = m_pTag->GetSize();
   for (icUInt32Number i=1; i<tagSize; i++) {
     CIccStructNamedColor *pNamedColor = (CIccStructNamedColor*)icGetTagStructHandlerOfType(m_pTag->GetIndex(i), icSigNamedColorStruct);
-    if (pNamedColor) {
-      CIccTag *pTag = pNamedColor->GetElem(icSigNmclDeviceDataMbr);
-      if (pTag && pTag->IsNumArrayType()) {
-        CIccTagNumArray *v = (CIccTagNumArray*)pTag;
-        icUInt32Number sampleCount = v->GetNumValues()/m_nDeviceSamples;
-        if (sampleCount) {
-          v->GetValues(pLab, (sampleCount-1)*m_nDeviceSamples, 3);
+    if (GetColorValues(pLab, pNamedColor, icSigNmclPcsDataMbr, 3)) {
+      if (m_csPcs != icSigLabData)
+        icXYZtoLab(pLab, pLab);
 
-          dCalcDE = icDeltaE(pLabIn, pLab);
+      dCalcDE = icDeltaE(pLabIn, pLab);
 
-          if (dCalcDE<dMinDE && dCalcDE<dLeastDE) {
-            dLeastDE = dCalcDE;
-            leastDEindex = pNamedColor;
-          }
-        }
+      if (dCalcDE<dMinDE && dCalcDE<dLeastDE) {
+        dLeastDE = dCalcDE;
+        leastDEindex = pNamedColor;
       }
     }
   }
@@ -388,11 +531,41 @@ CIccStructNamedColor* CIccArrayNamedColor::FindPcsColor(const icFloatNumber *pPC
   return leastDEindex;
 }
 
+/**
+ ****************************************************************************
+ * Name: CIccArrayNamedColor::FindSpectralColor
+ * 
+ * Purpose: Finds the named color with the full tint spectral value nearest
+ *  to pSpec
+ * 
+ * Args: 
+ *  pSpec = spectral color,
+ *  dMinRMS = the minimum RMS difference (tolerance)
+ * 
+ * Return: 
+ *  the nearest named color with an RMS difference less than dMinRMS, or NULL
+ *****************************************************************************
+ */
 CIccStructNamedColor* CIccArrayNamedColor::FindSpectralColor(const icFloatNumber *pSpec, icFloatNumber dMinRMS/*=1000.0*/) const
 {
   icFloatNumber dCalcRMS, dLeastRMS=dMinRMS;
   CIccStructNamedColor* leastRMSindex = NULL;
 
+  if (!m_nSpectralSamples)
+    return NULL;
+
+  if (m_pSpectralIndex) {
+    icInt32Number nId = m_pSpectralIndex->FindNearest(pSpec, &dCalcRMS);
+
+    //RMS difference is the euclidean distance scaled by 1/sqrt(samples)
+    dCalcRMS /= (icFloatNumber)sqrt((icFloatNumber)m_nSpectralSamples);
+
+    if (nId>=0 && dCalcRMS<dMinRMS)
+      return m_pColors[nId];
+
+    return NULL;
+  }
+
   icFloatNumber *temp = new icFloatNumber[m_nSpectralSamples];
 
   if (!temp)
@@ -401,21 +574,12 @@ CIccStructNamedColor* CIccArrayNamedColor::FindSpectralColor(const icFloatNumber
   icUInt32Number tagSize = m_pTag->GetSize();
   for (icUInt32Number i=1; i<tagSize; i++) {
     CIccStructNamedColor *pNamedColor = (CIccStructNamedColor*)icGetTagStructHandlerOfType(m_pTag->GetIndex(i), icSigNamedColorStruct);
-    if (pNamedColor) {
-      CIccTag *pTag = pNamedColor->GetElem(icSigNmclDeviceDataMbr);
-      if (pTag && pTag->IsNumArrayType()) {
-        CIccTagNumArray *v = (CIccTagNumArray*)pTag;
-        icUInt32Number sampleCount = v->GetNumValues()/m_nDeviceSamples;
-        if (sampleCount) {
-          v->GetValues(temp, (sampleCount-1)*m_nSpectralSamples, m_nSpectralSamples);
-
-          dCalcRMS = icRmsDif(pSpec, temp, m_nSpectralSamples);
+    if (GetColorValues(temp, pNamedColor, icSigNmclSpectralDataMbr, m_nSpectralSamples)) {
+      dCalcRMS = icRmsDif(pSpec, temp, m_nSpectralSamples);
 
-          if (dCalcRMS<dMinRMS && dCalcRMS<dLeastRMS) {
-            dLeastRMS = dCalcRMS;
-            leastRMSindex = pNamedColor;
-          }
-        }
+      if (dCalcRMS<dMinRMS && dCalcRMS<dLeastRMS) {
+        dLeastRMS = dCalcRMS;
+        leastRMSindex = pNamedColor;
       }
     }
   }
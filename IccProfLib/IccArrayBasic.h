@@ -69,7 +69,7 @@
 
 #include <list>
 #include <string>
-#include <map>
+#include <unordered_map>
 #include "IccDefs.h"
 #include "IccTagComposite.h"
 #ifdef USEICCDEVNAMESPACE
@@ -126,8 +126,9 @@ public:
 
 
 class CIccStructNamedColor;
+class CIccKdTree;
 
-typedef std::map<std::string, CIccStructNamedColor*> icNamedColorStructList;
+typedef std::unordered_map<std::string, CIccStructNamedColor*> icNamedColorStructList;
 
 /**
 ****************************************************************************
@@ -154,6 +155,7 @@ public:
 
   icValidateStatus Validate(std::string sigPath, std::string &sReport, const CIccProfile* pProfile=NULL) const;
 
+  ///Builds the name, PCS and spectral indexes used by the Find functions
   bool Begin();
 
   CIccStructNamedColor* FindColor(const icChar *szColor) const;
@@ -179,6 +181,10 @@ public:
   icUInt32Number GetSpectralSamples() { return m_nSpectralSamples; }
 
 protected:
+  bool GetColorValues(icFloatNumber *dstColor, const CIccStructNamedColor *pColor,
+                      icNamedColorlMemberSignature sig, icUInt32Number nSamples) const;
+  void ResetIndex();
+
   bool GetTint(icFloatNumber *dstColor,
                CIccTagNumArray *pZero,
                CIccTagNumArray *pData,
@@ -196,6 +202,11 @@ protected:
 
   icNamedColorStructList *m_list;
 
+  CIccStructNamedColor **m_pColors;  ///Named colors in the order of m_pTag
+  icUInt32Number m_nColors;
+  CIccKdTree *m_pPcsIndex;           ///Nearest Lab search of m_pColors
+  CIccKdTree *m_pSpectralIndex;      ///Nearest spectral search of m_pColors
+
   icUInt32Number m_nDeviceSamples;
   icUInt32Number m_nPcsSamples;
   icUInt32Number m_nSpectralSamples;
@@ -84,6 +84,7 @@
 #include "IccSparseMatrix.h"
 #include "IccEncoding.h"
 #include "IccMatrixMath.h"
+#include "IccProfileCache.h"
 #include <cassert>
 
 #ifdef USEICCDEVNAMESPACE
@@ -1514,6 +1515,31 @@ CIccApplyXform *CIccXform::GetNewApply(icStatusCMM &status)
   return rv;
 }
 
+/**
+**************************************************************************
+* Name: CIccXform::ApplyN
+* 
+* Purpose: 
+*  Applies the xform to a span of pixels.  The default implementation
+*  calls Apply() once per pixel.  Derived xforms override this to avoid
+*  per-pixel virtual dispatch.
+*  
+* Args:
+*  pApply = ApplyXform object containing temporary storage used during Apply
+*  DstPixels = Destination pixels where the results are stored,
+*  SrcPixels = Source pixels which are to be applied,
+*  nPixels = number of pixels to apply,
+*  nDstStride = samples between destination pixels,
+*  nSrcStride = samples between source pixels.
+**************************************************************************
+*/
+void CIccXform::ApplyN(CIccApplyXform *pApply, icFloatNumber *DstPixels, const icFloatNumber *SrcPixels, icUInt32Number nPixels,
+                       icUInt32Number nDstStride, icUInt32Number nSrcStride) const
+{
+  for (icUInt32Number k=0; k<nPixels; k++, DstPixels+=nDstStride, SrcPixels+=nSrcStride)
+    Apply(pApply, DstPixels, SrcPixels);
+}
+
 /**
  **************************************************************************
 * Name: CIccXform::AdjustPCS
@@ -3492,6 +3518,20 @@ void CIccPcsXform::Apply(CIccApplyXform *pXform, icFloatNumber *DstPixel, const
   }
 }
 
+/**
+**************************************************************************
+* Name: CIccPcsXform::ApplyN
+* 
+* Purpose: 
+*  Applies the xform to a span of pixels without per-pixel virtual dispatch.
+**************************************************************************
+*/
+void CIccPcsXform::ApplyN(CIccApplyXform* pApply, icFloatNumber *DstPixels, const icFloatNumber *SrcPixels, icUInt32Number nPixels,
+                          icUInt32Number nDstStride, icUInt32Number nSrcStride) const
+{
+  ApplyEach(this, pApply, DstPixels, SrcPixels, nPixels, nDstStride, nSrcStride);
+}
+
 /**
 **************************************************************************
 * Name: CIccPcsStep::GetNewApply
@@ -5436,6 +5476,20 @@ void CIccXformMatrixTRC::Apply(CIccApplyXform* pApply, icFloatNumber *DstPixel,
     CheckDstAbs(DstPixel);
 }
 
+/**
+**************************************************************************
+* Name: CIccXformMatrixTRC::ApplyN
+* 
+* Purpose: 
+*  Applies the xform to a span of pixels without per-pixel virtual dispatch.
+**************************************************************************
+*/
+void CIccXformMatrixTRC::ApplyN(CIccApplyXform* pApply, icFloatNumber *DstPixels, const icFloatNumber *SrcPixels, icUInt32Number nPixels,
+                                icUInt32Number nDstStride, icUInt32Number nSrcStride) const
+{
+  ApplyEach(this, pApply, DstPixels, SrcPixels, nPixels, nDstStride, nSrcStride);
+}
+
 /**
  **************************************************************************
  * Name: CIccXformMatrixTRC::GetCurve
@@ -5793,6 +5847,35 @@ void CIccXform3DLut::Apply(CIccApplyXform* pApply, icFloatNumber *DstPixel, cons
      Pixel[i] = 0.0;
   }
 
+  ApplyPreCLUT(Pixel);
+
+  if (m_pTag->m_CLUT) {
+    if (m_nInterp==icInterpLinear)
+      m_pTag->m_CLUT->Interp3d(Pixel, Pixel);
+    else
+      m_pTag->m_CLUT->Interp3dTetra(Pixel, Pixel);
+  }
+
+  ApplyPostCLUT(Pixel);
+
+  for (i=0; i<m_pTag->m_nOutput; i++) {
+    DstPixel[i] = Pixel[i];
+  }
+
+  if (m_bDstPcsConversion)
+    CheckDstAbs(DstPixel);
+}
+
+/**
+**************************************************************************
+* Name: CIccXform3DLut::ApplyPreCLUT
+* 
+* Purpose: 
+*  Applies the curves (and matrix) of the xform that come before the CLUT.
+**************************************************************************
+*/
+void CIccXform3DLut::ApplyPreCLUT(icFloatNumber *Pixel) const
+{
   if (m_pTag->m_bInputMatrix) {
     if (m_ApplyCurvePtrB) {
       Pixel[0] = m_ApplyCurvePtrB[0]->Apply(Pixel[0]);
@@ -5809,20 +5892,6 @@ void CIccXform3DLut::Apply(CIccApplyXform* pApply, icFloatNumber *DstPixel, cons
       Pixel[1] = m_ApplyCurvePtrM[1]->Apply(Pixel[1]);
       Pixel[2] = m_ApplyCurvePtrM[2]->Apply(Pixel[2]);
     }
-
-    if (m_pTag->m_CLUT) {
-      if (m_nInterp==icInterpLinear)
-        m_pTag->m_CLUT->Interp3d(Pixel, Pixel);
-      else
-        m_pTag->m_CLUT->Interp3dTetra(Pixel, Pixel);
-    }
-
-    if (m_ApplyCurvePtrA) {
-      for (i=0; i<m_pTag->m_nOutput; i++) {
-        Pixel[i] = m_ApplyCurvePtrA[i]->Apply(Pixel[i]);
-      }
-    }
-
   }
   else {
     if (m_ApplyCurvePtrA) {
@@ -5830,14 +5899,29 @@ void CIccXform3DLut::Apply(CIccApplyXform* pApply, icFloatNumber *DstPixel, cons
       Pixel[1] = m_ApplyCurvePtrA[1]->Apply(Pixel[1]);
       Pixel[2] = m_ApplyCurvePtrA[2]->Apply(Pixel[2]);
     }
+  }
+}
 
-    if (m_pTag->m_CLUT) {
-      if (m_nInterp==icInterpLinear)
-        m_pTag->m_CLUT->Interp3d(Pixel, Pixel);
-      else
-        m_pTag->m_CLUT->Interp3dTetra(Pixel, Pixel);
-    }
+/**
+**************************************************************************
+* Name: CIccXform3DLut::ApplyPostCLUT
+* 
+* Purpose: 
+*  Applies the curves (and matrix) of the xform that come after the CLUT.
+**************************************************************************
+*/
+void CIccXform3DLut::ApplyPostCLUT(icFloatNumber *Pixel) const
+{
+  int i;
 
+  if (m_pTag->m_bInputMatrix) {
+    if (m_ApplyCurvePtrA) {
+      for (i=0; i<m_pTag->m_nOutput; i++) {
+        Pixel[i] = m_ApplyCurvePtrA[i]->Apply(Pixel[i]);
+      }
+    }
+  }
+  else {
     if (m_ApplyCurvePtrM) {
       for (i=0; i<m_pTag->m_nOutput; i++) {
         Pixel[i] = m_ApplyCurvePtrM[i]->Apply(Pixel[i]);
@@ -5854,13 +5938,63 @@ void CIccXform3DLut::Apply(CIccApplyXform* pApply, icFloatNumber *DstPixel, cons
       }
     }
   }
+}
 
-  for (i=0; i<m_pTag->m_nOutput; i++) {
-    DstPixel[i] = Pixel[i];
+/**
+**************************************************************************
+* Name: CIccXform3DLut::ApplyN
+* 
+* Purpose: 
+*  Applies the xform to a span of pixels without per-pixel virtual dispatch.
+*  The CLUT of blocks of icCLUTBlockPixels pixels is interpolated with
+*  CIccCLUT::InterpN().
+**************************************************************************
+*/
+void CIccXform3DLut::ApplyN(CIccApplyXform* pApply, icFloatNumber *DstPixels, const icFloatNumber *SrcPixels, icUInt32Number nPixels,
+                            icUInt32Number nDstStride, icUInt32Number nSrcStride) const
+{
+  if (!m_pTag->m_CLUT) {
+    ApplyEach(this, pApply, DstPixels, SrcPixels, nPixels, nDstStride, nSrcStride);
+    return;
   }
 
-  if (m_bDstPcsConversion)
-    CheckDstAbs(DstPixel);
+  icFloatNumber Pixels[icCLUTBlockPixels*16];
+  icUInt32Number k;
+  int i;
+
+  while (nPixels) {
+    icUInt32Number nBlock = nPixels < icCLUTBlockPixels ? nPixels : icCLUTBlockPixels;
+    icFloatNumber *Pixel = Pixels;
+
+    for (k=0; k<nBlock; k++, SrcPixels+=nSrcStride, Pixel+=16) {
+      const icFloatNumber *SrcPixel = SrcPixels;
+
+      if (m_bSrcPcsConversion)
+        SrcPixel = CheckSrcAbs(pApply, SrcPixel);
+
+      Pixel[0] = SrcPixel[0];
+      Pixel[1] = SrcPixel[1];
+      Pixel[2] = SrcPixel[2];
+
+      ApplyPreCLUT(Pixel);
+    }
+
+    m_pTag->m_CLUT->InterpN(Pixels, Pixels, nBlock, 16, 16, m_nInterp!=icInterpLinear);
+
+    Pixel = Pixels;
+    for (k=0; k<nBlock; k++, DstPixels+=nDstStride, Pixel+=16) {
+      ApplyPostCLUT(Pixel);
+
+      for (i=0; i<m_pTag->m_nOutput; i++) {
+        DstPixels[i] = Pixel[i];
+      }
+
+      if (m_bDstPcsConversion)
+        CheckDstAbs(DstPixels);
+    }
+
+    nPixels -= nBlock;
+  }
 }
 
 /**
@@ -5947,6 +6081,38 @@ LPIccCurve* CIccXform3DLut::ExtractOutputCurves()
   return NULL;
 }
 
+/**
+**************************************************************************
+* Name: CIccXform3DLut::GetCLUTStages
+* 
+* Purpose: 
+*  Returns the CLUT along with its input and output curves when the xform
+*  applies nothing else (no matrix, M curves or PCS adjustments) so that
+*  the xform can be evaluated directly from the CLUT.  Should be called
+*  only after Begin() has been called.  Only tetrahedral interpolation
+*  is supported.
+*  
+* Return:
+*  Pointer to the CLUT, or NULL if the xform cannot be reduced to a CLUT.
+**************************************************************************
+*/
+const CIccCLUT *CIccXform3DLut::GetCLUTStages(const LPIccCurve *&pInputCurves, const LPIccCurve *&pOutputCurves) const
+{
+  if (!m_pTag || !m_pTag->m_CLUT || m_bAdjustPCS || m_ApplyMatrixPtr || m_ApplyCurvePtrM || m_nInterp!=icInterpTetrahedral)
+    return NULL;
+
+  if (m_pTag->m_bInputMatrix) {
+    pInputCurves = m_ApplyCurvePtrB;
+    pOutputCurves = m_ApplyCurvePtrA;
+  }
+  else {
+    pInputCurves = m_ApplyCurvePtrA;
+    pOutputCurves = m_ApplyCurvePtrB;
+  }
+
+  return m_pTag->m_CLUT;
+}
+
 /**
  **************************************************************************
  * Name: CIccXform4DLut::CIccXform4DLut
@@ -6145,6 +6311,32 @@ void CIccXform4DLut::Apply(CIccApplyXform* pApply, icFloatNumber *DstPixel, cons
   Pixel[2] = SrcPixel[2];
   Pixel[3] = SrcPixel[3];
 
+  ApplyPreCLUT(Pixel);
+
+  if (m_pTag->m_CLUT) {
+    m_pTag->m_CLUT->Interp4d(Pixel, Pixel);
+  }
+
+  ApplyPostCLUT(Pixel);
+
+  for (i=0; i<m_pTag->m_nOutput; i++) {
+    DstPixel[i] = Pixel[i];
+  }
+
+  if (m_bDstPcsConversion)
+    CheckDstAbs(DstPixel);
+}
+
+/**
+**************************************************************************
+* Name: CIccXform4DLut::ApplyPreCLUT
+* 
+* Purpose: 
+*  Applies the curves of the xform that come before the CLUT.
+**************************************************************************
+*/
+void CIccXform4DLut::ApplyPreCLUT(icFloatNumber *Pixel) const
+{
   if (m_pTag->m_bInputMatrix) {
     if (m_ApplyCurvePtrB) {
       Pixel[0] = m_ApplyCurvePtrB[0]->Apply(Pixel[0]);
@@ -6152,17 +6344,6 @@ void CIccXform4DLut::Apply(CIccApplyXform* pApply, icFloatNumber *DstPixel, cons
       Pixel[2] = m_ApplyCurvePtrB[2]->Apply(Pixel[2]);
       Pixel[3] = m_ApplyCurvePtrB[3]->Apply(Pixel[3]);
     }
-
-    if (m_pTag->m_CLUT) {
-      m_pTag->m_CLUT->Interp4d(Pixel, Pixel);
-    }
-
-    if (m_ApplyCurvePtrA) {
-      for (i=0; i<m_pTag->m_nOutput; i++) {
-        Pixel[i] = m_ApplyCurvePtrA[i]->Apply(Pixel[i]);
-      }
-    }
-
   }
   else {
     if (m_ApplyCurvePtrA) {
@@ -6171,11 +6352,29 @@ void CIccXform4DLut::Apply(CIccApplyXform* pApply, icFloatNumber *DstPixel, cons
       Pixel[2] = m_ApplyCurvePtrA[2]->Apply(Pixel[2]);
       Pixel[3] = m_ApplyCurvePtrA[3]->Apply(Pixel[3]);
     }
+  }
+}
 
-    if (m_pTag->m_CLUT) {
-      m_pTag->m_CLUT->Interp4d(Pixel, Pixel);
-    }
+/**
+**************************************************************************
+* Name: CIccXform4DLut::ApplyPostCLUT
+* 
+* Purpose: 
+*  Applies the curves (and matrix) of the xform that come after the CLUT.
+**************************************************************************
+*/
+void CIccXform4DLut::ApplyPostCLUT(icFloatNumber *Pixel) const
+{
+  int i;
 
+  if (m_pTag->m_bInputMatrix) {
+    if (m_ApplyCurvePtrA) {
+      for (i=0; i<m_pTag->m_nOutput; i++) {
+        Pixel[i] = m_ApplyCurvePtrA[i]->Apply(Pixel[i]);
+      }
+    }
+  }
+  else {
     if (m_ApplyCurvePtrM) {
       for (i=0; i<m_pTag->m_nOutput; i++) {
         Pixel[i] = m_ApplyCurvePtrM[i]->Apply(Pixel[i]);
@@ -6192,13 +6391,64 @@ void CIccXform4DLut::Apply(CIccApplyXform* pApply, icFloatNumber *DstPixel, cons
       }
     }
   }
+}
 
-  for (i=0; i<m_pTag->m_nOutput; i++) {
-    DstPixel[i] = Pixel[i];
+/**
+**************************************************************************
+* Name: CIccXform4DLut::ApplyN
+* 
+* Purpose: 
+*  Applies the xform to a span of pixels without per-pixel virtual dispatch.
+*  The CLUT of blocks of icCLUTBlockPixels pixels is interpolated with
+*  CIccCLUT::InterpN().
+**************************************************************************
+*/
+void CIccXform4DLut::ApplyN(CIccApplyXform* pApply, icFloatNumber *DstPixels, const icFloatNumber *SrcPixels, icUInt32Number nPixels,
+                            icUInt32Number nDstStride, icUInt32Number nSrcStride) const
+{
+  if (!m_pTag->m_CLUT) {
+    ApplyEach(this, pApply, DstPixels, SrcPixels, nPixels, nDstStride, nSrcStride);
+    return;
   }
 
-  if (m_bDstPcsConversion)
-    CheckDstAbs(DstPixel);
+  icFloatNumber Pixels[icCLUTBlockPixels*16];
+  icUInt32Number k;
+  int i;
+
+  while (nPixels) {
+    icUInt32Number nBlock = nPixels < icCLUTBlockPixels ? nPixels : icCLUTBlockPixels;
+    icFloatNumber *Pixel = Pixels;
+
+    for (k=0; k<nBlock; k++, SrcPixels+=nSrcStride, Pixel+=16) {
+      const icFloatNumber *SrcPixel = SrcPixels;
+
+      if (m_bSrcPcsConversion)
+        SrcPixel = CheckSrcAbs(pApply, SrcPixel);
+
+      Pixel[0] = SrcPixel[0];
+      Pixel[1] = SrcPixel[1];
+      Pixel[2] = SrcPixel[2];
+      Pixel[3] = SrcPixel[3];
+
+      ApplyPreCLUT(Pixel);
+    }
+
+    m_pTag->m_CLUT->InterpN(Pixels, Pixels, nBlock, 16, 16);
+
+    Pixel = Pixels;
+    for (k=0; k<nBlock; k++, DstPixels+=nDstStride, Pixel+=16) {
+      ApplyPostCLUT(Pixel);
+
+      for (i=0; i<m_pTag->m_nOutput; i++) {
+        DstPixels[i] = Pixel[i];
+      }
+
+      if (m_bDstPcsConversion)
+        CheckDstAbs(DstPixels);
+    }
+
+    nPixels -= nBlock;
+  }
 }
 
 /**
@@ -6288,6 +6538,37 @@ LPIccCurve* CIccXform4DLut::ExtractOutputCurves()
 }
 
 
+/**
+**************************************************************************
+* Name: CIccXform4DLut::GetCLUTStages
+* 
+* Purpose: 
+*  Returns the CLUT along with its input and output curves when the xform
+*  applies nothing else (no matrix, M curves or PCS adjustments) so that
+*  the xform can be evaluated directly from the CLUT.  Should be called
+*  only after Begin() has been called.
+*  
+* Return:
+*  Pointer to the CLUT, or NULL if the xform cannot be reduced to a CLUT.
+**************************************************************************
+*/
+const CIccCLUT *CIccXform4DLut::GetCLUTStages(const LPIccCurve *&pInputCurves, const LPIccCurve *&pOutputCurves) const
+{
+  if (!m_pTag || !m_pTag->m_CLUT || m_bAdjustPCS || m_ApplyMatrixPtr || m_ApplyCurvePtrM)
+    return NULL;
+
+  if (m_pTag->m_bInputMatrix) {
+    pInputCurves = m_ApplyCurvePtrB;
+    pOutputCurves = m_ApplyCurvePtrA;
+  }
+  else {
+    pInputCurves = m_ApplyCurvePtrA;
+    pOutputCurves = m_ApplyCurvePtrB;
+  }
+
+  return m_pTag->m_CLUT;
+}
+
 /**
  **************************************************************************
  * Name: CIccXformNDLut::CIccXformNDLut
@@ -6527,60 +6808,89 @@ void CIccXformNDLut::Apply(CIccApplyXform* pApply, icFloatNumber *DstPixel, cons
   for (i=0; i<nInput; i++)
     Pixel[i] = SrcPixel[i];
 
-  if (m_pTag->m_bInputMatrix) {
-    if (m_ApplyCurvePtrB) {
-      for (i=0; i<nInput; i++)
-        Pixel[i] = m_ApplyCurvePtrB[i]->Apply(Pixel[i]);
-    }
+  ApplyPreCLUT(Pixel);
 
-    if (m_pTag->m_CLUT) {
-      switch(nInput) {
-      case 5:
-        m_pTag->m_CLUT->Interp5d(Pixel, Pixel);
-        break;
-      case 6:
-        m_pTag->m_CLUT->Interp6d(Pixel, Pixel);
+  if (m_pTag->m_CLUT) {
+    switch(nInput) {
+    case 1:
+      m_pTag->m_CLUT->Interp1d(Pixel, Pixel);
+      break;
+    case 2:
+      m_pTag->m_CLUT->Interp2d(Pixel, Pixel);
+      break;
+    case 5:
+      m_pTag->m_CLUT->Interp5d(Pixel, Pixel);
+      break;
+    case 6:
+      m_pTag->m_CLUT->Interp6d(Pixel, Pixel);
+      break;
+    default:
+      {
+        CIccApplyNDLutXform* pNDApply = (CIccApplyNDLutXform*)pApply;
+        m_pTag->m_CLUT->InterpND(Pixel, Pixel, pNDApply->m_pApply);
         break;
-      default:
-        {
-          CIccApplyNDLutXform* pNDApply = (CIccApplyNDLutXform*)pApply;
-          m_pTag->m_CLUT->InterpND(Pixel, Pixel, pNDApply->m_pApply);
-          break;
-        }
       }
     }
+  }
 
-    if (m_ApplyCurvePtrA) {
-      for (i=0; i<m_pTag->m_nOutput; i++) {
-        Pixel[i] = m_ApplyCurvePtrA[i]->Apply(Pixel[i]);
-      }
-    }
+  ApplyPostCLUT(Pixel);
+
+  int nOutput = (m_pTag->m_nOutput > 16) ? 16 : m_pTag->m_nOutput;
+  for (i=0; i<nOutput; i++) {
+    DstPixel[i] = Pixel[i];
+  }
+
+  if (m_bDstPcsConversion)
+    CheckDstAbs(DstPixel);
+}
+
+/**
+**************************************************************************
+* Name: CIccXformNDLut::ApplyPreCLUT
+* 
+* Purpose: 
+*  Applies the curves of the xform that come before the CLUT.
+**************************************************************************
+*/
+void CIccXformNDLut::ApplyPreCLUT(icFloatNumber *Pixel) const
+{
+  int i;
+  int nInput = (m_nNumInput > 16) ? 16 : m_nNumInput;
 
+  if (m_pTag->m_bInputMatrix) {
+    if (m_ApplyCurvePtrB) {
+      for (i=0; i<nInput; i++)
+        Pixel[i] = m_ApplyCurvePtrB[i]->Apply(Pixel[i]);
+    }
   }
   else {
     if (m_ApplyCurvePtrA) {
       for (i=0; i<nInput; i++)
         Pixel[i] = m_ApplyCurvePtrA[i]->Apply(Pixel[i]);
     }
+  }
+}
 
-    if (m_pTag->m_CLUT) {
-      switch(m_nNumInput) {
-      case 5:
-        m_pTag->m_CLUT->Interp5d(Pixel, Pixel);
-        break;
-      case 6:
-        m_pTag->m_CLUT->Interp6d(Pixel, Pixel);
-        break;
-      default:
-      {
-        CIccApplyNDLutXform* pNDApply = (CIccApplyNDLutXform*)pApply;
-        m_pTag->m_CLUT->InterpND(Pixel, Pixel, pNDApply->m_pApply);
-        break;
-      }
-      break;
+/**
+**************************************************************************
+* Name: CIccXformNDLut::ApplyPostCLUT
+* 
+* Purpose: 
+*  Applies the curves (and matrix) of the xform that come after the CLUT.
+**************************************************************************
+*/
+void CIccXformNDLut::ApplyPostCLUT(icFloatNumber *Pixel) const
+{
+  int i;
+
+  if (m_pTag->m_bInputMatrix) {
+    if (m_ApplyCurvePtrA) {
+      for (i=0; i<m_pTag->m_nOutput; i++) {
+        Pixel[i] = m_ApplyCurvePtrA[i]->Apply(Pixel[i]);
       }
     }
-
+  }
+  else {
     if (m_ApplyCurvePtrM) {
       for (i=0; i<m_pTag->m_nOutput; i++) {
         Pixel[i] = m_ApplyCurvePtrM[i]->Apply(Pixel[i]);
@@ -6597,14 +6907,64 @@ void CIccXformNDLut::Apply(CIccApplyXform* pApply, icFloatNumber *DstPixel, cons
       }
     }
   }
+}
 
-  int nOutput = (m_pTag->m_nOutput > 16) ? 16 : m_pTag->m_nOutput;
-  for (i=0; i<nOutput; i++) {
-    DstPixel[i] = Pixel[i];
+/**
+**************************************************************************
+* Name: CIccXformNDLut::ApplyN
+* 
+* Purpose: 
+*  Applies the xform to a span of pixels without per-pixel virtual dispatch.
+*  The CLUT of blocks of icCLUTBlockPixels pixels is interpolated with
+*  CIccCLUT::InterpN().
+**************************************************************************
+*/
+void CIccXformNDLut::ApplyN(CIccApplyXform* pApply, icFloatNumber *DstPixels, const icFloatNumber *SrcPixels, icUInt32Number nPixels,
+                            icUInt32Number nDstStride, icUInt32Number nSrcStride) const
+{
+  //Interp5d and Interp6d have SIMD kernels, other CLUTs use InterpND
+  if (!m_pTag->m_CLUT || m_nNumInput<5 || m_nNumInput>16 || m_pTag->m_nOutput>16) {
+    ApplyEach(this, pApply, DstPixels, SrcPixels, nPixels, nDstStride, nSrcStride);
+    return;
   }
 
-  if (m_bDstPcsConversion)
-    CheckDstAbs(DstPixel);
+  CIccApplyNDLutXform* pNDApply = (CIccApplyNDLutXform*)pApply;
+  icFloatNumber Pixels[icCLUTBlockPixels*16];
+  icUInt32Number k;
+  int i;
+
+  while (nPixels) {
+    icUInt32Number nBlock = nPixels < icCLUTBlockPixels ? nPixels : icCLUTBlockPixels;
+    icFloatNumber *Pixel = Pixels;
+
+    for (k=0; k<nBlock; k++, SrcPixels+=nSrcStride, Pixel+=16) {
+      const icFloatNumber *SrcPixel = SrcPixels;
+
+      if (m_bSrcPcsConversion)
+        SrcPixel = CheckSrcAbs(pApply, SrcPixel);
+
+      for (i=0; i<m_nNumInput; i++)
+        Pixel[i] = SrcPixel[i];
+
+      ApplyPreCLUT(Pixel);
+    }
+
+    m_pTag->m_CLUT->InterpN(Pixels, Pixels, nBlock, 16, 16, true, pNDApply->m_pApply);
+
+    Pixel = Pixels;
+    for (k=0; k<nBlock; k++, DstPixels+=nDstStride, Pixel+=16) {
+      ApplyPostCLUT(Pixel);
+
+      for (i=0; i<m_pTag->m_nOutput; i++) {
+        DstPixels[i] = Pixel[i];
+      }
+
+      if (m_bDstPcsConversion)
+        CheckDstAbs(DstPixels);
+    }
+
+    nPixels -= nBlock;
+  }
 }
 
 /**
@@ -6711,6 +7071,7 @@ CIccXformNamedColor::CIccXformNamedColor(CIccTag *pTag, icColorSpaceSignature cs
 {
   m_nApplyInterface = icApplyPixel2Pixel; // was uninitialized
   m_pTag = NULL;
+  m_pArray = NULL;
   if (pTag) {
     if (pTag->GetType()==icSigNamedColor2Type) {
       m_pTag = (CIccTagNamedColor2*)pTag;
@@ -6732,7 +7093,6 @@ CIccXformNamedColor::CIccXformNamedColor(CIccTag *pTag, icColorSpaceSignature cs
 
   m_nSrcSpace = icSigUnknownData;
   m_nDestSpace = icSigUnknownData;
-  m_pArray = NULL;
 }
 
 
@@ -7626,6 +7986,101 @@ void CIccXformMpe::Apply(CIccApplyXform* pApply, icFloatNumber *DstPixel, const
   }
 }
 
+/**
+**************************************************************************
+* Name: CIccXformMpe::ApplyN
+* 
+* Purpose: 
+*  Applies the xform to a span of pixels without per-pixel virtual dispatch.
+**************************************************************************
+*/
+void CIccXformMpe::ApplyN(CIccApplyXform* pApply, icFloatNumber *DstPixels, const icFloatNumber *SrcPixels, icUInt32Number nPixels,
+                          icUInt32Number nDstStride, icUInt32Number nSrcStride) const
+{
+  //Note: pApply should be a CIccApplyXformMpe type here
+  CIccApplyXformMpe *pApplyMpe = (CIccApplyXformMpe *)pApply;
+  CIccApplyTagMpe *pApplyTag = pApplyMpe->m_pApply;
+  const CIccTagMultiProcessElement *pTag = m_pTag;
+  icUInt32Number k, n, nBlock;
+
+  if (!pApplyTag) {
+    ApplyEach(this, pApply, DstPixels, SrcPixels, nPixels, nDstStride, nSrcStride);
+    return;
+  }
+
+  if (!m_bInput || m_bPcsAdjustXform) { //PCS comming in?
+    //Source pixels are converted into the first block of the tag apply object
+    icUInt32Number nSrc = pTag->NumInputChannels();
+    icFloatNumber *pStage = pApplyTag->GetBlockBuf(0);
+
+    if (!pStage || (nSrc<3 && (GetSrcSpace()==icSigXYZData || GetSrcSpace()==icSigLabData))) {
+      ApplyEach(this, pApply, DstPixels, SrcPixels, nPixels, nDstStride, nSrcStride);
+      return;
+    }
+
+    for (n=0; n<nPixels; n+=nBlock) {
+      nBlock = nPixels - n;
+      if (nBlock>icMpeBlockPixels)
+        nBlock = icMpeBlockPixels;
+
+      icFloatNumber *pPixel = pStage;
+      for (k=0; k<nBlock; k++, SrcPixels+=nSrcStride, pPixel+=nSrc) {
+        const icFloatNumber *pSrc = SrcPixels;
+
+        if (m_nIntent != icAbsoluteColorimetric || m_nIntent != m_nTagIntent) {  //B2D3 tags don't need abs conversion
+          if (m_bSrcPcsConversion)
+            pSrc = CheckSrcAbs(pApply, pSrc);
+        }
+        memcpy(pPixel, pSrc, nSrc*sizeof(icFloatNumber));
+
+        //Since MPE tags use "real" values for PCS we need to convert from 
+        //internal encoding used by IccProfLib
+        switch (GetSrcSpace()) {
+          case icSigXYZData:
+            icXyzFromPcs(pPixel);
+            break;
+
+          case icSigLabData:
+            icLabFromPcs(pPixel);
+            break;
+
+          default:
+            break;
+        }
+      }
+
+      pTag->ApplyN(pApplyTag, DstPixels + n*nDstStride, pStage, nBlock, nDstStride, nSrc);
+    }
+  }
+  else {
+    pTag->ApplyN(pApplyTag, DstPixels, SrcPixels, nPixels, nDstStride, nSrcStride);
+  }
+
+  if (m_bInput) { //PCS going out?
+    for (k=0; k<nPixels; k++, DstPixels+=nDstStride) {
+      //Since MPE tags use "real" values for PCS we need to convert to
+      //internal encoding used by IccProfLib
+      switch(GetDstSpace()) {
+        case icSigXYZData:
+          icXyzToPcs(DstPixels);
+          break;
+
+        case icSigLabData:
+          icLabToPcs(DstPixels);
+          break;
+
+        default:
+          break;
+      }
+
+      if (m_nIntent != icAbsoluteColorimetric || m_nIntent != m_nTagIntent) { //D2B3 tags don't need abs conversion
+        if (m_bDstPcsConversion)
+          CheckDstAbs(DstPixels);
+      }
+    }
+  }
+}
+
 /**
 **************************************************************************
 * Name: CIccApplyXformMpe::CIccApplyXformMpe
@@ -7675,6 +8130,13 @@ CIccApplyCmm::CIccApplyCmm(CIccCmm *pCmm)
 
   m_Pixel = NULL;
   m_Pixel2 = NULL;
+
+  m_nBlockSamples = 0;
+  m_Block = NULL;
+  m_Block2 = NULL;
+
+  m_BufPixels = NULL;
+  m_BufCodes = NULL;
 }
 
 /**
@@ -7705,6 +8167,17 @@ CIccApplyCmm::~CIccApplyCmm()
     free(m_Pixel);
   if (m_Pixel2)
     free(m_Pixel2);
+
+  if (m_Block)
+    free(m_Block);
+  if (m_Block2)
+    free(m_Block2);
+
+  if (m_BufPixels)
+    free(m_BufPixels);
+
+  if (m_BufCodes)
+    free(m_BufCodes);
 }
 
 bool CIccApplyCmm::InitPixel()
@@ -7731,6 +8204,40 @@ bool CIccApplyCmm::InitPixel()
   return true;
 }
 
+/**
+**************************************************************************
+* Name: CIccApplyCmm::InitBlock
+* 
+* Purpose: 
+*  Allocates the scratch buffers used to pass blocks of icCmmBlockPixels
+*  pixels between xforms in the span based Apply.
+**************************************************************************
+*/
+bool CIccApplyCmm::InitBlock()
+{
+  if (m_Block && m_Block2)
+    return true;
+
+  icUInt16Number nSamples = 16;
+  CIccApplyXformList::iterator i;
+
+  for (i=m_Xforms->begin(); i!=m_Xforms->end(); i++) {
+    if (i->ptr->GetXform()) {
+      icUInt16Number nXformSamples = i->ptr->GetXform()->GetNumDstSamples();
+      if (nXformSamples>nSamples)
+        nSamples=nXformSamples;
+    }
+  }
+  m_nBlockSamples = nSamples;
+  m_Block = (icFloatNumber*)malloc((size_t)icCmmBlockPixels*nSamples*sizeof(icFloatNumber));
+  m_Block2 = (icFloatNumber*)malloc((size_t)icCmmBlockPixels*nSamples*sizeof(icFloatNumber));
+
+  if (!m_Block || !m_Block2)
+    return false;
+
+  return true;
+}
+
 //#define DEBUG_CMM_APPLY
 
 #ifdef DEBUG_CMM_APPLY
@@ -7836,53 +8343,60 @@ icStatusCMM CIccApplyCmm::Apply(icFloatNumber *DstPixel, const icFloatNumber *Sr
 * Name: CIccApplyCmm::Apply
 * 
 * Purpose: 
-*  Does the actual application of the Xforms in the list.
+*  Does the actual application of the Xforms in the list to a span of
+*  pixels.  Pixels are processed in blocks of icCmmBlockPixels with each
+*  xform applied to the whole block (using ApplyN) before moving on to the
+*  next xform.  Intermediate results are held in the m_Block scratch buffers.
 *  
 * Args:
-*  DstPixel = Destination pixel where the result is stored,
-*  SrcPixel = Source pixel which is to be applied.
+*  DstPixel = Destination pixels where the results are stored,
+*  SrcPixel = Source pixels which are to be applied,
+*  nPixels = number of pixels to apply.
 **************************************************************************
 */
 icStatusCMM CIccApplyCmm::Apply(icFloatNumber *DstPixel, const icFloatNumber *SrcPixel, icUInt32Number nPixels)
 {
-  icFloatNumber *pDst, *pTmp;
+  icFloatNumber *pDst;
   const icFloatNumber *pSrc;
   CIccApplyXformList::iterator i;
   int j, n = (int)m_Xforms->size();
-  icUInt32Number k;
+  icUInt32Number nSrcStride, nBlock;
+  icUInt16Number nSrcSamples = m_pCmm->GetSourceSamples();
+  icUInt16Number nDstSamples = m_pCmm->GetDestSamples();
 
   if (!n)
     return icCmmStatBadXform;
 
-  if (!m_Pixel && !InitPixel()) {
+  if (n==1) {
+    i = m_Xforms->begin();
+    i->ptr->ApplyN(DstPixel, SrcPixel, nPixels, nDstSamples, nSrcSamples);
+    return icCmmStatOk;
+  }
+
+  if (!m_Block && !InitBlock()) {
     return icCmmStatAllocErr;
   }
 
-  for (k=0; k<nPixels; k++) {
-    pSrc = SrcPixel;
-    pDst = m_Pixel;
+  while (nPixels) {
+    nBlock = nPixels < icCmmBlockPixels ? nPixels : icCmmBlockPixels;
 
-    if (n>1) {
-      for (j=0, i=m_Xforms->begin(); j<n-1 && i!=m_Xforms->end(); i++, j++) {
+    pSrc = SrcPixel;
+    nSrcStride = nSrcSamples;
+    pDst = m_Block;
 
-        i->ptr->Apply(pDst, pSrc);
-        pTmp = (icFloatNumber*)pSrc;
-        pSrc = pDst;
-        if (pTmp==SrcPixel)
-          pDst = m_Pixel2;
-        else
-          pDst = pTmp;
-      }
+    for (j=0, i=m_Xforms->begin(); j<n-1 && i!=m_Xforms->end(); i++, j++) {
+      i->ptr->ApplyN(pDst, pSrc, nBlock, m_nBlockSamples, nSrcStride);
 
-      i->ptr->Apply(DstPixel, pSrc);
-    }
-    else if (n==1) {
-      i = m_Xforms->begin();
-      i->ptr->Apply(DstPixel, SrcPixel);
+      pSrc = pDst;
+      nSrcStride = m_nBlockSamples;
+      pDst = (pDst==m_Block) ? m_Block2 : m_Block;
     }
 
-    DstPixel += m_pCmm->GetDestSamples();
-    SrcPixel += m_pCmm->GetSourceSamples();
+    i->ptr->ApplyN(DstPixel, pSrc, nBlock, nDstSamples, nSrcStride);
+
+    DstPixel += nBlock * nDstSamples;
+    SrcPixel += nBlock * nSrcSamples;
+    nPixels -= nBlock;
   }
 
   return icCmmStatOk;
@@ -7897,61 +8411,392 @@ void CIccApplyCmm::AppendApplyXform(CIccApplyXform *pApplyXform)
 }
 
 /**
- **************************************************************************
- * Name: CIccCmm::CIccCmm
- * 
- * Purpose: 
- *  Constructor
- *
- * Args:
- *  nSrcSpace = signature of the source color space,
- *  nDestSpace = signature of the destination color space,
- *  bFirstInput = true if the first profile added is an input profile
- **************************************************************************
- */
-CIccCmm::CIccCmm(icColorSpaceSignature nSrcSpace /*=icSigUnknownData*/,
-                 icColorSpaceSignature nDestSpace /*=icSigUnknownData*/,
-                 bool bFirstInput /*=true*/)
+**************************************************************************
+* Name: icGetBufferSampleSize
+* 
+* Purpose: 
+*  Returns the number of bytes used by a sample of type nType (0 if unknown)
+**************************************************************************
+*/
+icUInt32Number icGetBufferSampleSize(icBufferSampleType nType)
 {
-  m_bValid = false;
-
-  m_bLastInput = !bFirstInput;
-  m_nSrcSpace = nSrcSpace;
-  m_nDestSpace = nDestSpace;
-
-  m_nLastSpace = nSrcSpace;
-  m_nLastParentSpace = icSigNoColorData;
-  m_nLastIntent = icUnknownIntent;
-
-  m_Xforms = new CIccXformList;
-  m_Xforms->clear();
-
-  m_pApply = NULL;
+  switch(nType) {
+    case icBufferUInt8:
+      return 1;
+    case icBufferUInt16:
+    case icBufferFloat16:
+      return 2;
+    case icBufferFloat32:
+      return 4;
+    default:
+      return 0;
+  }
 }
 
 /**
- **************************************************************************
- * Name: CIccCmm::~CIccCmm
- * 
- * Purpose: 
- *  Destructor
- **************************************************************************
- */
-CIccCmm::~CIccCmm()
+**************************************************************************
+* Name: icUnpackSamples
+* 
+* Purpose: 
+*  Converts nPixels samples of type nType (nSrcStep samples apart) to
+*  internal float encoding (nDstStep floats apart).  8-bit samples use a
+*  lookup table so that no division is needed per sample.
+**************************************************************************
+*/
+static void icUnpackSamples(icFloatNumber *pDst, icUInt32Number nDstStep, const icUInt8Number *pSrc,
+                            icUInt32Number nSrcStep, icBufferSampleType nType, icUInt32Number nPixels)
 {
-  if (m_Xforms) {
-    CIccXformList::iterator i;
+  icUInt32Number i;
 
-    for (i=m_Xforms->begin(); i!=m_Xforms->end(); i++) {
-      if (i->ptr)
-        delete i->ptr;
-    }
+  switch(nType) {
+    case icBufferUInt8:
+      {
+        static struct icU8Table {
+          icU8Table() { for (int n=0; n<256; n++) v[n] = (icFloatNumber)n / 255.0f; }
+          icFloatNumber v[256];
+        } table;
 
-    delete m_Xforms;
+        for (i=0; i<nPixels; i++)
+          pDst[i*nDstStep] = table.v[pSrc[i*nSrcStep]];
+      }
+      break;
+
+    case icBufferUInt16:
+      {
+        const icUInt16Number *pSrc16 = (const icUInt16Number*)pSrc;
+
+        for (i=0; i<nPixels; i++)
+          pDst[i*nDstStep] = (icFloatNumber)pSrc16[i*nSrcStep] / 65535.0f;
+      }
+      break;
+
+    case icBufferFloat16:
+      {
+        const icFloat16Number *pSrc16 = (const icFloat16Number*)pSrc;
+
+        for (i=0; i<nPixels; i++)
+          pDst[i*nDstStep] = icF16toF(pSrc16[i*nSrcStep]);
+      }
+      break;
+
+    case icBufferFloat32:
+      {
+        const icFloat32Number *pSrc32 = (const icFloat32Number*)pSrc;
+
+        for (i=0; i<nPixels; i++)
+          pDst[i*nDstStep] = (icFloatNumber)pSrc32[i*nSrcStep];
+      }
+      break;
+  }
+}
+
+/**
+**************************************************************************
+* Name: icPackSamples
+* 
+* Purpose: 
+*  Converts nPixels floats in internal encoding (nSrcStep floats apart) to
+*  samples of type nType (nDstStep samples apart).  Integer samples are
+*  clipped to the [0.0, 1.0] range and rounded.
+**************************************************************************
+*/
+static void icPackSamples(icUInt8Number *pDst, icUInt32Number nDstStep, const icFloatNumber *pSrc,
+                          icUInt32Number nSrcStep, icBufferSampleType nType, icUInt32Number nPixels)
+{
+  icUInt32Number i;
+  icFloatNumber v;
+
+  switch(nType) {
+    case icBufferUInt8:
+      for (i=0; i<nPixels; i++) {
+        v = pSrc[i*nSrcStep];
+        v = (v > 0.0f) ? (v < 1.0f ? v : 1.0f) : 0.0f; //Also maps NaN to zero
+        pDst[i*nDstStep] = (icUInt8Number)(v * 255.0f + 0.5f);
+      }
+      break;
+
+    case icBufferUInt16:
+      {
+        icUInt16Number *pDst16 = (icUInt16Number*)pDst;
+
+        for (i=0; i<nPixels; i++) {
+          v = pSrc[i*nSrcStep];
+          v = (v > 0.0f) ? (v < 1.0f ? v : 1.0f) : 0.0f; //Also maps NaN to zero
+          pDst16[i*nDstStep] = (icUInt16Number)(v * 65535.0f + 0.5f);
+        }
+      }
+      break;
+
+    case icBufferFloat16:
+      {
+        icFloat16Number *pDst16 = (icFloat16Number*)pDst;
+
+        for (i=0; i<nPixels; i++)
+          pDst16[i*nDstStep] = icFtoF16((icFloat32Number)pSrc[i*nSrcStep]);
+      }
+      break;
+
+    case icBufferFloat32:
+      {
+        icFloat32Number *pDst32 = (icFloat32Number*)pDst;
+
+        for (i=0; i<nPixels; i++)
+          pDst32[i*nDstStep] = (icFloat32Number)pSrc[i*nSrcStep];
+      }
+      break;
+  }
+}
+
+/**
+**************************************************************************
+* Name: icUnpackCodes
+* 
+* Purpose: 
+*  Copies nPixels 8 or 16 bit samples (nSrcStep samples apart) to 16 bit
+*  codes (nDstStep codes apart) for fixed point interpolation.
+**************************************************************************
+*/
+static void icUnpackCodes(icUInt16Number *pDst, icUInt32Number nDstStep, const icUInt8Number *pSrc,
+                          icUInt32Number nSrcStep, icBufferSampleType nType, icUInt32Number nPixels)
+{
+  icUInt32Number i;
+
+  if (nType==icBufferUInt8) {
+    for (i=0; i<nPixels; i++)
+      pDst[i*nDstStep] = pSrc[i*nSrcStep];
+  }
+  else {
+    const icUInt16Number *pSrc16 = (const icUInt16Number*)pSrc;
+
+    for (i=0; i<nPixels; i++)
+      pDst[i*nDstStep] = pSrc16[i*nSrcStep];
+  }
+}
+
+/**
+**************************************************************************
+* Name: icPackCodes
+* 
+* Purpose: 
+*  Converts nPixels 16 bit interpolation results (nSrcStep codes apart) to
+*  8 or 16 bit samples (nDstStep samples apart) with rounding.
+**************************************************************************
+*/
+static void icPackCodes(icUInt8Number *pDst, icUInt32Number nDstStep, const icUInt16Number *pSrc,
+                        icUInt32Number nSrcStep, icBufferSampleType nType, icUInt32Number nPixels)
+{
+  icUInt32Number i;
+
+  if (nType==icBufferUInt8) {
+    for (i=0; i<nPixels; i++)
+      pDst[i*nDstStep] = (icUInt8Number)(((icUInt32Number)pSrc[i*nSrcStep]*255 + 32767) / 65535);
+  }
+  else {
+    icUInt16Number *pDst16 = (icUInt16Number*)pDst;
+
+    for (i=0; i<nPixels; i++)
+      pDst16[i*nDstStep] = pSrc[i*nSrcStep];
+  }
+}
+
+/**
+**************************************************************************
+* Name: CIccApplyCmm::ApplyBuffer
+* 
+* Purpose: 
+*  Applies the Xforms to an image buffer.  Each row is unpacked to internal
+*  encoding in blocks of icCmmBlockPixels pixels, applied using the span
+*  based Apply() and packed into the destination format.  Extra samples
+*  are copied from source to destination (converting the sample type as
+*  needed).  Destination extra samples without a source counterpart are
+*  set to zero.
+*  When the CMM has set up fixed point interpolation (see SetFixedInterp)
+*  and both buffers have integer samples of the supported sizes, colors
+*  are interpolated directly from the integer samples.
+*  
+* Args:
+*  pDst = destination image buffer,
+*  dstFormat = layout of destination samples,
+*  pSrc = source image buffer,
+*  srcFormat = layout of source samples,
+*  nWidth = number of pixels per row,
+*  nHeight = number of rows,
+*  nDstRowBytes = bytes between destination rows (0 = tightly packed),
+*  nSrcRowBytes = bytes between source rows (0 = tightly packed).
+**************************************************************************
+*/
+icStatusCMM CIccApplyCmm::ApplyBuffer(void *pDst, const icBufferFormat &dstFormat, const void *pSrc, const icBufferFormat &srcFormat,
+                                      icUInt32Number nWidth, icUInt32Number nHeight,
+                                      icUInt32Number nDstRowBytes, icUInt32Number nSrcRowBytes)
+{
+  icUInt32Number nSrcColor = m_pCmm->GetSourceSamples();
+  icUInt32Number nDstColor = m_pCmm->GetDestSamples();
+  icUInt32Number nSrcSize = icGetBufferSampleSize(srcFormat.nType);
+  icUInt32Number nDstSize = icGetBufferSampleSize(dstFormat.nType);
+
+  if (!nSrcColor || !nDstColor || !nSrcSize || !nDstSize)
+    return icCmmStatBadColorEncoding;
+
+  icUInt32Number nSrcTotal = nSrcColor + srcFormat.nExtraSamples;
+  icUInt32Number nDstTotal = nDstColor + dstFormat.nExtraSamples;
+
+  if (!nSrcRowBytes)
+    nSrcRowBytes = nWidth * nSrcSize * (srcFormat.bPlanar ? 1 : nSrcTotal);
+  if (!nDstRowBytes)
+    nDstRowBytes = nWidth * nDstSize * (dstFormat.bPlanar ? 1 : nDstTotal);
+
+  //Offsets in bytes between samples of a pixel and steps in samples between pixels
+  size_t nSrcSampleOffset = nSrcSize;
+  size_t nDstSampleOffset = nDstSize;
+
+  if (srcFormat.bPlanar)
+    nSrcSampleOffset = srcFormat.nPlaneBytes ? srcFormat.nPlaneBytes : (size_t)nSrcRowBytes * nHeight;
+  if (dstFormat.bPlanar)
+    nDstSampleOffset = dstFormat.nPlaneBytes ? dstFormat.nPlaneBytes : (size_t)nDstRowBytes * nHeight;
+  icUInt32Number nSrcStep = srcFormat.bPlanar ? 1 : nSrcTotal;
+  icUInt32Number nDstStep = dstFormat.bPlanar ? 1 : nDstTotal;
+
+  if (!m_BufPixels) {
+    //Extra space allows for xforms writing beyond the destination samples of the last pixel
+    m_BufPixels = (icFloatNumber*)malloc(((size_t)icCmmBlockPixels*(nSrcColor+nDstColor+1) + 16)*sizeof(icFloatNumber));
+    if (!m_BufPixels)
+      return icCmmStatAllocErr;
+  }
+
+  icFloatNumber *pSrcBuf = m_BufPixels;
+  icFloatNumber *pExtraBuf = pSrcBuf + icCmmBlockPixels*nSrcColor;
+  icFloatNumber *pDstBuf = pExtraBuf + icCmmBlockPixels;
+
+  icUInt32Number nExtra = srcFormat.nExtraSamples < dstFormat.nExtraSamples ? srcFormat.nExtraSamples : dstFormat.nExtraSamples;
+  icUInt32Number y, x, c, nBlock;
+  icStatusCMM rv;
+
+  //Use fixed point interpolation when set up by the CMM for this source type
+  const CIccCLUTFixed *pFixed = m_pCmm->m_pFixedCLUT;
+  if (pFixed && (srcFormat.nType!=(pFixed->GetInputBits()==8 ? icBufferUInt8 : icBufferUInt16) ||
+                 (dstFormat.nType!=icBufferUInt8 && dstFormat.nType!=icBufferUInt16)))
+    pFixed = NULL;
+
+  if (pFixed && !m_BufCodes) {
+    m_BufCodes = (icUInt16Number*)malloc((size_t)icCmmBlockPixels*(nSrcColor+nDstColor)*sizeof(icUInt16Number));
+    if (!m_BufCodes)
+      return icCmmStatAllocErr;
+  }
+
+  for (y=0; y<nHeight; y++) {
+    const icUInt8Number *pSrcRow = (const icUInt8Number*)pSrc + (size_t)y*nSrcRowBytes;
+    icUInt8Number *pDstRow = (icUInt8Number*)pDst + (size_t)y*nDstRowBytes;
+
+    for (x=0; x<nWidth; x+=nBlock) {
+      nBlock = nWidth-x < icCmmBlockPixels ? nWidth-x : icCmmBlockPixels;
+
+      const icUInt8Number *pSrcPix = pSrcRow + (size_t)x*nSrcStep*nSrcSize;
+      icUInt8Number *pDstPix = pDstRow + (size_t)x*nDstStep*nDstSize;
+
+      if (pFixed) {
+        icUInt16Number *pDstCodes = m_BufCodes + icCmmBlockPixels*nSrcColor;
+
+        for (c=0; c<nSrcColor; c++)
+          icUnpackCodes(m_BufCodes+c, nSrcColor, pSrcPix + c*nSrcSampleOffset, nSrcStep, srcFormat.nType, nBlock);
+
+        pFixed->Interp(pDstCodes, m_BufCodes, nBlock);
+
+        for (c=0; c<nDstColor; c++)
+          icPackCodes(pDstPix + c*nDstSampleOffset, nDstStep, pDstCodes+c, nDstColor, dstFormat.nType, nBlock);
+      }
+      else {
+        for (c=0; c<nSrcColor; c++)
+          icUnpackSamples(pSrcBuf+c, nSrcColor, pSrcPix + c*nSrcSampleOffset, nSrcStep, srcFormat.nType, nBlock);
+
+        rv = Apply(pDstBuf, pSrcBuf, nBlock);
+        if (rv != icCmmStatOk)
+          return rv;
+
+        for (c=0; c<nDstColor; c++)
+          icPackSamples(pDstPix + c*nDstSampleOffset, nDstStep, pDstBuf+c, nDstColor, dstFormat.nType, nBlock);
+      }
+
+      for (c=0; c<nExtra; c++) {
+        icUnpackSamples(pExtraBuf, 1, pSrcPix + (nSrcColor+c)*nSrcSampleOffset, nSrcStep, srcFormat.nType, nBlock);
+        icPackSamples(pDstPix + (nDstColor+c)*nDstSampleOffset, nDstStep, pExtraBuf, 1, dstFormat.nType, nBlock);
+      }
+      for (; c<dstFormat.nExtraSamples; c++) {
+        memset(pExtraBuf, 0, nBlock*sizeof(icFloatNumber));
+        icPackSamples(pDstPix + (nDstColor+c)*nDstSampleOffset, nDstStep, pExtraBuf, 1, dstFormat.nType, nBlock);
+      }
+    }
+  }
+
+  return icCmmStatOk;
+}
+
+/**
+ **************************************************************************
+ * Name: CIccCmm::CIccCmm
+ * 
+ * Purpose: 
+ *  Constructor
+ *
+ * Args:
+ *  nSrcSpace = signature of the source color space,
+ *  nDestSpace = signature of the destination color space,
+ *  bFirstInput = true if the first profile added is an input profile
+ **************************************************************************
+ */
+CIccCmm::CIccCmm(icColorSpaceSignature nSrcSpace /*=icSigUnknownData*/,
+                 icColorSpaceSignature nDestSpace /*=icSigUnknownData*/,
+                 bool bFirstInput /*=true*/)
+{
+  m_bValid = false;
+
+  m_bLastInput = !bFirstInput;
+  m_nSrcSpace = nSrcSpace;
+  m_nDestSpace = nDestSpace;
+
+  m_nLastSpace = nSrcSpace;
+  m_nLastParentSpace = icSigNoColorData;
+  m_nLastIntent = icUnknownIntent;
+
+  m_Xforms = new CIccXformList;
+  m_Xforms->clear();
+
+  m_pApply = NULL;
+
+  m_nCollapseGrid = 0;
+  m_nCollapseInterp = icInterpTetrahedral;
+  m_bCollapseLinearize = true;
+  memset(&m_CollapseStats, 0, sizeof(m_CollapseStats));
+
+  m_nFixedInputBits = 0;
+  m_pFixedCLUT = NULL;
+}
+
+/**
+ **************************************************************************
+ * Name: CIccCmm::~CIccCmm
+ * 
+ * Purpose: 
+ *  Destructor
+ **************************************************************************
+ */
+CIccCmm::~CIccCmm()
+{
+  if (m_Xforms) {
+    CIccXformList::iterator i;
+
+    for (i=m_Xforms->begin(); i!=m_Xforms->end(); i++) {
+      if (i->ptr)
+        delete i->ptr;
+    }
+
+    delete m_Xforms;
   }
 
   if (m_pApply)
     delete m_pApply;
+
+  if (m_pFixedCLUT)
+    delete m_pFixedCLUT;
 }
 
 const icChar* CIccCmm::GetStatusText(icStatusCMM stat)
@@ -7995,6 +8840,8 @@ const icChar* CIccCmm::GetStatusText(icStatusCMM stat)
     return "Too many samples used";
   case icCmmStatBadMCSLink:
     return "Invalid MCS link connection";
+  case icCmmStatCompiledMismatch:
+    return "Compiled transform does not match this library";
   default:
     return "Unknown CMM Status value";
 
@@ -8006,7 +8853,8 @@ const icChar* CIccCmm::GetStatusText(icStatusCMM stat)
  * Name: CIccCmm::AddXform
  * 
  * Purpose: 
- *  Adds a profile at the end of the Xform list 
+ *  Adds a profile at the end of the Xform list.  The profile is taken from
+ *  the process wide CIccProfileCache when the cache is enabled.
  * 
  * Args: 
  *  szProfilePath = file name of the profile to be added,
@@ -8028,7 +8876,9 @@ icStatusCMM CIccCmm::AddXform(const icChar *szProfilePath,
                               CIccCreateXformHintManager *pHintManager /*=NULL*/,
                               bool bUseSubProfile /*=false*/)
 {
-  CIccProfile *pProfile = OpenIccProfile(szProfilePath, bUseSubProfile);
+  CIccProfileCache *pCache = CIccProfileCache::GetProcessCache();
+  CIccProfile *pProfile = pCache->IsEnabled() ? pCache->OpenProfile(szProfilePath, bUseSubProfile) :
+                                                OpenIccProfile(szProfilePath, bUseSubProfile);
 
   if (!pProfile) 
     return icCmmStatCantOpenProfile;
@@ -8301,6 +9151,9 @@ icStatusCMM CIccCmm::AddXform(CIccProfile *pProfile,
   }
 
   CIccXformPtr Xform;
+
+  //Create() may replace (and delete) encoding class profiles
+  bool bMVIS = pProfile->m_Header.deviceClass==icSigMaterialVisualizationClass;
   
   Xform.ptr = CIccXform::Create(pProfile, bInput, nIntent, nInterp, pPcc, nLutType, bUseD2BxB2DxTags, pHintManager);
 
@@ -8308,7 +9161,7 @@ icStatusCMM CIccCmm::AddXform(CIccProfile *pProfile,
     return icCmmStatBadXform;
   }
 
-  if (pProfile->m_Header.deviceClass==icSigMaterialVisualizationClass) {
+  if (bMVIS) {
     bInput = true;
   }
 
@@ -8780,6 +9633,34 @@ icStatusCMM CIccCmm::Begin(bool bAllocApplyCmm/*=true*/, bool bUsePCSConversions
   if (rv != icCmmStatOk && rv!=icCmmStatIdentityXform)
     return rv;
 
+  //Begin(false) leaves m_pApply unset so a link that was already collapsed must not be collapsed again
+  if (m_nCollapseGrid && !m_CollapseStats.bCollapsed) {
+    icStatusCMM stat = CollapseXforms();
+    if (stat != icCmmStatOk)
+      return stat;
+  }
+
+  //Begin() may be called again (e.g. by CIccCmmCache)
+  if (m_pFixedCLUT) {
+    delete m_pFixedCLUT;
+    m_pFixedCLUT = NULL;
+  }
+
+  //Fixed point interpolation is used when the chain reduces to a single CLUT without output curves
+  if (m_nFixedInputBits && m_Xforms->size()==1) {
+    const LPIccCurve *pInputCurves = NULL, *pOutputCurves = NULL;
+    const CIccCLUT *pCLUT = m_Xforms->front().ptr->GetCLUTStages(pInputCurves, pOutputCurves);
+
+    if (pCLUT && !pOutputCurves) {
+      m_pFixedCLUT = new CIccCLUTFixed();
+
+      if (!m_pFixedCLUT->Init(pCLUT, m_nFixedInputBits, pInputCurves)) {
+        delete m_pFixedCLUT;
+        m_pFixedCLUT = NULL;
+      }
+    }
+  }
+
   if (bAllocApplyCmm) {
     m_pApply = GetNewApplyCmm(rv);
   }
@@ -8792,76 +9673,524 @@ icStatusCMM CIccCmm::Begin(bool bAllocApplyCmm/*=true*/, bool bUsePCSConversions
 
 /**
  **************************************************************************
- * Name: CIccCmm::GetNewApplyCmm
+ * Name: CIccCmm::SetCollapseLink
  * 
  * Purpose: 
- *  Allocates an CIccApplyCmm object that does the initialization of the Xforms
- *  that provides an Apply() function.
- *  Multiple CIccApplyCmm objects can be allocated and used in separate threads.
- *
+ *  Enables collapsing of the xform chain into a single device link CLUT
+ *  when Begin() is called.  Must be called before Begin().
+ * 
+ * Args: 
+ *  nGridPoints = number of grid points per input channel (0 disables)
+ *  nInterp = interpolation used by the collapsed link
+ *  bLinearize = use the input curves of the first xform and output curves
+ *   of the last xform as shaper curves of the link when available
  **************************************************************************
  */
-CIccApplyCmm *CIccCmm::GetNewApplyCmm(icStatusCMM &status)
+void CIccCmm::SetCollapseLink(icUInt8Number nGridPoints, icXformInterp nInterp/*=icInterpTetrahedral*/,
+                              bool bLinearize/*=true*/)
 {
-  CIccApplyCmm *pApply = new CIccApplyCmm(this);
+  m_nCollapseGrid = nGridPoints;
+  m_nCollapseInterp = nInterp;
+  m_bCollapseLinearize = bLinearize;
+}
 
-  if (!pApply) {
-    status = icCmmStatAllocErr;
-    return NULL;
-  }
 
-  CIccXformList::iterator i;
-  CIccApplyXform *pXform;
+/**
+ **************************************************************************
+ * Name: icCollapseFillGrid
+ * 
+ * Purpose: 
+ *  Fills a buffer with the next nPoints points of a regular grid.  The
+ *  last channel varies fastest (matching CIccCLUT data order).
+ * 
+ * Args: 
+ *  pSrc = buffer to fill with nPoints*nSamples values
+ *  nSamples = number of channels
+ *  pIdx = grid position of the next point (updated)
+ *  nPoints = number of points to fill
+ *  nSteps = number of steps per channel
+ *  fOffset = offset added to grid position
+ *  fScale = scale applied to offset grid position
+ **************************************************************************
+ */
+static void icCollapseFillGrid(icFloatNumber *pSrc, icUInt16Number nSamples, icUInt32Number *pIdx,
+                               icUInt32Number nPoints, icUInt32Number nSteps,
+                               icFloatNumber fOffset, icFloatNumber fScale)
+{
+  icUInt32Number n;
+  int i;
 
-  for (i=m_Xforms->begin(); i!=m_Xforms->end(); i++) {
-    pXform = i->ptr->GetNewApply(status);
-    if (!pXform || status != icCmmStatOk) {
-      delete pApply;
-      return NULL;
+  for (n=0; n<nPoints; n++) {
+    for (i=0; i<nSamples; i++)
+      *pSrc++ = ((icFloatNumber)pIdx[i] + fOffset) * fScale;
+
+    for (i=nSamples-1; i>=0; i--) {
+      if (++pIdx[i] < nSteps)
+        break;
+      pIdx[i] = 0;
     }
-    pApply->AppendApplyXform(pXform);
   }
-
-  m_bValid = true;
-
-  status = icCmmStatOk;
-
-  return pApply;
 }
 
 
 /**
-**************************************************************************
-* Name: CIccCmm::Apply
-* 
-* Purpose: 
-*  Uses the m_pApply object allocated during Begin to Apply the transformations
-*  associated with the CMM.
-*
-**************************************************************************
-*/
-icStatusCMM CIccCmm::Apply(icFloatNumber *DstPixel, const icFloatNumber *SrcPixel)
+ **************************************************************************
+ * Name: icCollapseDeltaE
+ * 
+ * Purpose: 
+ *  Determines the difference between two pixels in internal encoding.
+ *  Lab and XYZ pixels are compared using dE76, other spaces use the RMS
+ *  difference scaled to a range of 0 to 100.
+ **************************************************************************
+ */
+static icFloatNumber icCollapseDeltaE(icColorSpaceSignature nSpace, const icFloatNumber *pPixel1,
+                                      const icFloatNumber *pPixel2, icUInt16Number nSamples)
 {
-  return m_pApply->Apply(DstPixel, SrcPixel);
+  if (nSpace==icSigLabData || nSpace==icSigXYZData) {
+    icFloatNumber Lab1[3], Lab2[3];
+
+    memcpy(Lab1, pPixel1, sizeof(Lab1));
+    memcpy(Lab2, pPixel2, sizeof(Lab2));
+
+    if (nSpace==icSigLabData) {
+      icLabFromPcs(Lab1);
+      icLabFromPcs(Lab2);
+    }
+    else {
+      icXyzFromPcs(Lab1);
+      icXYZtoLab(Lab1);
+      icXyzFromPcs(Lab2);
+      icXYZtoLab(Lab2);
+    }
+
+    return icDeltaE(Lab1, Lab2);
+  }
+
+  return icRmsDif(pPixel1, pPixel2, nSamples) * 100.0f;
 }
 
 
 /**
-**************************************************************************
-* Name: CIccCmm::Apply
-* 
-* Purpose: 
-*  Uses the m_pApply object allocated during Begin to Apply the transformations
-*  associated with the CMM.
-*
-**************************************************************************
-*/
+ **************************************************************************
+ * Name: icCollapseNewLink
+ * 
+ * Purpose: 
+ *  Creates a device link xform with a CLUT sampled from the xform chain of
+ *  pCmm.  Shaper curves are placed before and after the CLUT when provided
+ *  and are always taken over by the new link (they are deleted along with
+ *  the link's profile if an error occurs).  The chain must have already had
+ *  any shaper curves removed so that the CLUT is sampled in shaped space.
+ * 
+ * Args: 
+ *  pCmm = CMM whose xform chain is sampled
+ *  nGrid = number of grid points per input channel
+ *  nInterp = interpolation used by the link
+ *  pCurvesA = optional input shaper curves (only used if nDst<=15)
+ *  pCurvesB = optional output shaper curves (only used if nDst<=15)
+ *  pGridSrc = scratch buffer of icCmmBlockPixels source pixels
+ *  rv = returned status
+ * 
+ * Return:
+ *  Pointer to the initialized link xform, or NULL on error.
+ **************************************************************************
+ */
+static CIccXform *icCollapseNewLink(CIccCmm *pCmm, icUInt8Number nGrid, icXformInterp nInterp,
+                                    LPIccCurve *pCurvesA, LPIccCurve *pCurvesB,
+                                    icFloatNumber *pGridSrc, icStatusCMM &rv)
+{
+  icUInt16Number nSrc = pCmm->GetSourceSamples();
+  icUInt16Number nDst = pCmm->GetDestSamples();
+  icUInt32Number i, n, nNodes;
+  icUInt32Number Idx[16];
+
+  CIccProfile *pProfile = new CIccProfile;
+  pProfile->InitHeader();
+  pProfile->m_Header.colorSpace = pCmm->GetSourceSpace();
+  pProfile->m_Header.pcs = pCmm->GetDestSpace();
+  pProfile->m_Header.deviceClass = icSigLinkClass;
+
+  CIccCLUT *pCLUT;
+  if (nDst<=15) {
+    pProfile->m_Header.version = icVersionNumberV4_3;
+
+    CIccTagLutAtoB *pTagLut = new CIccTagLutAtoB();
+    pTagLut->Init((icUInt8Number)nSrc, (icUInt8Number)nDst);
+
+    LPIccCurve *pCurves = pTagLut->NewCurvesA();
+    for (i=0; i<nSrc; i++)
+      pCurves[i] = pCurvesA ? pCurvesA[i] : new CIccTagCurve();
+
+    pCurves = pTagLut->NewCurvesB();
+    for (i=0; i<nDst; i++)
+      pCurves[i] = pCurvesB ? pCurvesB[i] : new CIccTagCurve();
+
+    pCLUT = pTagLut->NewCLUT(nGrid);
+
+    pProfile->AttachTag(icSigAToB0Tag, pTagLut);
+  }
+  else {
+    pProfile->m_Header.version = icVersionNumberV5;
+
+    CIccTagMultiProcessElement *pTag = new CIccTagMultiProcessElement(nSrc, nDst);
+    CIccMpeCLUT *pMpeCLUT = new CIccMpeCLUT();
+
+    pCLUT = new CIccCLUT((icUInt8Number)nSrc, nDst);
+    if (!pCLUT->Init(nGrid)) {
+      delete pCLUT;
+      pCLUT = NULL;
+    }
+    else
+      pMpeCLUT->SetCLUT(pCLUT);
+
+    pTag->Attach(pMpeCLUT);
+
+    pProfile->AttachTag(icSigAToB0Tag, pTag);
+  }
+
+  //Sample chain at grid points
+  CIccApplyCmm *pApply = pCLUT ? pCmm->GetNewApplyCmm(rv) : NULL;
+
+  if (pApply) {
+    icFloatNumber *pData = pCLUT->GetData(0);
+
+    nNodes = pCLUT->NumPoints();
+
+    memset(Idx, 0, sizeof(Idx));
+    for (n=0; n<nNodes && rv==icCmmStatOk; n+=i) {
+      i = nNodes - n;
+      if (i>icCmmBlockPixels)
+        i = icCmmBlockPixels;
+
+      icCollapseFillGrid(pGridSrc, nSrc, Idx, i, nGrid, 0.0f, 1.0f / (icFloatNumber)(nGrid-1));
+      rv = pApply->Apply(pData + (size_t)n*nDst, pGridSrc, i);
+    }
+    delete pApply;
+  }
+  else if (!pCLUT)
+    rv = icCmmStatAllocErr;
+
+  CIccXform *pLink = NULL;
+  if (rv==icCmmStatOk)
+    pLink = CIccXform::Create(pProfile, true, icPerceptual, nInterp, NULL, icXformLutColor, false);
+
+  //The link owns the profile once created
+  if (!pLink) {
+    delete pProfile;
+    if (rv==icCmmStatOk)
+      rv = icCmmStatBadXform;
+    return NULL;
+  }
+
+  rv = pLink->Begin();
+  if (rv!=icCmmStatOk) {
+    delete pLink;
+    return NULL;
+  }
+
+  return pLink;
+}
+
+
+/**
+ **************************************************************************
+ * Name: icCollapseMeasure
+ * 
+ * Purpose: 
+ *  Determines the maximum and mean difference between the results of a
+ *  collapsed link and the exact chain at the test points.
+ **************************************************************************
+ */
+static icStatusCMM icCollapseMeasure(CIccXform *pLink, icColorSpaceSignature nDstSpace,
+                                     const icFloatNumber *pTestSrc, const icFloatNumber *pTestRef,
+                                     icFloatNumber *pTestDst, icUInt32Number nTestPoints,
+                                     icFloatNumber &fMaxDE, icFloatNumber &fMeanDE)
+{
+  icStatusCMM rv;
+  CIccApplyXform *pApply = pLink->GetNewApply(rv);
+
+  if (!pApply)
+    return rv!=icCmmStatOk ? rv : icCmmStatAllocErr;
+
+  icUInt16Number nDst = pLink->GetNumDstSamples();
+  icFloatNumber fSum = 0.0f;
+  icUInt32Number n;
+
+  pLink->ApplyN(pApply, pTestDst, pTestSrc, nTestPoints, nDst, pLink->GetNumSrcSamples());
+  delete pApply;
+
+  fMaxDE = 0.0f;
+  for (n=0; n<nTestPoints; n++) {
+    icFloatNumber dE = icCollapseDeltaE(nDstSpace, pTestRef + (size_t)n*nDst, pTestDst + (size_t)n*nDst, nDst);
+
+    if (dE > fMaxDE)
+      fMaxDE = dE;
+    fSum += dE;
+  }
+  fMeanDE = fSum / (icFloatNumber)nTestPoints;
+
+  return icCmmStatOk;
+}
+
+
+/**
+ **************************************************************************
+ * Name: CIccCmm::CollapseXforms
+ * 
+ * Purpose: 
+ *  Replaces the xform chain with a single device link xform whose CLUT is
+ *  sampled from the chain.  When linearization is enabled, the input curves
+ *  of the first xform and output curves of the last xform are extracted
+ *  from the chain and used as shaper curves so that the grid is sampled in
+ *  linearized space.  Whichever link has the smaller mean difference from
+ *  the exact chain is kept, and its accuracy is stored in m_CollapseStats.
+ *  Called by Begin() after the xforms are initialized.
+ *
+ *  Chains that cannot be collapsed (too many channels or grid nodes, xforms
+ *  whose channels differ from the source or destination space, or a link
+ *  that cannot be created) are left unchanged with
+ *  m_CollapseStats.bCollapsed set to false.  Since extracting the shaper
+ *  curves changes the chain, this is only done after the link without
+ *  shaper curves has been created so that the chain is always replaced
+ *  from then on.
+ * 
+ * Return:
+ *  icCmmStatOk unless memory could not be allocated.
+ **************************************************************************
+ */
+icStatusCMM CIccCmm::CollapseXforms()
+{
+  icUInt16Number nSrc = GetSourceSamples();
+  icUInt16Number nDst = GetDestSamples();
+  icUInt8Number nGrid = m_nCollapseGrid;
+  icUInt32Number i, nNodes, nTest, nTestPoints;
+  icUInt32Number Idx[16];
+
+  memset(&m_CollapseStats, 0, sizeof(m_CollapseStats));
+
+  if (m_Xforms->empty() || nGrid<2 || !nSrc || nSrc>15 || !nDst)
+    return icCmmStatOk;
+
+  //The chain must produce all channels of the destination space (not the case when
+  //the spectral PCS of a profile is reported but its colorimetric PCS is used)
+  if (m_Xforms->front().ptr->GetNumSrcSamples()!=nSrc || m_Xforms->back().ptr->GetNumDstSamples()!=nDst)
+    return icCmmStatOk;
+
+  for (nNodes=1, i=0; i<nSrc; i++) {
+    if (nNodes > icCollapseMaxGridNodes / nGrid)
+      return icCmmStatOk;
+    nNodes *= nGrid;
+  }
+
+  //Test at the centers of the grid cells using fewer cells if needed
+  for (nTest=nGrid-1; ; nTest--) {
+    for (nTestPoints=1, i=0; i<nSrc && nTestPoints<=icCollapseMaxTestPoints; i++)
+      nTestPoints *= nTest;
+    if (nTestPoints<=icCollapseMaxTestPoints || nTest==1)
+      break;
+  }
+
+  icFloatNumber *pTestSrc = (icFloatNumber*)malloc((size_t)nTestPoints * nSrc * sizeof(icFloatNumber));
+  icFloatNumber *pTestRef = (icFloatNumber*)malloc((size_t)nTestPoints * nDst * sizeof(icFloatNumber));
+  icFloatNumber *pTestDst = (icFloatNumber*)malloc((size_t)nTestPoints * nDst * sizeof(icFloatNumber));
+  icFloatNumber *pGridSrc = (icFloatNumber*)malloc((size_t)icCmmBlockPixels * nSrc * sizeof(icFloatNumber));
+
+  if (!pTestSrc || !pTestRef || !pTestDst || !pGridSrc) {
+    if (pTestSrc)
+      free(pTestSrc);
+    if (pTestRef)
+      free(pTestRef);
+    if (pTestDst)
+      free(pTestDst);
+    if (pGridSrc)
+      free(pGridSrc);
+    return icCmmStatAllocErr;
+  }
+
+  memset(Idx, 0, sizeof(Idx));
+  icCollapseFillGrid(pTestSrc, nSrc, Idx, nTestPoints, nTest, 0.5f, 1.0f / (icFloatNumber)nTest);
+
+  //Get results of exact chain
+  icStatusCMM rv;
+  CIccApplyCmm *pApply = GetNewApplyCmm(rv);
+  if (pApply) {
+    rv = pApply->Apply(pTestRef, pTestSrc, nTestPoints);
+    delete pApply;
+  }
+
+  CIccXform *pLink = NULL;
+  icFloatNumber fMaxDE = 0.0f, fMeanDE = 0.0f;
+  bool bLinearized = false;
+
+  if (rv==icCmmStatOk)
+    pLink = icCollapseNewLink(this, nGrid, m_nCollapseInterp, NULL, NULL, pGridSrc, rv);
+
+  if (pLink) {
+    rv = icCollapseMeasure(pLink, m_nDestSpace, pTestSrc, pTestRef, pTestDst, nTestPoints, fMaxDE, fMeanDE);
+    if (rv!=icCmmStatOk) {
+      delete pLink;
+      pLink = NULL;
+    }
+  }
+
+  if (pLink && m_bCollapseLinearize && nDst<=15) {
+    CIccXform *pFirst = m_Xforms->front().ptr;
+    CIccXform *pLast = m_Xforms->back().ptr;
+    LPIccCurve *pCurvesA = NULL, *pCurvesB = NULL;
+
+    //Shaper curves that are extracted are no longer applied by the chain
+    if (pFirst->GetNumSrcSamples()==nSrc)
+      pCurvesA = pFirst->ExtractInputCurves();
+    if (pLast->GetNumDstSamples()==nDst)
+      pCurvesB = pLast->ExtractOutputCurves();
+
+    //The link without shaper curves is kept if the linearized link fails
+    if (pCurvesA || pCurvesB) {
+      icStatusCMM stat;
+      icFloatNumber fLinMaxDE, fLinMeanDE;
+      CIccXform *pLinLink = icCollapseNewLink(this, nGrid, m_nCollapseInterp, pCurvesA, pCurvesB, pGridSrc, stat);
+
+      if (pLinLink)
+        stat = icCollapseMeasure(pLinLink, m_nDestSpace, pTestSrc, pTestRef, pTestDst, nTestPoints, fLinMaxDE, fLinMeanDE);
+
+      if (pLinLink && stat==icCmmStatOk && fLinMeanDE<fMeanDE) {
+        delete pLink;
+        pLink = pLinLink;
+        fMaxDE = fLinMaxDE;
+        fMeanDE = fLinMeanDE;
+        bLinearized = true;
+      }
+      else if (pLinLink)
+        delete pLinLink;
+
+      if (pCurvesA)
+        delete [] pCurvesA;
+      if (pCurvesB)
+        delete [] pCurvesB;
+    }
+  }
+
+  free(pTestSrc);
+  free(pTestRef);
+  free(pTestDst);
+  free(pGridSrc);
+
+  //Keep the exact chain if it could not be collapsed
+  if (!pLink)
+    return rv==icCmmStatAllocErr ? rv : icCmmStatOk;
+
+  CIccXformList::iterator x;
+
+  for (x=m_Xforms->begin(); x!=m_Xforms->end(); x++) {
+    if (x->ptr)
+      delete x->ptr;
+  }
+  m_Xforms->clear();
+
+  CIccXformPtr ptr;
+  ptr.ptr = pLink;
+  m_Xforms->push_back(ptr);
+
+  m_CollapseStats.bCollapsed = true;
+  m_CollapseStats.nGridPoints = nGrid;
+  m_CollapseStats.bLinearized = bLinearized;
+  m_CollapseStats.nTestPoints = nTestPoints;
+  m_CollapseStats.fMaxDE = fMaxDE;
+  m_CollapseStats.fMeanDE = fMeanDE;
+
+  return icCmmStatOk;
+}
+
+
+/**
+ **************************************************************************
+ * Name: CIccCmm::GetNewApplyCmm
+ * 
+ * Purpose: 
+ *  Allocates an CIccApplyCmm object that does the initialization of the Xforms
+ *  that provides an Apply() function.
+ *  Multiple CIccApplyCmm objects can be allocated and used in separate threads.
+ *
+ **************************************************************************
+ */
+CIccApplyCmm *CIccCmm::GetNewApplyCmm(icStatusCMM &status)
+{
+  CIccApplyCmm *pApply = new CIccApplyCmm(this);
+
+  if (!pApply) {
+    status = icCmmStatAllocErr;
+    return NULL;
+  }
+
+  CIccXformList::iterator i;
+  CIccApplyXform *pXform;
+
+  for (i=m_Xforms->begin(); i!=m_Xforms->end(); i++) {
+    pXform = i->ptr->GetNewApply(status);
+    if (!pXform || status != icCmmStatOk) {
+      delete pApply;
+      return NULL;
+    }
+    pApply->AppendApplyXform(pXform);
+  }
+
+  m_bValid = true;
+
+  status = icCmmStatOk;
+
+  return pApply;
+}
+
+
+/**
+**************************************************************************
+* Name: CIccCmm::Apply
+* 
+* Purpose: 
+*  Uses the m_pApply object allocated during Begin to Apply the transformations
+*  associated with the CMM.
+*
+**************************************************************************
+*/
+icStatusCMM CIccCmm::Apply(icFloatNumber *DstPixel, const icFloatNumber *SrcPixel)
+{
+  return m_pApply->Apply(DstPixel, SrcPixel);
+}
+
+
+/**
+**************************************************************************
+* Name: CIccCmm::Apply
+* 
+* Purpose: 
+*  Uses the m_pApply object allocated during Begin to Apply the transformations
+*  associated with the CMM.
+*
+**************************************************************************
+*/
 icStatusCMM CIccCmm::Apply(icFloatNumber *DstPixel, const icFloatNumber *SrcPixel, icUInt32Number nPixels)
 {
   return m_pApply->Apply(DstPixel, SrcPixel, nPixels);
 }
 
 
+/**
+**************************************************************************
+* Name: CIccCmm::ApplyBuffer
+* 
+* Purpose: 
+*  Uses the m_pApply object allocated during Begin to Apply the transformations
+*  associated with the CMM to an image buffer.
+*
+**************************************************************************
+*/
+icStatusCMM CIccCmm::ApplyBuffer(void *pDst, const icBufferFormat &dstFormat, const void *pSrc, const icBufferFormat &srcFormat,
+                                 icUInt32Number nWidth, icUInt32Number nHeight,
+                                 icUInt32Number nDstRowBytes, icUInt32Number nSrcRowBytes)
+{
+  return m_pApply->ApplyBuffer(pDst, dstFormat, pSrc, srcFormat, nWidth, nHeight, nDstRowBytes, nSrcRowBytes);
+}
+
+
 /**
 **************************************************************************
 * Name: CIccCmm::RemoveAllIO()
@@ -10470,7 +11799,8 @@ CIccNamedColorCmm::~CIccNamedColorCmm()
  * Name: CIccNamedColorCmm::AddXform
  * 
  * Purpose: 
- *  Adds a profile at the end of the Xform list 
+ *  Adds a profile at the end of the Xform list.  The profile is taken from
+ *  the process wide CIccProfileCache when the cache is enabled.
  * 
  * Args: 
  *  szProfilePath = file name of the profile to be added,
@@ -10491,7 +11821,9 @@ icStatusCMM CIccNamedColorCmm::AddXform(const icChar *szProfilePath,
                                         CIccCreateXformHintManager *pHintManager /*=NULL*/,
                                         bool bUseSubProfile /*=false*/)
 {
-  CIccProfile *pProfile = OpenIccProfile(szProfilePath, bUseSubProfile);
+  CIccProfileCache *pCache = CIccProfileCache::GetProcessCache();
+  CIccProfile *pProfile = pCache->IsEnabled() ? pCache->OpenProfile(szProfilePath, bUseSubProfile) :
+                                                OpenIccProfile(szProfilePath, bUseSubProfile);
 
   if (!pProfile) 
     return icCmmStatCantOpenProfile;
@@ -10964,6 +12296,8 @@ CIccMruCmm::CIccMruCmm()
   m_pCmm = NULL;
   m_bDeleteCmm = false;
   m_nCacheSize = 0;
+  m_nHashSize = 0;
+  m_nKeyBits = 0;
 }
 
 
@@ -11031,18 +12365,53 @@ CIccMruCmm* CIccMruCmm::Attach(CIccCmm *pCmm, icUInt8Number nCacheSize/* =4 */,
   return rv;
 }
 
-CIccApplyCmm *CIccMruCmm::GetNewApplyCmm(icStatusCMM &status)
+/**
+****************************************************************************
+* Name: CIccMruCmm::AttachHashed
+* 
+* Purpose: Create a Cmm decorator object that implements a hashed cache of
+*  pixel transformations (see CIccHashCache).
+* 
+* Args:
+*  pCmm - pointer to cmm object that we are attaching to.
+*  nCacheSize - number of transformations to cache (rounded up to a power of 2)
+*  nKeyBits - 0 to key colors by exact value, 8 or 16 to key colors by their
+*    8 or 16-bit codes
+*  bDeleteCmm - flag to indicate whether cmm should be deleted when
+*    this is destroyed.
+*
+* Return:
+*  A CIccMruCmm object that represents a cached form of the pCmm passed in.
+*
+*  If this function fails the pCmm object will be deleted (if bDeleteCmm).
+*****************************************************************************
+*/
+CIccMruCmm* CIccMruCmm::AttachHashed(CIccCmm *pCmm, icUInt32Number nCacheSize/* =4096 */, icUInt8Number nKeyBits/* =0 */,
+                                     bool bDeleteCmm/*=true*/)
 {
-  CIccApplyMruCmm *rv = new CIccApplyMruCmm(this);
+  if (!pCmm || !nCacheSize || (nKeyBits && nKeyBits!=8 && nKeyBits!=16))
+    return NULL;
 
-  if (!rv) {
-    status = icCmmStatAllocErr;
+  if (!pCmm->Valid()) {
+    if (bDeleteCmm)
+      delete pCmm;
     return NULL;
   }
 
-  if (!rv->Init(m_pCmm, m_nCacheSize)) {
+  CIccMruCmm *rv = new CIccMruCmm();
+
+  rv->m_pCmm = pCmm;
+  rv->m_nHashSize = nCacheSize;
+  rv->m_nKeyBits = nKeyBits;
+  rv->m_bDeleteCmm = bDeleteCmm;
+
+  rv->m_nSrcSpace = pCmm->GetSourceSpace();
+  rv->m_nDestSpace = pCmm->GetDestSpace();
+  rv->m_nLastSpace = pCmm->GetLastSpace();
+  rv->m_nLastIntent = pCmm->GetLastIntent();
+
+  if (rv->Begin()!=icCmmStatOk) {
     delete rv;
-    status = icCmmStatBad;
     return NULL;
   }
 
@@ -11051,23 +12420,66 @@ CIccApplyCmm *CIccMruCmm::GetNewApplyCmm(icStatusCMM &status)
 
 /**
 ****************************************************************************
-* Name: CIccMruCache::CIccMruCache
-*
-* Purpose: constructor
+* Name: CIccMruCmm::GetCacheStats
+* 
+* Purpose: Get the hit, miss and eviction counts of the cache used by the
+*  Apply functions of this object.
+* 
+* Return:
+*  false if the object doesn't use a hashed cache
 *****************************************************************************
 */
-template<class T>
-CIccMruCache<T>::CIccMruCache()
+bool CIccMruCmm::GetCacheStats(icColorCacheStats &stats) const
 {
-  m_cache = NULL;
-  m_nNumPixel = 0;
-  m_pixelData = NULL;
-  m_nSrcSamples = 0;
-  m_pFirst = NULL;
+  if (!m_pApply)
+    return false;
+
+  return ((CIccApplyMruCmm*)m_pApply)->GetCacheStats(stats);
 }
 
-/**
-****************************************************************************
+void CIccMruCmm::ResetCacheStats()
+{
+  if (m_pApply)
+    ((CIccApplyMruCmm*)m_pApply)->ResetCacheStats();
+}
+
+CIccApplyCmm *CIccMruCmm::GetNewApplyCmm(icStatusCMM &status)
+{
+  CIccApplyMruCmm *rv = new CIccApplyMruCmm(this);
+
+  if (!rv) {
+    status = icCmmStatAllocErr;
+    return NULL;
+  }
+
+  if (m_nHashSize ? !rv->Init(m_pCmm, m_nHashSize, m_nKeyBits) : !rv->Init(m_pCmm, m_nCacheSize)) {
+    delete rv;
+    status = icCmmStatBad;
+    return NULL;
+  }
+
+  return rv;
+}
+
+/**
+****************************************************************************
+* Name: CIccMruCache::CIccMruCache
+*
+* Purpose: constructor
+*****************************************************************************
+*/
+template<class T>
+CIccMruCache<T>::CIccMruCache()
+{
+  m_cache = NULL;
+  m_nNumPixel = 0;
+  m_pixelData = NULL;
+  m_nSrcSamples = 0;
+  m_pFirst = NULL;
+}
+
+/**
+****************************************************************************
 * Name: CIccMruCache::~CIccMruCache
 *
 * Purpose: destructor
@@ -11216,11 +12628,487 @@ template class CIccMruCache<icFloatNumber>;
 template class CIccMruCache<icUInt8Number>;
 template class CIccMruCache<icUInt16Number>;
 
+/**
+****************************************************************************
+* Name: CIccHashCache::CIccHashCache
+*
+* Purpose: protected constructor - Use NewHashCache to create objects
+*****************************************************************************
+*/
+CIccHashCache::CIccHashCache()
+{
+  m_nSrcSamples = 0;
+  m_nDstSamples = 0;
+  m_nKeyMax = 0;
+  m_nKeyWords = 0;
+  m_nMask = 0;
+  m_nVictim = 0;
+
+  m_pKeys = NULL;
+  m_pHash = NULL;
+  m_pState = NULL;
+  m_pValues = NULL;
+
+  m_pKey = NULL;
+  m_nUpdateSlot = -1;
+
+  m_nMiss = 0;
+  m_pMissIdx = NULL;
+  m_pMissSlot = NULL;
+  m_nDup = 0;
+  m_pDupIdx = NULL;
+  m_pDupSlot = NULL;
+
+  ResetStats();
+}
+
+/**
+****************************************************************************
+* Name: CIccHashCache::~CIccHashCache
+*
+* Purpose: destructor
+*****************************************************************************
+*/
+CIccHashCache::~CIccHashCache()
+{
+  if (m_pKeys)
+    free(m_pKeys);
+  if (m_pHash)
+    free(m_pHash);
+  if (m_pState)
+    free(m_pState);
+  if (m_pValues)
+    free(m_pValues);
+  if (m_pKey)
+    free(m_pKey);
+  if (m_pMissIdx)
+    free(m_pMissIdx);
+  if (m_pMissSlot)
+    free(m_pMissSlot);
+  if (m_pDupIdx)
+    free(m_pDupIdx);
+  if (m_pDupSlot)
+    free(m_pDupSlot);
+}
+
+/**
+****************************************************************************
+* Name: CIccHashCache::Init
+*
+* Purpose: Initialize the object and allocate the hash table
+*
+* Args:
+*  nSrcSamples - number of samples in a source pixel
+*  nDstSamples - number of samples in a destination pixel
+*  nCacheSize - number of colors to cache (rounded up to a power of 2)
+*  nKeyBits - 0 for exact keys, 8 or 16 for quantized keys
+*
+* Return:
+*  true if successful
+*****************************************************************************
+*/
+bool CIccHashCache::Init(icUInt16Number nSrcSamples, icUInt16Number nDstSamples, icUInt32Number nCacheSize, icUInt8Number nKeyBits)
+{
+  if (!nSrcSamples || !nDstSamples || !nCacheSize || nCacheSize>0x1000000)
+    return false;
+
+  m_nSrcSamples = nSrcSamples;
+  m_nDstSamples = nDstSamples;
+
+  if (nKeyBits==8) {
+    m_nKeyMax = 0xff;
+    m_nKeyWords = (nSrcSamples+1)/2;
+  }
+  else if (nKeyBits==16) {
+    m_nKeyMax = 0xffff;
+    m_nKeyWords = (nSrcSamples+1)/2;
+  }
+  else if (!nKeyBits) {
+    m_nKeyMax = 0;
+    m_nKeyWords = (icUInt32Number)((nSrcSamples*sizeof(icFloatNumber)+3)/4);
+  }
+  else
+    return false;
+
+  icUInt32Number nSlots = icHashCacheMaxProbe;
+  while (nSlots<nCacheSize)
+    nSlots <<= 1;
+  m_nMask = nSlots-1;
+
+  m_pKeys = (icUInt32Number*)malloc((size_t)nSlots*m_nKeyWords*sizeof(icUInt32Number));
+  m_pHash = (icUInt32Number*)malloc((size_t)nSlots*sizeof(icUInt32Number));
+  m_pState = (icUInt8Number*)calloc(nSlots, sizeof(icUInt8Number));
+  m_pValues = (icFloatNumber*)malloc((size_t)nSlots*nDstSamples*sizeof(icFloatNumber));
+  m_pKey = (icUInt32Number*)malloc(m_nKeyWords*sizeof(icUInt32Number));
+
+  m_pMissIdx = (icUInt32Number*)malloc(icCmmBlockPixels*sizeof(icUInt32Number));
+  m_pMissSlot = (icInt32Number*)malloc(icCmmBlockPixels*sizeof(icInt32Number));
+  m_pDupIdx = (icUInt32Number*)malloc(icCmmBlockPixels*sizeof(icUInt32Number));
+  m_pDupSlot = (icInt32Number*)malloc(icCmmBlockPixels*sizeof(icInt32Number));
+
+  if (!m_pKeys || !m_pHash || !m_pState || !m_pValues || !m_pKey ||
+      !m_pMissIdx || !m_pMissSlot || !m_pDupIdx || !m_pDupSlot)
+    return false;
+
+  return true;
+}
+
+CIccHashCache *CIccHashCache::NewHashCache(icUInt16Number nSrcSamples, icUInt16Number nDstSamples,
+                                           icUInt32Number nCacheSize/* =4096 */, icUInt8Number nKeyBits/* =0 */)
+{
+  CIccHashCache *rv = new CIccHashCache;
+
+  if (!rv->Init(nSrcSamples, nDstSamples, nCacheSize, nKeyBits)) {
+    delete rv;
+    return NULL;
+  }
+
+  return rv;
+}
+
+/**
+****************************************************************************
+* Name: CIccHashCache::MakeKey
+*
+* Purpose: Build the key words of a source pixel.
+*
+* Return:
+*  false if the pixel cannot be cached (quantized samples out of range).
+*****************************************************************************
+*/
+bool CIccHashCache::MakeKey(icUInt32Number *pKey, const icFloatNumber *SrcPixel) const
+{
+  icUInt32Number i;
+
+  if (!m_nKeyMax) {
+    pKey[m_nKeyWords-1] = 0;
+    memcpy(pKey, SrcPixel, m_nSrcSamples*sizeof(icFloatNumber));
+    return true;
+  }
+
+  icFloatNumber fMax = (icFloatNumber)m_nKeyMax;
+
+  for (i=0; i<m_nSrcSamples; i++) {
+    icFloatNumber v = SrcPixel[i];
+
+    //Inverted compare also rejects NaN
+    if (!(v>=0.0 && v<=1.0))
+      return false;
+
+    icUInt32Number nCode = (icUInt32Number)(v*fMax + 0.5);
+
+    if (i&1)
+      pKey[i>>1] |= nCode<<16;
+    else
+      pKey[i>>1] = nCode;
+  }
+
+  return true;
+}
+
+/**
+****************************************************************************
+* Name: icHashKey
+*
+* Purpose: Hash the key words of a pixel
+*****************************************************************************
+*/
+static inline icUInt32Number icHashKey(const icUInt32Number *pKey, icUInt32Number nWords)
+{
+  icUInt32Number h = 0x811c9dc5;
+
+  for (icUInt32Number i=0; i<nWords; i++) {
+    h = (h ^ pKey[i]) * 0x9e3779b1;
+    h ^= h >> 15;
+  }
+
+  h ^= h >> 16;
+  h *= 0x85ebca6b;
+  h ^= h >> 13;
+
+  return h;
+}
+
+//Slot states of a CIccHashCache
+#define icHashSlotEmpty   0
+#define icHashSlotValid   1
+#define icHashSlotPending 2
+#define icHashSlotStale   3   //pending result that was never stored
+
+/**
+****************************************************************************
+* Name: CIccHashCache::Find
+*
+* Purpose: Find the slot of a key.  Slots are never emptied so the search
+*  ends at the first empty slot or after icHashCacheMaxProbe slots.
+*
+* Args:
+*  pKey - key words to find
+*  nHash - hash of pKey
+*  bFound - set to true if the key was found
+*
+* Return:
+*  The slot holding the key when bFound is true.  Otherwise the slot that
+*  the key should be stored in (evicting a valid color if needed), or -1
+*  if all slots searched are pending results of the current Lookup().
+*****************************************************************************
+*/
+icInt32Number CIccHashCache::Find(const icUInt32Number *pKey, icUInt32Number nHash, bool &bFound)
+{
+  icUInt32Number i, nSlot;
+  icUInt32Number nKeySize = m_nKeyWords*sizeof(icUInt32Number);
+
+  bFound = false;
+
+  for (i=0; i<icHashCacheMaxProbe; i++) {
+    nSlot = (nHash + i) & m_nMask;
+
+    if (m_pState[nSlot]==icHashSlotEmpty)
+      return (icInt32Number)nSlot;
+
+    if (m_pHash[nSlot]==nHash && m_pState[nSlot]!=icHashSlotStale && !memcmp(&m_pKeys[nSlot*m_nKeyWords], pKey, nKeySize)) {
+      bFound = true;
+      return (icInt32Number)nSlot;
+    }
+  }
+
+  //Evict colors from the searched slots in turn
+  for (i=0; i<icHashCacheMaxProbe; i++) {
+    nSlot = (nHash + ((m_nVictim+i) % icHashCacheMaxProbe)) & m_nMask;
+
+    if (m_pState[nSlot]!=icHashSlotPending) {
+      m_nVictim++;
+      m_stats.nEvictions++;
+      return (icInt32Number)nSlot;
+    }
+  }
+
+  return -1;
+}
+
+/**
+****************************************************************************
+* Name: CIccHashCache::DropPending
+*
+* Purpose: Mark slots reserved by an Apply() or Lookup() whose results were
+*  never stored so that they are not found again.
+*****************************************************************************
+*/
+void CIccHashCache::DropPending()
+{
+  icUInt32Number i;
+
+  if (m_nUpdateSlot>=0)
+    m_pState[m_nUpdateSlot] = icHashSlotStale;
+
+  for (i=0; i<m_nMiss; i++) {
+    if (m_pMissSlot[i]>=0)
+      m_pState[m_pMissSlot[i]] = icHashSlotStale;
+  }
+
+  m_nUpdateSlot = -1;
+  m_nMiss = 0;
+  m_nDup = 0;
+}
+
+/**
+****************************************************************************
+* Name: CIccHashCache::Apply
+*
+* Purpose: Look up the transformation of a pixel.
+*
+* Args:
+*  DstPixel - Location to store pixel results
+*  SrcPixel - Location to get pixel values from
+*
+* Return:
+*  true if SrcPixel found in cache and DstPixel initialized with value.
+*  false if SrcPixel not found (DstPixel not touched).  Update() should
+*  then be called with the transformed pixel.
+*****************************************************************************
+*/
+bool CIccHashCache::Apply(icFloatNumber *DstPixel, const icFloatNumber *SrcPixel)
+{
+  if (m_nUpdateSlot>=0 || m_nMiss)
+    DropPending();
+
+  if (!MakeKey(m_pKey, SrcPixel)) {
+    m_stats.nMisses++;
+    return false;
+  }
+
+  icUInt32Number nHash = icHashKey(m_pKey, m_nKeyWords);
+  bool bFound;
+  icInt32Number nSlot = Find(m_pKey, nHash, bFound);
+
+  if (bFound && m_pState[nSlot]==icHashSlotValid) {
+    memcpy(DstPixel, &m_pValues[nSlot*m_nDstSamples], m_nDstSamples*sizeof(icFloatNumber));
+    m_stats.nHits++;
+    return true;
+  }
+
+  m_stats.nMisses++;
+
+  if (nSlot>=0) {
+    memcpy(&m_pKeys[nSlot*m_nKeyWords], m_pKey, m_nKeyWords*sizeof(icUInt32Number));
+    m_pHash[nSlot] = nHash;
+    m_pState[nSlot] = icHashSlotPending;
+    m_nUpdateSlot = nSlot;
+  }
+
+  return false;
+}
+
+/**
+****************************************************************************
+* Name: CIccHashCache::Update
+*
+* Purpose: Store the transformation of the pixel last missed by Apply().
+*****************************************************************************
+*/
+void CIccHashCache::Update(icFloatNumber *DstPixel)
+{
+  if (m_nUpdateSlot<0)
+    return;
+
+  memcpy(&m_pValues[m_nUpdateSlot*m_nDstSamples], DstPixel, m_nDstSamples*sizeof(icFloatNumber));
+  m_pState[m_nUpdateSlot] = icHashSlotValid;
+  m_nUpdateSlot = -1;
+}
+
+/**
+****************************************************************************
+* Name: CIccHashCache::Lookup
+*
+* Purpose: Look up the transformations of a block of pixels.  Cached colors
+*  are copied to DstPixels.  The source samples of the other pixels are
+*  copied (compacted) to MissPixels.  These should be transformed in place
+*  or into another buffer and passed to Commit() which stores them in the
+*  cache and fills in the remaining DstPixels.  Colors repeated within the
+*  block are only returned in MissPixels once.
+*
+* Args:
+*  DstPixels - Location to store pixel results
+*  SrcPixels - Location to get pixel values from
+*  nPixels - number of pixels (at most icCmmBlockPixels)
+*  MissPixels - Location to store source pixels not found in the cache
+*
+* Return:
+*  Number of pixels copied to MissPixels
+*****************************************************************************
+*/
+icUInt32Number CIccHashCache::Lookup(icFloatNumber *DstPixels, const icFloatNumber *SrcPixels, icUInt32Number nPixels,
+                                     icFloatNumber *MissPixels)
+{
+  icUInt32Number k, nHash;
+  icInt32Number nSlot;
+  bool bFound;
+
+  if (nPixels>icCmmBlockPixels)
+    nPixels = icCmmBlockPixels;
+
+  if (m_nUpdateSlot>=0 || m_nMiss)
+    DropPending();
+
+  for (k=0; k<nPixels; k++, SrcPixels+=m_nSrcSamples) {
+    if (MakeKey(m_pKey, SrcPixels)) {
+      nHash = icHashKey(m_pKey, m_nKeyWords);
+      nSlot = Find(m_pKey, nHash, bFound);
+
+      if (bFound) {
+        if (m_pState[nSlot]==icHashSlotValid)
+          memcpy(&DstPixels[k*m_nDstSamples], &m_pValues[nSlot*m_nDstSamples], m_nDstSamples*sizeof(icFloatNumber));
+        else {
+          m_pDupIdx[m_nDup] = k;
+          m_pDupSlot[m_nDup] = nSlot;
+          m_nDup++;
+        }
+        m_stats.nHits++;
+        continue;
+      }
+
+      if (nSlot>=0) {
+        memcpy(&m_pKeys[nSlot*m_nKeyWords], m_pKey, m_nKeyWords*sizeof(icUInt32Number));
+        m_pHash[nSlot] = nHash;
+        m_pState[nSlot] = icHashSlotPending;
+      }
+    }
+    else
+      nSlot = -1;
+
+    memcpy(&MissPixels[m_nMiss*m_nSrcSamples], SrcPixels, m_nSrcSamples*sizeof(icFloatNumber));
+    m_pMissIdx[m_nMiss] = k;
+    m_pMissSlot[m_nMiss] = nSlot;
+    m_nMiss++;
+    m_stats.nMisses++;
+  }
+
+  return m_nMiss;
+}
+
+/**
+****************************************************************************
+* Name: CIccHashCache::Commit
+*
+* Purpose: Store the transformations of the pixels returned by the last
+*  Lookup() and copy them to DstPixels.
+*
+* Args:
+*  DstPixels - DstPixels passed to Lookup()
+*  MissPixels - transformed (compacted) destination pixels
+*****************************************************************************
+*/
+void CIccHashCache::Commit(icFloatNumber *DstPixels, const icFloatNumber *MissPixels)
+{
+  icUInt32Number i;
+  icUInt32Number nDstSize = m_nDstSamples*sizeof(icFloatNumber);
+
+  for (i=0; i<m_nMiss; i++, MissPixels+=m_nDstSamples) {
+    memcpy(&DstPixels[m_pMissIdx[i]*m_nDstSamples], MissPixels, nDstSize);
+
+    if (m_pMissSlot[i]>=0) {
+      memcpy(&m_pValues[m_pMissSlot[i]*m_nDstSamples], MissPixels, nDstSize);
+      m_pState[m_pMissSlot[i]] = icHashSlotValid;
+    }
+  }
+
+  for (i=0; i<m_nDup; i++)
+    memcpy(&DstPixels[m_pDupIdx[i]*m_nDstSamples], &m_pValues[m_pDupSlot[i]*m_nDstSamples], nDstSize);
+
+  m_nMiss = 0;
+  m_nDup = 0;
+}
+
+/**
+****************************************************************************
+* Name: CIccHashCache::GetStats
+*
+* Purpose: Get the hit, miss and eviction counts since the cache was
+*  created or ResetStats() was called.
+*****************************************************************************
+*/
+void CIccHashCache::GetStats(icColorCacheStats &stats) const
+{
+  stats = m_stats;
+}
+
+void CIccHashCache::ResetStats()
+{
+  m_stats.nHits = 0;
+  m_stats.nMisses = 0;
+  m_stats.nEvictions = 0;
+}
+
+
 
 CIccApplyMruCmm::CIccApplyMruCmm(CIccMruCmm *pCmm) : CIccApplyCmm(pCmm)
 {
   m_pCachedCmm = NULL;
+  m_pCachedApply = NULL;
   m_pCache = NULL;
+  m_pHashCache = NULL;
+  m_pMissSrc = NULL;
+  m_pMissDst = NULL;
 }
 
 /**
@@ -11234,7 +13122,14 @@ CIccApplyMruCmm::~CIccApplyMruCmm()
 {
   if (m_pCache)
     delete m_pCache;
-
+  if (m_pHashCache)
+    delete m_pHashCache;
+  if (m_pCachedApply)
+    delete m_pCachedApply;
+  if (m_pMissSrc)
+    free(m_pMissSrc);
+  if (m_pMissDst)
+    free(m_pMissDst);
 }
 
 /**
@@ -11263,6 +13158,75 @@ bool CIccApplyMruCmm::Init(CIccCmm *pCachedCmm, icUInt16Number nCacheSize)
   return true;
 }
 
+/**
+****************************************************************************
+* Name: CIccApplyMruCmm::Init
+* 
+* Purpose: Initialize the object and set up a hashed cache
+* 
+* Args:
+*  pCmm - pointer to cmm object that we are attaching to.
+*  nCacheSize - number of transformations to cache
+*  nKeyBits - 0 for exact keys, 8 or 16 for quantized keys
+*
+* Return:
+*  true if successful
+*****************************************************************************
+*/
+bool CIccApplyMruCmm::Init(CIccCmm *pCachedCmm, icUInt32Number nCacheSize, icUInt8Number nKeyBits)
+{
+  icUInt32Number nSrcSamples = m_pCmm->GetSourceSamples();
+  icUInt32Number nDstSamples = m_pCmm->GetDestSamples();
+  icStatusCMM stat;
+
+  m_pCachedCmm = pCachedCmm;
+
+  //Misses are applied with an apply object of our own so that apply objects can be used by separate threads
+  m_pCachedApply = pCachedCmm->GetNewApplyCmm(stat);
+  if (!m_pCachedApply)
+    return false;
+
+  m_pHashCache = CIccHashCache::NewHashCache(nSrcSamples, nDstSamples, nCacheSize, nKeyBits);
+
+  if (!m_pHashCache)
+    return false;
+
+  //Extra space allows for xforms writing beyond the destination samples of the last pixel
+  m_pMissSrc = (icFloatNumber*)malloc(((size_t)icCmmBlockPixels*nSrcSamples + 16)*sizeof(icFloatNumber));
+  m_pMissDst = (icFloatNumber*)malloc(((size_t)icCmmBlockPixels*nDstSamples + 16)*sizeof(icFloatNumber));
+
+  if (!m_pMissSrc || !m_pMissDst)
+    return false;
+
+  return true;
+}
+
+/**
+****************************************************************************
+* Name: CIccApplyMruCmm::GetCacheStats
+* 
+* Purpose: Get the hit, miss and eviction counts of the hashed cache
+* 
+* Return:
+*  false if the object doesn't use a hashed cache
+*****************************************************************************
+*/
+bool CIccApplyMruCmm::GetCacheStats(icColorCacheStats &stats) const
+{
+  if (!m_pHashCache)
+    return false;
+
+  m_pHashCache->GetStats(stats);
+
+  return true;
+}
+
+void CIccApplyMruCmm::ResetCacheStats()
+{
+  if (m_pHashCache)
+    m_pHashCache->ResetStats();
+}
+
 /**
 ****************************************************************************
 * Name: CIccMruCmm::Apply
@@ -11280,10 +13244,22 @@ bool CIccApplyMruCmm::Init(CIccCmm *pCachedCmm, icUInt16Number nCacheSize)
 icStatusCMM CIccApplyMruCmm::Apply(icFloatNumber *DstPixel, const icFloatNumber *SrcPixel)
 {
 #if defined(_DEBUG)
-  if (!m_pCache)
+  if (!m_pCache && !m_pHashCache)
     return icCmmStatInvalidLut;
 #endif
 
+  if (m_pHashCache) {
+    if (!m_pHashCache->Apply(DstPixel, SrcPixel)) {
+      icStatusCMM rv = m_pCachedApply->Apply(DstPixel, SrcPixel);
+      if (rv != icCmmStatOk)
+        return rv;
+
+      m_pHashCache->Update(DstPixel);
+    }
+
+    return icCmmStatOk;
+  }
+
   if (!m_pCache->Apply(DstPixel, SrcPixel)) {
 
     m_pCachedCmm->Apply(DstPixel, SrcPixel);
@@ -11314,10 +13290,36 @@ icStatusCMM CIccApplyMruCmm::Apply(icFloatNumber *DstPixel, const icFloatNumber
   icUInt32Number k;
 
 #if defined(_DEBUG)
-  if (!m_pCache)
+  if (!m_pCache && !m_pHashCache)
     return icCmmStatInvalidLut;
 #endif
 
+  if (m_pHashCache) {
+    icUInt32Number nSrcSamples = m_pCmm->GetSourceSamples();
+    icUInt32Number nDstSamples = m_pCmm->GetDestSamples();
+    icUInt32Number nBlock, nMiss;
+    icStatusCMM rv;
+
+    for (k=0; k<nPixels; k+=nBlock) {
+      nBlock = nPixels-k < icCmmBlockPixels ? nPixels-k : icCmmBlockPixels;
+
+      nMiss = m_pHashCache->Lookup(DstPixel, SrcPixel, nBlock, m_pMissSrc);
+
+      if (nMiss) {
+        rv = m_pCachedApply->Apply(m_pMissDst, m_pMissSrc, nMiss);
+        if (rv != icCmmStatOk)
+          return rv;
+      }
+
+      m_pHashCache->Commit(DstPixel, m_pMissDst);
+
+      SrcPixel += nBlock*nSrcSamples;
+      DstPixel += nBlock*nDstSamples;
+    }
+
+    return icCmmStatOk;
+  }
+
   for (k=0; k<nPixels;k++) {
     if (!m_pCache->Apply(DstPixel, SrcPixel)) {
       m_pCachedCmm->Apply(DstPixel, SrcPixel);
@@ -104,6 +104,7 @@ typedef enum {
   icCmmStatTooManySamples     = 16,
   icCmmStatBadMCSLink         = 17,
   icCmmStatUnsupported        = 18,
+  icCmmStatCompiledMismatch   = 19,
 } icStatusCMM;
 
 /// CMM Interpolation types
@@ -155,9 +156,75 @@ typedef enum {
   icXformTypeUnknown    = 0x7ffffff,
 } icXformType;
 
+/// Number of pixels processed per transform stage by CIccApplyCmm::Apply(..., nPixels)
+#define icCmmBlockPixels 256
+
+/// Maximum number of test points used to measure the accuracy of a collapsed xform chain
+#define icCollapseMaxTestPoints 65536
+
+/// Maximum number of grid nodes in the CLUT of a collapsed xform chain
+#define icCollapseMaxGridNodes 0x1000000
+
+/// Sample types supported by CIccApplyCmm::ApplyBuffer()
+typedef enum {
+  icBufferUInt8                = 0,
+  icBufferUInt16               = 1,
+  icBufferFloat16              = 2,
+  icBufferFloat32              = 3,
+} icBufferSampleType;
+
 
 #ifdef __cplusplus
 
+/**
+**************************************************************************
+* Type: Structure
+* 
+* Purpose: 
+*  Describes the layout of an image buffer passed to ApplyBuffer().
+*  Integer samples are linearly scaled to/from the internal [0.0, 1.0]
+*  encoding, float samples are used in internal encoding as is.  Extra
+*  (alpha) samples follow the color samples and are passed through.
+*  Planar buffers store one plane per sample with planes separated by
+*  nPlaneBytes bytes (zero indicates nRowBytes*nHeight).
+**************************************************************************
+*/
+struct icBufferFormat
+{
+  icBufferFormat(icBufferSampleType type=icBufferFloat32, icUInt16Number extra=0, bool planar=false, size_t planeBytes=0) :
+    nType(type), nExtraSamples(extra), bPlanar(planar), nPlaneBytes(planeBytes) {}
+
+  icBufferSampleType nType;
+  icUInt16Number nExtraSamples;
+  bool bPlanar;
+  size_t nPlaneBytes;
+};
+
+///Returns the number of bytes used by a sample of type nType (0 if unknown)
+ICCPROFLIB_API icUInt32Number icGetBufferSampleSize(icBufferSampleType nType);
+
+/**
+**************************************************************************
+* Type: Structure
+* 
+* Purpose: 
+*  Reports the accuracy of a CIccCmm xform chain that was collapsed into a
+*  single device link CLUT by Begin().  Differences are measured at the
+*  centers of the grid cells.  Lab and XYZ destinations report CIE dE76,
+*  other destinations report the RMS difference of the samples scaled to
+*  a range of 0 to 100.
+**************************************************************************
+*/
+struct icCollapseStats
+{
+  bool bCollapsed;
+  icUInt8Number nGridPoints;
+  bool bLinearized;
+  icUInt32Number nTestPoints;
+  icFloatNumber fMaxDE;
+  icFloatNumber fMeanDE;
+};
+
 /**
 **************************************************************************
 * Type: Class
@@ -381,6 +448,10 @@ public:
 
   virtual void Apply(CIccApplyXform *pXform, icFloatNumber *DstPixel, const icFloatNumber *SrcPixel) const = 0;
 
+  ///Applies the xform to a span of nPixels pixels.  Strides are the number of samples between consecutive pixels (zero reuses the same pixel).
+  virtual void ApplyN(CIccApplyXform *pXform, icFloatNumber *DstPixels, const icFloatNumber *SrcPixels, icUInt32Number nPixels,
+                      icUInt32Number nDstStride, icUInt32Number nSrcStride) const;
+
   //Detach and remove CIccIO object associated with xform's profile.  Must call after Begin()
   virtual bool RemoveIO() { return m_pProfile ? m_pProfile->Detach() : false; }
 
@@ -419,6 +490,9 @@ public:
   virtual LPIccCurve* ExtractInputCurves()=0;
   virtual LPIccCurve* ExtractOutputCurves()=0;
 
+  /// Returns the CLUT if the xform only applies input curves, a CLUT and output curves (curves are NULL if identity)
+  virtual const CIccCLUT *GetCLUTStages(const LPIccCurve *& /*pInputCurves*/, const LPIccCurve *& /*pOutputCurves*/) const { return NULL; }
+
   virtual bool NoClipPCS() const { return true; }
 
 	/// Returns the profile pointer. Profile is still owned by the Xform.
@@ -455,6 +529,15 @@ protected:
 
   virtual bool HasPerceptualHandling() { return true; }
 
+  ///Applies the Apply() of xform class T to each pixel of a span without per-pixel virtual dispatch
+  template <class T>
+  static void ApplyEach(const T *pXform, CIccApplyXform *pApply, icFloatNumber *DstPixels, const icFloatNumber *SrcPixels,
+                        icUInt32Number nPixels, icUInt32Number nDstStride, icUInt32Number nSrcStride)
+  {
+    for (icUInt32Number k=0; k<nPixels; k++, DstPixels+=nDstStride, SrcPixels+=nSrcStride)
+      pXform->T::Apply(pApply, DstPixels, SrcPixels);
+  }
+
   CIccProfile *m_pProfile;
   bool m_bOwnsProfile = true;
   bool m_bPcsAdjustXform = false;
@@ -524,6 +607,9 @@ public:
   virtual icXformType GetXformType() const { return icXformTypeUnknown; }
 
   void __inline Apply(icFloatNumber *DstPixel, const icFloatNumber *SrcPixel) { m_pXform->Apply(this, DstPixel, SrcPixel); }
+  void __inline ApplyN(icFloatNumber *DstPixels, const icFloatNumber *SrcPixels, icUInt32Number nPixels,
+                       icUInt32Number nDstStride, icUInt32Number nSrcStride)
+  { m_pXform->ApplyN(this, DstPixels, SrcPixels, nPixels, nDstStride, nSrcStride); }
 
   const CIccXform *GetXform() { return m_pXform; }
 
@@ -1023,6 +1109,8 @@ public:
   virtual CIccApplyXform *GetNewApply(icStatusCMM &status);  //Must be called after Begin
 
   virtual void Apply(CIccApplyXform *pXform, icFloatNumber *DstPixel, const icFloatNumber *SrcPixel) const;
+  virtual void ApplyN(CIccApplyXform *pXform, icFloatNumber *DstPixels, const icFloatNumber *SrcPixels, icUInt32Number nPixels,
+                      icUInt32Number nDstStride, icUInt32Number nSrcStride) const;
 
   ///Returns the source color space of the transform
   virtual icColorSpaceSignature GetSrcSpace() const { return m_srcSpace; }
@@ -1190,6 +1278,8 @@ public:
 
   virtual icStatusCMM Begin();
   virtual void Apply(CIccApplyXform *pApplyXform, icFloatNumber *DstPixel, const icFloatNumber *SrcPixel) const;
+  virtual void ApplyN(CIccApplyXform *pApplyXform, icFloatNumber *DstPixels, const icFloatNumber *SrcPixels, icUInt32Number nPixels,
+                      icUInt32Number nDstStride, icUInt32Number nSrcStride) const;
   
   virtual LPIccCurve* ExtractInputCurves();
   virtual LPIccCurve* ExtractOutputCurves();
@@ -1230,12 +1320,18 @@ public:
 
   virtual icStatusCMM Begin();
   virtual void Apply(CIccApplyXform *pApplyXform, icFloatNumber *DstPixel, const icFloatNumber *SrcPixel) const;
+  virtual void ApplyN(CIccApplyXform *pApplyXform, icFloatNumber *DstPixels, const icFloatNumber *SrcPixels, icUInt32Number nPixels,
+                      icUInt32Number nDstStride, icUInt32Number nSrcStride) const;
 
   virtual bool UseLegacyPCS() const { return m_pTag->UseLegacyPCS(); }
 
   virtual LPIccCurve* ExtractInputCurves();
   virtual LPIccCurve* ExtractOutputCurves();
+
+  virtual const CIccCLUT *GetCLUTStages(const LPIccCurve *&pInputCurves, const LPIccCurve *&pOutputCurves) const;
 protected:
+  void ApplyPreCLUT(icFloatNumber *Pixel) const;
+  void ApplyPostCLUT(icFloatNumber *Pixel) const;
 
   const CIccMBB *m_pTag;
 
@@ -1265,12 +1361,19 @@ public:
 
   virtual icStatusCMM Begin();
   virtual void Apply(CIccApplyXform *pApplyXform, icFloatNumber *DstPixel, const icFloatNumber *SrcPixel) const;
+  virtual void ApplyN(CIccApplyXform *pApplyXform, icFloatNumber *DstPixels, const icFloatNumber *SrcPixels, icUInt32Number nPixels,
+                      icUInt32Number nDstStride, icUInt32Number nSrcStride) const;
 
   virtual bool UseLegacyPCS() const { return m_pTag->UseLegacyPCS(); }
 
   virtual LPIccCurve* ExtractInputCurves();
   virtual LPIccCurve* ExtractOutputCurves();
+
+  virtual const CIccCLUT *GetCLUTStages(const LPIccCurve *&pInputCurves, const LPIccCurve *&pOutputCurves) const;
 protected:
+  void ApplyPreCLUT(icFloatNumber *Pixel) const;
+  void ApplyPostCLUT(icFloatNumber *Pixel) const;
+
   const CIccMBB *m_pTag;
 
   /// Pointers to data in m_pTag, used only for applying the xform
@@ -1301,12 +1404,17 @@ public:
   virtual CIccApplyXform* GetNewApply(icStatusCMM& status);  //Must be called after Begin
 
   virtual void Apply(CIccApplyXform *pApplyXform, icFloatNumber *DstPixel, const icFloatNumber *SrcPixel) const;
+  virtual void ApplyN(CIccApplyXform *pApplyXform, icFloatNumber *DstPixels, const icFloatNumber *SrcPixels, icUInt32Number nPixels,
+                      icUInt32Number nDstStride, icUInt32Number nSrcStride) const;
 
   virtual bool UseLegacyPCS() const { return m_pTag->UseLegacyPCS(); }
 
   virtual LPIccCurve* ExtractInputCurves();
   virtual LPIccCurve* ExtractOutputCurves();
 protected:
+  void ApplyPreCLUT(icFloatNumber *Pixel) const;
+  void ApplyPostCLUT(icFloatNumber *Pixel) const;
+
   const CIccMBB *m_pTag;
   int m_nNumInput;
 
@@ -1433,6 +1541,8 @@ public:
 
   virtual CIccApplyXform *GetNewApply(icStatusCMM &status);
   virtual void Apply(CIccApplyXform *pApplyXform, icFloatNumber *DstPixel, const icFloatNumber *SrcPixel) const;
+  virtual void ApplyN(CIccApplyXform *pApplyXform, icFloatNumber *DstPixels, const icFloatNumber *SrcPixels, icUInt32Number nPixels,
+                      icUInt32Number nDstStride, icUInt32Number nSrcStride) const;
 
   virtual bool UseLegacyPCS() const { return false; }
   virtual LPIccCurve* ExtractInputCurves() {return NULL;}
@@ -1577,11 +1687,17 @@ public:
   //Make sure that when DstPixel==SrcPixel the sizeof DstPixel is less than size of SrcPixel
   virtual icStatusCMM Apply(icFloatNumber *DstPixel, const icFloatNumber *SrcPixel, icUInt32Number nPixels);
 
+  //Apply to an image buffer of 8/16-bit, half or float samples.  Row bytes of zero indicate tightly packed rows.
+  virtual icStatusCMM ApplyBuffer(void *pDst, const icBufferFormat &dstFormat, const void *pSrc, const icBufferFormat &srcFormat,
+                                  icUInt32Number nWidth, icUInt32Number nHeight=1,
+                                  icUInt32Number nDstRowBytes=0, icUInt32Number nSrcRowBytes=0);
+
   void AppendApplyXform(CIccApplyXform *pApplyXform);
 
   CIccCmm *GetCmm() { return m_pCmm; }
 
   bool InitPixel();
+  bool InitBlock();
 
 protected:
   CIccApplyCmm(CIccCmm *pCmm);
@@ -1591,6 +1707,17 @@ protected:
 
   icFloatNumber *m_Pixel;
   icFloatNumber *m_Pixel2;
+
+  ///Scratch buffers of icCmmBlockPixels pixels used by the span based Apply
+  icUInt16Number m_nBlockSamples;
+  icFloatNumber *m_Block;
+  icFloatNumber *m_Block2;
+
+  ///Unpacked source/destination pixels used by ApplyBuffer
+  icFloatNumber *m_BufPixels;
+
+  ///Source/destination codes used by ApplyBuffer with fixed point interpolation
+  icUInt16Number *m_BufCodes;
 };
 
 class IXformIterator
@@ -1668,11 +1795,26 @@ public:
   //Get an additional Apply cmm object to apply pixels with.  The Apply object should be deleted by the caller.
   virtual CIccApplyCmm *GetNewApplyCmm(icStatusCMM &status); 
 
+  ///Call before Begin() to have Begin() replace the xform chain with a single sampled device link (nGridPoints=0 disables)
+  void SetCollapseLink(icUInt8Number nGridPoints, icXformInterp nInterp=icInterpTetrahedral, bool bLinearize=true);
+  ///Returns the accuracy of the collapsed device link (valid after Begin(), bCollapsed is false if the chain was kept)
+  const icCollapseStats &GetCollapseStats() const { return m_CollapseStats; }
+
+  ///Call before Begin() to have ApplyBuffer() use fixed point CLUT interpolation for 8 or 16 bit sources (0 disables).
+  ///Only used when the chain is a single 3 or 4 input CLUT xform with no output curves (e.g. a device link, or the
+  ///result of SetCollapseLink() with bLinearize=false); other chains keep the float path (see HasFixedInterp()).
+  void SetFixedInterp(icUInt8Number nInputBits) { m_nFixedInputBits = nInputBits; }
+  ///Returns true if Begin() was able to set up fixed point interpolation
+  bool HasFixedInterp() const { return m_pFixedCLUT!=NULL; }
+
   virtual CIccApplyCmm *GetApply() { return m_pApply; }
 
   //The following apply functions should only be called if using Begin(true);
   virtual icStatusCMM Apply(icFloatNumber *DstPixel, const icFloatNumber *SrcPixel);
   virtual icStatusCMM Apply(icFloatNumber *DstPixel, const icFloatNumber *SrcPixel, icUInt32Number nPixels);
+  virtual icStatusCMM ApplyBuffer(void *pDst, const icBufferFormat &dstFormat, const void *pSrc, const icBufferFormat &srcFormat,
+                                  icUInt32Number nWidth, icUInt32Number nHeight=1,
+                                  icUInt32Number nDstRowBytes=0, icUInt32Number nSrcRowBytes=0);
 
   //Call to Detach and remove all pending IO objects attached to the profiles used by the CMM. Should be called only after Begin()
   virtual icStatusCMM RemoveAllIO();
@@ -1747,6 +1889,7 @@ protected:
 
   icStatusCMM CheckPCSRangeConversions();
   icStatusCMM CheckPCSConnections(bool bUsePCSConversions=false);
+  icStatusCMM CollapseXforms();
 
   CIccApplyCmm *m_pApply;
 
@@ -1761,6 +1904,14 @@ protected:
   icRenderingIntent m_nLastIntent;
 
   CIccXformList *m_Xforms;
+
+  icUInt8Number m_nCollapseGrid;
+  icXformInterp m_nCollapseInterp;
+  bool m_bCollapseLinearize;
+  icCollapseStats m_CollapseStats;
+
+  icUInt8Number m_nFixedInputBits;
+  CIccCLUTFixed *m_pFixedCLUT;
 };
 
 //Forward Class for CIccApplyNamedColorCmm
@@ -1911,6 +2062,87 @@ typedef CIccMruCache<icFloatNumber> CIccMruCacheFloat;
 typedef CIccMruCache<icUInt8Number> CIccMruCache8;
 typedef CIccMruCache<icUInt16Number> CIccMruCache16;
 
+/// Maximum number of slots searched by CIccHashCache for a color
+#define icHashCacheMaxProbe 8
+
+/// Hit, miss and eviction counts of a color cache
+typedef struct {
+  icUInt64Number nHits;
+  icUInt64Number nMisses;
+  icUInt64Number nEvictions;
+} icColorCacheStats;
+
+/**
+**************************************************************************
+* Type: Class
+*
+* Purpose: Defines an open addressing hash table of source to destination
+* pixel transformations.  Unlike CIccMruCache it can hold thousands of
+* colors so that repeated colors are found anywhere in an image.
+*
+* Colors are either keyed by their exact sample values, or (nKeyBits of 8
+* or 16) by the samples quantized to 8 or 16-bit codes.  Quantized keys
+* are intended for pixels that were decoded from 8/16-bit data.  Pixels
+* with quantized samples outside of 0.0 to 1.0 are not cached.
+*
+* Colors can be looked up one pixel at a time using Apply()/Update(), or a
+* block of up to icCmmBlockPixels pixels at a time using Lookup()/Commit().
+*
+**************************************************************************
+*/
+class ICCPROFLIB_API CIccHashCache
+{
+public:
+  static CIccHashCache *NewHashCache(icUInt16Number nSrcSamples, icUInt16Number nDstSamples,
+                                     icUInt32Number nCacheSize=4096, icUInt8Number nKeyBits=0);
+
+  virtual ~CIccHashCache();
+
+  virtual bool Apply(icFloatNumber *DstPixel, const icFloatNumber *SrcPixel);
+  virtual void Update(icFloatNumber *DstPixel);
+
+  icUInt32Number Lookup(icFloatNumber *DstPixels, const icFloatNumber *SrcPixels, icUInt32Number nPixels,
+                        icFloatNumber *MissPixels);
+  void Commit(icFloatNumber *DstPixels, const icFloatNumber *MissPixels);
+
+  icUInt32Number GetCacheSize() const { return m_nMask+1; }
+  void GetStats(icColorCacheStats &stats) const;
+  void ResetStats();
+
+protected:
+  CIccHashCache();
+  bool Init(icUInt16Number nSrcSamples, icUInt16Number nDstSamples, icUInt32Number nCacheSize, icUInt8Number nKeyBits);
+
+  bool MakeKey(icUInt32Number *pKey, const icFloatNumber *SrcPixel) const;
+  icInt32Number Find(const icUInt32Number *pKey, icUInt32Number nHash, bool &bFound);
+  void DropPending();
+
+  icUInt32Number m_nSrcSamples;
+  icUInt32Number m_nDstSamples;
+  icUInt32Number m_nKeyMax;
+  icUInt32Number m_nKeyWords;
+  icUInt32Number m_nMask;
+  icUInt32Number m_nVictim;
+
+  icUInt32Number *m_pKeys;
+  icUInt32Number *m_pHash;
+  icUInt8Number *m_pState;
+  icFloatNumber *m_pValues;
+
+  icUInt32Number *m_pKey;
+  icInt32Number m_nUpdateSlot;
+
+  ///Pending misses and repeated colors of the last Lookup()
+  icUInt32Number m_nMiss;
+  icUInt32Number *m_pMissIdx;
+  icInt32Number *m_pMissSlot;
+  icUInt32Number m_nDup;
+  icUInt32Number *m_pDupIdx;
+  icInt32Number *m_pDupSlot;
+
+  icColorCacheStats m_stats;
+};
+
 // forward class CIccMruCmm used by CIccApplyMruCmm
 class CIccMruCmm;
 /**
@@ -1938,9 +2170,21 @@ protected:
   CIccApplyMruCmm(CIccMruCmm *pCmm);
 
   bool Init(CIccCmm *pCachedCmm, icUInt16Number nCacheSize);
+  bool Init(CIccCmm *pCachedCmm, icUInt32Number nCacheSize, icUInt8Number nKeyBits);
 
+public:
+  bool GetCacheStats(icColorCacheStats &stats) const;
+  void ResetCacheStats();
+
+protected:
   CIccCmm *m_pCachedCmm;
+  CIccApplyCmm *m_pCachedApply;
   CIccMruCacheFloat *m_pCache;
+  CIccHashCache *m_pHashCache;
+
+  ///Compacted source and destination pixels of hash cache misses
+  icFloatNumber *m_pMissSrc;
+  icFloatNumber *m_pMissDst;
 };
 
 /**
@@ -1962,6 +2206,13 @@ public:
   //This is the function used to create a new CIccMruCmm.  The pCmm must be valid and its Begin() already called.
   static CIccMruCmm* Attach(CIccCmm *pCmm, icUInt8Number nCacheSize=6, bool bDeleteCmm=true);  //The returned object will own pCmm, and pCmm is deleted on failure.
 
+  //Same as Attach but caches colors in a CIccHashCache of nCacheSize colors (nKeyBits of 8 or 16 quantizes the keys)
+  static CIccMruCmm* AttachHashed(CIccCmm *pCmm, icUInt32Number nCacheSize=4096, icUInt8Number nKeyBits=0, bool bDeleteCmm=true);
+
+  //Get/reset the hit, miss and eviction counts of the cache used by Apply (hashed caches only)
+  bool GetCacheStats(icColorCacheStats &stats) const;
+  void ResetCacheStats();
+
   //override AddXform/Begin functions to return bad status.
   virtual icStatusCMM AddXform(const icChar * /* szProfilePath */,
                                 icRenderingIntent /* nIntent=icUnknownIntent */,
@@ -2029,6 +2280,9 @@ protected:
   icUInt16Number m_nCacheSize;
   bool m_bDeleteCmm;
 
+  icUInt32Number m_nHashSize;
+  icUInt8Number m_nKeyBits;
+
 };
 
 #endif //__cplusplus
@@ -0,0 +1,740 @@
+/** @file
+    File:       IccCmmCache.cpp
+
+    Contains:   Implementation of the cache of ready to use CMM transforms
+
+    Version:    V1
+
+    Copyright:  (c) see Software License
+*/
+
+/*
+ * Copyright (c) International Color Consortium.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer. 
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. In the absence of prior written permission, the names "ICC" and "The
+ *    International Color Consortium" must not be used to imply that the
+ *    ICC organization endorses or promotes products derived from this
+ *    software.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE INTERNATIONAL COLOR CONSORTIUM OR
+ * ITS CONTRIBUTING MEMBERS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by many
+ * individuals on behalf of the The International Color Consortium. 
+ *
+ *
+ * Membership in the ICC is encouraged when this software is used for
+ * commercial purposes. 
+ *
+ *  
+ * For more information on The International Color Consortium, please
+ * see <http://www.color.org/>.
+ *  
+ * 
+ */
+
+
+//////////////////////////////////////////////////////////////////////
+// HISTORY:
+//
+// -Initial implementation of transform cache 10-18-2026
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "IccCmmCache.h"
+#include "IccProfile.h"
+#include "IccApplyBPC.h"
+#include "IccMD5.h"
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <thread>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#if defined(WIN32)
+  #include <process.h>
+  #define icGetProcessId() _getpid()
+#else
+  #include <unistd.h>
+  #define icGetProcessId() getpid()
+#endif
+
+#if defined(USEICCDEVNAMESPACE)
+namespace iccDEV {
+#endif
+
+typedef std::list<CIccProfile*> icCmmCacheProfileList;
+
+/**
+ ****************************************************************************
+ * Name: icCmmRecipeXform::icCmmRecipeXform
+ * 
+ * Purpose: Constructor.  Hints and PCC profile are initially unused.
+ *****************************************************************************
+ */
+icCmmRecipeXform::icCmmRecipeXform(const icChar *szProfilePath/*=NULL*/, icRenderingIntent intent/*=icUnknownIntent*/,
+                                   icXformInterp interp/*=icInterpLinear*/, icXformLutType lutType/*=icXformLutColor*/)
+{
+  if (szProfilePath)
+    sProfilePath = szProfilePath;
+  nIntent = intent;
+  nInterp = interp;
+  nLutType = lutType;
+  bUseD2BxB2DxTags = true;
+  bUseSubProfile = false;
+  bUseBPC = false;
+  bLuminanceMatching = false;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccCmmRecipe::CIccCmmRecipe
+ * 
+ * Purpose: Constructor.  Arguments match those of CIccCmm.
+ *****************************************************************************
+ */
+CIccCmmRecipe::CIccCmmRecipe(icColorSpaceSignature nSrcSpace/*=icSigUnknownData*/,
+                             icColorSpaceSignature nDestSpace/*=icSigUnknownData*/,
+                             bool bFirstInput/*=true*/)
+{
+  m_nSrcSpace = nSrcSpace;
+  m_nDestSpace = nDestSpace;
+  m_bFirstInput = bFirstInput;
+  m_bUsePcsConversion = false;
+
+  m_nCollapseGrid = 0;
+  m_nCollapseInterp = icInterpTetrahedral;
+  m_bCollapseLinearize = true;
+  m_nFixedInputBits = 0;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccCmmRecipe::SetCollapseLink
+ * 
+ * Purpose: Has the built CMM replace its xform chain with a single sampled
+ *  device link (nGridPoints=0 disables)
+ *****************************************************************************
+ */
+void CIccCmmRecipe::SetCollapseLink(icUInt8Number nGridPoints, icXformInterp nInterp/*=icInterpTetrahedral*/,
+                                    bool bLinearize/*=true*/)
+{
+  m_nCollapseGrid = nGridPoints;
+  m_nCollapseInterp = nInterp;
+  m_bCollapseLinearize = bLinearize;
+}
+
+/**
+ ****************************************************************************
+ * Name: icCmmCacheDeleter
+ * 
+ * Purpose: Deletes a CMM built from a recipe together with the PCC profiles
+ *  that its xforms refer to
+ *****************************************************************************
+ */
+class icCmmCacheDeleter
+{
+public:
+  icCmmCacheDeleter(const std::shared_ptr<icCmmCacheProfileList> &pccList) : m_pccList(pccList) {}
+
+  void operator()(CIccCmm *pCmm)
+  {
+    delete pCmm;
+
+    if (m_pccList) {
+      icCmmCacheProfileList::iterator i;
+      for (i=m_pccList->begin(); i!=m_pccList->end(); i++)
+        delete *i;
+    }
+  }
+
+protected:
+  std::shared_ptr<icCmmCacheProfileList> m_pccList;
+};
+
+/**
+ ****************************************************************************
+ * Name: CIccCmmRecipe::NewCmm
+ * 
+ * Purpose: Builds a CIccCmm from the recipe and begins it without an apply
+ *  object.  Use GetNewApplyCmm() to apply the returned CMM.
+ * 
+ * Args:
+ *  rv - returned status
+ * 
+ * Return: 
+ *  Shared pointer to the CMM, empty on error
+ *****************************************************************************
+ */
+CIccCmmPtr CIccCmmRecipe::NewCmm(icStatusCMM &rv) const
+{
+  std::shared_ptr<icCmmCacheProfileList> pccList(new icCmmCacheProfileList);
+  CIccCmmPtr pCmm(new CIccCmm(m_nSrcSpace, m_nDestSpace, m_bFirstInput), icCmmCacheDeleter(pccList));
+  std::vector<icCmmRecipeXform>::const_iterator x;
+
+  if (m_Xforms.empty()) {
+    rv = icCmmStatBadXform;
+    return CIccCmmPtr();
+  }
+
+  for (x=m_Xforms.begin(); x!=m_Xforms.end(); x++) {
+    CIccProfile *pPccProfile = NULL;
+    CIccCreateXformHintManager Hint;
+
+    if (x->bUseBPC)
+      Hint.AddHint(new CIccApplyBPCHint());
+
+    if (x->bLuminanceMatching)
+      Hint.AddHint(new CIccLuminanceMatchingHint());
+
+    if (!x->envVars.empty()) {
+      icCmmEnvSigMap envVars = x->envVars;
+      Hint.AddHint(new CIccCmmEnvVarHint(envVars));
+    }
+
+    if (!x->pccEnvVars.empty()) {
+      icCmmEnvSigMap pccEnvVars = x->pccEnvVars;
+      Hint.AddHint(new CIccCmmPccEnvVarHint(pccEnvVars));
+    }
+
+    if (!x->sPccPath.empty()) {
+      pPccProfile = OpenIccProfile(x->sPccPath.c_str());
+      if (!pPccProfile) {
+        rv = icCmmStatCantOpenProfile;
+        return CIccCmmPtr();
+      }
+      pccList->push_back(pPccProfile);
+    }
+
+    rv = pCmm->AddXform(x->sProfilePath.c_str(), x->nIntent, x->nInterp, pPccProfile, x->nLutType,
+                        x->bUseD2BxB2DxTags, &Hint, x->bUseSubProfile);
+    if (rv != icCmmStatOk)
+      return CIccCmmPtr();
+  }
+
+  pCmm->SetCollapseLink(m_nCollapseGrid, m_nCollapseInterp, m_bCollapseLinearize);
+  pCmm->SetFixedInterp(m_nFixedInputBits);
+
+  rv = pCmm->Begin(false, m_bUsePcsConversion);
+  if (rv != icCmmStatOk)
+    return CIccCmmPtr();
+
+  return pCmm;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccCmmRecipe::NewCmm
+ * 
+ * Purpose: Builds a CIccCmm from a device link saved from a CMM that was
+ *  built from the recipe and collapsed
+ * 
+ * Args:
+ *  szLinkPath - path of the saved device link profile
+ *  rv - returned status
+ * 
+ * Return: 
+ *  Shared pointer to the CMM, empty on error
+ *****************************************************************************
+ */
+CIccCmmPtr CIccCmmRecipe::NewCmm(const icChar *szLinkPath, icStatusCMM &rv) const
+{
+  CIccProfile *pLink = OpenIccProfile(szLinkPath);
+
+  if (!pLink) {
+    rv = icCmmStatCantOpenProfile;
+    return CIccCmmPtr();
+  }
+
+  if (pLink->m_Header.deviceClass != icSigLinkClass) {
+    delete pLink;
+    rv = icCmmStatBadXform;
+    return CIccCmmPtr();
+  }
+
+  CIccCmmPtr pCmm(new CIccCmm(m_nSrcSpace, m_nDestSpace, true));
+
+  rv = pCmm->AddXform(pLink, icPerceptual, m_nCollapseInterp);
+  if (rv != icCmmStatOk) {
+    delete pLink;
+    return CIccCmmPtr();
+  }
+
+  pCmm->SetFixedInterp(m_nFixedInputBits);
+
+  rv = pCmm->Begin(false, m_bUsePcsConversion);
+  if (rv != icCmmStatOk)
+    return CIccCmmPtr();
+
+  return pCmm;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccCmmCache::CIccCmmCache
+ * 
+ * Purpose: Constructor
+ * 
+ * Args:
+ *  nMaxEntries - number of transforms that the cache holds
+ *****************************************************************************
+ */
+CIccCmmCache::CIccCmmCache(size_t nMaxEntries/*=icCmmCacheDefaultEntries*/)
+{
+  m_nMaxEntries = nMaxEntries;
+
+  m_nHits = 0;
+  m_nDiskHits = 0;
+  m_nMisses = 0;
+  m_nDiskWrites = 0;
+  m_nEvictions = 0;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccCmmCache::~CIccCmmCache
+ * 
+ * Purpose: Destructor
+ *****************************************************************************
+ */
+CIccCmmCache::~CIccCmmCache()
+{
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccCmmCache::GetProcessCache
+ * 
+ * Purpose: Returns the process wide cache
+ *****************************************************************************
+ */
+CIccCmmCache *CIccCmmCache::GetProcessCache()
+{
+  static CIccCmmCache cache;
+
+  return &cache;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccCmmCache::SetMaxEntries
+ * 
+ * Purpose: Changes the number of transforms held and evicts if needed
+ *****************************************************************************
+ */
+void CIccCmmCache::SetMaxEntries(size_t nMaxEntries)
+{
+  std::lock_guard<std::mutex> lock(m_lock);
+
+  m_nMaxEntries = nMaxEntries;
+  Evict();
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccCmmCache::GetMaxEntries
+ * 
+ * Purpose: Returns the number of transforms held
+ *****************************************************************************
+ */
+size_t CIccCmmCache::GetMaxEntries()
+{
+  std::lock_guard<std::mutex> lock(m_lock);
+
+  return m_nMaxEntries;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccCmmCache::SetCacheDir
+ * 
+ * Purpose: Sets the directory that collapsed links are saved in and loaded
+ *  from.  The directory must exist.
+ *****************************************************************************
+ */
+void CIccCmmCache::SetCacheDir(const icChar *szDir)
+{
+  std::lock_guard<std::mutex> lock(m_lock);
+
+  if (szDir)
+    m_sCacheDir = szDir;
+  else
+    m_sCacheDir.clear();
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccCmmCache::GetCacheDir
+ * 
+ * Purpose: Returns the cache directory (empty if not used)
+ *****************************************************************************
+ */
+std::string CIccCmmCache::GetCacheDir()
+{
+  std::lock_guard<std::mutex> lock(m_lock);
+
+  return m_sCacheDir;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccCmmCache::GetProfileId
+ * 
+ * Purpose: Returns the profile ID of a file as 32 hex digits.  The MD5 of
+ *  the file is used when the header has no ID.  IDs are remembered by
+ *  file path, size and modification time so that files are only hashed
+ *  once.  A file with a sub-profile is identified by the outer profile.
+ * 
+ * Return: 
+ *  true if the file can be read, false otherwise
+ *****************************************************************************
+ */
+bool CIccCmmCache::GetProfileId(const std::string &sPath, std::string &sId)
+{
+  struct stat st;
+
+  if (stat(sPath.c_str(), &st) || !(st.st_mode & S_IFREG))
+    return false;
+
+  char buf[64];
+  sprintf(buf, "|%llu|%lld", (unsigned long long)st.st_size, (long long)st.st_mtime);
+
+  std::string sFileKey = sPath + buf;
+
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    CIccCmmCacheIdMap::iterator i = m_ids.find(sFileKey);
+    if (i != m_ids.end()) {
+      sId = i->second;
+      return true;
+    }
+  }
+
+  CIccFileIO io;
+  icProfileID id;
+  int i;
+
+  if (!io.Open(sPath.c_str(), "rb"))
+    return false;
+
+  memset(&id, 0, sizeof(id));
+  if (io.Seek(84, icSeekSet)<0 || io.Read8(&id.ID8[0], sizeof(id.ID8))!=sizeof(id.ID8))
+    return false;
+
+  for (i=0; i<16 && !id.ID8[i]; i++);
+
+  if (i==16)
+    CalcProfileID(&io, &id);
+
+  io.Close();
+
+  sId.clear();
+  for (i=0; i<16; i++) {
+    sprintf(buf, "%02x", id.ID8[i]);
+    sId += buf;
+  }
+
+  std::lock_guard<std::mutex> lock(m_lock);
+
+  m_ids[sFileKey] = sId;
+
+  return true;
+}
+
+/**
+ ****************************************************************************
+ * Name: icCmmCacheAddEnvVars
+ * 
+ * Purpose: Appends the values of an environment variable map to a key
+ *****************************************************************************
+ */
+static void icCmmCacheAddEnvVars(std::string &sKey, const icCmmEnvSigMap &envVars)
+{
+  icCmmEnvSigMap::const_iterator v;
+  char buf[64];
+
+  for (v=envVars.begin(); v!=envVars.end(); v++) {
+    sprintf(buf, "%08x=%.17g,", (unsigned int)v->first, (double)v->second);
+    sKey += buf;
+  }
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccCmmCache::GetKey
+ * 
+ * Purpose: Builds the cache key of a recipe
+ * 
+ * Args:
+ *  recipe - recipe to build the key of
+ *  sKey - returned key
+ * 
+ * Return: 
+ *  true if all profiles of the recipe can be read, false otherwise
+ *****************************************************************************
+ */
+bool CIccCmmCache::GetKey(const CIccCmmRecipe &recipe, std::string &sKey)
+{
+  std::vector<icCmmRecipeXform>::const_iterator x;
+  std::string sId;
+  char buf[128];
+
+  sprintf(buf, "%08x|%08x|%d|%d|%d|%d|%d|%d;", (unsigned int)recipe.m_nSrcSpace, (unsigned int)recipe.m_nDestSpace,
+          recipe.m_bFirstInput ? 1 : 0, recipe.m_bUsePcsConversion ? 1 : 0, recipe.m_nCollapseGrid,
+          recipe.m_nCollapseInterp, recipe.m_bCollapseLinearize ? 1 : 0, recipe.m_nFixedInputBits);
+  sKey = buf;
+
+  for (x=recipe.m_Xforms.begin(); x!=recipe.m_Xforms.end(); x++) {
+    if (!GetProfileId(x->sProfilePath, sId))
+      return false;
+    sKey += sId;
+
+    sprintf(buf, "|%d|%d|%d|%d|%d|%d|%d|", x->bUseSubProfile ? 1 : 0, x->nIntent, x->nInterp, x->nLutType,
+            x->bUseD2BxB2DxTags ? 1 : 0, x->bUseBPC ? 1 : 0, x->bLuminanceMatching ? 1 : 0);
+    sKey += buf;
+
+    if (!x->sPccPath.empty()) {
+      if (!GetProfileId(x->sPccPath, sId))
+        return false;
+      sKey += sId;
+    }
+    sKey += "|";
+
+    icCmmCacheAddEnvVars(sKey, x->envVars);
+    sKey += "|";
+    icCmmCacheAddEnvVars(sKey, x->pccEnvVars);
+    sKey += ";";
+  }
+
+  return true;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccCmmCache::GetCmm
+ * 
+ * Purpose: Returns the CMM for a recipe.  It is built, or loaded from the
+ *  cache directory, if it is not in the cache.  The CMM must be applied
+ *  through objects returned by its GetNewApplyCmm() function.
+ * 
+ * Args:
+ *  recipe - recipe of the CMM
+ *  rv - returned status
+ * 
+ * Return: 
+ *  Shared pointer to the cached CMM, empty on error
+ *****************************************************************************
+ */
+CIccCmmPtr CIccCmmCache::GetCmm(const CIccCmmRecipe &recipe, icStatusCMM &rv)
+{
+  std::string sKey, sDir;
+
+  if (!GetKey(recipe, sKey)) {
+    rv = icCmmStatCantOpenProfile;
+    return CIccCmmPtr();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    CIccCmmCacheMap::iterator i = m_keys.find(sKey);
+    if (i != m_keys.end()) {
+      m_lru.splice(m_lru.begin(), m_lru, i->second);
+      m_nHits++;
+      rv = icCmmStatOk;
+      return i->second->pCmm;
+    }
+
+    sDir = m_sCacheDir;
+  }
+
+  //Link files are named by the MD5 of the key
+  std::string sLinkPath;
+  if (!sDir.empty() && recipe.m_nCollapseGrid) {
+    MD5_CTX context;
+    icUInt8Number digest[16];
+    char buf[8];
+    int i;
+
+    icMD5Init(&context);
+    icMD5Update(&context, (unsigned char*)sKey.c_str(), (unsigned int)sKey.size());
+    icMD5Final(digest, &context);
+
+    sLinkPath = sDir;
+    if (sLinkPath[sLinkPath.size()-1] != '/' && sLinkPath[sLinkPath.size()-1] != '\\')
+      sLinkPath += "/";
+    for (i=0; i<16; i++) {
+      sprintf(buf, "%02x", digest[i]);
+      sLinkPath += buf;
+    }
+    sLinkPath += ".icc";
+  }
+
+  //Build without holding the lock.  If another thread adds the same
+  //recipe in the mean time then the first one is kept.
+  CIccCmmPtr pCmm;
+  bool bFromDisk = false, bSaved = false;
+
+  if (!sLinkPath.empty()) {
+    struct stat st;
+
+    if (!stat(sLinkPath.c_str(), &st)) {
+      pCmm = recipe.NewCmm(sLinkPath.c_str(), rv);
+      bFromDisk = pCmm != NULL;
+    }
+  }
+
+  if (!pCmm) {
+    pCmm = recipe.NewCmm(rv);
+    if (!pCmm)
+      return pCmm;
+
+    //Save to a temporary file and rename it so that other processes never see a partial file
+    if (!sLinkPath.empty() && pCmm->GetCollapseStats().bCollapsed && pCmm->GetNumXforms()==1) {
+      CIccProfile *pLink = pCmm->GetFirstXform()->GetProfilePtr();
+      char buf[64];
+
+      //Thread ids are only unique within a process so the process id is included as well
+      sprintf(buf, ".%lx.%llx.%llx.tmp", (unsigned long)icGetProcessId(),
+              (unsigned long long)std::hash<std::thread::id>()(std::this_thread::get_id()),
+              (unsigned long long)time(NULL));
+      std::string sTmpPath = sLinkPath + buf;
+
+      if (pLink && SaveIccProfile(sTmpPath.c_str(), pLink)) {
+        remove(sLinkPath.c_str());
+        bSaved = !rename(sTmpPath.c_str(), sLinkPath.c_str());
+      }
+      if (!bSaved)
+        remove(sTmpPath.c_str());
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(m_lock);
+
+  if (bFromDisk)
+    m_nDiskHits++;
+  else
+    m_nMisses++;
+  if (bSaved)
+    m_nDiskWrites++;
+
+  rv = icCmmStatOk;
+
+  CIccCmmCacheMap::iterator i = m_keys.find(sKey);
+  if (i != m_keys.end())
+    return i->second->pCmm;
+
+  CIccCmmCacheEntry entry;
+  entry.sKey = sKey;
+  entry.pCmm = pCmm;
+
+  m_lru.push_front(entry);
+  m_keys[sKey] = m_lru.begin();
+
+  Evict();
+
+  return pCmm;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccCmmCache::Clear
+ * 
+ * Purpose: Removes all transforms from the cache.  Transforms that are
+ *  still in use are deleted when they are no longer used.  Files in the
+ *  cache directory are kept.
+ *****************************************************************************
+ */
+void CIccCmmCache::Clear()
+{
+  std::lock_guard<std::mutex> lock(m_lock);
+
+  m_lru.clear();
+  m_keys.clear();
+  m_ids.clear();
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccCmmCache::GetStats
+ * 
+ * Purpose: Returns the usage counters of the cache
+ *****************************************************************************
+ */
+void CIccCmmCache::GetStats(icCmmCacheStats &stats)
+{
+  std::lock_guard<std::mutex> lock(m_lock);
+
+  stats.nHits = m_nHits;
+  stats.nDiskHits = m_nDiskHits;
+  stats.nMisses = m_nMisses;
+  stats.nDiskWrites = m_nDiskWrites;
+  stats.nEvictions = m_nEvictions;
+  stats.nEntries = m_lru.size();
+  stats.nMaxEntries = m_nMaxEntries;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccCmmCache::ResetStats
+ * 
+ * Purpose: Sets the usage counters to zero
+ *****************************************************************************
+ */
+void CIccCmmCache::ResetStats()
+{
+  std::lock_guard<std::mutex> lock(m_lock);
+
+  m_nHits = 0;
+  m_nDiskHits = 0;
+  m_nMisses = 0;
+  m_nDiskWrites = 0;
+  m_nEvictions = 0;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccCmmCache::Evict
+ * 
+ * Purpose: Removes least recently used transforms until the entry limit
+ *  is met.  Must be called with m_lock held.
+ *****************************************************************************
+ */
+void CIccCmmCache::Evict()
+{
+  while (m_lru.size() > m_nMaxEntries) {
+    m_keys.erase(m_lru.back().sKey);
+    m_lru.pop_back();
+    m_nEvictions++;
+  }
+}
+
+#if defined(USEICCDEVNAMESPACE)
+}; //namespace iccDEV
+#endif
@@ -0,0 +1,255 @@
+/** @file
+    File:       IccCmmCache.h
+
+    Contains:   Header for the cache of ready to use CMM transforms
+
+    Version:    V1
+
+    Copyright:  (c) see Software License
+*/
+
+/*
+ * Copyright (c) International Color Consortium.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer. 
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. In the absence of prior written permission, the names "ICC" and "The
+ *    International Color Consortium" must not be used to imply that the
+ *    ICC organization endorses or promotes products derived from this
+ *    software.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE INTERNATIONAL COLOR CONSORTIUM OR
+ * ITS CONTRIBUTING MEMBERS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by many
+ * individuals on behalf of the The International Color Consortium. 
+ *
+ *
+ * Membership in the ICC is encouraged when this software is used for
+ * commercial purposes. 
+ *
+ *  
+ * For more information on The International Color Consortium, please
+ * see <http://www.color.org/>.
+ *  
+ * 
+ */
+
+
+//////////////////////////////////////////////////////////////////////
+// HISTORY:
+//
+// -Initial implementation of transform cache 10-18-2026
+//
+//////////////////////////////////////////////////////////////////////
+
+#if !defined(_ICCCMMCACHE_H)
+#define _ICCCMMCACHE_H
+
+#include "IccCmm.h"
+#include "IccEnvVar.h"
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+
+#if defined(USEICCDEVNAMESPACE)
+namespace iccDEV {
+#endif
+
+/// Default number of transforms held by a CIccCmmCache
+#define icCmmCacheDefaultEntries 64
+
+typedef std::shared_ptr<CIccCmm> CIccCmmPtr;
+
+/**
+**************************************************************************
+* Type: Structure
+*
+* Purpose: Describes one profile of a CIccCmmRecipe.  The members match
+*  the arguments of CIccCmm::AddXform() with the hints given as values so
+*  that they can be compared.
+**************************************************************************
+*/
+struct ICCPROFLIB_API icCmmRecipeXform
+{
+  icCmmRecipeXform(const icChar *szProfilePath=NULL, icRenderingIntent intent=icUnknownIntent,
+                   icXformInterp interp=icInterpLinear, icXformLutType lutType=icXformLutColor);
+
+  std::string sProfilePath;
+  icRenderingIntent nIntent;
+  icXformInterp nInterp;
+  icXformLutType nLutType;
+  bool bUseD2BxB2DxTags;
+  bool bUseSubProfile;
+
+  std::string sPccPath;       //Profile connection conditions (empty for none)
+  icCmmEnvSigMap envVars;     //Passed with a CIccCmmEnvVarHint
+  icCmmEnvSigMap pccEnvVars;  //Passed with a CIccCmmPccEnvVarHint
+  bool bUseBPC;               //Passed with a CIccApplyBPCHint
+  bool bLuminanceMatching;    //Passed with a CIccLuminanceMatchingHint
+};
+
+/**
+**************************************************************************
+* Type: Class
+*
+* Purpose: Everything needed to build and begin a CIccCmm.  A recipe is
+*  used as the key of a CIccCmmCache.
+**************************************************************************
+*/
+class ICCPROFLIB_API CIccCmmRecipe
+{
+  friend class CIccCmmCache;
+public:
+  CIccCmmRecipe(icColorSpaceSignature nSrcSpace=icSigUnknownData,
+                icColorSpaceSignature nDestSpace=icSigUnknownData,
+                bool bFirstInput=true);
+
+  void AddXform(const icCmmRecipeXform &xform) { m_Xforms.push_back(xform); }
+  icUInt32Number GetNumXforms() const { return (icUInt32Number)m_Xforms.size(); }
+
+  ///See CIccCmm::SetCollapseLink().  Only collapsed transforms are saved to a cache directory.
+  void SetCollapseLink(icUInt8Number nGridPoints, icXformInterp nInterp=icInterpTetrahedral, bool bLinearize=true);
+  ///See CIccCmm::SetFixedInterp()
+  void SetFixedInterp(icUInt8Number nInputBits) { m_nFixedInputBits = nInputBits; }
+  ///See CIccCmm::Begin()
+  void SetUsePcsConversion(bool bUsePcsConversion) { m_bUsePcsConversion = bUsePcsConversion; }
+
+  CIccCmmPtr NewCmm(icStatusCMM &rv) const;
+
+protected:
+  CIccCmmPtr NewCmm(const icChar *szLinkPath, icStatusCMM &rv) const;
+
+  icColorSpaceSignature m_nSrcSpace;
+  icColorSpaceSignature m_nDestSpace;
+  bool m_bFirstInput;
+  bool m_bUsePcsConversion;
+
+  icUInt8Number m_nCollapseGrid;
+  icXformInterp m_nCollapseInterp;
+  bool m_bCollapseLinearize;
+  icUInt8Number m_nFixedInputBits;
+
+  std::vector<icCmmRecipeXform> m_Xforms;
+};
+
+/**
+**************************************************************************
+* Type: Structure
+*
+* Purpose: Usage counters of a CIccCmmCache
+**************************************************************************
+*/
+typedef struct {
+  icUInt64Number nHits;       //Lookups served from memory
+  icUInt64Number nDiskHits;   //Lookups served from a link in the cache directory
+  icUInt64Number nMisses;     //Lookups that had to build the transform
+  icUInt64Number nDiskWrites; //Links saved to the cache directory
+  icUInt64Number nEvictions;  //Entries removed to stay within the entry limit
+  size_t nEntries;            //Transforms currently held
+  size_t nMaxEntries;         //Entry limit
+} icCmmCacheStats;
+
+/**
+**************************************************************************
+* Type: Class
+*
+* Purpose: Cache of CMMs that have been built and begun from a recipe.
+*  Recipes are keyed by the profile IDs of their profiles and PCC profiles
+*  (the MD5 of the file when the header has no ID) together with the
+*  intents, interpolations, lut types, hints and collapse settings.
+*
+*  Cached CMMs are begun without an apply object and are shared by all
+*  users, so they must be applied through objects returned by
+*  GetNewApplyCmm(), one per thread.  A CMM stays valid for as long as it
+*  is used even if it is evicted.
+*
+*  When a cache directory is set, recipes that collapse the chain into a
+*  device link save the link profile in the directory under the MD5 of the
+*  key, and later lookups (also by other processes) load the link rather
+*  than building the chain again.  Links with up to 15 output channels are
+*  saved with 16 bit CLUT entries.  Loaded CMMs report no collapse stats.
+*
+*  All member functions may be called from several threads.
+**************************************************************************
+*/
+class ICCPROFLIB_API CIccCmmCache
+{
+public:
+  CIccCmmCache(size_t nMaxEntries=icCmmCacheDefaultEntries);
+  virtual ~CIccCmmCache();
+
+  ///Returns a process wide cache
+  static CIccCmmCache *GetProcessCache();
+
+  void SetMaxEntries(size_t nMaxEntries);
+  size_t GetMaxEntries();
+
+  ///Sets the directory that collapsed links are saved in (NULL or empty to disable)
+  void SetCacheDir(const icChar *szDir);
+  std::string GetCacheDir();
+
+  CIccCmmPtr GetCmm(const CIccCmmRecipe &recipe, icStatusCMM &rv);
+  bool GetKey(const CIccCmmRecipe &recipe, std::string &sKey);
+
+  void Clear();
+  void GetStats(icCmmCacheStats &stats);
+  void ResetStats();
+
+protected:
+  struct CIccCmmCacheEntry {
+    std::string sKey;
+    CIccCmmPtr pCmm;
+  };
+  typedef std::list<CIccCmmCacheEntry> CIccCmmCacheList;
+  typedef std::unordered_map<std::string, CIccCmmCacheList::iterator> CIccCmmCacheMap;
+  typedef std::unordered_map<std::string, std::string> CIccCmmCacheIdMap;
+
+  bool GetProfileId(const std::string &sPath, std::string &sId);
+  void Evict();
+
+  std::mutex m_lock;
+  size_t m_nMaxEntries;
+  std::string m_sCacheDir;
+
+  CIccCmmCacheList m_lru;     //Most recently used first
+  CIccCmmCacheMap m_keys;     //Entries by recipe key
+  CIccCmmCacheIdMap m_ids;    //Profile ID keys by file path, size and time
+
+  icUInt64Number m_nHits;
+  icUInt64Number m_nDiskHits;
+  icUInt64Number m_nMisses;
+  icUInt64Number m_nDiskWrites;
+  icUInt64Number m_nEvictions;
+};
+
+#if defined(USEICCDEVNAMESPACE)
+}; //namespace iccDEV
+#endif
+
+#endif //_ICCCMMCACHE_H
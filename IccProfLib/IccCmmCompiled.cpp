@@ -0,0 +1,549 @@
+/** @file
+    File:       IccCmmCompiled.cpp
+
+    Contains:   Implementation of saving and loading compiled transforms
+
+    Version:    V1
+
+    Copyright:  (c) see Software License
+*/
+
+
+/*
+ * Copyright (c) International Color Consortium.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer. 
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. In the absence of prior written permission, the names "ICC" and "The
+ *    International Color Consortium" must not be used to imply that the
+ *    ICC organization endorses or promotes products derived from this
+ *    software.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE INTERNATIONAL COLOR CONSORTIUM OR
+ * ITS CONTRIBUTING MEMBERS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by many
+ * individuals on behalf of the The International Color Consortium. 
+ *
+ *
+ * Membership in the ICC is encouraged when this software is used for
+ * commercial purposes. 
+ *
+ *  
+ * For more information on The International Color Consortium, please
+ * see <http://www.color.org/>.
+ *  
+ * 
+ */
+
+//////////////////////////////////////////////////////////////////////
+// HISTORY:
+//
+// -Initial implementation of compiled transforms 10-18-2026
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "IccCmmCompiled.h"
+#include "IccTagLut.h"
+#include "IccSimd.h"
+#include "IccProfLibVer.h"
+#include <cstring>
+
+#if defined(USEICCDEVNAMESPACE)
+namespace iccDEV {
+#endif
+
+/**
+ ****************************************************************************
+ * Name: icCompiledPad
+ * 
+ * Purpose: Writes zeros until the position of pIO is a multiple of
+ *  icCompiledXformAlign from nStart
+ * 
+ * Return: 
+ *  Offset of the new position from nStart, or 0 on error
+ *****************************************************************************
+ */
+static icUInt32Number icCompiledPad(CIccIO *pIO, int64_t nStart)
+{
+  icUInt8Number zero[icCompiledXformAlign];
+  int64_t nPos = pIO->Tell() - nStart;
+  size_t nPad = (size_t)((icCompiledXformAlign - nPos % icCompiledXformAlign) % icCompiledXformAlign);
+
+  memset(zero, 0, sizeof(zero));
+  if (nPos<0 || pIO->Write8(zero, nPad)!=nPad)
+    return 0;
+
+  return (icUInt32Number)(nPos + nPad);
+}
+
+
+/**
+ ****************************************************************************
+ * Name: icCompiledWriteCurves
+ * 
+ * Purpose: Writes a curve section of a compiled transform
+ * 
+ * Args:
+ *  pIO - IO object to write to
+ *  pCurves - curves to write
+ *  nCurves - number of curves
+ * 
+ * Return: 
+ *  true if all curves could be written
+ *****************************************************************************
+ */
+static bool icCompiledWriteCurves(CIccIO *pIO, LPIccCurve *pCurves, icUInt32Number nCurves)
+{
+  icUInt32Number i;
+
+  for (i=0; i<nCurves; i++) {
+    icCompiledCurveEntry entry;
+    icFloatNumber *pValues;
+
+    if (!pCurves[i])
+      return false;
+
+    entry.type = pCurves[i]->GetType();
+    if (entry.type==icSigCurveType) {
+      CIccTagCurve *pCurve = (CIccTagCurve*)pCurves[i];
+
+      entry.functionType = 0;
+      entry.nValues = pCurve->GetSize();
+      pValues = entry.nValues ? pCurve->GetData(0) : NULL;
+    }
+    else if (entry.type==icSigParametricCurveType) {
+      CIccTagParametricCurve *pCurve = (CIccTagParametricCurve*)pCurves[i];
+
+      entry.functionType = pCurve->GetFunctionType();
+      entry.nValues = pCurve->GetNumParam();
+      pValues = pCurve->GetParams();
+    }
+    else
+      return false;
+
+    size_t nBytes = (size_t)entry.nValues * sizeof(icFloatNumber);
+    if (pIO->Write8(&entry, sizeof(entry))!=sizeof(entry) ||
+        (nBytes && pIO->Write8(pValues, nBytes)!=nBytes))
+      return false;
+  }
+
+  return true;
+}
+
+
+/**
+ ****************************************************************************
+ * Name: icCompiledReadCurves
+ * 
+ * Purpose: Reads a curve section of a compiled transform into the curves
+ *  of a lut tag
+ * 
+ * Args:
+ *  pCurves - curves to fill in (entries left NULL on error)
+ *  nCurves - number of curves
+ *  pData - start of the section
+ *  nSize - size of the section
+ * 
+ * Return: 
+ *  true if all curves could be read
+ *****************************************************************************
+ */
+static bool icCompiledReadCurves(LPIccCurve *pCurves, icUInt32Number nCurves,
+                                 const icUInt8Number *pData, icUInt32Number nSize)
+{
+  icUInt32Number i, nPos = 0;
+
+  for (i=0; i<nCurves; i++) {
+    icCompiledCurveEntry entry;
+
+    if (nSize - nPos < sizeof(entry))
+      return false;
+    memcpy(&entry, pData + nPos, sizeof(entry));
+    nPos += sizeof(entry);
+
+    if (entry.nValues > (nSize - nPos) / sizeof(icFloatNumber))
+      return false;
+
+    const icUInt8Number *pValues = pData + nPos;
+    size_t nBytes = (size_t)entry.nValues * sizeof(icFloatNumber);
+
+    if (entry.type==icSigCurveType) {
+      CIccTagCurve *pCurve = new CIccTagCurve(0);
+
+      pCurves[i] = pCurve;
+      if (entry.nValues) {
+        if (!pCurve->SetSize(entry.nValues))
+          return false;
+        memcpy(pCurve->GetData(0), pValues, nBytes);
+      }
+    }
+    else if (entry.type==icSigParametricCurveType) {
+      CIccTagParametricCurve *pCurve = new CIccTagParametricCurve();
+
+      pCurves[i] = pCurve;
+      if (!pCurve->SetFunctionType((icUInt16Number)entry.functionType) || pCurve->GetNumParam()!=entry.nValues)
+        return false;
+      if (nBytes)
+        memcpy(pCurve->GetParams(), pValues, nBytes);
+    }
+    else
+      return false;
+
+    nPos += (icUInt32Number)nBytes;
+  }
+
+  return true;
+}
+
+
+/**
+ ****************************************************************************
+ * Name: CIccCompiledCmm::CIccCompiledCmm
+ * 
+ * Purpose: Constructor
+ *****************************************************************************
+ */
+CIccCompiledCmm::CIccCompiledCmm() : CIccCmm(icSigUnknownData, icSigUnknownData, true)
+{
+  m_pMappedIO = NULL;
+}
+
+
+/**
+ ****************************************************************************
+ * Name: CIccCompiledCmm::~CIccCompiledCmm
+ * 
+ * Purpose: Destructor.  The link xform does not use the grid data when it
+ *  is deleted, so the mapping can be closed before the base class deletes
+ *  the xforms.
+ *****************************************************************************
+ */
+CIccCompiledCmm::~CIccCompiledCmm()
+{
+  if (m_pMappedIO)
+    delete m_pMappedIO;
+}
+
+
+/**
+ ****************************************************************************
+ * Name: CIccCompiledCmm::Save
+ * 
+ * Purpose: Saves the device link of a CMM whose chain was collapsed by
+ *  Begin() as a compiled transform
+ * 
+ * Args:
+ *  pCmm - CMM to save
+ *  pIO - IO object to write to (written from its current position)
+ * 
+ * Return: 
+ *  icCmmStatOk if saved, icCmmStatBadLutType if the CMM has not been
+ *  collapsed to a device link with a lutAtoBType tag
+ *****************************************************************************
+ */
+icStatusCMM CIccCompiledCmm::Save(const CIccCmm *pCmm, CIccIO *pIO)
+{
+  if (!pCmm || !pIO)
+    return icCmmStatBad;
+
+  if (!pCmm->GetCollapseStats().bCollapsed || pCmm->GetNumXforms()!=1)
+    return icCmmStatBadLutType;
+
+  CIccXform *pXform = pCmm->GetFirstXform();
+  CIccProfile *pProfile = pXform->GetProfilePtr();
+  CIccTag *pTag = pProfile ? pProfile->FindTag(icSigAToB0Tag) : NULL;
+
+  if (!pTag || pTag->GetType()!=icSigLutAtoBType)
+    return icCmmStatBadLutType;
+
+  CIccTagLutAtoB *pLut = (CIccTagLutAtoB*)pTag;
+  CIccCLUT *pCLUT = pLut->GetCLUT();
+
+  if (!pCLUT || !pLut->GetCurvesA() || !pLut->GetCurvesB() || pLut->GetMatrix() || pLut->GetCurvesM() ||
+      pCLUT->GetInputDim()!=pLut->InputChannels() || pCLUT->GetOutputChannels()!=pLut->OutputChannels())
+    return icCmmStatBadLutType;
+
+  icCompiledXformHeader hdr;
+  int64_t nStart = pIO->Tell();
+
+  memset(&hdr, 0, sizeof(hdr));
+  hdr.magic = icCompiledXformMagic;
+  hdr.byteOrder = icCompiledXformByteOrder;
+  hdr.version = icCompiledXformVersion;
+  hdr.headerSize = sizeof(hdr);
+  strncpy(hdr.libVersion, ICCPROFLIBVER, sizeof(hdr.libVersion)-1);
+  hdr.floatSize = sizeof(icFloatNumber);
+  hdr.simdLevel = (icUInt32Number)icGetSimdLevel();
+  hdr.srcSpace = pProfile->m_Header.colorSpace;
+  hdr.dstSpace = pProfile->m_Header.pcs;
+  hdr.nInput = pLut->InputChannels();
+  hdr.nOutput = pLut->OutputChannels();
+  hdr.nInterp = pXform->GetInterp();
+  memcpy(hdr.gridPoints, pCLUT->GridPointArray(), hdr.nInput);
+
+  //The header is written again once the sections have been placed
+  if (nStart<0 || pIO->Write8(&hdr, sizeof(hdr))!=sizeof(hdr))
+    return icCmmStatBad;
+
+  hdr.inCurvesOffset = icCompiledPad(pIO, nStart);
+  if (!hdr.inCurvesOffset || !icCompiledWriteCurves(pIO, pLut->GetCurvesA(), hdr.nInput))
+    return icCmmStatBadLutType;
+  hdr.inCurvesSize = (icUInt32Number)(pIO->Tell() - nStart) - hdr.inCurvesOffset;
+
+  hdr.outCurvesOffset = icCompiledPad(pIO, nStart);
+  if (!hdr.outCurvesOffset || !icCompiledWriteCurves(pIO, pLut->GetCurvesB(), hdr.nOutput))
+    return icCmmStatBadLutType;
+  hdr.outCurvesSize = (icUInt32Number)(pIO->Tell() - nStart) - hdr.outCurvesOffset;
+
+  size_t nCLUTSize = (size_t)pCLUT->NumPoints() * hdr.nOutput * sizeof(icFloatNumber);
+
+  hdr.clutOffset = icCompiledPad(pIO, nStart);
+  if (!hdr.clutOffset || (icUInt64Number)hdr.clutOffset + nCLUTSize > 0xffffffff ||
+      pIO->Write8(pCLUT->GetData(0), nCLUTSize)!=nCLUTSize)
+    return icCmmStatBad;
+  hdr.clutSize = (icUInt32Number)nCLUTSize;
+  hdr.fileSize = hdr.clutOffset + hdr.clutSize;
+
+  if (pIO->Seek(nStart, icSeekSet)<0 || pIO->Write8(&hdr, sizeof(hdr))!=sizeof(hdr) ||
+      pIO->Seek(nStart + hdr.fileSize, icSeekSet)<0)
+    return icCmmStatBad;
+
+  return icCmmStatOk;
+}
+
+
+/**
+ ****************************************************************************
+ * Name: CIccCompiledCmm::Save
+ * 
+ * Purpose: Saves the device link of a CMM whose chain was collapsed by
+ *  Begin() to a compiled transform file
+ * 
+ * Args:
+ *  pCmm - CMM to save
+ *  szFilename - name of file to create
+ *****************************************************************************
+ */
+icStatusCMM CIccCompiledCmm::Save(const CIccCmm *pCmm, const icChar *szFilename)
+{
+  CIccFileIO FileIO;
+
+  if (!FileIO.Open(szFilename, "w+b"))
+    return icCmmStatCantOpenProfile;
+
+  icStatusCMM rv = Save(pCmm, &FileIO);
+
+  FileIO.Close();
+  if (rv!=icCmmStatOk)
+    remove(szFilename);
+
+  return rv;
+}
+
+
+/**
+ ****************************************************************************
+ * Name: CIccCompiledCmm::ValidateHeader
+ * 
+ * Purpose: Checks that a compiled transform in memory was saved in a
+ *  layout that this library uses and that its sections are consistent
+ * 
+ * Args:
+ *  pMem - start of the compiled transform
+ *  nSize - number of bytes at pMem
+ * 
+ * Return: 
+ *  icCmmStatOk if it can be loaded, icCmmStatCompiledMismatch if it was
+ *  saved by an incompatible library or machine, or icCmmStatInvalidProfile
+ *  if it is not a valid compiled transform
+ *****************************************************************************
+ */
+icStatusCMM CIccCompiledCmm::ValidateHeader(const icUInt8Number *pMem, icUInt32Number nSize)
+{
+  icCompiledXformHeader hdr;
+  icUInt32Number i, nPoints;
+
+  if (!pMem || nSize < sizeof(hdr.magic) + sizeof(hdr.byteOrder))
+    return icCmmStatInvalidProfile;
+
+  memcpy(&hdr, pMem, sizeof(hdr.magic) + sizeof(hdr.byteOrder));
+  if (hdr.magic!=icCompiledXformMagic) {
+    icUInt32Number nSwapped = (hdr.magic>>24) | ((hdr.magic>>8)&0xff00) | ((hdr.magic<<8)&0xff0000) | (hdr.magic<<24);
+    return nSwapped==icCompiledXformMagic ? icCmmStatCompiledMismatch : icCmmStatInvalidProfile;
+  }
+  if (hdr.byteOrder!=icCompiledXformByteOrder || nSize < 3*sizeof(icUInt32Number))
+    return icCmmStatCompiledMismatch;
+
+  memcpy(&hdr.version, pMem + 2*sizeof(icUInt32Number), sizeof(hdr.version));
+  if (hdr.version!=icCompiledXformVersion)
+    return icCmmStatCompiledMismatch;
+
+  if (nSize < sizeof(hdr))
+    return icCmmStatInvalidProfile;
+  memcpy(&hdr, pMem, sizeof(hdr));
+
+  if (hdr.headerSize!=sizeof(hdr) || hdr.floatSize!=sizeof(icFloatNumber) ||
+      strncmp(hdr.libVersion, ICCPROFLIBVER, sizeof(hdr.libVersion)))
+    return icCmmStatCompiledMismatch;
+
+  if (hdr.nInput<1 || hdr.nInput>15 || hdr.nOutput<1 || hdr.nOutput>15 ||
+      (hdr.nInterp!=icInterpLinear && hdr.nInterp!=icInterpTetrahedral) ||
+      hdr.fileSize>nSize)
+    return icCmmStatInvalidProfile;
+
+  for (nPoints=1, i=0; i<hdr.nInput; i++) {
+    if (hdr.gridPoints[i]<2 || nPoints > icCollapseMaxGridNodes / hdr.gridPoints[i])
+      return icCmmStatInvalidProfile;
+    nPoints *= hdr.gridPoints[i];
+  }
+
+  if (hdr.inCurvesOffset < sizeof(hdr) || hdr.inCurvesOffset > hdr.fileSize ||
+      hdr.inCurvesSize > hdr.fileSize - hdr.inCurvesOffset ||
+      hdr.outCurvesOffset < sizeof(hdr) || hdr.outCurvesOffset > hdr.fileSize ||
+      hdr.outCurvesSize > hdr.fileSize - hdr.outCurvesOffset ||
+      hdr.clutOffset < sizeof(hdr) || hdr.clutOffset > hdr.fileSize ||
+      hdr.clutSize != hdr.fileSize - hdr.clutOffset ||
+      hdr.clutSize != (icUInt64Number)nPoints * hdr.nOutput * sizeof(icFloatNumber) ||
+      ((size_t)(pMem + hdr.clutOffset)) % sizeof(icFloatNumber))
+    return icCmmStatInvalidProfile;
+
+  return icCmmStatOk;
+}
+
+
+/**
+ ****************************************************************************
+ * Name: CIccCompiledCmm::Load
+ * 
+ * Purpose: Builds the CMM from a compiled transform in memory.  The grid
+ *  is used in place, so the memory must stay valid and unchanged until
+ *  the CMM is deleted.  Begin() must be called before the CMM is applied.
+ * 
+ * Args:
+ *  pMem - start of the compiled transform
+ *  nSize - number of bytes at pMem
+ * 
+ * Return: 
+ *  icCmmStatOk if loaded, or the status of ValidateHeader()
+ *****************************************************************************
+ */
+icStatusCMM CIccCompiledCmm::Load(const icUInt8Number *pMem, icUInt32Number nSize)
+{
+  if (GetNumXforms())
+    return icCmmStatBadXform;
+
+  icStatusCMM rv = ValidateHeader(pMem, nSize);
+  if (rv!=icCmmStatOk)
+    return rv;
+
+  icCompiledXformHeader hdr;
+  memcpy(&hdr, pMem, sizeof(hdr));
+
+  //Same link as the one built by CIccCmm::CollapseXforms()
+  CIccProfile *pProfile = new CIccProfile;
+  pProfile->InitHeader();
+  pProfile->m_Header.colorSpace = (icColorSpaceSignature)hdr.srcSpace;
+  pProfile->m_Header.pcs = (icColorSpaceSignature)hdr.dstSpace;
+  pProfile->m_Header.deviceClass = icSigLinkClass;
+  pProfile->m_Header.version = icVersionNumberV4_3;
+
+  CIccTagLutAtoB *pTagLut = new CIccTagLutAtoB();
+  pTagLut->Init((icUInt8Number)hdr.nInput, (icUInt8Number)hdr.nOutput);
+  pProfile->AttachTag(icSigAToB0Tag, pTagLut);
+
+  //The grid is used in place and is only read
+  CIccCLUT *pCLUT = new CIccCLUT((icUInt8Number)hdr.nInput, (icUInt16Number)hdr.nOutput);
+  if (!pCLUT->AttachData(hdr.gridPoints, (icFloatNumber*)(pMem + hdr.clutOffset))) {
+    delete pCLUT;
+    pCLUT = NULL;
+  }
+
+  if (!pCLUT || !pTagLut->SetCLUT(pCLUT) ||
+      !icCompiledReadCurves(pTagLut->NewCurvesA(), hdr.nInput, pMem + hdr.inCurvesOffset, hdr.inCurvesSize) ||
+      !icCompiledReadCurves(pTagLut->NewCurvesB(), hdr.nOutput, pMem + hdr.outCurvesOffset, hdr.outCurvesSize)) {
+    delete pProfile;
+    return icCmmStatInvalidProfile;
+  }
+
+  CIccXform *pLink = CIccXform::Create(pProfile, true, icPerceptual, (icXformInterp)hdr.nInterp,
+                                       NULL, icXformLutColor, false);
+
+  //The link owns the profile once created
+  if (!pLink) {
+    delete pProfile;
+    return icCmmStatBadXform;
+  }
+
+  m_nSrcSpace = (icColorSpaceSignature)hdr.srcSpace;
+  m_nDestSpace = (icColorSpaceSignature)hdr.dstSpace;
+
+  return AddXform(pLink);
+}
+
+
+/**
+ ****************************************************************************
+ * Name: CIccCompiledCmm::Load
+ * 
+ * Purpose: Builds the CMM from a compiled transform file that is memory
+ *  mapped (or read into memory where mapping is not available) until the
+ *  CMM is deleted.  Begin() must be called before the CMM is applied.
+ * 
+ * Args:
+ *  szFilename - name of compiled transform file
+ * 
+ * Return: 
+ *  icCmmStatOk if loaded, icCmmStatCantOpenProfile if the file cannot be
+ *  opened, or the status of ValidateHeader()
+ *****************************************************************************
+ */
+icStatusCMM CIccCompiledCmm::Load(const icChar *szFilename)
+{
+  if (GetNumXforms() || m_pMappedIO)
+    return icCmmStatBadXform;
+
+  CIccMappedIO *pIO = new CIccMappedIO;
+
+  if (!pIO->Open(szFilename) || pIO->GetLength() > 0xffffffff) {
+    delete pIO;
+    return icCmmStatCantOpenProfile;
+  }
+
+  icStatusCMM rv = Load(pIO->GetData(), (icUInt32Number)pIO->GetLength());
+
+  if (rv!=icCmmStatOk) {
+    delete pIO;
+    return rv;
+  }
+
+  m_pMappedIO = pIO;
+
+  return icCmmStatOk;
+}
+
+#if defined(USEICCDEVNAMESPACE)
+}; //namespace iccDEV
+#endif
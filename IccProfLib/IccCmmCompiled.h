@@ -0,0 +1,185 @@
+/** @file
+    File:       IccCmmCompiled.h
+
+    Contains:   Header for saving and loading compiled transforms
+
+    Version:    V1
+
+    Copyright:  (c) see Software License
+*/
+
+
+/*
+ * Copyright (c) International Color Consortium.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer. 
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. In the absence of prior written permission, the names "ICC" and "The
+ *    International Color Consortium" must not be used to imply that the
+ *    ICC organization endorses or promotes products derived from this
+ *    software.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE INTERNATIONAL COLOR CONSORTIUM OR
+ * ITS CONTRIBUTING MEMBERS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by many
+ * individuals on behalf of the The International Color Consortium. 
+ *
+ *
+ * Membership in the ICC is encouraged when this software is used for
+ * commercial purposes. 
+ *
+ *  
+ * For more information on The International Color Consortium, please
+ * see <http://www.color.org/>.
+ *  
+ * 
+ */
+
+//////////////////////////////////////////////////////////////////////
+// HISTORY:
+//
+// -Initial implementation of compiled transforms 10-18-2026
+//
+//////////////////////////////////////////////////////////////////////
+
+#if !defined(_ICCCMMCOMPILED_H)
+#define _ICCCMMCOMPILED_H
+
+#include "IccCmm.h"
+
+#if defined(USEICCDEVNAMESPACE)
+namespace iccDEV {
+#endif
+
+/// Signature at the start of a compiled transform ('iccX')
+#define icCompiledXformMagic      0x69636358
+/// Written in the byte order of the machine that saved the compiled transform
+#define icCompiledXformByteOrder  0x01020304
+/// Version of the compiled transform layout
+#define icCompiledXformVersion    1
+/// Alignment of the sections of a compiled transform (a cache line)
+#define icCompiledXformAlign      64
+
+/**
+**************************************************************************
+* Type: Structure
+*
+* Purpose: Header at the start of a compiled transform.  All values are
+*  in the byte order of the machine that saved the transform and the
+*  sections are given as offsets from the start of the header.
+*
+*  The curve sections hold an icCompiledCurveEntry for each channel
+*  followed by the icFloatNumber entries of a curveType curve or the
+*  parameters of a parametricCurveType curve.  The CLUT section holds the
+*  grid as an array of icFloatNumber values in CIccCLUT order that is used
+*  in place.
+**************************************************************************
+*/
+typedef struct {
+  icUInt32Number magic;           //icCompiledXformMagic
+  icUInt32Number byteOrder;       //icCompiledXformByteOrder
+  icUInt32Number version;         //icCompiledXformVersion
+  icUInt32Number headerSize;      //sizeof(icCompiledXformHeader)
+  icChar libVersion[16];          //ICCPROFLIBVER of the library that saved the transform
+  icUInt32Number floatSize;       //sizeof(icFloatNumber)
+  icUInt32Number simdLevel;       //icSimdLevel of the machine that saved the transform
+  icUInt32Number srcSpace;        //icColorSpaceSignature
+  icUInt32Number dstSpace;        //icColorSpaceSignature
+  icUInt32Number nInput;          //Number of input channels
+  icUInt32Number nOutput;         //Number of output channels
+  icUInt32Number nInterp;         //icXformInterp
+  icUInt8Number gridPoints[16];   //Grid points of each input channel
+  icUInt32Number inCurvesOffset;
+  icUInt32Number inCurvesSize;
+  icUInt32Number outCurvesOffset;
+  icUInt32Number outCurvesSize;
+  icUInt32Number clutOffset;
+  icUInt32Number clutSize;
+  icUInt32Number fileSize;
+  icUInt32Number reserved[5];
+} icCompiledXformHeader;
+
+/**
+**************************************************************************
+* Type: Structure
+*
+* Purpose: Describes one curve in a curve section of a compiled transform
+**************************************************************************
+*/
+typedef struct {
+  icUInt32Number type;            //icSigCurveType or icSigParametricCurveType
+  icUInt32Number functionType;    //Function type of a parametric curve
+  icUInt32Number nValues;         //Number of entries or parameters that follow
+} icCompiledCurveEntry;
+
+/**
+**************************************************************************
+* Type: Class
+*
+* Purpose: A CMM that is loaded from a compiled transform.
+*
+*  Save() writes the device link of a CMM whose chain was collapsed by
+*  Begin() (see CIccCmm::SetCollapseLink()) together with its shaper
+*  curves.  Load() rebuilds the link around the saved grid without
+*  copying it, so that a memory mapped compiled transform can be applied
+*  right after Begin() is called.  Calculator, MPE and PCS processing of
+*  the original chain is part of the sampled grid.
+*
+*  Load() returns icCmmStatCompiledMismatch when the transform was saved
+*  by a different layout version, library version, byte order or size of
+*  icFloatNumber.  The caller should then build the CMM from its profiles
+*  again (and may save a new compiled transform).  The SIMD level of the
+*  saving machine is recorded for information only since the grid is
+*  used by every interpolation kernel as is.
+**************************************************************************
+*/
+class ICCPROFLIB_API CIccCompiledCmm : public CIccCmm
+{
+public:
+  CIccCompiledCmm();
+  virtual ~CIccCompiledCmm();
+
+  ///Saves a CMM that has been collapsed to a single device link by Begin()
+  static icStatusCMM Save(const CIccCmm *pCmm, CIccIO *pIO);
+  static icStatusCMM Save(const CIccCmm *pCmm, const icChar *szFilename);
+
+  ///Maps (or reads) a compiled transform file that is kept open until the CMM is deleted
+  icStatusCMM Load(const icChar *szFilename);
+  ///Uses a compiled transform in memory that must stay valid until the CMM is deleted
+  icStatusCMM Load(const icUInt8Number *pMem, icUInt32Number nSize);
+
+  ///Checks that a compiled transform in memory can be loaded by this library
+  static icStatusCMM ValidateHeader(const icUInt8Number *pMem, icUInt32Number nSize);
+
+protected:
+  CIccMappedIO *m_pMappedIO;
+};
+
+#if defined(USEICCDEVNAMESPACE)
+}; //namespace iccDEV
+#endif
+
+#endif //_ICCCMMCOMPILED_H
@@ -0,0 +1,591 @@
+/** @file
+    File:       IccCmmParallel.cpp
+
+    Contains:   Implementation of the CIccParallelApply class.
+
+    Version:    V1
+
+    Copyright:  (c) see Software License
+*/
+
+/*
+ * Copyright (c) International Color Consortium.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer. 
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. In the absence of prior written permission, the names "ICC" and "The
+ *    International Color Consortium" must not be used to imply that the
+ *    ICC organization endorses or promotes products derived from this
+ *    software.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE INTERNATIONAL COLOR CONSORTIUM OR
+ * ITS CONTRIBUTING MEMBERS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by many
+ * individuals on behalf of the The International Color Consortium. 
+ *
+ *
+ * Membership in the ICC is encouraged when this software is used for
+ * commercial purposes. 
+ *
+ *  
+ * For more information on The International Color Consortium, please
+ * see <http://www.color.org/>.
+ *  
+ * 
+ */
+
+//////////////////////////////////////////////////////////////////////
+// HISTORY:
+//
+// -Initial implementation of multi-threaded apply 10-17-2026
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "IccCmmParallel.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+
+#if defined(USEICCDEVNAMESPACE)
+namespace iccDEV {
+#endif
+
+/**
+**************************************************************************
+* Type: Class
+*
+* Purpose: Interface used by CIccParallelApply::Run() to apply a single tile
+**************************************************************************
+*/
+class CIccParallelWorker
+{
+public:
+  virtual ~CIccParallelWorker() {}
+
+  virtual icStatusCMM ApplyTile(CIccApplyCmm *pApply, icUInt32Number nTile) = 0;
+};
+
+/**
+**************************************************************************
+* Type: Class
+*
+* Purpose: Range of tiles [m_nNext, m_nEnd) waiting to be applied by a worker
+**************************************************************************
+*/
+class CIccTileRange
+{
+public:
+  CIccTileRange() : m_nNext(0), m_nEnd(0) {}
+
+  std::mutex m_lock;
+  icUInt32Number m_nNext;
+  icUInt32Number m_nEnd;
+};
+
+/**
+**************************************************************************
+* Name: icNextTile
+*
+* Purpose:
+*  Gets the next tile for worker nWorker.  When the worker's own range is
+*  exhausted half of the remaining tiles of another worker are stolen.
+*
+* Return:
+*  true if a tile was found, false if there are no tiles left.
+**************************************************************************
+*/
+static bool icNextTile(CIccTileRange *pRanges, icUInt32Number nWorkers, icUInt32Number nWorker, icUInt32Number &nTile)
+{
+  CIccTileRange &own = pRanges[nWorker];
+
+  {
+    std::lock_guard<std::mutex> guard(own.m_lock);
+    if (own.m_nNext < own.m_nEnd) {
+      nTile = own.m_nNext++;
+      return true;
+    }
+  }
+
+  for (icUInt32Number i=1; i<nWorkers; i++) {
+    CIccTileRange &victim = pRanges[(nWorker + i) % nWorkers];
+    icUInt32Number nStart, nEnd;
+
+    {
+      std::lock_guard<std::mutex> guard(victim.m_lock);
+      icUInt32Number nLeft = victim.m_nEnd - victim.m_nNext;
+      if (!nLeft)
+        continue;
+
+      nEnd = victim.m_nEnd;
+      nStart = nEnd - (nLeft + 1) / 2;
+      victim.m_nEnd = nStart;
+    }
+
+    std::lock_guard<std::mutex> guard(own.m_lock);
+    own.m_nNext = nStart + 1;
+    own.m_nEnd = nEnd;
+    nTile = nStart;
+    return true;
+  }
+
+  return false;
+}
+
+
+/**
+**************************************************************************
+* Type: Class
+*
+* Purpose: Applies the tiles of a single CIccParallelApply::Run() call.
+*  Work() is called once for each worker taking part in the run.
+**************************************************************************
+*/
+class CIccParallelJob
+{
+public:
+  CIccParallelJob(CIccParallelWorker &work, CIccApplyCmm **pApplies, icUInt32Number nTiles, icUInt32Number nWorkers)
+    : m_work(work), m_pApplies(pApplies), m_nTiles(nTiles), m_nWorkers(nWorkers),
+      m_ranges(new CIccTileRange[nWorkers]), m_bAbort(false), m_nErrTile(nTiles), m_errStat(icCmmStatOk)
+  {
+    for (icUInt32Number w=0; w<nWorkers; w++) {
+      m_ranges[w].m_nNext = (icUInt32Number)((icUInt64Number)nTiles * w / nWorkers);
+      m_ranges[w].m_nEnd = (icUInt32Number)((icUInt64Number)nTiles * (w+1) / nWorkers);
+    }
+  }
+
+  void Work(icUInt32Number w)
+  {
+    icUInt32Number t;
+
+    while (!m_bAbort && icNextTile(m_ranges.get(), m_nWorkers, w, t)) {
+      icStatusCMM stat = m_work.ApplyTile(m_pApplies[w], t);
+
+      if (stat != icCmmStatOk) {
+        std::lock_guard<std::mutex> guard(m_errLock);
+        if (t < m_nErrTile) {
+          m_nErrTile = t;
+          m_errStat = stat;
+        }
+        m_bAbort = true;
+      }
+    }
+  }
+
+  icUInt32Number GetNumWorkers() const { return m_nWorkers; }
+  icStatusCMM GetStatus() const { return m_errStat; }
+
+protected:
+  CIccParallelWorker &m_work;
+  CIccApplyCmm **m_pApplies;
+  icUInt32Number m_nTiles;
+  icUInt32Number m_nWorkers;
+
+  std::unique_ptr<CIccTileRange[]> m_ranges;
+  std::atomic<bool> m_bAbort;
+  std::mutex m_errLock;
+  icUInt32Number m_nErrTile;
+  icStatusCMM m_errStat;
+};
+
+/**
+**************************************************************************
+* Type: Class
+*
+* Purpose: Persistent worker threads used by CIccParallelApply.  The thread
+*  calling Run() acts as worker zero, so a pool of N workers has N-1
+*  threads.  Threads sleep between runs and are joined by the destructor.
+**************************************************************************
+*/
+class CIccParallelPool
+{
+public:
+  CIccParallelPool() : m_pJob(NULL), m_nGeneration(0), m_nActive(0), m_bStop(false) {}
+
+  ~CIccParallelPool()
+  {
+    {
+      std::lock_guard<std::mutex> guard(m_lock);
+      m_bStop = true;
+    }
+    m_wake.notify_all();
+
+    for (size_t i=0; i<m_threads.size(); i++)
+      m_threads[i].join();
+  }
+
+  ///Starts threads for workers 1 to nWorkers-1 and returns the number of workers available
+  icUInt32Number Start(icUInt32Number nWorkers)
+  {
+    for (icUInt32Number w=(icUInt32Number)m_threads.size()+1; w<nWorkers; w++) {
+      try {
+        m_threads.push_back(std::thread(&CIccParallelPool::Loop, this, w));
+      }
+      catch (...) {
+        //Runs use the workers that could be started
+        break;
+      }
+    }
+
+    return (icUInt32Number)m_threads.size() + 1;
+  }
+
+  ///Runs the job on its workers and waits for all of them to finish
+  void Run(CIccParallelJob &job)
+  {
+    {
+      std::lock_guard<std::mutex> guard(m_lock);
+      m_pJob = &job;
+      m_nActive = job.GetNumWorkers() - 1;
+      m_nGeneration++;
+    }
+    m_wake.notify_all();
+
+    job.Work(0);
+
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_done.wait(lock, [this]{ return m_nActive==0; });
+    m_pJob = NULL;
+  }
+
+protected:
+  void Loop(icUInt32Number w)
+  {
+    icUInt64Number nSeen = 0;
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    for (;;) {
+      m_wake.wait(lock, [&]{ return m_bStop || m_nGeneration!=nSeen; });
+      if (m_bStop)
+        break;
+      nSeen = m_nGeneration;
+
+      CIccParallelJob *pJob = m_pJob;
+      if (!pJob || w >= pJob->GetNumWorkers())
+        continue;
+
+      lock.unlock();
+      pJob->Work(w);
+      lock.lock();
+
+      if (!--m_nActive)
+        m_done.notify_all();
+    }
+  }
+
+  std::vector<std::thread> m_threads;
+
+  std::mutex m_lock;
+  std::condition_variable m_wake;
+  std::condition_variable m_done;
+
+  CIccParallelJob *m_pJob;
+  icUInt64Number m_nGeneration;
+  icUInt32Number m_nActive;
+  bool m_bStop;
+};
+
+
+/**
+**************************************************************************
+* Name: CIccParallelApply::CIccParallelApply
+*
+* Purpose:
+*  Constructor
+*
+* Args:
+*  pCmm = CMM to apply (Begin() must be called before Init()),
+*  nThreads = number of worker threads (0 = number of hardware threads).
+**************************************************************************
+*/
+CIccParallelApply::CIccParallelApply(CIccCmm *pCmm, icUInt32Number nThreads)
+{
+  m_pCmm = pCmm;
+
+  if (!nThreads)
+    nThreads = std::thread::hardware_concurrency();
+  m_nThreads = nThreads ? nThreads : 1;
+
+  m_nTileBytes = icParallelTileBytes;
+  m_pPool = NULL;
+}
+
+/**
+**************************************************************************
+* Name: CIccParallelApply::~CIccParallelApply
+*
+* Purpose:
+*  Destructor
+**************************************************************************
+*/
+CIccParallelApply::~CIccParallelApply()
+{
+  delete m_pPool;
+
+  for (size_t i=0; i<m_Applies.size(); i++)
+    delete m_Applies[i];
+}
+
+/**
+**************************************************************************
+* Name: CIccParallelApply::Init
+*
+* Purpose:
+*  Allocates one CIccApplyCmm object per worker and starts the worker
+*  threads.  If fewer threads can be started, fewer workers are used.
+**************************************************************************
+*/
+icStatusCMM CIccParallelApply::Init()
+{
+  if (!m_pCmm || !m_pCmm->Valid())
+    return icCmmStatBadXform;
+
+  icStatusCMM stat = icCmmStatOk;
+
+  while (m_Applies.size() < m_nThreads) {
+    CIccApplyCmm *pApply = m_pCmm->GetNewApplyCmm(stat);
+
+    if (!pApply)
+      return stat!=icCmmStatOk ? stat : icCmmStatAllocErr;
+
+    m_Applies.push_back(pApply);
+  }
+
+  if (m_nThreads>1) {
+    if (!m_pPool)
+      m_pPool = new CIccParallelPool();
+
+    icUInt32Number nWorkers = m_pPool->Start(m_nThreads);
+    while (m_Applies.size() > nWorkers) {
+      delete m_Applies.back();
+      m_Applies.pop_back();
+    }
+  }
+
+  return icCmmStatOk;
+}
+
+/**
+**************************************************************************
+* Name: CIccParallelApply::Run
+*
+* Purpose:
+*  Applies nTiles tiles using the worker pool.  Tile ranges are divided
+*  evenly between workers with idle workers stealing from busy ones.  The
+*  calling thread is worker zero.
+*
+* Return:
+*  icCmmStatOk, or the status of the lowest numbered tile that failed.
+**************************************************************************
+*/
+icStatusCMM CIccParallelApply::Run(icUInt32Number nTiles, CIccParallelWorker &work)
+{
+  if (m_Applies.empty())
+    return icCmmStatIncorrectApply;
+
+  icUInt32Number nWorkers = (icUInt32Number)m_Applies.size();
+  if (nWorkers > nTiles)
+    nWorkers = nTiles;
+
+  if (nWorkers<=1 || !m_pPool) {
+    for (icUInt32Number t=0; t<nTiles; t++) {
+      icStatusCMM stat = work.ApplyTile(m_Applies[0], t);
+      if (stat != icCmmStatOk)
+        return stat;
+    }
+    return icCmmStatOk;
+  }
+
+  CIccParallelJob job(work, &m_Applies[0], nTiles, nWorkers);
+
+  m_pPool->Run(job);
+
+  return job.GetStatus();
+}
+
+/**
+**************************************************************************
+* Type: Class
+*
+* Purpose: Applies tiles of a pixel array
+**************************************************************************
+*/
+class CIccParallelPixelWorker : public CIccParallelWorker
+{
+public:
+  virtual icStatusCMM ApplyTile(CIccApplyCmm *pApply, icUInt32Number nTile)
+  {
+    icUInt32Number nStart = nTile * m_nTilePixels;
+    icUInt32Number nPixels = m_nPixels - nStart < m_nTilePixels ? m_nPixels - nStart : m_nTilePixels;
+
+    return pApply->Apply(m_pDst + (size_t)nStart*m_nDstSamples, m_pSrc + (size_t)nStart*m_nSrcSamples, nPixels);
+  }
+
+  icFloatNumber *m_pDst;
+  const icFloatNumber *m_pSrc;
+  icUInt32Number m_nPixels;
+  icUInt32Number m_nTilePixels;
+  icUInt32Number m_nDstSamples;
+  icUInt32Number m_nSrcSamples;
+};
+
+/**
+**************************************************************************
+* Name: CIccParallelApply::Apply
+*
+* Purpose:
+*  Applies the CMM to an array of pixels in internal encoding.  Source and
+*  destination arrays must not overlap.
+**************************************************************************
+*/
+icStatusCMM CIccParallelApply::Apply(icFloatNumber *DstPixels, const icFloatNumber *SrcPixels, icUInt32Number nPixels)
+{
+  CIccParallelPixelWorker work;
+
+  work.m_pDst = DstPixels;
+  work.m_pSrc = SrcPixels;
+  work.m_nPixels = nPixels;
+  work.m_nDstSamples = m_pCmm->GetDestSamples();
+  work.m_nSrcSamples = m_pCmm->GetSourceSamples();
+
+  icUInt32Number nPixelBytes = (work.m_nDstSamples + work.m_nSrcSamples) * sizeof(icFloatNumber);
+  work.m_nTilePixels = nPixelBytes ? m_nTileBytes / nPixelBytes : 0;
+
+  //Keep tiles a multiple of the block size used by CIccApplyCmm::Apply()
+  if (work.m_nTilePixels > icCmmBlockPixels)
+    work.m_nTilePixels -= work.m_nTilePixels % icCmmBlockPixels;
+  else
+    work.m_nTilePixels = icCmmBlockPixels;
+
+  if (!nPixels)
+    return icCmmStatOk;
+
+  return Run((nPixels - 1) / work.m_nTilePixels + 1, work);
+}
+
+/**
+**************************************************************************
+* Type: Class
+*
+* Purpose: Applies rectangular tiles of an image buffer
+**************************************************************************
+*/
+class CIccParallelBufferWorker : public CIccParallelWorker
+{
+public:
+  virtual icStatusCMM ApplyTile(CIccApplyCmm *pApply, icUInt32Number nTile)
+  {
+    icUInt32Number y = (nTile / m_nTilesAcross) * m_nTileRows;
+    icUInt32Number x = (nTile % m_nTilesAcross) * m_nTileCols;
+    icUInt32Number nRows = m_nHeight - y < m_nTileRows ? m_nHeight - y : m_nTileRows;
+    icUInt32Number nCols = m_nWidth - x < m_nTileCols ? m_nWidth - x : m_nTileCols;
+
+    const icUInt8Number *pSrc = m_pSrc + (size_t)y*m_nSrcRowBytes + (size_t)x*m_nSrcPixelBytes;
+    icUInt8Number *pDst = m_pDst + (size_t)y*m_nDstRowBytes + (size_t)x*m_nDstPixelBytes;
+
+    return pApply->ApplyBuffer(pDst, m_dstFormat, pSrc, m_srcFormat, nCols, nRows, m_nDstRowBytes, m_nSrcRowBytes);
+  }
+
+  icUInt8Number *m_pDst;
+  const icUInt8Number *m_pSrc;
+  icBufferFormat m_dstFormat;
+  icBufferFormat m_srcFormat;
+  icUInt32Number m_nWidth;
+  icUInt32Number m_nHeight;
+  icUInt32Number m_nDstRowBytes;
+  icUInt32Number m_nSrcRowBytes;
+  icUInt32Number m_nDstPixelBytes;
+  icUInt32Number m_nSrcPixelBytes;
+  icUInt32Number m_nTileCols;
+  icUInt32Number m_nTileRows;
+  icUInt32Number m_nTilesAcross;
+};
+
+/**
+**************************************************************************
+* Name: CIccParallelApply::ApplyBuffer
+*
+* Purpose:
+*  Applies the CMM to an image buffer (see CIccApplyCmm::ApplyBuffer()).
+*  The image is split into tiles of whole rows when rows fit within the
+*  tile size, otherwise rows are split into column spans.  Source and
+*  destination buffers must not overlap.
+**************************************************************************
+*/
+icStatusCMM CIccParallelApply::ApplyBuffer(void *pDst, const icBufferFormat &dstFormat, const void *pSrc, const icBufferFormat &srcFormat,
+                                           icUInt32Number nWidth, icUInt32Number nHeight,
+                                           icUInt32Number nDstRowBytes, icUInt32Number nSrcRowBytes)
+{
+  icUInt32Number nSrcSize = icGetBufferSampleSize(srcFormat.nType);
+  icUInt32Number nDstSize = icGetBufferSampleSize(dstFormat.nType);
+  icUInt32Number nSrcTotal = m_pCmm->GetSourceSamples() + srcFormat.nExtraSamples;
+  icUInt32Number nDstTotal = m_pCmm->GetDestSamples() + dstFormat.nExtraSamples;
+
+  if (!nSrcSize || !nDstSize)
+    return icCmmStatBadColorEncoding;
+
+  if (!nWidth || !nHeight)
+    return icCmmStatOk;
+
+  CIccParallelBufferWorker work;
+
+  work.m_pDst = (icUInt8Number*)pDst;
+  work.m_pSrc = (const icUInt8Number*)pSrc;
+  work.m_dstFormat = dstFormat;
+  work.m_srcFormat = srcFormat;
+  work.m_nWidth = nWidth;
+  work.m_nHeight = nHeight;
+  work.m_nSrcPixelBytes = nSrcSize * (srcFormat.bPlanar ? 1 : nSrcTotal);
+  work.m_nDstPixelBytes = nDstSize * (dstFormat.bPlanar ? 1 : nDstTotal);
+  work.m_nSrcRowBytes = nSrcRowBytes ? nSrcRowBytes : nWidth * work.m_nSrcPixelBytes;
+  work.m_nDstRowBytes = nDstRowBytes ? nDstRowBytes : nWidth * work.m_nDstPixelBytes;
+
+  //Tiles must use the plane offsets of the whole image
+  if (srcFormat.bPlanar && !srcFormat.nPlaneBytes)
+    work.m_srcFormat.nPlaneBytes = (size_t)work.m_nSrcRowBytes * nHeight;
+  if (dstFormat.bPlanar && !dstFormat.nPlaneBytes)
+    work.m_dstFormat.nPlaneBytes = (size_t)work.m_nDstRowBytes * nHeight;
+
+  icUInt32Number nPixelBytes = nSrcSize*nSrcTotal + nDstSize*nDstTotal;
+  icUInt32Number nTilePixels = m_nTileBytes / nPixelBytes;
+  if (nTilePixels < icCmmBlockPixels)
+    nTilePixels = icCmmBlockPixels;
+
+  work.m_nTileCols = nWidth < nTilePixels ? nWidth : nTilePixels;
+  work.m_nTileRows = nTilePixels / work.m_nTileCols;
+  if (work.m_nTileRows > nHeight)
+    work.m_nTileRows = nHeight;
+  work.m_nTilesAcross = (nWidth - 1) / work.m_nTileCols + 1;
+
+  icUInt32Number nTilesDown = (nHeight - 1) / work.m_nTileRows + 1;
+
+  return Run(work.m_nTilesAcross * nTilesDown, work);
+}
+
+#if defined(USEICCDEVNAMESPACE)
+}; //namespace iccDEV
+#endif
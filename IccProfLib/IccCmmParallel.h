@@ -0,0 +1,137 @@
+/** @file
+    File:       IccCmmParallel.h
+
+    Contains:   Header file for implementation of the CIccParallelApply class.
+
+    Version:    V1
+
+    Copyright:  (c) see Software License
+*/
+
+/*
+ * Copyright (c) International Color Consortium.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer. 
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. In the absence of prior written permission, the names "ICC" and "The
+ *    International Color Consortium" must not be used to imply that the
+ *    ICC organization endorses or promotes products derived from this
+ *    software.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE INTERNATIONAL COLOR CONSORTIUM OR
+ * ITS CONTRIBUTING MEMBERS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by many
+ * individuals on behalf of the The International Color Consortium. 
+ *
+ *
+ * Membership in the ICC is encouraged when this software is used for
+ * commercial purposes. 
+ *
+ *  
+ * For more information on The International Color Consortium, please
+ * see <http://www.color.org/>.
+ *  
+ * 
+ */
+
+//////////////////////////////////////////////////////////////////////
+// HISTORY:
+//
+// -Initial implementation of multi-threaded apply 10-17-2026
+//
+//////////////////////////////////////////////////////////////////////
+
+#if !defined(_ICCCMMPARALLEL_H)
+#define _ICCCMMPARALLEL_H
+
+#include "IccCmm.h"
+#include <vector>
+
+#if defined(USEICCDEVNAMESPACE)
+namespace iccDEV {
+#endif
+
+/// Default number of bytes of source and destination data processed by a single tile
+#define icParallelTileBytes (256*1024)
+
+class CIccParallelWorker;
+class CIccParallelPool;
+
+/**
+**************************************************************************
+* Type: Class
+*
+* Purpose: Applies a CIccCmm to large pixel or image buffers using multiple
+*  threads.  Init() allocates one CIccApplyCmm object per worker from the
+*  CMM and starts the worker threads, which wait for work until the object
+*  is destroyed.  Each call splits the buffer into cache sized
+*  tiles that are initially divided evenly between the workers.  Workers
+*  that run out of tiles steal half of the remaining tiles of another
+*  worker.  Tiles are applied independently so results do not depend on
+*  the number of threads or on scheduling.
+*
+*  Begin() must have been called on the CMM before Init(), and the CMM
+*  must stay valid for the life of the CIccParallelApply object.  Apply()
+*  and ApplyBuffer() must not be called concurrently on the same object.
+**************************************************************************
+*/
+class ICCPROFLIB_API CIccParallelApply
+{
+public:
+  ///nThreads of zero uses the number of hardware threads
+  CIccParallelApply(CIccCmm *pCmm, icUInt32Number nThreads=0);
+  virtual ~CIccParallelApply();
+
+  virtual icStatusCMM Init();
+
+  icUInt32Number GetNumThreads() const { return m_nThreads; }
+
+  ///Sets the approximate number of bytes of source and destination data per tile
+  void SetTileBytes(icUInt32Number nTileBytes) { m_nTileBytes = nTileBytes ? nTileBytes : icParallelTileBytes; }
+  icUInt32Number GetTileBytes() const { return m_nTileBytes; }
+
+  virtual icStatusCMM Apply(icFloatNumber *DstPixels, const icFloatNumber *SrcPixels, icUInt32Number nPixels);
+
+  virtual icStatusCMM ApplyBuffer(void *pDst, const icBufferFormat &dstFormat, const void *pSrc, const icBufferFormat &srcFormat,
+                                  icUInt32Number nWidth, icUInt32Number nHeight=1,
+                                  icUInt32Number nDstRowBytes=0, icUInt32Number nSrcRowBytes=0);
+
+protected:
+  icStatusCMM Run(icUInt32Number nTiles, CIccParallelWorker &work);
+
+  CIccCmm *m_pCmm;
+  icUInt32Number m_nThreads;
+  icUInt32Number m_nTileBytes;
+
+  std::vector<CIccApplyCmm*> m_Applies;
+  CIccParallelPool *m_pPool;
+};
+
+#if defined(USEICCDEVNAMESPACE)
+}; //namespace iccDEV
+#endif
+
+#endif //_ICCCMMPARALLEL_H
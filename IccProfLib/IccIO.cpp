@@ -70,10 +70,22 @@
 
 #include "IccIO.h"
 #include "IccUtil.h"
+#include "IccSimd.h"
 #include <cstdlib>
 #include <memory.h>
 #include <cstring>
 
+#if defined(WIN32)
+  #include <windows.h>
+  #include <io.h>
+#elif defined(__unix__) || defined(__APPLE__)
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+  #define ICC_USE_MMAP
+#endif
+
 #ifndef __max
 #define __max(a,b)  (((a) > (b)) ? (a) : (b))
 #endif
@@ -81,6 +93,9 @@
 #define __min(a,b)  (((a) < (b)) ? (a) : (b))
 #endif
 
+//Size in bytes of the stack buffers used by the CIccIO array readers/writers
+#define icIOChunkSize 8192
+
 #ifdef USEICCDEVNAMESPACE
 namespace iccDEV {
 #endif
@@ -121,7 +136,7 @@ size_t CIccIO::Read16(void *pBuf16, size_t nNum)
 
   nNum = Read8(pBuf16, nNum<<1)>>1;
 #ifdef ICC_BYTE_ORDER_LITTLE_ENDIAN
-  icSwab16Array(pBuf16, nNum);
+  icSimdSwap16Array(pBuf16, nNum);
 #endif
 
   return nNum;
@@ -135,19 +150,21 @@ size_t CIccIO::Write16(void *pBuf16, size_t nNum)
 #ifndef ICC_BYTE_ORDER_LITTLE_ENDIAN
   return Write8(pBuf16, nNum<<1)>>1;
 #else
-  icUInt16Number *ptr = (icUInt16Number*)pBuf16;
-  icUInt16Number tmp;
-  size_t i;
-
-  for (i=0; i<nNum; i++) {
-    tmp = *ptr;
-    icSwab16(tmp);
-    if (Write8(&tmp, 2)!=2)
-      break;
-    ptr++;
+  icUInt8Number buf[icIOChunkSize];
+  const icUInt8Number *ptr = (const icUInt8Number*)pBuf16;
+  size_t i, n, nWritten;
+
+  for (i=0; i<nNum; i+=n) {
+    n = __min(nNum-i, icIOChunkSize>>1);
+    memcpy(buf, ptr + (i<<1), n<<1);
+    icSimdSwap16Array(buf, n);
+
+    nWritten = Write8(buf, n<<1)>>1;
+    if (nWritten!=n)
+      return i + nWritten;
   }
 
-  return i;
+  return nNum;
 #endif
 }
 
@@ -158,7 +175,7 @@ size_t CIccIO::Read32(void *pBuf32, size_t nNum)
 
   nNum = Read8(pBuf32, nNum<<2)>>2;
 #ifdef ICC_BYTE_ORDER_LITTLE_ENDIAN
-  icSwab32Array(pBuf32, nNum);
+  icSimdSwap32Array(pBuf32, nNum);
 #endif
 
   return nNum;
@@ -173,19 +190,21 @@ size_t CIccIO::Write32(void *pBuf32, size_t nNum)
 #ifndef ICC_BYTE_ORDER_LITTLE_ENDIAN
   return Write8(pBuf32, nNum<<2)>>2;
 #else
-  icUInt32Number *ptr = (icUInt32Number*)pBuf32;
-  icUInt32Number tmp;
-  size_t i;
-
-  for (i=0; i<nNum; i++) {
-    tmp = *ptr;
-    icSwab32(tmp);
-    if (Write8(&tmp, 4)!=4)
-      break;
-    ptr++;
+  icUInt8Number buf[icIOChunkSize];
+  const icUInt8Number *ptr = (const icUInt8Number*)pBuf32;
+  size_t i, n, nWritten;
+
+  for (i=0; i<nNum; i+=n) {
+    n = __min(nNum-i, icIOChunkSize>>2);
+    memcpy(buf, ptr + (i<<2), n<<2);
+    icSimdSwap32Array(buf, n);
+
+    nWritten = Write8(buf, n<<2)>>2;
+    if (nWritten!=n)
+      return i + nWritten;
   }
 
-  return i;
+  return nNum;
 #endif
 }
 
@@ -211,19 +230,21 @@ size_t CIccIO::Write64(void *pBuf64, size_t nNum)
 #ifndef ICC_BYTE_ORDER_LITTLE_ENDIAN
   return Write8(pBuf64, nNum<<3)>>3;
 #else
-  icUInt64Number *ptr = (icUInt64Number*)pBuf64;
-  icUInt64Number tmp;
-  size_t i;
-
-  for (i=0; i<nNum; i++) {
-    tmp = *ptr;
-    icSwab64(tmp);
-    if (Write8(&tmp, 8)!=8)
-      break;
-    ptr++;
+  icUInt64Number buf[icIOChunkSize>>3];
+  const icUInt8Number *ptr = (const icUInt8Number*)pBuf64;
+  size_t i, n, nWritten;
+
+  for (i=0; i<nNum; i+=n) {
+    n = __min(nNum-i, icIOChunkSize>>3);
+    memcpy(buf, ptr + (i<<3), n<<3);
+    icSwab64Array(buf, n);
+
+    nWritten = Write8(buf, n<<3)>>3;
+    if (nWritten!=n)
+      return i + nWritten;
   }
 
-  return i;
+  return nNum;
 #endif
 }
 
@@ -233,17 +254,26 @@ size_t CIccIO::ReadUInt8Float(void *pBufFloat, size_t nNum)
     return 0;
 
   icFloatNumber *ptr = (icFloatNumber*)pBufFloat;
-  icUInt8Number tmp;
-  size_t i;
 
-  for (i=0; i<nNum; i++) {
-    if (Read8(&tmp, 1)!=1)
-      break;
-    *ptr = (icFloatNumber)((icFloatNumber)tmp / 255.0);
-    ptr++;
+  const icUInt8Number *pView = ReadView(nNum);
+  if (pView) {
+    icSimdUInt8ToFloat(ptr, pView, nNum);
+    return nNum;
+  }
+
+  icUInt8Number buf[icIOChunkSize];
+  size_t i, n, nRead;
+
+  for (i=0; i<nNum; i+=n) {
+    n = __min(nNum-i, icIOChunkSize);
+
+    nRead = Read8(buf, n);
+    icSimdUInt8ToFloat(ptr+i, buf, nRead);
+    if (nRead!=n)
+      return i + nRead;
   }
 
-  return i;
+  return nNum;
 }
 
 size_t CIccIO::WriteUInt8Float(void *pBufFloat, size_t nNum)
@@ -251,19 +281,21 @@ size_t CIccIO::WriteUInt8Float(void *pBufFloat, size_t nNum)
   if (!pBufFloat)
     return 0;
 
-  icFloatNumber *ptr = (icFloatNumber*)pBufFloat;
-  icUInt8Number tmp;
-  size_t i;
+  const icFloatNumber *ptr = (const icFloatNumber*)pBufFloat;
+  icUInt8Number buf[icIOChunkSize];
+  size_t i, j, n, nWritten;
 
-  for (i=0; i<nNum; i++) {
-    tmp = (icUInt8Number)(__max(0.0, __min(1.0, *ptr)) * 255.0 + 0.5);
+  for (i=0; i<nNum; i+=n) {
+    n = __min(nNum-i, icIOChunkSize);
+    for (j=0; j<n; j++)
+      buf[j] = (icUInt8Number)(__max(0.0, __min(1.0, ptr[i+j])) * 255.0 + 0.5);
 
-    if (Write8(&tmp, 1)!=1)
-      break;
-    ptr++;
+    nWritten = Write8(buf, n);
+    if (nWritten!=n)
+      return i + nWritten;
   }
 
-  return i;
+  return nNum;
 }
 
 size_t CIccIO::ReadUInt16Float(void *pBufFloat, size_t nNum)
@@ -272,17 +304,26 @@ size_t CIccIO::ReadUInt16Float(void *pBufFloat, size_t nNum)
     return 0;
 
   icFloatNumber *ptr = (icFloatNumber*)pBufFloat;
-  icUInt16Number tmp;
-  size_t i;
 
-  for (i=0; i<nNum; i++) {
-    if (Read16(&tmp, 1)!=1)
-      break;
-    *ptr = (icFloatNumber)((icFloatNumber)tmp / 65535.0);
-    ptr++;
+  const icUInt8Number *pView = ReadView(nNum<<1);
+  if (pView) {
+    icSimdUInt16BEToFloat(ptr, pView, nNum);
+    return nNum;
+  }
+
+  icUInt8Number buf[icIOChunkSize];
+  size_t i, n, nRead;
+
+  for (i=0; i<nNum; i+=n) {
+    n = __min(nNum-i, icIOChunkSize>>1);
+
+    nRead = Read8(buf, n<<1)>>1;
+    icSimdUInt16BEToFloat(ptr+i, buf, nRead);
+    if (nRead!=n)
+      return i + nRead;
   }
 
-  return i;
+  return nNum;
 }
 
 size_t CIccIO::WriteUInt16Float(void *pBufFloat, size_t nNum)
@@ -290,19 +331,25 @@ size_t CIccIO::WriteUInt16Float(void *pBufFloat, size_t nNum)
   if (!pBufFloat)
     return 0;
 
-  icFloatNumber *ptr = (icFloatNumber*)pBufFloat;
+  const icFloatNumber *ptr = (const icFloatNumber*)pBufFloat;
+  icUInt8Number buf[icIOChunkSize];
   icUInt16Number tmp;
-  size_t i;
-
-  for (i=0; i<nNum; i++) {
-    tmp = (icUInt16Number)(__max(0.0, __min(1.0, *ptr)) * 65535.0 + 0.5);
+  size_t i, j, n, nWritten;
+
+  for (i=0; i<nNum; i+=n) {
+    n = __min(nNum-i, icIOChunkSize>>1);
+    for (j=0; j<n; j++) {
+      tmp = (icUInt16Number)(__max(0.0, __min(1.0, ptr[i+j])) * 65535.0 + 0.5);
+      buf[2*j] = (icUInt8Number)(tmp>>8);
+      buf[2*j+1] = (icUInt8Number)tmp;
+    }
 
-    if (Write16(&tmp, 1)!=1)
-      break;
-    ptr++;
+    nWritten = Write8(buf, n<<1)>>1;
+    if (nWritten!=n)
+      return i + nWritten;
   }
 
-  return i;
+  return nNum;
 }
 
 size_t CIccIO::ReadFloat16Float(void *pBufFloat, size_t nNum)
@@ -311,17 +358,26 @@ size_t CIccIO::ReadFloat16Float(void *pBufFloat, size_t nNum)
     return 0;
 
   icFloatNumber *ptr = (icFloatNumber*)pBufFloat;
-  icFloat16Number tmp;
-  size_t i;
 
-  for (i=0; i<nNum; i++) {
-    if (Read16(&tmp, 1)!=1)
-      break;
-    *ptr = icF16toF(tmp);
-    ptr++;
+  const icUInt8Number *pView = ReadView(nNum<<1);
+  if (pView) {
+    icSimdFloat16BEToFloat(ptr, pView, nNum);
+    return nNum;
   }
 
-  return i;
+  icUInt8Number buf[icIOChunkSize];
+  size_t i, n, nRead;
+
+  for (i=0; i<nNum; i+=n) {
+    n = __min(nNum-i, icIOChunkSize>>1);
+
+    nRead = Read8(buf, n<<1)>>1;
+    icSimdFloat16BEToFloat(ptr+i, buf, nRead);
+    if (nRead!=n)
+      return i + nRead;
+  }
+
+  return nNum;
 }
 
 size_t CIccIO::WriteFloat16Float(void *pBufFloat, size_t nNum)
@@ -329,19 +385,25 @@ size_t CIccIO::WriteFloat16Float(void *pBufFloat, size_t nNum)
   if (!pBufFloat)
     return 0;
 
-  icFloatNumber *ptr = (icFloatNumber*)pBufFloat;
+  const icFloatNumber *ptr = (const icFloatNumber*)pBufFloat;
+  icUInt8Number buf[icIOChunkSize];
   icUInt16Number tmp;
-  size_t i;
-
-  for (i=0; i<nNum; i++) {
-    tmp = icFtoF16(*ptr);
+  size_t i, j, n, nWritten;
+
+  for (i=0; i<nNum; i+=n) {
+    n = __min(nNum-i, icIOChunkSize>>1);
+    for (j=0; j<n; j++) {
+      tmp = icFtoF16(ptr[i+j]);
+      buf[2*j] = (icUInt8Number)(tmp>>8);
+      buf[2*j+1] = (icUInt8Number)tmp;
+    }
 
-    if (Write16(&tmp, 1)!=1)
-      break;
-    ptr++;
+    nWritten = Write8(buf, n<<1)>>1;
+    if (nWritten!=n)
+      return i + nWritten;
   }
 
-  return i;
+  return nNum;
 }
 
 size_t CIccIO::ReadFloat32Float(void *pBufFloat, size_t nNum)
@@ -353,17 +415,20 @@ size_t CIccIO::ReadFloat32Float(void *pBufFloat, size_t nNum)
     return 0;
 
   icFloatNumber *ptr = (icFloatNumber*)pBufFloat;
-  icFloat32Number tmp;
-  size_t i;
+  icFloat32Number buf[icIOChunkSize>>2];
+  size_t i, j, n, nRead;
 
-  for (i=0; i<nNum; i++) {
-    if (Read32(&tmp, 1)!=1)
-      break;
-    *ptr = (icFloatNumber)tmp;
-    ptr++;
+  for (i=0; i<nNum; i+=n) {
+    n = __min(nNum-i, icIOChunkSize>>2);
+
+    nRead = Read32(buf, n);
+    for (j=0; j<nRead; j++)
+      ptr[i+j] = (icFloatNumber)buf[j];
+    if (nRead!=n)
+      return i + nRead;
   }
 
-  return i;
+  return nNum;
 }
 
 size_t CIccIO::WriteFloat32Float(void *pBufFloat, size_t nNum)
@@ -374,19 +439,21 @@ size_t CIccIO::WriteFloat32Float(void *pBufFloat, size_t nNum)
   if (!pBufFloat)
     return 0;
 
-  icFloatNumber *ptr = (icFloatNumber*)pBufFloat;
-  icFloat32Number tmp;
-  size_t i;
+  const icFloatNumber *ptr = (const icFloatNumber*)pBufFloat;
+  icFloat32Number buf[icIOChunkSize>>2];
+  size_t i, j, n, nWritten;
 
-  for (i=0; i<nNum; i++) {
-    tmp = (icFloat32Number)*ptr;
+  for (i=0; i<nNum; i+=n) {
+    n = __min(nNum-i, icIOChunkSize>>2);
+    for (j=0; j<n; j++)
+      buf[j] = (icFloat32Number)ptr[i+j];
 
-    if (Write32(&tmp, 1)!=1)
-      break;
-    ptr++;
+    nWritten = Write32(buf, n);
+    if (nWritten!=n)
+      return i + nWritten;
   }
 
-  return i;
+  return nNum;
 }
 
 bool CIccIO::Align32()
@@ -550,6 +617,61 @@ int64_t CIccFileIO::Tell()
 }
 
 
+bool CIccFileIO::CanReadAt()
+{
+#if defined(ICC_USE_MMAP) || defined(WIN32)
+  return m_fFile != NULL;
+#else
+  return false;
+#endif
+}
+
+
+size_t CIccFileIO::ReadAt(size_t nOffset, void *pBuf, size_t nNum)
+{
+  if (!m_fFile)
+    return 0;
+
+#if defined(ICC_USE_MMAP)
+  int fd = fileno(m_fFile);
+  icUInt8Number *ptr = (icUInt8Number*)pBuf;
+  size_t nRead = 0;
+
+  while (nRead < nNum) {
+    ssize_t n = pread(fd, ptr + nRead, nNum - nRead, (off_t)(nOffset + nRead));
+    if (n <= 0)
+      break;
+    nRead += (size_t)n;
+  }
+
+  return nRead;
+#elif defined(WIN32)
+  HANDLE hFile = (HANDLE)_get_osfhandle(_fileno(m_fFile));
+  icUInt8Number *ptr = (icUInt8Number*)pBuf;
+  size_t nRead = 0;
+
+  while (nRead < nNum) {
+    OVERLAPPED ov = {};
+    unsigned long long nPos = (unsigned long long)(nOffset + nRead);
+    DWORD nChunk = (DWORD)__min(nNum - nRead, (size_t)0x40000000);
+    DWORD n = 0;
+
+    ov.Offset = (DWORD)nPos;
+    ov.OffsetHigh = (DWORD)(nPos >> 32);
+
+    if (!ReadFile(hFile, ptr + nRead, nChunk, &n, &ov) || !n)
+      break;
+    nRead += n;
+  }
+
+  return nRead;
+#else
+  (void)nOffset; (void)pBuf; (void)nNum;
+  return 0;
+#endif
+}
+
+
 //////////////////////////////////////////////////////////////////////
 // Class CIccEmbedIO
 //////////////////////////////////////////////////////////////////////
@@ -693,6 +815,199 @@ int64_t CIccEmbedIO::Tell()
 }
 
 
+const icUInt8Number *CIccEmbedIO::ReadView(size_t nNum)
+{
+  if (!m_pIO)
+    return NULL;
+
+  if (m_nSize > 0) {
+    size_t nOffset = (size_t)(m_pIO->Tell() - m_nStartPos);
+
+    if (nOffset > m_nSize || nNum > m_nSize - nOffset)
+      return NULL;
+  }
+
+  return m_pIO->ReadView(nNum);
+}
+
+
+bool CIccEmbedIO::CanReadAt()
+{
+  return m_pIO && m_pIO->CanReadAt();
+}
+
+
+size_t CIccEmbedIO::ReadAt(size_t nOffset, void *pBuf, size_t nNum)
+{
+  if (!m_pIO)
+    return 0;
+
+  if (m_nSize > 0) {
+    if (nOffset > m_nSize)
+      return 0;
+    if (nNum > m_nSize - nOffset)
+      nNum = m_nSize - nOffset;
+  }
+
+  return m_pIO->ReadAt((size_t)m_nStartPos + nOffset, pBuf, nNum);
+}
+
+
+const icUInt8Number *CIccEmbedIO::ViewAt(size_t nOffset, size_t nNum)
+{
+  if (!m_pIO)
+    return NULL;
+
+  if (m_nSize > 0 && (nOffset > m_nSize || nNum > m_nSize - nOffset))
+    return NULL;
+
+  return m_pIO->ViewAt((size_t)m_nStartPos + nOffset, nNum);
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// Class CIccPositionalIO
+//////////////////////////////////////////////////////////////////////
+
+CIccPositionalIO::CIccPositionalIO() : CIccIO()
+{
+  m_pIO = NULL;
+  m_nSize = 0;
+  m_nPos = 0;
+}
+
+CIccPositionalIO::~CIccPositionalIO()
+{
+  Close();
+}
+
+bool CIccPositionalIO::Attach(CIccIO *pIO)
+{
+  if (!pIO || !pIO->CanReadAt())
+    return false;
+
+  m_pIO = pIO;
+  m_nSize = pIO->GetLength();
+  m_nPos = 0;
+
+  return true;
+}
+
+
+void CIccPositionalIO::Close()
+{
+  m_pIO = NULL;
+  m_nSize = 0;
+  m_nPos = 0;
+}
+
+
+size_t CIccPositionalIO::Read8(void *pBuf, size_t nNum)
+{
+  if (!m_pIO || m_nPos >= m_nSize)
+    return 0;
+
+  if (nNum > m_nSize - m_nPos)
+    nNum = m_nSize - m_nPos;
+
+  nNum = m_pIO->ReadAt(m_nPos, pBuf, nNum);
+  m_nPos += nNum;
+
+  return nNum;
+}
+
+
+size_t CIccPositionalIO::Write8(void * /*pBuf*/, size_t /*nNum*/)
+{
+  return 0;
+}
+
+
+size_t CIccPositionalIO::GetLength()
+{
+  return m_nSize;
+}
+
+
+int64_t CIccPositionalIO::Seek(int64_t nOffset, icSeekVal pos)
+{
+  if (!m_pIO)
+    return -1;
+
+  int64_t nPos;
+
+  switch(pos) {
+  case icSeekSet:
+    nPos = nOffset;
+    break;
+  case icSeekCur:
+    nPos = (int64_t)m_nPos + nOffset;
+    break;
+  case icSeekEnd:
+    nPos = (int64_t)m_nSize + nOffset;
+    break;
+  default:
+    return -1;
+  }
+
+  if (nPos < 0 || nPos > (int64_t)m_nSize)
+    return -1;
+
+  m_nPos = (size_t)nPos;
+
+  return nPos;
+}
+
+
+int64_t CIccPositionalIO::Tell()
+{
+  if (!m_pIO)
+    return -1;
+
+  return (int64_t)m_nPos;
+}
+
+
+const icUInt8Number *CIccPositionalIO::ReadView(size_t nNum)
+{
+  if (!m_pIO || m_nPos > m_nSize || nNum > m_nSize - m_nPos)
+    return NULL;
+
+  const icUInt8Number *pView = m_pIO->ViewAt(m_nPos, nNum);
+  if (pView)
+    m_nPos += nNum;
+
+  return pView;
+}
+
+
+bool CIccPositionalIO::CanReadAt()
+{
+  return m_pIO != NULL;
+}
+
+
+size_t CIccPositionalIO::ReadAt(size_t nOffset, void *pBuf, size_t nNum)
+{
+  if (!m_pIO || nOffset >= m_nSize)
+    return 0;
+
+  if (nNum > m_nSize - nOffset)
+    nNum = m_nSize - nOffset;
+
+  return m_pIO->ReadAt(nOffset, pBuf, nNum);
+}
+
+
+const icUInt8Number *CIccPositionalIO::ViewAt(size_t nOffset, size_t nNum)
+{
+  if (!m_pIO || nOffset > m_nSize || nNum > m_nSize - nOffset)
+    return NULL;
+
+  return m_pIO->ViewAt(nOffset, nNum);
+}
+
+
 //////////////////////////////////////////////////////////////////////
 // Class CIccMemIO
 //////////////////////////////////////////////////////////////////////
@@ -705,6 +1020,7 @@ CIccMemIO::CIccMemIO() : CIccIO()
   m_nPos = 0;
 
   m_bFreeData = false;
+  m_bGrow = false;
 }
 
 CIccMemIO::~CIccMemIO()
@@ -713,7 +1029,7 @@ CIccMemIO::~CIccMemIO()
 }
 
 
-bool CIccMemIO::Alloc(size_t nSize, bool bWrite)
+bool CIccMemIO::Alloc(size_t nSize, bool bWrite, bool bGrow)
 {
   if (m_pData)
     Close();
@@ -729,6 +1045,29 @@ bool CIccMemIO::Alloc(size_t nSize, bool bWrite)
   }
 
   m_bFreeData = true;
+  m_bGrow = bWrite && bGrow;
+
+  return true;
+}
+
+
+bool CIccMemIO::Grow(size_t nSize)
+{
+  if (!m_bGrow)
+    return false;
+
+  size_t nAvail = m_nAvail ? m_nAvail : 1024;
+
+  while (nAvail < nSize)
+    nAvail *= 2;
+
+  icUInt8Number *pData = (icUInt8Number*)realloc(m_pData, nAvail);
+
+  if (!pData)
+    return false;
+
+  m_pData = pData;
+  m_nAvail = nAvail;
 
   return true;
 }
@@ -744,6 +1083,7 @@ bool CIccMemIO::Attach(icUInt8Number *pData, size_t nSize, bool bWrite)
 
   m_pData = pData;
   m_nPos = 0;
+  m_bGrow = false;
 
   if (bWrite) {
     m_nAvail = nSize;
@@ -767,6 +1107,7 @@ void CIccMemIO::Close()
     }
     m_pData = NULL;
   }
+  m_bGrow = false;
 }
 
 
@@ -788,6 +1129,9 @@ size_t CIccMemIO::Write8(void *pBuf, size_t nNum)
   if (!m_pData || !pBuf)
     return 0;
 
+  if (m_bGrow && nNum > m_nAvail-m_nPos)
+    Grow(m_nPos + nNum);
+
   nNum = __min((m_nAvail-m_nPos), nNum);
 
   memcpy(m_pData + m_nPos, pBuf, nNum);
@@ -835,6 +1179,9 @@ int64_t CIccMemIO::Seek(int64_t nOffset, icSeekVal pos)
 
   icUInt32Number uPos = (icUInt32Number)nPos;
 
+  if (m_bGrow && uPos > m_nAvail)
+    Grow(uPos);
+
   if (uPos > m_nSize && m_nSize != m_nAvail && uPos <=m_nAvail) {
     memset(m_pData+m_nSize, 0, (icInt32Number)(uPos - m_nSize));
     m_nSize = uPos;
@@ -856,6 +1203,210 @@ int64_t CIccMemIO::Tell()
   return m_nPos;
 }
 
+
+const icUInt8Number *CIccMemIO::ReadView(size_t nNum)
+{
+  if (!m_pData || m_nPos > m_nSize || nNum > m_nSize - m_nPos)
+    return NULL;
+
+  const icUInt8Number *pView = m_pData + m_nPos;
+  m_nPos += nNum;
+
+  return pView;
+}
+
+
+size_t CIccMemIO::ReadAt(size_t nOffset, void *pBuf, size_t nNum)
+{
+  if (!m_pData || nOffset >= m_nSize)
+    return 0;
+
+  if (nNum > m_nSize - nOffset)
+    nNum = m_nSize - nOffset;
+
+  memcpy(pBuf, m_pData + nOffset, nNum);
+
+  return nNum;
+}
+
+
+const icUInt8Number *CIccMemIO::ViewAt(size_t nOffset, size_t nNum)
+{
+  if (!m_pData || nOffset > m_nSize || nNum > m_nSize - nOffset)
+    return NULL;
+
+  return m_pData + nOffset;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+// Class CIccMappedIO
+//////////////////////////////////////////////////////////////////////
+
+CIccMappedIO::CIccMappedIO() : CIccMemIO()
+{
+#ifdef WIN32
+  m_hMapping = NULL;
+#endif
+  m_bMapped = false;
+}
+
+CIccMappedIO::~CIccMappedIO()
+{
+  Close();
+}
+
+
+bool CIccMappedIO::Open(const icChar *szFilename)
+{
+  Close();
+
+  if (!szFilename)
+    return false;
+
+#if defined(ICC_USE_MMAP)
+  int fd = open(szFilename, O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  if (fstat(fd, &st) || st.st_size <= 0 || (icUInt64Number)st.st_size > (icUInt64Number)(size_t)-1) {
+    close(fd);
+    return false;
+  }
+
+  size_t nSize = (size_t)st.st_size;
+  void *pMap = mmap(NULL, nSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (pMap != MAP_FAILED) {
+    CIccMemIO::Attach((icUInt8Number*)pMap, nSize);
+    m_bMapped = true;
+    return true;
+  }
+#elif defined(WIN32)
+  HANDLE hFile = CreateFileA(szFilename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (hFile == INVALID_HANDLE_VALUE)
+    return false;
+
+  bool bMapped = MapHandle(hFile);
+  CloseHandle(hFile);
+
+  if (bMapped)
+    return true;
+#endif
+
+  FILE *f = fopen(szFilename, "rb");
+  if (!f)
+    return false;
+
+  bool rv = LoadFile(f);
+  fclose(f);
+
+  return rv;
+}
+
+
+#ifdef WIN32
+bool CIccMappedIO::Open(const icWChar *szFilename)
+{
+  Close();
+
+  if (!szFilename)
+    return false;
+
+  HANDLE hFile = CreateFileW(szFilename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (hFile == INVALID_HANDLE_VALUE)
+    return false;
+
+  bool bMapped = MapHandle(hFile);
+  CloseHandle(hFile);
+
+  if (bMapped)
+    return true;
+
+  FILE *f = _wfopen(szFilename, L"rb");
+  if (!f)
+    return false;
+
+  bool rv = LoadFile(f);
+  fclose(f);
+
+  return rv;
+}
+
+
+bool CIccMappedIO::MapHandle(void *hFile)
+{
+  LARGE_INTEGER nLength;
+
+  if (!GetFileSizeEx((HANDLE)hFile, &nLength) || nLength.QuadPart <= 0 ||
+      (icUInt64Number)nLength.QuadPart > (icUInt64Number)(size_t)-1)
+    return false;
+
+  HANDLE hMapping = CreateFileMapping((HANDLE)hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (!hMapping)
+    return false;
+
+  void *pView = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+  if (!pView) {
+    CloseHandle(hMapping);
+    return false;
+  }
+
+  CIccMemIO::Attach((icUInt8Number*)pView, (size_t)nLength.QuadPart);
+  m_hMapping = hMapping;
+  m_bMapped = true;
+
+  return true;
+}
+#endif
+
+
+bool CIccMappedIO::LoadFile(FILE *f)
+{
+  if (fseek(f, 0, SEEK_END))
+    return false;
+
+  long nLength = ftell(f);
+  if (nLength <= 0 || fseek(f, 0, SEEK_SET))
+    return false;
+
+  if (!Alloc((size_t)nLength))
+    return false;
+
+  if (fread(m_pData, 1, (size_t)nLength, f) != (size_t)nLength) {
+    Close();
+    return false;
+  }
+
+  return true;
+}
+
+
+void CIccMappedIO::Close()
+{
+  if (m_pData && m_bMapped) {
+#if defined(ICC_USE_MMAP)
+    munmap(m_pData, m_nSize);
+#elif defined(WIN32)
+    UnmapViewOfFile(m_pData);
+    CloseHandle((HANDLE)m_hMapping);
+    m_hMapping = NULL;
+#endif
+    m_pData = NULL;
+    m_bMapped = false;
+  }
+
+  CIccMemIO::Close();
+}
+
+
+size_t CIccMappedIO::Write8(void * /* pBuf */, size_t /* nNum */)
+{
+  return 0;
+}
+
 ///////////////////////////////
 
 //////////////////////////////////////////////////////////////////////
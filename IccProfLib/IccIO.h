@@ -130,6 +130,24 @@ public:
   virtual int64_t Seek(int64_t /*nOffset*/, icSeekVal /*pos*/) {return -1;}
   virtual int64_t Tell() {return 0;}
 
+  ///Returns a pointer to the next nNum bytes in the IO's own storage and advances
+  ///the read position.  NULL is returned (and the position is unchanged) if the
+  ///IO has no such storage or fewer than nNum bytes remain.  The data stays valid
+  ///until the IO is closed.
+  virtual const icUInt8Number *ReadView(size_t /*nNum*/) { return NULL; }
+
+  ///Returns true if ReadAt() is supported.  Positional reads do not use or move
+  ///the read position so several threads can issue them at once.
+  virtual bool CanReadAt() { return false; }
+
+  ///Reads nNum bytes starting at nOffset without using or moving the read position.
+  ///Returns the number of bytes read.
+  virtual size_t ReadAt(size_t /*nOffset*/, void * /*pBuf*/, size_t /*nNum*/) { return 0; }
+
+  ///Returns a pointer to nNum bytes at nOffset in the IO's own storage without
+  ///moving the read position.  NULL is returned if there is no such storage.
+  virtual const icUInt8Number *ViewAt(size_t /*nOffset*/, size_t /*nNum*/) { return NULL; }
+
   ///Write operation to make sure that filelength is evenly divisible by 4
   bool Align32(); 
 
@@ -168,6 +186,9 @@ public:
   virtual int64_t Seek(int64_t nOffset, icSeekVal pos);
   virtual int64_t Tell();
 
+  virtual bool CanReadAt();
+  virtual size_t ReadAt(size_t nOffset, void *pBuf, size_t nNum);
+
 protected:
   FILE *m_fFile;
 };
@@ -196,6 +217,12 @@ public:
   virtual int64_t Seek(int64_t nOffset, icSeekVal pos);
   virtual int64_t Tell();
 
+  virtual const icUInt8Number *ReadView(size_t nNum);
+
+  virtual bool CanReadAt();
+  virtual size_t ReadAt(size_t nOffset, void *pBuf, size_t nNum);
+  virtual const icUInt8Number *ViewAt(size_t nOffset, size_t nNum);
+
 protected:
  CIccIO *m_pIO;
  int64_t m_nStartPos;
@@ -204,6 +231,46 @@ protected:
 };
 
 
+/**
+**************************************************************************
+* Type: Class
+*
+* Purpose: Reads from another IO object through positional reads with a
+*  read position of its own.  Several CIccPositionalIO objects can read the
+*  same IO object from different threads as long as that object supports
+*  ReadAt().  The length of the underlying IO is captured by Attach().
+**************************************************************************
+*/
+class ICCPROFLIB_API CIccPositionalIO : public CIccIO
+{
+public:
+  CIccPositionalIO();
+  virtual ~CIccPositionalIO();
+
+  bool Attach(CIccIO *pIO);
+  virtual void Close();
+
+  virtual size_t Read8(void *pBuf, size_t nNum = 1);
+  virtual size_t Write8(void *pBuf, size_t nNum = 1);
+
+  virtual size_t GetLength();
+
+  virtual int64_t Seek(int64_t nOffset, icSeekVal pos);
+  virtual int64_t Tell();
+
+  virtual const icUInt8Number *ReadView(size_t nNum);
+
+  virtual bool CanReadAt();
+  virtual size_t ReadAt(size_t nOffset, void *pBuf, size_t nNum);
+  virtual const icUInt8Number *ViewAt(size_t nOffset, size_t nNum);
+
+protected:
+  CIccIO *m_pIO;
+  size_t m_nSize;
+  size_t m_nPos;
+};
+
+
 /**
  **************************************************************************
  * Type: Class
@@ -217,7 +284,8 @@ public:
   CIccMemIO();
   virtual ~CIccMemIO();
 
-  bool Alloc(size_t nSize, bool bWrite = false);
+  ///With bGrow the allocated memory grows as it is written past its end
+  bool Alloc(size_t nSize, bool bWrite = false, bool bGrow = false);
 
   bool Attach(icUInt8Number *pData, size_t nSize, bool bWrite=false);
   virtual void Close();
@@ -230,15 +298,65 @@ public:
   virtual int64_t Seek(int64_t nOffset, icSeekVal pos);
   virtual int64_t Tell();
 
+  virtual const icUInt8Number *ReadView(size_t nNum);
+
+  virtual bool CanReadAt() { return m_pData != NULL; }
+  virtual size_t ReadAt(size_t nOffset, void *pBuf, size_t nNum);
+  virtual const icUInt8Number *ViewAt(size_t nOffset, size_t nNum);
+
   icUInt8Number *GetData() { return m_pData; }
 
 protected:
+  bool Grow(size_t nSize);
+
   icUInt8Number *m_pData;
   size_t m_nSize;
   size_t m_nAvail;
   size_t m_nPos;
 
   bool m_bFreeData;
+  bool m_bGrow;
+};
+
+/**
+ **************************************************************************
+ * Type: Class
+ * 
+ * Purpose: Handles read only IO of a memory mapped file.  The file is
+ *  mapped with mmap() on POSIX systems and with a file mapping object on
+ *  Windows.  Elsewhere (or if mapping fails) the file is read into memory.
+ *  Data is paged in from the file as it is read, and ReadView() gives
+ *  direct access to the mapped bytes.  The file must not be truncated
+ *  while it is mapped.
+ **************************************************************************
+ */
+class ICCPROFLIB_API CIccMappedIO : public CIccMemIO
+{
+public:
+  CIccMappedIO();
+  virtual ~CIccMappedIO();
+
+  bool Open(const icChar *szFilename);
+#ifdef WIN32
+  bool Open(const icWChar *szFilename);
+#endif
+
+  virtual void Close();
+
+  virtual size_t Write8(void *pBuf, size_t nNum=1);
+
+  ///Returns true if the data is mapped rather than read into memory
+  bool IsMapped() const { return m_bMapped; }
+
+protected:
+#ifdef WIN32
+  bool MapHandle(void *hFile);
+
+  void *m_hMapping;
+#endif
+  bool LoadFile(FILE *f);
+
+  bool m_bMapped;
 };
 
 /**
@@ -81,6 +81,7 @@
 #include "IccIO.h"
 #include <map>
 #include <limits>
+#include <algorithm>
 #include "IccUtil.h"
 
 //#define ICC_VERBOSE_CALC_APPLY 1
@@ -2878,6 +2879,12 @@ CIccCalculatorFunc::CIccCalculatorFunc(CIccMpeCalculator *pCalc)
 
   m_nOps = 0;
   m_Op = NULL;
+
+  m_nInst = 0;
+  m_Inst = NULL;
+  m_Jump = NULL;
+  m_nProgStack = 0;
+  m_nRemovedInst = 0;
 }
 
 /**
@@ -2904,6 +2911,13 @@ CIccCalculatorFunc::CIccCalculatorFunc(const CIccCalculatorFunc &func)
   }
   else
     m_Op = NULL;
+
+  //Programs are compiled by Begin
+  m_nInst = 0;
+  m_Inst = NULL;
+  m_Jump = NULL;
+  m_nProgStack = 0;
+  m_nRemovedInst = 0;
 }
 
 /**
@@ -2925,6 +2939,8 @@ CIccCalculatorFunc &CIccCalculatorFunc::operator=(const CIccCalculatorFunc &func
   if (m_Op)
     free(m_Op);
 
+  FreeProgram();
+
   m_nOps = func.m_nOps;
 
   if (m_nOps) {
@@ -2952,6 +2968,8 @@ CIccCalculatorFunc::~CIccCalculatorFunc()
   if (m_Op) {
     free(m_Op);
   }
+
+  FreeProgram();
 }
 
 void CIccCalculatorFunc::InsertBlanks(std::string &sDescription, int nBlanks)
@@ -3597,51 +3615,2547 @@ bool CIccCalculatorFunc::Begin(const CIccMpeCalculator *pChannelCalc, CIccTagMul
   if (!InitSelectOps())
     return false;
 
-  if (!HasValidOperations(sReport))
-    return false;
+  if (!HasValidOperations(sReport))
+    return false;
+
+  if (!SetOpDefs())
+    return false;
+
+  if (DoesOverflowInput(pChannelCalc->NumInputChannels()))
+    return false;
+
+  if (DoesOverflowOutput(pChannelCalc->NumOutputChannels()))
+    return false;
+
+  if (DoesStackUnderflowOverflow(sReport)!=icFuncParseNoError)
+    return false;
+
+  //Functions that can't be compiled are interpreted
+  Compile();
+
+  return true;
+}
+
+/**
+ ******************************************************************************
+ * Name: CIccCalculatorFunc::InitSelectOps
+ * 
+ * Purpose: 
+ * 
+ * Args: 
+ * 
+ * Return: 
+ ******************************************************************************/
+bool CIccCalculatorFunc::InitSelectOps()
+{
+  icUInt32Number i;
+
+  for (i=0; i<m_nOps; i++) {
+    if (m_Op[i].sig==icSigSelectOp) {
+      if (!InitSelectOp(&m_Op[i], m_nOps-i))
+        return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ ******************************************************************************
+ * Name: CIccCalculatorFunc::InitSelectOp
+ * 
+ * Purpose: 
+ * 
+ * Args: 
+ * 
+ * Return: 
+ ******************************************************************************/
+bool CIccCalculatorFunc::InitSelectOp(SIccCalcOp *ops, icUInt32Number nOps)
+{
+
+  if (ops->sig != icSigSelectOp)
+    return false;
+
+  if (ops->extra)
+    return true;
+
+
+  icUInt32Number i, n, pos;
+  for (n=0; n<nOps && ops[n+1].sig==icSigCaseOp; n++);
+  ops->extra=n;
+  if (ops[n+1].sig==icSigDefaultOp) {
+    n++;
+  }
+  pos = n;
+  for (i=1; i<=n && pos<nOps; i++) {
+    ops[i].extra = pos;
+    pos += ops[i].data.size;
+  }
+
+  if (i<=n)
+    return false;
+
+  return true;
+}
+
+/**
+******************************************************************************
+* Name: CIccCalculatorFunc::ApplySequence
+* 
+* Purpose: 
+* 
+* Args: 
+* 
+* Return: 
+******************************************************************************/
+bool CIccCalculatorFunc::ApplySequence(CIccApplyMpeCalculator *pApply, icUInt32Number nOps, SIccCalcOp *ops) const
+{
+  SIccCalcOp *op;
+  SIccOpState os;
+
+  os.pApply = pApply;
+  os.pStack = pApply->GetStack();
+  os.pScratch = pApply->GetScratch();
+  os.temp = pApply->GetTemp();
+  os.pixel = pApply->GetInput();
+  os.output = pApply->GetOutput();
+  os.nOps = nOps;
+
+  for (os.idx=0; os.idx<os.nOps; os.idx++) {
+    op = &ops[os.idx];
+
+    if (g_pDebugger)
+      g_pDebugger->BeforeOp(op, os, ops);
+
+    if (op->sig==icSigIfOp) {
+      icFloatNumber a1;
+      OsPopArg(a1);
+
+      if (os.idx+1<nOps && ops[os.idx+1].sig==icSigElseOp) {
+        os.idx++;
+        if (a1>=0.5) {
+          if (os.idx+1 + op->data.size >= nOps)
+            return false;
+
+          if (!ApplySequence(pApply, op->data.size, &ops[os.idx+1]))
+            return false;
+        }
+        else {
+          if (os.idx+1 + op->data.size + ops[os.idx].data.size > nOps)
+            return false;
+
+          if (!ApplySequence(pApply, ops[os.idx].data.size, &ops[os.idx+1 + op->data.size]))
+            return false;
+        }
+        os.idx += op->data.size + ops[os.idx].data.size;
+      }
+      else {
+        if (a1>=0.5) {
+          if (os.idx+op->data.size >= nOps)
+            return false;
+
+          if (!ApplySequence(pApply, op->data.size, &ops[os.idx+1]))
+            return false;
+        }
+        os.idx+= op->data.size;
+      }
+    }
+    else if (op->sig==icSigSelectOp) {
+      icFloatNumber a1;
+      OsPopArg(a1);
+      if (std::isnan(a1))
+        a1 = 0.0;
+        
+      icInt32Number nSel;
+      if (std::isinf(a1)) {
+        nSel = (a1 < 0.0) ? std::numeric_limits<icInt32Number>::lowest() : std::numeric_limits<icInt32Number>::max();
+      }
+      else
+        nSel = (a1 >= 0.0) ? (icInt32Number)(a1+0.5f) : (icInt32Number)(a1-0.5f);
+
+      if (!op->extra) {
+        return false;
+      }
+      
+      icUInt32Number nDefOff = (icUInt32Number)(os.idx+1 + op->extra);
+      if (nDefOff >= nOps)
+        return false;
+
+      if (nSel<0 || (icUInt32Number)nSel>=op->extra) {
+
+        if (ops[nDefOff].sig==icSigDefaultOp) {
+          if (os.idx+1 + ops[nDefOff].extra >= nOps)
+            return false;
+
+          if (!ApplySequence(pApply, ops[nDefOff].data.size, &ops[os.idx+1 + ops[nDefOff].extra]))
+            break;
+        }
+      }
+      else {
+        icUInt32Number nOff = os.idx+1 + nSel;
+
+        if (nOff >= nOps) 
+          return false;
+
+        if (!ApplySequence(pApply, ops[nOff].data.size, &ops[os.idx+1 + ops[nOff].extra]))
+          break;
+      }
+
+      if (ops[nDefOff].sig==icSigDefaultOp) {
+        if (os.idx+1 + ops[nDefOff].extra + ops[nDefOff].data.size >nOps)
+          return false;
+
+        os.idx = (icUInt32Number)(os.idx + ops[nDefOff].extra + ops[nDefOff].data.size);
+      }
+      else if (op->extra) {
+        unsigned long nOff = os.idx + op->extra;
+
+        if (os.idx+1 + ops[nOff].extra + ops[nOff].data.size > nOps)
+          return false;
+
+        os.idx = (icUInt32Number)(os.idx + ops[nOff].extra + ops[nOff].data.size);
+      }
+      else 
+        return false;
+    }
+    else {
+      if (!op->def->Exec(op, os))
+        return false;
+    }
+
+    if (g_pDebugger) {
+      g_pDebugger->AfterOp(op, os, ops);
+    }
+  }
+  return true;
+}
+
+/**
+******************************************************************************
+* Instruction codes of compiled calculator functions
+******************************************************************************/
+typedef enum {
+  icCalcInstConst = 0,
+  icCalcInstIn,
+  icCalcInstOut,
+  icCalcInstTempGet,
+  icCalcInstTempPut,
+  icCalcInstEnvVar,
+  icCalcInstSubElem,
+  icCalcInstCopy,
+  icCalcInstPositionDup,
+  icCalcInstFlip,
+  icCalcInstRotateLeft,
+  icCalcInstRotateRight,
+  icCalcInstTranspose,
+  icCalcInstSolve,
+  icCalcInstSum,
+  icCalcInstProduct,
+  icCalcInstMinimum,
+  icCalcInstMaximum,
+  icCalcInstAnd,
+  icCalcInstOr,
+  icCalcInstVectorMinimum,
+  icCalcInstVectorMaximum,
+  icCalcInstVectorAnd,
+  icCalcInstVectorOr,
+  icCalcInstAdd,
+  icCalcInstSubtract,
+  icCalcInstMultiply,
+  icCalcInstDivide,
+  icCalcInstModulus,
+  icCalcInstPow,
+  icCalcInstGamma,
+  icCalcInstScalarAdd,
+  icCalcInstScalarSubtract,
+  icCalcInstScalarMultiply,
+  icCalcInstScalarDivide,
+  icCalcInstSquare,
+  icCalcInstSquareRoot,
+  icCalcInstCube,
+  icCalcInstCubeRoot,
+  icCalcInstSign,
+  icCalcInstAbsoluteVal,
+  icCalcInstTruncate,
+  icCalcInstFloor,
+  icCalcInstCeiling,
+  icCalcInstRound,
+  icCalcInstExp,
+  icCalcInstLogrithm,
+  icCalcInstNaturalLog,
+  icCalcInstSine,
+  icCalcInstCosine,
+  icCalcInstTangent,
+  icCalcInstArcSine,
+  icCalcInstArcCosine,
+  icCalcInstArcTangent,
+  icCalcInstArcTan2,
+  icCalcInstCartesianToPolar,
+  icCalcInstPolarToCartesian,
+  icCalcInstRealNumber,
+  icCalcInstLessThan,
+  icCalcInstLessThanEqual,
+  icCalcInstEqual,
+  icCalcInstNotEqual,
+  icCalcInstNear,
+  icCalcInstGreaterThanEqual,
+  icCalcInstGreaterThan,
+  icCalcInstNot,
+  icCalcInstNeg,
+  icCalcInstToLab,
+  icCalcInstToXYZ,
+  icCalcInstJump,       //continue at instruction b
+  icCalcInstJumpIfNot,  //continue at instruction b if argument is false
+  icCalcInstSelect,     //continue at instruction from jump table entry b + case (entry b+n is the default)
+} icCalcInstCode;
+
+/**
+******************************************************************************
+* Name: icCalcInstFromOp
+* 
+* Purpose: Get the instruction code of operations that map to a single
+*  instruction working on v1+1 (or v1+2) arguments.
+* 
+* Return: 
+*  true if the operation maps to an instruction
+******************************************************************************/
+static bool icCalcInstFromOp(icSigCalcOp sig, icCalcInstCode &code)
+{
+  switch (sig) {
+    case icSigSumOp:              code = icCalcInstSum; break;
+    case icSigProductOp:          code = icCalcInstProduct; break;
+    case icSigMinimumOp:          code = icCalcInstMinimum; break;
+    case icSigMaximumOp:          code = icCalcInstMaximum; break;
+    case icSigAndOp:              code = icCalcInstAnd; break;
+    case icSigOrOp:               code = icCalcInstOr; break;
+    case icSigVectorMinimumOp:    code = icCalcInstVectorMinimum; break;
+    case icSigVectorMaximumOp:    code = icCalcInstVectorMaximum; break;
+    case icSigVectorAndOp:        code = icCalcInstVectorAnd; break;
+    case icSigVectorOrOp:         code = icCalcInstVectorOr; break;
+    case icSigAddOp:              code = icCalcInstAdd; break;
+    case icSigSubtractOp:         code = icCalcInstSubtract; break;
+    case icSigMultiplyOp:         code = icCalcInstMultiply; break;
+    case icSigDivideOp:           code = icCalcInstDivide; break;
+    case icSigModulusOp:          code = icCalcInstModulus; break;
+    case icSigPowOp:              code = icCalcInstPow; break;
+    case icSigGammaOp:            code = icCalcInstGamma; break;
+    case icSigScalarAddOp:        code = icCalcInstScalarAdd; break;
+    case icSigScalarSubtractOp:   code = icCalcInstScalarSubtract; break;
+    case icSigScalarMultiplyOp:   code = icCalcInstScalarMultiply; break;
+    case icSigScalarDivideOp:     code = icCalcInstScalarDivide; break;
+    case icSigSquareOp:           code = icCalcInstSquare; break;
+    case icSigSquareRootOp:       code = icCalcInstSquareRoot; break;
+    case icSigCubeOp:             code = icCalcInstCube; break;
+    case icSigCubeRootOp:         code = icCalcInstCubeRoot; break;
+    case icSigSignOp:             code = icCalcInstSign; break;
+    case icSigAbsoluteValOp:      code = icCalcInstAbsoluteVal; break;
+    case icSigTruncateOp:         code = icCalcInstTruncate; break;
+    case icSigFloorOp:            code = icCalcInstFloor; break;
+    case icSigCeilingOp:          code = icCalcInstCeiling; break;
+    case icSigRoundOp:            code = icCalcInstRound; break;
+    case icSigExpOp:              code = icCalcInstExp; break;
+    case icSigLogrithmOp:         code = icCalcInstLogrithm; break;
+    case icSigNaturalLogOp:       code = icCalcInstNaturalLog; break;
+    case icSigSineOp:             code = icCalcInstSine; break;
+    case icSigCosineOp:           code = icCalcInstCosine; break;
+    case icSigTangentOp:          code = icCalcInstTangent; break;
+    case icSigArcSineOp:          code = icCalcInstArcSine; break;
+    case icSigArcCosineOp:        code = icCalcInstArcCosine; break;
+    case icSigArcTangentOp:       code = icCalcInstArcTangent; break;
+    case icSigArcTan2Op:          code = icCalcInstArcTan2; break;
+    case icSigCartesianToPolarOp: code = icCalcInstCartesianToPolar; break;
+    case icSigPolarToCartesianOp: code = icCalcInstPolarToCartesian; break;
+    case icSigRealNumberOp:       code = icCalcInstRealNumber; break;
+    case icSigLessThanOp:         code = icCalcInstLessThan; break;
+    case icSigLessThanEqualOp:    code = icCalcInstLessThanEqual; break;
+    case icSigEqualOp:            code = icCalcInstEqual; break;
+    case icSigNotEqualOp:         code = icCalcInstNotEqual; break;
+    case icSigNearOp:             code = icCalcInstNear; break;
+    case icSigGreaterThanEqualOp: code = icCalcInstGreaterThanEqual; break;
+    case icSigGreaterThanOp:      code = icCalcInstGreaterThan; break;
+    case icSigNotOp:              code = icCalcInstNot; break;
+    case icSigNegOp:              code = icCalcInstNeg; break;
+    case icSigToLabOp:            code = icCalcInstToLab; break;
+    case icSigToXYZOp:            code = icCalcInstToXYZ; break;
+    default:
+      return false;
+  }
+  return true;
+}
+
+/**
+ ******************************************************************************
+ * Name: CIccCalculatorFunc::CompileSequence
+ * 
+ * Purpose: 
+ *  Appends the instructions of a sequence of operations to a program.
+ *  The stack depth before each operation is known when compiling so stack
+ *  arguments are given fixed positions.  Conditional and select blocks are
+ *  compiled inline with jumps to the following instructions.
+ * 
+ * Args: 
+ *  nOps = number of operations in sequence,
+ *  ops = operations to compile,
+ *  nDepth = stack depth before/after the sequence,
+ *  nMaxDepth = maximum stack depth used,
+ *  nScratch = maximum scratch space needed by instructions,
+ *  prog = program instructions,
+ *  jumps = jump table used by select instructions.
+ * 
+ * Return: 
+ *  false if the sequence cannot be compiled.  This happens when blocks of
+ *  an if/else or select leave the stack at different depths, or when
+ *  operations would fail when applied.
+ ******************************************************************************/
+bool CIccCalculatorFunc::CompileSequence(icUInt32Number nOps, SIccCalcOp *ops, icUInt32Number &nDepth, icUInt32Number &nMaxDepth,
+                                         icUInt32Number &nScratch, std::vector<SIccCalcInst> &prog, std::vector<icUInt32Number> &jumps)
+{
+  icUInt32Number i;
+
+  for (i=0; i<nOps; i++) {
+    SIccCalcOp *op = &ops[i];
+    icUInt32Number nUsed = op->ArgsUsed(m_pCalc);
+    icUInt32Number nPushed = op->ArgsPushed(m_pCalc);
+    icCalcInstCode code;
+    SIccCalcInst inst;
+
+    if (nUsed>nDepth || nUsed>=icMaxDataStackSize || nPushed>=icMaxDataStackSize)
+      return false;
+
+    memset(&inst, 0, sizeof(inst));
+    inst.a = nDepth - nUsed;
+    inst.nUsed = (icUInt16Number)nUsed;
+    inst.nPushed = (icUInt16Number)nPushed;
+
+    switch (op->sig) {
+      case icSigDataOp:
+        inst.code = icCalcInstConst;
+        inst.v = op->data.num;
+        break;
+
+      case icSigPiOp:
+        inst.code = icCalcInstConst;
+        inst.v = (icFloatNumber)icPiNum;
+        break;
+
+      case icSigPosInfinityOp:
+        inst.code = icCalcInstConst;
+        inst.v = (icFloatNumber)icPosInfinity;
+        break;
+
+      case icSigNegInfinityOp:
+        inst.code = icCalcInstConst;
+        inst.v = (icFloatNumber)icNegInfinity;
+        break;
+
+      case icSigNotaNumberOp:
+        inst.code = icCalcInstConst;
+        inst.v = (icFloatNumber)icNotANumber;
+        break;
+
+      case icSigInputChanOp:
+      case icSigOutputChanOp:
+      case icSigTempGetChanOp:
+      case icSigTempPutChanOp:
+      case icSigTempSaveChanOp:
+        inst.code = op->sig==icSigInputChanOp ? icCalcInstIn :
+                    op->sig==icSigOutputChanOp ? icCalcInstOut :
+                    op->sig==icSigTempGetChanOp ? icCalcInstTempGet : icCalcInstTempPut;
+        inst.b = op->data.select.v1;
+        inst.n = (icUInt32Number)op->data.select.v2+1;
+        break;
+
+      case icSigEnvVarOp:
+        inst.code = icCalcInstEnvVar;
+        inst.b = op->data.size;
+        break;
+
+      case icSigApplyCurvesOp:
+      case icSigApplyMatrixOp:
+      case icSigApplyCLutOp:
+      case icSigApplyTintOp:
+      case icSigApplyToJabOp:
+      case icSigApplyFromJabOp:
+      case icSigApplyCalcOp:
+      case icSigApplyElemOp:
+        if (!m_pCalc->GetElem(op->sig, op->data.select.v1))
+          return false;
+        inst.code = icCalcInstSubElem;
+        inst.b = op->data.select.v1;
+        inst.n = nUsed;
+        inst.c = nPushed;
+        if (nPushed>nScratch)
+          nScratch = nPushed;
+        break;
+
+      case icSigPopOp:
+        nDepth = inst.a;
+        continue;
+
+      case icSigCopyOp:
+      case icSigPositionDupOp:
+        inst.code = op->sig==icSigCopyOp ? icCalcInstCopy : icCalcInstPositionDup;
+        inst.n = (icUInt32Number)op->data.select.v1+1;
+        inst.c = (icUInt32Number)op->data.select.v2+1;
+        break;
+
+      case icSigFlipOp:
+        inst.code = icCalcInstFlip;
+        inst.n = (icUInt32Number)op->data.select.v1+2;
+        break;
+
+      case icSigRotateLeftOp:
+      case icSigRotateRightOp:
+        inst.code = op->sig==icSigRotateLeftOp ? icCalcInstRotateLeft : icCalcInstRotateRight;
+        inst.n = (icUInt32Number)op->data.select.v1+1;
+        inst.c = ((icUInt32Number)op->data.select.v2+1) % inst.n;
+        if (inst.n>nScratch)
+          nScratch = inst.n;
+        break;
+
+      case icSigTransposeOp:
+        inst.code = icCalcInstTranspose;
+        inst.n = (icUInt32Number)op->data.select.v1+1;
+        inst.c = (icUInt32Number)op->data.select.v2+1;
+        if (inst.n*inst.c>nScratch)
+          nScratch = inst.n*inst.c;
+        break;
+
+      case icSigSolveOp:
+        //Stack usage of applying solve only matches ArgsUsed/ArgsPushed for square matrices
+        if (op->data.select.v1!=op->data.select.v2)
+          return false;
+        inst.code = icCalcInstSolve;
+        inst.n = (icUInt32Number)op->data.select.v1+1;
+        inst.c = (icUInt32Number)op->data.select.v2+1;
+        if (inst.c>nScratch)
+          nScratch = inst.c;
+        break;
+
+      case icSigIfOp:
+        {
+          icUInt32Number nIfSize = op->data.size;
+          icUInt32Number nIfDepth = inst.a, nElseDepth = inst.a;
+          icUInt32Number nJumpIf = (icUInt32Number)prog.size();
+
+          inst.code = icCalcInstJumpIfNot;
+          prog.push_back(inst);
+
+          if (i+1<nOps && ops[i+1].sig==icSigElseOp) {
+            icUInt32Number nElseSize = ops[i+1].data.size;
+
+            if (i+2+nIfSize>=nOps || i+2+nIfSize+nElseSize>nOps)
+              return false;
+
+            if (!CompileSequence(nIfSize, &ops[i+2], nIfDepth, nMaxDepth, nScratch, prog, jumps))
+              return false;
+
+            icUInt32Number nJumpEnd = (icUInt32Number)prog.size();
+            inst.code = icCalcInstJump;
+            inst.nUsed = 0;
+            prog.push_back(inst);
+
+            prog[nJumpIf].b = (icUInt32Number)prog.size();
+
+            if (!CompileSequence(nElseSize, &ops[i+2+nIfSize], nElseDepth, nMaxDepth, nScratch, prog, jumps))
+              return false;
+
+            prog[nJumpEnd].b = (icUInt32Number)prog.size();
+            i += 1 + nIfSize + nElseSize;
+          }
+          else {
+            if (i+nIfSize>=nOps)
+              return false;
+
+            if (!CompileSequence(nIfSize, &ops[i+1], nIfDepth, nMaxDepth, nScratch, prog, jumps))
+              return false;
+
+            prog[nJumpIf].b = (icUInt32Number)prog.size();
+            i += nIfSize;
+          }
+
+          if (nIfDepth!=nElseDepth)
+            return false;
+
+          nDepth = nIfDepth;
+        }
+        continue;
+
+      case icSigSelectOp:
+        {
+          icUInt32Number nCases = (icUInt32Number)op->extra;
+          icUInt32Number nDefOff = i+1+nCases;
+          icUInt32Number nSelDepth = inst.a, nCaseDepth, nNext, k;
+          std::vector<icUInt32Number> endJumps;
+
+          if (!nCases || nDefOff>=nOps)
+            return false;
+
+          bool bDefault = ops[nDefOff].sig==icSigDefaultOp;
+          icUInt32Number nLast = bDefault ? nDefOff : i+nCases;
+
+          nNext = i + 1 + (icUInt32Number)ops[nLast].extra + ops[nLast].data.size;
+          if (nNext>nOps)
+            return false;
+
+          inst.code = icCalcInstSelect;
+          inst.n = nCases;
+          inst.b = (icUInt32Number)jumps.size();
+          prog.push_back(inst);
+          jumps.resize(jumps.size() + nCases + 1);
+
+          for (k=0; k<=nCases; k++) {
+            SIccCalcOp *pCase = &ops[i+1+k];
+            icUInt32Number nStart = i+1 + (icUInt32Number)pCase->extra;
+
+            if (k==nCases && !bDefault)
+              break;
+
+            if (nStart>=nOps || nStart+pCase->data.size>nOps)
+              return false;
+
+            jumps[inst.b + k] = (icUInt32Number)prog.size();
+
+            nCaseDepth = inst.a;
+            if (!CompileSequence(pCase->data.size, &ops[nStart], nCaseDepth, nMaxDepth, nScratch, prog, jumps))
+              return false;
+
+            if (!k)
+              nSelDepth = nCaseDepth;
+            else if (nCaseDepth!=nSelDepth)
+              return false;
+
+            if (k<nCases) {
+              SIccCalcInst jump;
+              memset(&jump, 0, sizeof(jump));
+              jump.code = icCalcInstJump;
+              endJumps.push_back((icUInt32Number)prog.size());
+              prog.push_back(jump);
+            }
+          }
+
+          if (!bDefault) {
+            //Selections without a case leave the stack unchanged
+            if (nSelDepth!=inst.a)
+              return false;
+            jumps[inst.b + nCases] = (icUInt32Number)prog.size();
+          }
+
+          for (k=0; k<(icUInt32Number)endJumps.size(); k++)
+            prog[endJumps[k]].b = (icUInt32Number)prog.size();
+
+          nDepth = nSelDepth;
+          i = nNext - 1;
+        }
+        continue;
+
+      default:
+        if (!icCalcInstFromOp(op->sig, code))
+          return false;
+        inst.code = code;
+        inst.n = (icUInt32Number)op->data.select.v1 + ((code>=icCalcInstSum && code<=icCalcInstOr) ? 2 : 1);
+        break;
+    }
+
+    prog.push_back(inst);
+
+    nDepth = inst.a + nPushed;
+    if (nDepth>icMaxDataStackSize)
+      return false;
+    if (nDepth>nMaxDepth)
+      nMaxDepth = nDepth;
+  }
+
+  return true;
+}
+
+/**
+ ******************************************************************************
+ * Name: icCalcSelectCase
+ * 
+ * Purpose: 
+ *  Finds the case of a compiled select instruction the same way that the
+ *  select operation does.
+ * 
+ * Args: 
+ *  a1 = selector value
+ *  nCases = number of cases
+ * 
+ * Return: 
+ *  case index, or nCases for the default case
+ ******************************************************************************/
+static icUInt32Number icCalcSelectCase(icFloatNumber a1, icUInt32Number nCases)
+{
+  if (std::isnan(a1))
+    a1 = 0.0;
+
+  icInt32Number nSel;
+  if (std::isinf(a1)) {
+    nSel = (a1 < 0.0) ? std::numeric_limits<icInt32Number>::lowest() : std::numeric_limits<icInt32Number>::max();
+  }
+  else
+    nSel = (a1 >= 0.0) ? (icInt32Number)(a1+0.5f) : (icInt32Number)(a1-0.5f);
+
+  if (nSel<0 || (icUInt32Number)nSel>=nCases)
+    return nCases;
+
+  return (icUInt32Number)nSel;
+}
+
+/**
+ ******************************************************************************
+ * Name: icCalcInstIsFoldable
+ * 
+ * Purpose: 
+ *  Determines whether an instruction only depends on its stack arguments
+ *  so that it can be evaluated when all of its arguments are known.
+ ******************************************************************************/
+static bool icCalcInstIsFoldable(icUInt32Number code)
+{
+  return code>=icCalcInstCopy && code<=icCalcInstToXYZ && code!=icCalcInstSolve;
+}
+
+/**
+ ******************************************************************************
+ * Name: icCalcInstIsRemovable
+ * 
+ * Purpose: 
+ *  Determines whether an instruction can be removed when none of the
+ *  values that it pushes are used.
+ ******************************************************************************/
+static bool icCalcInstIsRemovable(icUInt32Number code)
+{
+  switch (code) {
+    case icCalcInstOut:
+    case icCalcInstTempPut:
+    case icCalcInstSubElem:
+    case icCalcInstJump:
+    case icCalcInstJumpIfNot:
+    case icCalcInstSelect:
+      return false;
+
+    default:
+      return true;
+  }
+}
+
+/**
+ ******************************************************************************
+ * Name: icCalcAllKnown
+ * 
+ * Purpose: 
+ *  Checks whether nSlots stack positions starting at nStart have known
+ *  values that all have the bit pattern of v.
+ ******************************************************************************/
+static bool icCalcAllKnown(const std::vector<bool> &known, const std::vector<icFloatNumber> &val,
+                           icUInt32Number nStart, icUInt32Number nSlots, icFloatNumber v)
+{
+  for (icUInt32Number k=nStart; k<nStart+nSlots; k++) {
+    if (!known[k] || memcmp(&val[k], &v, sizeof(icFloatNumber)))
+      return false;
+  }
+  return true;
+}
+
+/**
+ ******************************************************************************
+ * Name: CIccCalculatorFunc::FoldConstants
+ * 
+ * Purpose: 
+ *  Follows the stack values that are known when the CMM is built (data
+ *  operations, environment variables and results computed from them).
+ *  Instructions with known arguments are replaced by their result,
+ *  instructions that leave their first argument unchanged (such as
+ *  multiplying by one) and branches with known conditions are replaced
+ *  by jumps that OptimizeProgram() removes.  Nothing is known at the
+ *  start of an instruction that is the target of a jump.
+ * 
+ * Args: 
+ *  prog = compiled program
+ *  jumps = select jump table of program
+ *  nScratch = number of scratch positions in front of the stack
+ *  nSlots = size of program stack
+ * 
+ * Return: 
+ *  true if any instruction was changed
+ ******************************************************************************/
+bool CIccCalculatorFunc::FoldConstants(std::vector<SIccCalcInst> &prog, std::vector<icUInt32Number> &jumps,
+                                       icUInt32Number nScratch, icUInt32Number nSlots)
+{
+  icUInt32Number nInst = (icUInt32Number)prog.size();
+  std::vector<bool> target(nInst+1, false);
+  std::vector<bool> known(nSlots, false);
+  std::vector<icFloatNumber> val(nSlots, 0);
+  IIccCmmEnvVarLookup *pLookup = m_pCalc->GetCmmEnvVarLookup();
+  icFloatNumber one = 1.0, posZero = 0.0, negZero = -posZero;
+  icUInt32Number i, k;
+  bool bChanged = false;
+
+  for (i=0; i<nInst; i++) {
+    const SIccCalcInst *p = &prog[i];
+    if (p->code==icCalcInstJump || p->code==icCalcInstJumpIfNot)
+      target[p->b] = true;
+    else if (p->code==icCalcInstSelect) {
+      for (k=0; k<=p->n; k++)
+        target[jumps[p->b+k]] = true;
+    }
+  }
+
+  //Folded instructions are evaluated with an apply object that only has a stack
+  CIccApplyMpeCalculator eval(m_pCalc);
+  eval.m_progStack = (icFloatNumber*)calloc(nSlots, sizeof(icFloatNumber));
+  if (!eval.m_progStack)
+    return false;
+
+  for (i=0; i<nInst; i++) {
+    SIccCalcInst *p = &prog[i];
+    icUInt32Number a = p->a;
+
+    if (target[i])
+      std::fill(known.begin(), known.end(), false);
+
+    switch (p->code) {
+      case icCalcInstConst:
+        known[a] = true;
+        val[a] = p->v;
+        continue;
+
+      case icCalcInstEnvVar:
+        {
+          icSigCmmEnvVar sig = (icSigCmmEnvVar)p->b;
+          icFloatNumber v=0.0;
+
+          known[a] = known[a+1] = true;
+          if (sig==icSigTrueVar) {
+            val[a] = val[a+1] = (icFloatNumber)1.0;
+          }
+          else if (sig==icSigNotDefVar) {
+            val[a] = val[a+1] = (icFloatNumber)0.0;
+          }
+          else if (!pLookup) {
+            val[a] = val[a+1] = (icFloatNumber)0.0;
+          }
+          else if (pLookup->GetEnvVar(sig, v)) {
+            val[a] = v;
+            val[a+1] = (icFloatNumber)1.0;
+          }
+          else {
+            val[a] = val[a+1] = (icFloatNumber)0.0;
+          }
+        }
+        continue;
+
+      case icCalcInstJumpIfNot:
+        if (known[a]) {
+          p->b = val[a]>=0.5 ? i+1 : p->b;
+          p->code = icCalcInstJump;
+          p->nUsed = 0;
+          bChanged = true;
+        }
+        continue;
+
+      case icCalcInstSelect:
+        if (known[a]) {
+          p->b = jumps[p->b + icCalcSelectCase(val[a], p->n)];
+          p->code = icCalcInstJump;
+          p->nUsed = 0;
+          bChanged = true;
+        }
+        continue;
+
+      case icCalcInstJump:
+        continue;
+
+      case icCalcInstAdd:
+      case icCalcInstSubtract:
+      case icCalcInstMultiply:
+      case icCalcInstDivide:
+      case icCalcInstScalarAdd:
+      case icCalcInstScalarSubtract:
+      case icCalcInstScalarMultiply:
+      case icCalcInstScalarDivide:
+        {
+          //x+(-0), x-(+0), x*1 and x/1 are exactly x
+          bool bScalar = p->code>=icCalcInstScalarAdd;
+          icUInt32Number nArg = bScalar ? 1 : p->n;
+          icFloatNumber id = (p->code==icCalcInstAdd || p->code==icCalcInstScalarAdd) ? negZero :
+                             (p->code==icCalcInstSubtract || p->code==icCalcInstScalarSubtract) ? posZero : one;
+
+          if (icCalcAllKnown(known, val, a+p->n, nArg, id)) {
+            p->code = icCalcInstJump;
+            p->b = i+1;
+            p->nUsed = p->nPushed = 0;
+            bChanged = true;
+            continue;
+          }
+        }
+        break;
+
+      default:
+        break;
+    }
+
+    bool bKnown = icCalcInstIsFoldable(p->code);
+    for (k=0; bKnown && k<p->nUsed; k++) {
+      if (!known[a+k])
+        bKnown = false;
+    }
+
+    if (bKnown && a+p->nUsed<=nSlots && a+p->nPushed<=nSlots) {
+      for (k=0; k<p->nUsed; k++)
+        eval.m_progStack[a+k] = val[a+k];
+
+      SIccCalcInst fold = *p;
+      if (ExecProgram(&eval, &fold, 1, 0)) {
+        for (k=0; k<p->nPushed; k++) {
+          known[a+k] = true;
+          val[a+k] = eval.m_progStack[a+k];
+        }
+
+        if (p->nPushed==1) {
+          p->code = icCalcInstConst;
+          p->v = val[a];
+          p->n = p->b = p->c = 0;
+          p->nUsed = 0;
+          bChanged = true;
+        }
+        continue;
+      }
+    }
+
+    for (k=0; k<p->nPushed && a+k<nSlots; k++)
+      known[a+k] = false;
+  }
+
+  return bChanged;
+}
+
+/**
+ ******************************************************************************
+ * Name: CIccCalculatorFunc::OptimizeProgram
+ * 
+ * Purpose: 
+ *  Removes work from a compiled program that doesn't depend on the pixel
+ *  being processed.  Constants are folded by FoldConstants() after which
+ *  unreachable instructions, instructions whose results are never used
+ *  and jumps to the next instruction are removed.  This is repeated until
+ *  nothing changes.  Results of the optimized program are identical to
+ *  those of the operations.
+ * 
+ * Args: 
+ *  prog = compiled program (stack positions include the scratch space)
+ *  jumps = select jump table of program
+ *  nScratch = number of scratch positions in front of the stack
+ *  nSlots = size of program stack
+ * 
+ * Return: 
+ *  number of instructions removed
+ ******************************************************************************/
+icUInt32Number CIccCalculatorFunc::OptimizeProgram(std::vector<SIccCalcInst> &prog, std::vector<icUInt32Number> &jumps,
+                                                   icUInt32Number nScratch, icUInt32Number nSlots)
+{
+  icUInt32Number nStartInst = (icUInt32Number)prog.size();
+  icUInt32Number i, k, nPass;
+
+  for (nPass=0; nPass<icCalcOptimizePasses; nPass++) {
+    bool bChanged = FoldConstants(prog, jumps, nScratch, nSlots);
+    icUInt32Number nInst = (icUInt32Number)prog.size();
+    std::vector<bool> reach(nInst+1, false), keep(nInst, false), isTarget(nInst+1, false);
+
+    //Find reachable instructions (all jumps are forward)
+    reach[0] = true;
+    for (i=0; i<nInst; i++) {
+      const SIccCalcInst *p = &prog[i];
+
+      if (p->code==icCalcInstSelect) {
+        for (k=0; k<=p->n; k++)
+          isTarget[jumps[p->b+k]] = true;
+      }
+      else if (p->code==icCalcInstJump || p->code==icCalcInstJumpIfNot)
+        isTarget[p->b] = true;
+
+      if (!reach[i])
+        continue;
+
+      if (p->code==icCalcInstSelect) {
+        for (k=0; k<=p->n; k++)
+          reach[jumps[p->b+k]] = true;
+      }
+      else {
+        if (p->code!=icCalcInstJump)
+          reach[i+1] = true;
+        if (p->code==icCalcInstJump || p->code==icCalcInstJumpIfNot)
+          reach[p->b] = true;
+      }
+    }
+
+    //Backwards pass keeping instructions with side effects or used results
+    std::vector<bool> live(nSlots, false), out(nSlots);
+    std::map<icUInt32Number, std::vector<bool> > targetLive;
+
+    for (i=nInst; i>0;) {
+      i--;
+      const SIccCalcInst *p = &prog[i];
+
+      if (!reach[i])
+        continue;
+
+      //Values used by the instructions that can follow
+      if (p->code==icCalcInstJump || p->code==icCalcInstSelect)
+        std::fill(out.begin(), out.end(), false);
+      else
+        out = live;
+
+      if (p->code==icCalcInstJump || p->code==icCalcInstJumpIfNot) {
+        if (p->b<nInst) {
+          const std::vector<bool> &t = targetLive[p->b];
+          for (k=0; k<(icUInt32Number)t.size(); k++)
+            if (t[k]) out[k] = true;
+        }
+      }
+      else if (p->code==icCalcInstSelect) {
+        for (icUInt32Number c=0; c<=p->n; c++) {
+          if (jumps[p->b+c]<nInst) {
+            const std::vector<bool> &t = targetLive[jumps[p->b+c]];
+            for (k=0; k<(icUInt32Number)t.size(); k++)
+              if (t[k]) out[k] = true;
+          }
+        }
+      }
+
+      bool bUsed = !icCalcInstIsRemovable(p->code);
+      for (k=0; !bUsed && k<p->nPushed; k++) {
+        if (out[p->a+k])
+          bUsed = true;
+      }
+
+      live = out;
+      if (bUsed) {
+        keep[i] = true;
+        for (k=0; k<p->nPushed; k++)
+          live[p->a+k] = false;
+        for (k=0; k<p->nUsed; k++)
+          live[p->a+k] = true;
+      }
+
+      if (isTarget[i])
+        targetLive[i] = live;
+    }
+
+    //Remove jumps to the instruction that follows them
+    std::vector<icUInt32Number> newIdx(nInst+1);
+    bool bRemoved;
+    do {
+      icUInt32Number nCount = 0;
+      for (i=0; i<nInst; i++) {
+        newIdx[i] = nCount;
+        if (keep[i])
+          nCount++;
+      }
+      newIdx[nInst] = nCount;
+
+      bRemoved = false;
+      for (i=0; i<nInst; i++) {
+        const SIccCalcInst *p = &prog[i];
+        if (keep[i] && (p->code==icCalcInstJump || p->code==icCalcInstJumpIfNot) && newIdx[p->b]==newIdx[i]+1) {
+          keep[i] = false;
+          bRemoved = true;
+        }
+      }
+    } while (bRemoved);
+
+    std::vector<SIccCalcInst> newProg;
+    for (i=0; i<nInst; i++) {
+      if (keep[i]) {
+        SIccCalcInst inst = prog[i];
+        if (inst.code==icCalcInstJump || inst.code==icCalcInstJumpIfNot)
+          inst.b = newIdx[inst.b];
+        newProg.push_back(inst);
+      }
+    }
+    for (k=0; k<(icUInt32Number)jumps.size(); k++)
+      jumps[k] = newIdx[jumps[k]];
+
+    if (newProg.size()!=prog.size())
+      bChanged = true;
+
+    prog.swap(newProg);
+
+    if (!bChanged)
+      break;
+  }
+
+  return nStartInst - (icUInt32Number)prog.size();
+}
+
+/**
+ ******************************************************************************
+ * Name: CIccCalculatorFunc::Compile
+ * 
+ * Purpose: 
+ *  Compiles the operations of the function into a program of instructions
+ *  with fixed stack positions.  Apply() executes the program instead of
+ *  interpreting the operations unless a calculator debugger is set.
+ *  Functions that cannot be compiled are always interpreted.
+ * 
+ * Return: 
+ *  true if the function was compiled
+ ******************************************************************************/
+bool CIccCalculatorFunc::Compile()
+{
+  std::vector<SIccCalcInst> prog;
+  std::vector<icUInt32Number> jumps;
+  icUInt32Number nDepth=0, nMaxDepth=0, nScratch=0, i;
+
+  FreeProgram();
+
+  if (!m_Op || !m_pCalc)
+    return false;
+
+  if (!CompileSequence(m_nOps, m_Op, nDepth, nMaxDepth, nScratch, prog, jumps))
+    return false;
+
+  //Scratch space is placed in front of the stack
+  for (i=0; i<(icUInt32Number)prog.size(); i++)
+    prog[i].a += nScratch;
+
+  m_nRemovedInst = OptimizeProgram(prog, jumps, nScratch, nScratch + nMaxDepth + 1);
+
+  m_Inst = (SIccCalcInst*)malloc((prog.size()+1)*sizeof(SIccCalcInst));
+  m_Jump = (icUInt32Number*)malloc((jumps.size()+1)*sizeof(icUInt32Number));
+
+  if (!m_Inst || !m_Jump) {
+    FreeProgram();
+    return false;
+  }
+
+  if (prog.size())
+    memcpy(m_Inst, &prog[0], prog.size()*sizeof(SIccCalcInst));
+  if (jumps.size())
+    memcpy(m_Jump, &jumps[0], jumps.size()*sizeof(icUInt32Number));
+
+  m_nInst = (icUInt32Number)prog.size();
+  m_nProgStack = nScratch + nMaxDepth + 1;
+
+  return true;
+}
+
+/**
+ ******************************************************************************
+ * Name: CIccCalculatorFunc::FreeProgram
+ * 
+ * Purpose: Releases the compiled program
+ ******************************************************************************/
+void CIccCalculatorFunc::FreeProgram()
+{
+  if (m_Inst)
+    free(m_Inst);
+  if (m_Jump)
+    free(m_Jump);
+
+  m_Inst = NULL;
+  m_Jump = NULL;
+  m_nInst = 0;
+  m_nProgStack = 0;
+  m_nRemovedInst = 0;
+}
+
+/**
+ ******************************************************************************
+ * Name: CIccCalculatorFunc::ExecProgram
+ * 
+ * Purpose: 
+ *  Executes a compiled program.  Each instruction does the same
+ *  calculation as the Exec() of its operation definition on the fixed
+ *  stack positions found by Compile().  ApplyProgram() executes the
+ *  program of the function.
+ * 
+ * Args: 
+ *  pApply = apply object with input, output, temp and program stack
+ *  inst = instructions to execute
+ *  nInst = number of instructions
+ *  nStart = index of first instruction to execute
+ * 
+ * Return: 
+ *  true if successful
+ ******************************************************************************/
+bool CIccCalculatorFunc::ExecProgram(CIccApplyMpeCalculator *pApply, const SIccCalcInst *inst, icUInt32Number nInst,
+                                     icUInt32Number nStart) const
+{
+  icFloatNumber *S = pApply->GetProgramStack();
+  const icFloatNumber *pixel = pApply->GetInput();
+  icFloatNumber *output = pApply->GetOutput();
+  icFloatNumber *pTemp = pApply->GetTemp();
+  icUInt32Number pc = nStart;
+  int j, n;
+
+  while (pc<nInst) {
+    const SIccCalcInst *p = &inst[pc++];
+    icFloatNumber *s = S + p->a;
+
+    switch (p->code) {
+      case icCalcInstConst:
+        s[0] = p->v;
+        break;
+
+      case icCalcInstIn:
+        memcpy(s, &pixel[p->b], p->n*sizeof(icFloatNumber));
+        break;
+
+      case icCalcInstOut:
+        memcpy(&output[p->b], s, p->n*sizeof(icFloatNumber));
+        break;
+
+      case icCalcInstTempGet:
+        memcpy(s, &pTemp[p->b], p->n*sizeof(icFloatNumber));
+        break;
+
+      case icCalcInstTempPut:
+        memcpy(&pTemp[p->b], s, p->n*sizeof(icFloatNumber));
+        break;
+
+      case icCalcInstEnvVar:
+        {
+          icSigCmmEnvVar sig = (icSigCmmEnvVar)p->b;
+          icFloatNumber val=0.0;
+
+          if (sig==icSigTrueVar) {
+            s[0] = (icFloatNumber)1.0;
+            s[1] = (icFloatNumber)1.0;
+          }
+          else if (sig==icSigNotDefVar) {
+            s[0] = (icFloatNumber)0.0;
+            s[1] = (icFloatNumber)0.0;
+          }
+          else if (pApply->GetEnvVar(sig, val)) {
+            s[0] = (icFloatNumber)val;
+            s[1] = (icFloatNumber)1.0;
+          }
+          else {
+            s[0] = (icFloatNumber)0.0;
+            s[1] = (icFloatNumber)0.0;
+          }
+        }
+        break;
+
+      case icCalcInstSubElem:
+        {
+          CIccSubCalcApply *pElemApply = pApply->GetApply((icUInt16Number)p->b);
+          if (!pElemApply)
+            return false;
+
+          pElemApply->Apply(S, s);
+          memcpy(s, S, p->c*sizeof(icFloatNumber));
+        }
+        break;
+
+      case icCalcInstCopy:
+        {
+          icFloatNumber *to = s + p->n;
+          for (j=0; j<(int)p->c; j++) {
+            memcpy(to, s, p->n*sizeof(icFloatNumber));
+            to += p->n;
+          }
+        }
+        break;
+
+      case icCalcInstPositionDup:
+        for (j=0; j<(int)p->c; j++)
+          s[p->n + j] = s[0];
+        break;
+
+      case icCalcInstFlip:
+        {
+          icFloatNumber t;
+          int k;
+          for (j=0, k=(int)p->n-1; j<k; j++, k--) {
+            t = s[j];
+            s[j] = s[k];
+            s[k] = t;
+          }
+        }
+        break;
+
+      case icCalcInstRotateLeft:
+        n = (int)p->n;
+        memcpy(S, s, n*sizeof(icFloatNumber));
+        for (j=0; j<n; j++)
+          s[j] = S[(j+p->c)%n];
+        break;
+
+      case icCalcInstRotateRight:
+        n = (int)p->n;
+        memcpy(S, s, n*sizeof(icFloatNumber));
+        for (j=0; j<n; j++)
+          s[j] = S[(j+n-p->c)%n];
+        break;
+
+      case icCalcInstTranspose:
+        {
+          int r = (int)p->n, c = (int)p->c, k;
+
+          if (r>1 && c>1) {
+            icFloatNumber *start = s;
+            icFloatNumber *to = S;
+
+            for (k=0; k<c; k++) {
+              icFloatNumber *from = start;
+              for (j=0; j<r; j++) {
+                *to++ = *from;
+                from += c;
+              }
+              start++;
+            }
+            memcpy(s, S, r*c*sizeof(icFloatNumber));
+          }
+        }
+        break;
+
+      case icCalcInstSolve:
+        {
+          int r = (int)p->n, c = (int)p->c;
+
+          if (r>1 && c>1) {
+            icFloatNumber *x = S;
+            icFloatNumber *mtx = s;
+            icFloatNumber *y = &s[r*c];
+
+            bool bResult = false;
+
+            if (g_pIccMatrixSolver) {
+              bResult = g_pIccMatrixSolver->Solve(x, mtx, y, r, c);
+            }
+            if (bResult) {
+              memcpy(s, x, c*sizeof(icFloatNumber));
+              s[c] = 1.0;
+            }
+            else {
+              memset(s, 0, c*sizeof(icFloatNumber));
+              s[c] = 0.0;
+            }
+          }
+        }
+        break;
+
+      case icCalcInstSum:
+        n = (int)p->n;
+        if (n==2) {
+          s[0] += s[1];
+        }
+        else {
+          for (j=1; j<n; j++) {
+            s[0] += s[j];
+          }
+        }
+        break;
+
+      case icCalcInstProduct:
+        n = (int)p->n;
+        if (n==2) {
+          s[0] *= s[1];
+        }
+        else {
+          for (j=1; j<n; j++) {
+            s[0] *= s[j];
+          }
+        }
+        break;
+
+      case icCalcInstMinimum:
+        n = (int)p->n;
+        if (n==2) {
+          s[0] = icMin(s[0], s[1]);
+        }
+        else {
+          icFloatNumber mv = s[0];
+          for (j=1; j<n; j++) {
+            if (s[j]<mv)
+              mv = s[j];
+          }
+          s[0] = mv;
+        }
+        break;
+
+      case icCalcInstMaximum:
+        n = (int)p->n;
+        if (n==2) {
+          s[0] = icMax(s[0], s[1]);
+        }
+        else {
+          icFloatNumber mv = s[0];
+          for (j=1; j<n; j++) {
+            if (s[j]>mv)
+              mv = s[j];
+          }
+          s[0] = mv;
+        }
+        break;
+
+      case icCalcInstAnd:
+        n = (int)p->n;
+        for (j=0; j<n; j++) {
+          if (s[j]<0.5f)
+            break;
+        }
+        s[0] = j<n ? 0.0f : 1.0f;
+        break;
+
+      case icCalcInstOr:
+        n = (int)p->n;
+        for (j=0; j<n; j++) {
+          if (s[j]>=0.5f)
+            break;
+        }
+        s[0] = j<n ? 1.0f : 0.0f;
+        break;
+
+      case icCalcInstVectorMinimum:
+        n = (int)p->n;
+        for (j=0; j<n; j++)
+          s[j] = icMin(s[j], s[j+n]);
+        break;
+
+      case icCalcInstVectorMaximum:
+        n = (int)p->n;
+        for (j=0; j<n; j++)
+          s[j] = icMax(s[j], s[j+n]);
+        break;
+
+      case icCalcInstVectorAnd:
+        n = (int)p->n;
+        for (j=0; j<n; j++)
+          s[j] = (s[j]>=0.5f && s[j+n]>=0.5) ? 1.0f : 0.0f;
+        break;
+
+      case icCalcInstVectorOr:
+        n = (int)p->n;
+        for (j=0; j<n; j++)
+          s[j] = (s[j]>=0.5f || s[j+n]>=0.5) ? 1.0f : 0.0f;
+        break;
+
+      case icCalcInstAdd:
+        n = (int)p->n;
+        for (j=0; j<n; j++)
+          s[j] += s[j+n];
+        break;
+
+      case icCalcInstSubtract:
+        n = (int)p->n;
+        for (j=0; j<n; j++)
+          s[j] -= s[j+n];
+        break;
+
+      case icCalcInstMultiply:
+        n = (int)p->n;
+        for (j=0; j<n; j++)
+          s[j] *= s[j+n];
+        break;
+
+      case icCalcInstDivide:
+        n = (int)p->n;
+        for (j=0; j<n; j++)
+          s[j] /= s[j+n];
+        break;
+
+      case icCalcInstModulus:
+        {
+          const icFloatNumber epsilon = 1e-12;
+          n = (int)p->n;
+          for (j=0; j<n; j++) {
+            icFloatNumber temp = s[j];
+            icFloatNumber tempN = s[j+n];
+            if (std::isnan(temp) || std::isinf(temp)
+              || std::isnan(tempN) || std::isinf(tempN) || fabs(tempN) < epsilon)
+              s[j] = 0.0;
+            else
+              s[j] = temp - (icFloatNumber)((int)(temp / tempN))*tempN;
+          }
+        }
+        break;
+
+      case icCalcInstPow:
+        n = (int)p->n;
+        for (j=0; j<n; j++)
+          s[j] = (icFloatNumber)pow(s[j], s[j+n]);
+        break;
+
+      case icCalcInstGamma:
+        {
+          n = (int)p->n;
+          icFloatNumber e = s[n];
+          for (j=0; j<n; j++)
+            s[j] = (icFloatNumber)pow(s[j], e);
+        }
+        break;
+
+      case icCalcInstScalarAdd:
+        {
+          n = (int)p->n;
+          icFloatNumber e = s[n];
+          for (j=0; j<n; j++)
+            s[j] = s[j] + e;
+        }
+        break;
+
+      case icCalcInstScalarSubtract:
+        {
+          n = (int)p->n;
+          icFloatNumber e = s[n];
+          for (j=0; j<n; j++)
+            s[j] = s[j] - e;
+        }
+        break;
+
+      case icCalcInstScalarMultiply:
+        {
+          n = (int)p->n;
+          icFloatNumber e = s[n];
+          for (j=0; j<n; j++)
+            s[j] = s[j] * e;
+        }
+        break;
+
+      case icCalcInstScalarDivide:
+        {
+          n = (int)p->n;
+          icFloatNumber e = s[n];
+          for (j=0; j<n; j++)
+            s[j] = s[j] / e;
+        }
+        break;
+
+      case icCalcInstSquare:
+        for (j=0; j<(int)p->n; j++)
+          s[j] = s[j]*s[j];
+        break;
+
+      case icCalcInstSquareRoot:
+        for (j=0; j<(int)p->n; j++)
+          s[j] = (icFloatNumber)sqrt(s[j]);
+        break;
+
+      case icCalcInstCube:
+        for (j=0; j<(int)p->n; j++)
+          s[j] = s[j]*s[j]*s[j];
+        break;
+
+      case icCalcInstCubeRoot:
+        for (j=0; j<(int)p->n; j++)
+          s[j] = (icFloatNumber)ICC_CBRTF(s[j]);
+        break;
+
+      case icCalcInstSign:
+        for (j=0; j<(int)p->n; j++)
+          s[j] = (icFloatNumber)(s[j] < 0 ? -1 : (s[j] > 0 ? 1 : 0));
+        break;
+
+      case icCalcInstAbsoluteVal:
+        for (j=0; j<(int)p->n; j++)
+          s[j] = (s[j] < 0 ? -s[j] : s[j]);
+        break;
+
+      case icCalcInstTruncate:
+        for (j=0; j<(int)p->n; j++) {
+          icFloatNumber temp = s[j];
+          if (std::isnan(temp))
+            s[j] = 0.0;
+          else if (std::isinf(temp)) {
+            if (temp > 0.0)
+              s[j] = (icFloatNumber)std::numeric_limits<int>::max();
+            else
+              s[j] = (icFloatNumber)std::numeric_limits<int>::lowest();
+          }
+          else
+            s[j] = (icFloatNumber)((int)temp);
+        }
+        break;
+
+      case icCalcInstFloor:
+        for (j=0; j<(int)p->n; j++)
+          s[j] = (icFloatNumber)floor(s[j]);
+        break;
+
+      case icCalcInstCeiling:
+        for (j=0; j<(int)p->n; j++)
+          s[j] = (icFloatNumber)ceil(s[j]);
+        break;
+
+      case icCalcInstRound:
+        for (j=0; j<(int)p->n; j++) {
+          icFloatNumber temp = s[j];
+          if (std::isnan(temp))
+            temp = 0.0;
+          else if (std::isinf(temp))
+            temp = 10000.0;
+          if (temp < 0.0)
+            s[j] = icFloatNumber((int)(temp-0.5));
+          else
+            s[j] = icFloatNumber((int)(temp+0.5));
+        }
+        break;
+
+      case icCalcInstExp:
+        for (j=0; j<(int)p->n; j++)
+          s[j] = (icFloatNumber)exp(s[j]);
+        break;
+
+      case icCalcInstLogrithm:
+        for (j=0; j<(int)p->n; j++)
+          s[j] = (icFloatNumber)log10(s[j]);
+        break;
+
+      case icCalcInstNaturalLog:
+        for (j=0; j<(int)p->n; j++)
+          s[j] = (icFloatNumber)log(s[j]);
+        break;
+
+      case icCalcInstSine:
+        for (j=0; j<(int)p->n; j++)
+          s[j] = (icFloatNumber)sin(s[j]);
+        break;
+
+      case icCalcInstCosine:
+        for (j=0; j<(int)p->n; j++)
+          s[j] = (icFloatNumber)cos(s[j]);
+        break;
+
+      case icCalcInstTangent:
+        for (j=0; j<(int)p->n; j++)
+          s[j] = (icFloatNumber)tan(s[j]);
+        break;
+
+      case icCalcInstArcSine:
+        for (j=0; j<(int)p->n; j++)
+          s[j] = (icFloatNumber)asin(s[j]);
+        break;
+
+      case icCalcInstArcCosine:
+        for (j=0; j<(int)p->n; j++)
+          s[j] = (icFloatNumber)acos(s[j]);
+        break;
+
+      case icCalcInstArcTangent:
+        for (j=0; j<(int)p->n; j++)
+          s[j] = (icFloatNumber)atan(s[j]);
+        break;
+
+      case icCalcInstArcTan2:
+        n = (int)p->n;
+        for (j=0; j<n; j++)
+          s[j] = (icFloatNumber)atan2(s[j+n], s[j]);
+        break;
+
+      case icCalcInstCartesianToPolar:
+        n = (int)p->n;
+        for (j=0; j<n; j++) {
+          icFloatNumber a1 = s[j];
+          icFloatNumber a2 = s[j+n];
+          s[j] = (icFloatNumber)sqrt(a2*a2 + a1*a1);
+          icFloatNumber h = (icFloatNumber)atan2(a2, a1) * 180.0f / (icFloatNumber)icPiNum;
+          if (h<0.0f)
+            h += 360.0f;
+          s[j+n] = h;
+        }
+        break;
+
+      case icCalcInstPolarToCartesian:
+        n = (int)p->n;
+        for (j=0; j<n; j++) {
+          icFloatNumber a1 = s[j];
+          icFloatNumber a2 = s[j+n] * (icFloatNumber)icPiNum / 180.0f;
+
+          s[j] = a1 * (icFloatNumber)cos(a2);
+          s[j+n] = a1 * (icFloatNumber)sin(a2);
+        }
+        break;
+
+      case icCalcInstRealNumber:
+        {
+          icFloatNumber nan = icNotANumber;
+          for (j=0; j<(int)p->n; j++) {
+            icFloatNumber a1 = s[j];
+            if (a1==icPosInfinity || a1==icNegInfinity || !memcmp(&a1,&nan, sizeof(nan)))
+              s[j] = 0.0;
+            else
+              s[j] = 1.0;
+          }
+        }
+        break;
+
+      case icCalcInstLessThan:
+        n = (int)p->n;
+        for (j=0; j<n; j++)
+          s[j] = (s[j] < s[j+n] ? (icFloatNumber)1.0 : (icFloatNumber)0.0);
+        break;
+
+      case icCalcInstLessThanEqual:
+        n = (int)p->n;
+        for (j=0; j<n; j++)
+          s[j] = (s[j] <= s[j+n] ? (icFloatNumber)1.0 : (icFloatNumber)0.0);
+        break;
+
+      case icCalcInstEqual:
+      case icCalcInstNotEqual:
+        {
+          icFloatNumber nan = icNotANumber;
+          icFloatNumber t = p->code==icCalcInstEqual ? (icFloatNumber)1.0 : (icFloatNumber)0.0;
+          icFloatNumber f = p->code==icCalcInstEqual ? (icFloatNumber)0.0 : (icFloatNumber)1.0;
+          n = (int)p->n;
+          for (j=0; j<n; j++) {
+            icFloatNumber a1 = s[j];
+            icFloatNumber a2 = s[j+n];
+            s[j] = (a1 == a2 ? t :
+                     ((!memcmp(&a1, &nan, sizeof(icFloatNumber)) && !memcmp(&a1, &a2, sizeof(a1))) ? t : f));
+          }
+        }
+        break;
+
+      case icCalcInstNear:
+        n = (int)p->n;
+        for (j=0; j<n; j++)
+          s[j] = (fabs(s[j]-s[j+n])<1.0e-5 ? (icFloatNumber)1.0 : (icFloatNumber)0.0);
+        break;
+
+      case icCalcInstGreaterThanEqual:
+        n = (int)p->n;
+        for (j=0; j<n; j++)
+          s[j] = (s[j] >= s[j+n] ? (icFloatNumber)1.0 : (icFloatNumber)0.0);
+        break;
+
+      case icCalcInstGreaterThan:
+        n = (int)p->n;
+        for (j=0; j<n; j++)
+          s[j] = (s[j] > s[j+n] ? (icFloatNumber)1.0 : (icFloatNumber)0.0);
+        break;
+
+      case icCalcInstNot:
+        for (j=0; j<(int)p->n; j++)
+          s[j] = (s[j] >= (icFloatNumber)0.5 ? (icFloatNumber)0.0 : (icFloatNumber)1.0);
+        break;
+
+      case icCalcInstNeg:
+        for (j=0; j<(int)p->n; j++)
+          s[j] = -s[j];
+        break;
+
+      case icCalcInstToLab:
+        {
+          n = (int)p->n;
+          int n2 = n+n;
+          for (j=0; j<n; j++) {
+            icFloatNumber a1 = icCubeth(s[j]);
+            icFloatNumber a2 = icCubeth(s[j+n]);
+            icFloatNumber a3 = icCubeth(s[j+n2]);
+
+            s[j] = (icFloatNumber)(116.0 * a2 - 16.0);
+            s[j+n] = (icFloatNumber)(500.0 * (a1 - a2));
+            s[j+n2] = (icFloatNumber)(200.0 * (a2 - a3));
+          }
+        }
+        break;
+
+      case icCalcInstToXYZ:
+        {
+          n = (int)p->n;
+          int n2 = n+n;
+          for (j=0; j<n; j++) {
+            icFloatNumber a1 = s[j];
+            icFloatNumber a2 = s[j+n];
+            icFloatNumber a3 = s[j+n2];
+
+            icFloatNumber fy = (icFloatNumber)((a1 + 16.0f) / 116.0f);
+
+            s[j] = icICubeth((icFloatNumber)(a2/500.0 + fy));
+            s[j+n] = icICubeth(fy);
+            s[j+n2] = icICubeth((icFloatNumber)(fy - a3/200.0));
+          }
+        }
+        break;
+
+      case icCalcInstJump:
+        pc = p->b;
+        break;
+
+      case icCalcInstJumpIfNot:
+        if (!(s[0]>=0.5))
+          pc = p->b;
+        break;
+
+      case icCalcInstSelect:
+        pc = m_Jump[p->b + icCalcSelectCase(s[0], p->n)];
+        break;
+
+      default:
+        return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ ******************************************************************************
+ * Name: CIccCalculatorFunc::ApplyProgramLanes
+ * 
+ * Purpose: 
+ *  Executes the compiled program for nLanes pixels at once.  Each row of
+ *  the lane stack, input, output and temp storage holds one value for
+ *  every lane so instructions work on whole rows.  When lanes take
+ *  different branches the remaining instructions are executed for one
+ *  lane at a time with ApplyProgramFromLanes().
+ * 
+ * Args: 
+ *  pApply = apply object with lane storage
+ *  nLanes = number of lanes (1 to icCalcLanes)
+ * 
+ * Return: 
+ *  true if successful
+ ******************************************************************************/
+bool CIccCalculatorFunc::ApplyProgramLanes(CIccApplyMpeCalculator *pApply, icUInt32Number nLanes) const
+{
+  icFloatNumber *V = pApply->GetLaneStack();
+  icFloatNumber *S = pApply->GetProgramStack();
+  const icFloatNumber *pixel = pApply->GetLaneInput();
+  icFloatNumber *output = pApply->GetLaneOutput();
+  icFloatNumber *pTemp = pApply->GetLaneTemp();
+  const SIccCalcInst *inst = m_Inst;
+  const icUInt32Number nInst = m_nInst;
+  const int L = (int)nLanes;
+  icUInt32Number pc = 0;
+  int j, k, l, n;
+
+  while (pc<nInst) {
+    const SIccCalcInst *p = &inst[pc++];
+    icFloatNumber *s = V + p->a*L;
+
+    switch (p->code) {
+      case icCalcInstConst:
+        for (l=0; l<L; l++)
+          s[l] = p->v;
+        break;
+
+      case icCalcInstIn:
+        memcpy(s, &pixel[p->b*L], p->n*L*sizeof(icFloatNumber));
+        break;
+
+      case icCalcInstOut:
+        memcpy(&output[p->b*L], s, p->n*L*sizeof(icFloatNumber));
+        break;
+
+      case icCalcInstTempGet:
+        memcpy(s, &pTemp[p->b*L], p->n*L*sizeof(icFloatNumber));
+        break;
+
+      case icCalcInstTempPut:
+        memcpy(&pTemp[p->b*L], s, p->n*L*sizeof(icFloatNumber));
+        break;
+
+      case icCalcInstEnvVar:
+        {
+          icSigCmmEnvVar sig = (icSigCmmEnvVar)p->b;
+          icFloatNumber val=0.0, v0, v1;
+
+          if (sig==icSigTrueVar) {
+            v0 = (icFloatNumber)1.0;
+            v1 = (icFloatNumber)1.0;
+          }
+          else if (sig==icSigNotDefVar) {
+            v0 = (icFloatNumber)0.0;
+            v1 = (icFloatNumber)0.0;
+          }
+          else if (pApply->GetEnvVar(sig, val)) {
+            v0 = (icFloatNumber)val;
+            v1 = (icFloatNumber)1.0;
+          }
+          else {
+            v0 = (icFloatNumber)0.0;
+            v1 = (icFloatNumber)0.0;
+          }
+          for (l=0; l<L; l++) {
+            s[l] = v0;
+            s[L+l] = v1;
+          }
+        }
+        break;
+
+      case icCalcInstSubElem:
+        {
+          CIccSubCalcApply *pElemApply = pApply->GetApply((icUInt16Number)p->b);
+          if (!pElemApply)
+            return false;
+
+          //Arguments are placed after the results in the scalar program stack
+          icFloatNumber *pArgs = S + p->c;
+          for (l=0; l<L; l++) {
+            for (j=0; j<(int)p->n; j++)
+              pArgs[j] = s[j*L+l];
+            pElemApply->Apply(S, pArgs);
+            for (j=0; j<(int)p->c; j++)
+              s[j*L+l] = S[j];
+          }
+        }
+        break;
+
+      case icCalcInstCopy:
+        {
+          n = (int)p->n*L;
+          icFloatNumber *to = s + n;
+          for (j=0; j<(int)p->c; j++) {
+            memcpy(to, s, n*sizeof(icFloatNumber));
+            to += n;
+          }
+        }
+        break;
+
+      case icCalcInstPositionDup:
+        for (j=0; j<(int)p->c; j++)
+          memcpy(&s[(p->n+j)*L], s, L*sizeof(icFloatNumber));
+        break;
+
+      case icCalcInstFlip:
+        {
+          icFloatNumber t;
+          int m;
+          for (j=0, m=(int)p->n-1; j<m; j++, m--) {
+            for (l=0; l<L; l++) {
+              t = s[j*L+l];
+              s[j*L+l] = s[m*L+l];
+              s[m*L+l] = t;
+            }
+          }
+        }
+        break;
+
+      case icCalcInstRotateLeft:
+        n = (int)p->n;
+        memcpy(V, s, n*L*sizeof(icFloatNumber));
+        for (j=0; j<n; j++)
+          memcpy(&s[j*L], &V[((j+p->c)%n)*L], L*sizeof(icFloatNumber));
+        break;
+
+      case icCalcInstRotateRight:
+        n = (int)p->n;
+        memcpy(V, s, n*L*sizeof(icFloatNumber));
+        for (j=0; j<n; j++)
+          memcpy(&s[j*L], &V[((j+n-p->c)%n)*L], L*sizeof(icFloatNumber));
+        break;
+
+      case icCalcInstTranspose:
+        {
+          int r = (int)p->n, c = (int)p->c;
+
+          if (r>1 && c>1) {
+            icFloatNumber *to = V;
+
+            for (k=0; k<c; k++) {
+              for (j=0; j<r; j++) {
+                memcpy(to, &s[(j*c+k)*L], L*sizeof(icFloatNumber));
+                to += L;
+              }
+            }
+            memcpy(s, V, r*c*L*sizeof(icFloatNumber));
+          }
+        }
+        break;
+
+      case icCalcInstSolve:
+        {
+          int r = (int)p->n, c = (int)p->c;
+
+          if (r>1 && c>1) {
+            icFloatNumber *x = S;
+            icFloatNumber *mtx = S + c;
+            icFloatNumber *y = &mtx[r*c];
+
+            for (l=0; l<L; l++) {
+              for (j=0; j<r*c+r; j++)
+                mtx[j] = s[j*L+l];
+
+              bool bResult = false;
+
+              if (g_pIccMatrixSolver) {
+                bResult = g_pIccMatrixSolver->Solve(x, mtx, y, r, c);
+              }
+              if (bResult) {
+                for (j=0; j<c; j++)
+                  s[j*L+l] = x[j];
+                s[c*L+l] = 1.0;
+              }
+              else {
+                for (j=0; j<c; j++)
+                  s[j*L+l] = 0.0;
+                s[c*L+l] = 0.0;
+              }
+            }
+          }
+        }
+        break;
+
+      case icCalcInstSum:
+        n = (int)p->n;
+        for (j=1; j<n; j++) {
+          for (l=0; l<L; l++)
+            s[l] += s[j*L+l];
+        }
+        break;
+
+      case icCalcInstProduct:
+        n = (int)p->n;
+        for (j=1; j<n; j++) {
+          for (l=0; l<L; l++)
+            s[l] *= s[j*L+l];
+        }
+        break;
+
+      case icCalcInstMinimum:
+        n = (int)p->n;
+        if (n==2) {
+          for (l=0; l<L; l++)
+            s[l] = icMin(s[l], s[L+l]);
+        }
+        else {
+          for (l=0; l<L; l++) {
+            icFloatNumber mv = s[l];
+            for (j=1; j<n; j++) {
+              if (s[j*L+l]<mv)
+                mv = s[j*L+l];
+            }
+            s[l] = mv;
+          }
+        }
+        break;
+
+      case icCalcInstMaximum:
+        n = (int)p->n;
+        if (n==2) {
+          for (l=0; l<L; l++)
+            s[l] = icMax(s[l], s[L+l]);
+        }
+        else {
+          for (l=0; l<L; l++) {
+            icFloatNumber mv = s[l];
+            for (j=1; j<n; j++) {
+              if (s[j*L+l]>mv)
+                mv = s[j*L+l];
+            }
+            s[l] = mv;
+          }
+        }
+        break;
+
+      case icCalcInstAnd:
+        n = (int)p->n;
+        for (l=0; l<L; l++) {
+          for (j=0; j<n; j++) {
+            if (s[j*L+l]<0.5f)
+              break;
+          }
+          s[l] = j<n ? 0.0f : 1.0f;
+        }
+        break;
+
+      case icCalcInstOr:
+        n = (int)p->n;
+        for (l=0; l<L; l++) {
+          for (j=0; j<n; j++) {
+            if (s[j*L+l]>=0.5f)
+              break;
+          }
+          s[l] = j<n ? 1.0f : 0.0f;
+        }
+        break;
+
+      //The remaining instructions work on each value independently so
+      //the n rows of an argument are treated as a single vector of n*L values
+      case icCalcInstVectorMinimum:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = icMin(s[j], s[j+n]);
+        break;
+
+      case icCalcInstVectorMaximum:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = icMax(s[j], s[j+n]);
+        break;
+
+      case icCalcInstVectorAnd:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = (s[j]>=0.5f && s[j+n]>=0.5) ? 1.0f : 0.0f;
+        break;
+
+      case icCalcInstVectorOr:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = (s[j]>=0.5f || s[j+n]>=0.5) ? 1.0f : 0.0f;
+        break;
+
+      case icCalcInstAdd:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] += s[j+n];
+        break;
+
+      case icCalcInstSubtract:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] -= s[j+n];
+        break;
+
+      case icCalcInstMultiply:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] *= s[j+n];
+        break;
+
+      case icCalcInstDivide:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] /= s[j+n];
+        break;
+
+      case icCalcInstModulus:
+        {
+          const icFloatNumber epsilon = 1e-12;
+          n = (int)p->n*L;
+          for (j=0; j<n; j++) {
+            icFloatNumber temp = s[j];
+            icFloatNumber tempN = s[j+n];
+            if (std::isnan(temp) || std::isinf(temp)
+              || std::isnan(tempN) || std::isinf(tempN) || fabs(tempN) < epsilon)
+              s[j] = 0.0;
+            else
+              s[j] = temp - (icFloatNumber)((int)(temp / tempN))*tempN;
+          }
+        }
+        break;
+
+      case icCalcInstPow:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = (icFloatNumber)pow(s[j], s[j+n]);
+        break;
+
+      case icCalcInstGamma:
+        {
+          n = (int)p->n;
+          const icFloatNumber *e = &s[n*L];
+          for (j=0; j<n; j++) {
+            for (l=0; l<L; l++)
+              s[j*L+l] = (icFloatNumber)pow(s[j*L+l], e[l]);
+          }
+        }
+        break;
+
+      case icCalcInstScalarAdd:
+        {
+          n = (int)p->n;
+          const icFloatNumber *e = &s[n*L];
+          for (j=0; j<n; j++) {
+            for (l=0; l<L; l++)
+              s[j*L+l] = s[j*L+l] + e[l];
+          }
+        }
+        break;
+
+      case icCalcInstScalarSubtract:
+        {
+          n = (int)p->n;
+          const icFloatNumber *e = &s[n*L];
+          for (j=0; j<n; j++) {
+            for (l=0; l<L; l++)
+              s[j*L+l] = s[j*L+l] - e[l];
+          }
+        }
+        break;
+
+      case icCalcInstScalarMultiply:
+        {
+          n = (int)p->n;
+          const icFloatNumber *e = &s[n*L];
+          for (j=0; j<n; j++) {
+            for (l=0; l<L; l++)
+              s[j*L+l] = s[j*L+l] * e[l];
+          }
+        }
+        break;
+
+      case icCalcInstScalarDivide:
+        {
+          n = (int)p->n;
+          const icFloatNumber *e = &s[n*L];
+          for (j=0; j<n; j++) {
+            for (l=0; l<L; l++)
+              s[j*L+l] = s[j*L+l] / e[l];
+          }
+        }
+        break;
+
+      case icCalcInstSquare:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = s[j]*s[j];
+        break;
+
+      case icCalcInstSquareRoot:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = (icFloatNumber)sqrt(s[j]);
+        break;
+
+      case icCalcInstCube:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = s[j]*s[j]*s[j];
+        break;
+
+      case icCalcInstCubeRoot:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = (icFloatNumber)ICC_CBRTF(s[j]);
+        break;
+
+      case icCalcInstSign:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = (icFloatNumber)(s[j] < 0 ? -1 : (s[j] > 0 ? 1 : 0));
+        break;
+
+      case icCalcInstAbsoluteVal:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = (s[j] < 0 ? -s[j] : s[j]);
+        break;
+
+      case icCalcInstTruncate:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++) {
+          icFloatNumber temp = s[j];
+          if (std::isnan(temp))
+            s[j] = 0.0;
+          else if (std::isinf(temp)) {
+            if (temp > 0.0)
+              s[j] = (icFloatNumber)std::numeric_limits<int>::max();
+            else
+              s[j] = (icFloatNumber)std::numeric_limits<int>::lowest();
+          }
+          else
+            s[j] = (icFloatNumber)((int)temp);
+        }
+        break;
+
+      case icCalcInstFloor:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = (icFloatNumber)floor(s[j]);
+        break;
+
+      case icCalcInstCeiling:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = (icFloatNumber)ceil(s[j]);
+        break;
+
+      case icCalcInstRound:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++) {
+          icFloatNumber temp = s[j];
+          if (std::isnan(temp))
+            temp = 0.0;
+          else if (std::isinf(temp))
+            temp = 10000.0;
+          if (temp < 0.0)
+            s[j] = icFloatNumber((int)(temp-0.5));
+          else
+            s[j] = icFloatNumber((int)(temp+0.5));
+        }
+        break;
+
+      case icCalcInstExp:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = (icFloatNumber)exp(s[j]);
+        break;
+
+      case icCalcInstLogrithm:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = (icFloatNumber)log10(s[j]);
+        break;
+
+      case icCalcInstNaturalLog:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = (icFloatNumber)log(s[j]);
+        break;
+
+      case icCalcInstSine:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = (icFloatNumber)sin(s[j]);
+        break;
+
+      case icCalcInstCosine:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = (icFloatNumber)cos(s[j]);
+        break;
+
+      case icCalcInstTangent:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = (icFloatNumber)tan(s[j]);
+        break;
+
+      case icCalcInstArcSine:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = (icFloatNumber)asin(s[j]);
+        break;
+
+      case icCalcInstArcCosine:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = (icFloatNumber)acos(s[j]);
+        break;
+
+      case icCalcInstArcTangent:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = (icFloatNumber)atan(s[j]);
+        break;
+
+      case icCalcInstArcTan2:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = (icFloatNumber)atan2(s[j+n], s[j]);
+        break;
+
+      case icCalcInstCartesianToPolar:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++) {
+          icFloatNumber a1 = s[j];
+          icFloatNumber a2 = s[j+n];
+          s[j] = (icFloatNumber)sqrt(a2*a2 + a1*a1);
+          icFloatNumber h = (icFloatNumber)atan2(a2, a1) * 180.0f / (icFloatNumber)icPiNum;
+          if (h<0.0f)
+            h += 360.0f;
+          s[j+n] = h;
+        }
+        break;
+
+      case icCalcInstPolarToCartesian:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++) {
+          icFloatNumber a1 = s[j];
+          icFloatNumber a2 = s[j+n] * (icFloatNumber)icPiNum / 180.0f;
+
+          s[j] = a1 * (icFloatNumber)cos(a2);
+          s[j+n] = a1 * (icFloatNumber)sin(a2);
+        }
+        break;
+
+      case icCalcInstRealNumber:
+        {
+          icFloatNumber nan = icNotANumber;
+          n = (int)p->n*L;
+          for (j=0; j<n; j++) {
+            icFloatNumber a1 = s[j];
+            if (a1==icPosInfinity || a1==icNegInfinity || !memcmp(&a1,&nan, sizeof(nan)))
+              s[j] = 0.0;
+            else
+              s[j] = 1.0;
+          }
+        }
+        break;
+
+      case icCalcInstLessThan:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = (s[j] < s[j+n] ? (icFloatNumber)1.0 : (icFloatNumber)0.0);
+        break;
+
+      case icCalcInstLessThanEqual:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = (s[j] <= s[j+n] ? (icFloatNumber)1.0 : (icFloatNumber)0.0);
+        break;
+
+      case icCalcInstEqual:
+      case icCalcInstNotEqual:
+        {
+          icFloatNumber nan = icNotANumber;
+          icFloatNumber t = p->code==icCalcInstEqual ? (icFloatNumber)1.0 : (icFloatNumber)0.0;
+          icFloatNumber f = p->code==icCalcInstEqual ? (icFloatNumber)0.0 : (icFloatNumber)1.0;
+          n = (int)p->n*L;
+          for (j=0; j<n; j++) {
+            icFloatNumber a1 = s[j];
+            icFloatNumber a2 = s[j+n];
+            s[j] = (a1 == a2 ? t :
+                     ((!memcmp(&a1, &nan, sizeof(icFloatNumber)) && !memcmp(&a1, &a2, sizeof(a1))) ? t : f));
+          }
+        }
+        break;
+
+      case icCalcInstNear:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = (fabs(s[j]-s[j+n])<1.0e-5 ? (icFloatNumber)1.0 : (icFloatNumber)0.0);
+        break;
+
+      case icCalcInstGreaterThanEqual:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = (s[j] >= s[j+n] ? (icFloatNumber)1.0 : (icFloatNumber)0.0);
+        break;
+
+      case icCalcInstGreaterThan:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = (s[j] > s[j+n] ? (icFloatNumber)1.0 : (icFloatNumber)0.0);
+        break;
+
+      case icCalcInstNot:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = (s[j] >= (icFloatNumber)0.5 ? (icFloatNumber)0.0 : (icFloatNumber)1.0);
+        break;
+
+      case icCalcInstNeg:
+        n = (int)p->n*L;
+        for (j=0; j<n; j++)
+          s[j] = -s[j];
+        break;
+
+      case icCalcInstToLab:
+        {
+          n = (int)p->n*L;
+          int n2 = n+n;
+          for (j=0; j<n; j++) {
+            icFloatNumber a1 = icCubeth(s[j]);
+            icFloatNumber a2 = icCubeth(s[j+n]);
+            icFloatNumber a3 = icCubeth(s[j+n2]);
+
+            s[j] = (icFloatNumber)(116.0 * a2 - 16.0);
+            s[j+n] = (icFloatNumber)(500.0 * (a1 - a2));
+            s[j+n2] = (icFloatNumber)(200.0 * (a2 - a3));
+          }
+        }
+        break;
+
+      case icCalcInstToXYZ:
+        {
+          n = (int)p->n*L;
+          int n2 = n+n;
+          for (j=0; j<n; j++) {
+            icFloatNumber a1 = s[j];
+            icFloatNumber a2 = s[j+n];
+            icFloatNumber a3 = s[j+n2];
+
+            icFloatNumber fy = (icFloatNumber)((a1 + 16.0f) / 116.0f);
+
+            s[j] = icICubeth((icFloatNumber)(a2/500.0 + fy));
+            s[j+n] = icICubeth(fy);
+            s[j+n2] = icICubeth((icFloatNumber)(fy - a3/200.0));
+          }
+        }
+        break;
 
-  if (!SetOpDefs())
-    return false;
+      case icCalcInstJump:
+        pc = p->b;
+        break;
 
-  if (DoesOverflowInput(pChannelCalc->NumInputChannels()))
-    return false;
+      case icCalcInstJumpIfNot:
+        {
+          bool bTrue = s[0]>=0.5;
+          for (l=1; l<L; l++) {
+            if ((s[l]>=0.5)!=bTrue) {
+              ApplyProgramFromLanes(pApply, nLanes, pc-1);
+              return true;
+            }
+          }
+          if (!bTrue)
+            pc = p->b;
+        }
+        break;
 
-  if (DoesOverflowOutput(pChannelCalc->NumOutputChannels()))
-    return false;
+      case icCalcInstSelect:
+        {
+          icUInt32Number nCase = icCalcSelectCase(s[0], p->n);
+          for (l=1; l<L; l++) {
+            if (icCalcSelectCase(s[l], p->n)!=nCase) {
+              ApplyProgramFromLanes(pApply, nLanes, pc-1);
+              return true;
+            }
+          }
+          pc = m_Jump[p->b + nCase];
+        }
+        break;
 
-  if (DoesStackUnderflowOverflow(sReport)!=icFuncParseNoError)
-    return false;
+      default:
+        return false;
+    }
+  }
 
   return true;
 }
 
 /**
  ******************************************************************************
- * Name: CIccCalculatorFunc::InitSelectOps
+ * Name: CIccCalculatorFunc::ApplyProgramFromLanes
  * 
  * Purpose: 
+ *  Finishes the lanes of ApplyProgramLanes() one at a time using the
+ *  scalar program starting at the instruction where the lanes diverged.
  * 
  * Args: 
- * 
- * Return: 
+ *  pApply = apply object with lane storage
+ *  nLanes = number of lanes
+ *  nStart = index of the instruction to continue with
  ******************************************************************************/
-bool CIccCalculatorFunc::InitSelectOps()
+void CIccCalculatorFunc::ApplyProgramFromLanes(CIccApplyMpeCalculator *pApply, icUInt32Number nLanes, icUInt32Number nStart) const
 {
-  icUInt32Number i;
+  icUInt32Number nIn = m_pCalc->NumInputChannels();
+  icUInt32Number nOut = m_pCalc->NumOutputChannels();
+  icUInt32Number nTemp = pApply->m_nTempChannels;
+  icFloatNumber *S = pApply->m_progStack;
+  icFloatNumber *pIn = pApply->m_lanePixel;
+  icFloatNumber *pOut = pIn + nIn;
+  icUInt32Number k, l;
 
-  for (i=0; i<m_nOps; i++) {
-    if (m_Op[i].sig==icSigSelectOp) {
-      if (!InitSelectOp(&m_Op[i], m_nOps-i))
-        return false;
+  const icFloatNumber *pSaveInput = pApply->m_input;
+  icFloatNumber *pSaveOutput = pApply->m_output;
+
+  pApply->m_input = pIn;
+  pApply->m_output = pOut;
+
+  for (l=0; l<nLanes; l++) {
+    for (k=0; k<m_nProgStack; k++)
+      S[k] = pApply->m_laneStack[k*nLanes+l];
+    for (k=0; k<nIn; k++)
+      pIn[k] = pApply->m_laneIn[k*nLanes+l];
+    for (k=0; k<nOut; k++)
+      pOut[k] = pApply->m_laneOut[k*nLanes+l];
+    for (k=0; k<nTemp; k++)
+      pApply->m_temp[k] = pApply->m_laneTemp[k*nLanes+l];
+
+    if (!ApplyProgram(pApply, nStart)) {
+      for (k=0; k<nOut; k++)
+        pOut[k] = -1;
     }
+
+    for (k=0; k<nOut; k++)
+      pApply->m_laneOut[k*nLanes+l] = pOut[k];
   }
 
-  return true;
+  pApply->m_input = pSaveInput;
+  pApply->m_output = pSaveOutput;
 }
 
 /**
  ******************************************************************************
- * Name: CIccCalculatorFunc::InitSelectOp
+ * Name: CIccCalculatorFunc::Apply
  * 
  * Purpose: 
  * 
@@ -3649,186 +6163,58 @@ bool CIccCalculatorFunc::InitSelectOps()
  * 
  * Return: 
  ******************************************************************************/
-bool CIccCalculatorFunc::InitSelectOp(SIccCalcOp *ops, icUInt32Number nOps)
+bool CIccCalculatorFunc::Apply(CIccApplyMpeCalculator *pApply) const
 {
+  bool rv;
 
-  if (ops->sig != icSigSelectOp)
-    return false;
-
-  if (ops->extra)
-    return true;
+  //Use the compiled program unless a debugger needs to follow the operations
+  if (m_Inst && !g_pDebugger && pApply->GetProgramStack()) {
+    rv = ApplyProgram(pApply);
+  }
+  else {
+    CIccFloatVector *pStack = pApply->GetStack();
 
+    pStack->clear();
 
-  icUInt32Number i, n, pos;
-  for (n=0; n<nOps && ops[n+1].sig==icSigCaseOp; n++);
-  ops->extra=n;
-  if (ops[n+1].sig==icSigDefaultOp) {
-    n++;
-  }
-  pos = n;
-  for (i=1; i<=n && pos<nOps; i++) {
-    ops[i].extra = pos;
-    pos += ops[i].data.size;
+    rv = ApplySequence(pApply, m_nOps, m_Op);
   }
 
-  if (i<=n)
+  if (!rv) {
+    icFloatNumber *pOut = pApply->GetOutput();
+    icUInt32Number i;
+    for (i=0; i<m_pCalc->NumOutputChannels(); i++)
+      pOut[i] = -1;
     return false;
-
-  return true;
-}
-
-/**
-******************************************************************************
-* Name: CIccCalculatorFunc::ApplySequence
-* 
-* Purpose: 
-* 
-* Args: 
-* 
-* Return: 
-******************************************************************************/
-bool CIccCalculatorFunc::ApplySequence(CIccApplyMpeCalculator *pApply, icUInt32Number nOps, SIccCalcOp *ops) const
-{
-  SIccCalcOp *op;
-  SIccOpState os;
-
-  os.pApply = pApply;
-  os.pStack = pApply->GetStack();
-  os.pScratch = pApply->GetScratch();
-  os.temp = pApply->GetTemp();
-  os.pixel = pApply->GetInput();
-  os.output = pApply->GetOutput();
-  os.nOps = nOps;
-
-  for (os.idx=0; os.idx<os.nOps; os.idx++) {
-    op = &ops[os.idx];
-
-    if (g_pDebugger)
-      g_pDebugger->BeforeOp(op, os, ops);
-
-    if (op->sig==icSigIfOp) {
-      icFloatNumber a1;
-      OsPopArg(a1);
-
-      if (os.idx+1<nOps && ops[os.idx+1].sig==icSigElseOp) {
-        os.idx++;
-        if (a1>=0.5) {
-          if (os.idx+1 + op->data.size >= nOps)
-            return false;
-
-          if (!ApplySequence(pApply, op->data.size, &ops[os.idx+1]))
-            return false;
-        }
-        else {
-          if (os.idx+1 + op->data.size + ops[os.idx].data.size > nOps)
-            return false;
-
-          if (!ApplySequence(pApply, ops[os.idx].data.size, &ops[os.idx+1 + op->data.size]))
-            return false;
-        }
-        os.idx += op->data.size + ops[os.idx].data.size;
-      }
-      else {
-        if (a1>=0.5) {
-          if (os.idx+op->data.size >= nOps)
-            return false;
-
-          if (!ApplySequence(pApply, op->data.size, &ops[os.idx+1]))
-            return false;
-        }
-        os.idx+= op->data.size;
-      }
-    }
-    else if (op->sig==icSigSelectOp) {
-      icFloatNumber a1;
-      OsPopArg(a1);
-      if (std::isnan(a1))
-        a1 = 0.0;
-        
-      icInt32Number nSel;
-      if (std::isinf(a1)) {
-        nSel = (a1 < 0.0) ? std::numeric_limits<icInt32Number>::lowest() : std::numeric_limits<icInt32Number>::max();
-      }
-      else
-        nSel = (a1 >= 0.0) ? (icInt32Number)(a1+0.5f) : (icInt32Number)(a1-0.5f);
-
-      if (!op->extra) {
-        return false;
-      }
-      
-      icUInt32Number nDefOff = (icUInt32Number)(os.idx+1 + op->extra);
-      if (nDefOff >= nOps)
-        return false;
-
-      if (nSel<0 || (icUInt32Number)nSel>=op->extra) {
-
-        if (ops[nDefOff].sig==icSigDefaultOp) {
-          if (os.idx+1 + ops[nDefOff].extra >= nOps)
-            return false;
-
-          if (!ApplySequence(pApply, ops[nDefOff].data.size, &ops[os.idx+1 + ops[nDefOff].extra]))
-            break;
-        }
-      }
-      else {
-        icUInt32Number nOff = os.idx+1 + nSel;
-
-        if (nOff >= nOps) 
-          return false;
-
-        if (!ApplySequence(pApply, ops[nOff].data.size, &ops[os.idx+1 + ops[nOff].extra]))
-          break;
-      }
-
-      if (ops[nDefOff].sig==icSigDefaultOp) {
-        if (os.idx+1 + ops[nDefOff].extra + ops[nDefOff].data.size >nOps)
-          return false;
-
-        os.idx = (icUInt32Number)(os.idx + ops[nDefOff].extra + ops[nDefOff].data.size);
-      }
-      else if (op->extra) {
-        unsigned long nOff = os.idx + op->extra;
-
-        if (os.idx+1 + ops[nOff].extra + ops[nOff].data.size > nOps)
-          return false;
-
-        os.idx = (icUInt32Number)(os.idx + ops[nOff].extra + ops[nOff].data.size);
-      }
-      else 
-        return false;
-    }
-    else {
-      if (!op->def->Exec(op, os))
-        return false;
-    }
-
-    if (g_pDebugger) {
-      g_pDebugger->AfterOp(op, os, ops);
-    }
   }
+
   return true;
 }
 
 /**
  ******************************************************************************
- * Name: CIccCalculatorFunc::Apply
+ * Name: CIccCalculatorFunc::ApplyLanes
  * 
  * Purpose: 
+ *  Applies the compiled function to nLanes pixels held in the lane
+ *  storage of the apply object.
  * 
  * Args: 
+ *  pApply = apply object with lane input, output and temp rows set up
+ *  nLanes = number of pixels (1 to icCalcLanes)
  * 
  * Return: 
+ *  true if successful
  ******************************************************************************/
-bool CIccCalculatorFunc::Apply(CIccApplyMpeCalculator *pApply) const
+bool CIccCalculatorFunc::ApplyLanes(CIccApplyMpeCalculator *pApply, icUInt32Number nLanes) const
 {
-  CIccFloatVector *pStack = pApply->GetStack();
-
-  pStack->clear();
+  if (!m_Inst || !pApply->GetLaneStack() || !pApply->GetProgramStack())
+    return false;
 
-  if (!ApplySequence(pApply, m_nOps, m_Op)) {
-    icFloatNumber *pOut = pApply->GetOutput();
+  if (!ApplyProgramLanes(pApply, nLanes)) {
+    icUInt32Number n = m_pCalc->NumOutputChannels()*nLanes;
+    icFloatNumber *pOut = pApply->GetLaneOutput();
     icUInt32Number i;
-    for (i=0; i<m_pCalc->NumOutputChannels(); i++)
+    for (i=0; i<n; i++)
       pOut[i] = -1;
     return false;
   }
@@ -4931,6 +7317,37 @@ CIccApplyMpe *CIccMpeCalculator::GetNewApply(CIccApplyTagMpe *pApplyTag)
   else {
     m_SubElem=NULL;
   }
+
+  if (m_calcFunc && m_calcFunc->IsCompiled()) {
+    bool bSubApply = true;
+
+    for (i=0; i<pApply->m_nSubElem; i++) {
+      if (m_SubElem && m_SubElem[i] && (!pApply->m_SubElem || !pApply->m_SubElem[i] || !pApply->m_SubElem[i]->GetApply()))
+        bSubApply = false;
+    }
+
+    //Without a program stack the apply object interprets the function
+    if (bSubApply) {
+      icUInt32Number nStack = m_calcFunc->GetProgramStackSize();
+
+      pApply->m_progStack = (icFloatNumber*)malloc(nStack*sizeof(icFloatNumber));
+
+      //Without lane storage ApplyN applies one pixel at a time
+      if (pApply->m_progStack) {
+        icUInt32Number nRows = nStack + m_nInputChannels + m_nOutputChannels + m_nTempChannels;
+
+        pApply->m_laneStack = (icFloatNumber*)malloc((nRows*icCalcLanes + m_nInputChannels + m_nOutputChannels)*sizeof(icFloatNumber));
+        if (pApply->m_laneStack) {
+          pApply->m_laneIn = pApply->m_laneStack + nStack*icCalcLanes;
+          pApply->m_laneOut = pApply->m_laneIn + m_nInputChannels*icCalcLanes;
+          pApply->m_laneTemp = pApply->m_laneOut + m_nOutputChannels*icCalcLanes;
+          pApply->m_lanePixel = pApply->m_laneTemp + m_nTempChannels*icCalcLanes;
+          pApply->m_nTempChannels = m_nTempChannels;
+        }
+      }
+    }
+  }
+
   return pApply;
 }
 
@@ -4972,6 +7389,68 @@ void CIccMpeCalculator::Apply(CIccApplyMpe *pApply, icFloatNumber *pDestPixel, c
   }
 }
 
+/**
+ ******************************************************************************
+ * Name: CIccMpeCalculator::ApplyN
+ * 
+ * Purpose: 
+ *  Applies the calculator to a block of pixels.  Compiled functions are
+ *  evaluated for up to icCalcLanes pixels at a time with the pixels
+ *  transposed into lane rows.
+ * 
+ * Args: 
+ *  pApply = apply object from GetNewApply()
+ *  pDestPixels = NumOutputChannels() samples per pixel
+ *  pSrcPixels = NumInputChannels() samples per pixel
+ *  nPixels = number of pixels
+ ******************************************************************************/
+void CIccMpeCalculator::ApplyN(CIccApplyMpe *pApply, icFloatNumber *pDestPixels, const icFloatNumber *pSrcPixels,
+                               icUInt32Number nPixels) const
+{
+  CIccApplyMpeCalculator *pApplyCalc = (CIccApplyMpeCalculator*)pApply;
+
+  if (g_pDebugger || !pApplyCalc->m_laneStack) {
+    CIccMultiProcessElement::ApplyN(pApply, pDestPixels, pSrcPixels, nPixels);
+    return;
+  }
+
+  icUInt32Number nIn = m_nInputChannels, nOut = m_nOutputChannels;
+  icFloatNumber *pLaneIn = pApplyCalc->m_laneIn;
+  icFloatNumber *pLaneOut = pApplyCalc->m_laneOut;
+  icUInt32Number n, nLanes, k, l;
+
+  for (n=0; n<nPixels; n+=nLanes) {
+    nLanes = nPixels - n;
+    if (nLanes>icCalcLanes)
+      nLanes = icCalcLanes;
+
+    for (k=0; k<nIn; k++) {
+      for (l=0; l<nLanes; l++)
+        pLaneIn[k*nLanes+l] = pSrcPixels[l*nIn+k];
+    }
+
+    //Outputs that the function doesn't set keep their values as with Apply()
+    for (k=0; k<nOut; k++) {
+      for (l=0; l<nLanes; l++)
+        pLaneOut[k*nLanes+l] = pDestPixels[l*nOut+k];
+    }
+
+    if (m_bNeedTempReset) {
+      memset(pApplyCalc->m_laneTemp, 0, m_nTempChannels*nLanes*sizeof(icFloatNumber));
+    }
+
+    (void) m_calcFunc->ApplyLanes(pApplyCalc, nLanes);
+
+    for (k=0; k<nOut; k++) {
+      for (l=0; l<nLanes; l++)
+        pDestPixels[l*nOut+k] = pLaneOut[k*nLanes+l];
+    }
+
+    pSrcPixels += nLanes*nIn;
+    pDestPixels += nLanes*nOut;
+  }
+}
+
 /**
  ******************************************************************************
  * Name: CIccMpeCalculator::Validate
@@ -5170,6 +7649,14 @@ CIccApplyMpeCalculator::CIccApplyMpeCalculator(CIccMultiProcessElement *pElem) :
   
   m_stack = NULL;
   m_scratch = NULL;
+  m_progStack = NULL;
+
+  m_laneStack = NULL;
+  m_laneIn = NULL;
+  m_laneOut = NULL;
+  m_laneTemp = NULL;
+  m_lanePixel = NULL;
+  m_nTempChannels = 0;
 
   m_nSubElem = 0;
   m_SubElem = NULL;
@@ -5195,6 +7682,12 @@ CIccApplyMpeCalculator::~CIccApplyMpeCalculator()
   if (m_scratch) {
     delete m_scratch;
   }
+  if (m_progStack) {
+    free(m_progStack);
+  }
+  if (m_laneStack) {
+    free(m_laneStack);
+  }
 
   if (m_temp) {
     free(m_temp);
@@ -90,6 +90,12 @@ class IIccOpDef;
 
 #define icMaxDataStackSize 65535
 
+/// Number of pixels evaluated together by CIccMpeCalculator::ApplyN()
+#define icCalcLanes 32
+
+/// Maximum number of passes made by CIccCalculatorFunc::OptimizeProgram()
+#define icCalcOptimizePasses 8
+
 
 
 /************************************************************************
@@ -307,6 +313,27 @@ public:
 };
 
 
+/**
+****************************************************************************
+* Structure: SIccCalcInst
+* 
+* Purpose: An instruction of a compiled calculator function.  Stack
+*  arguments are resolved to fixed positions in the program stack when the
+*  function is compiled so no stack pointer is kept while executing.
+*****************************************************************************
+*/
+struct SIccCalcInst
+{
+  icUInt32Number code;  //Instruction code
+  icUInt32Number n;     //Vector length or number of values
+  icUInt32Number a;     //Program stack position of first argument
+  icUInt32Number b;     //Channel, sub-element, jump target or jump table index
+  icUInt32Number c;     //Second count used by some instructions
+  icFloatNumber v;      //Constant value
+  icUInt16Number nUsed;   //Stack values used (for optimization)
+  icUInt16Number nPushed; //Stack values pushed (for optimization)
+};
+
 typedef enum {
   icFuncParseNoError=0,
   icFuncParseSyntaxError,
@@ -381,6 +408,7 @@ public:
 
   virtual bool Begin(const CIccMpeCalculator *pChannelMux, CIccTagMultiProcessElement *pMPE);
   virtual bool Apply(CIccApplyMpeCalculator *pApply) const;
+  virtual bool ApplyLanes(CIccApplyMpeCalculator *pApply, icUInt32Number nLanes) const;
   virtual icValidateStatus Validate(std::string sigPath, std::string &sReport,
                                     const CIccMpeCalculator* pChannelCalc=NULL, const CIccProfile* pProfile = NULL) const;
 
@@ -397,6 +425,13 @@ public:
   bool NeedTempReset(icUInt8Number *tempUsage, icUInt32Number nMaxTemp);
   bool SetOpDefs();
 
+  bool Compile();
+  bool IsCompiled() const { return m_Inst!=NULL; }
+  icUInt32Number GetProgramStackSize() const { return m_nProgStack; }
+  icUInt32Number GetNumInstructions() const { return m_nInst; }
+  ///Number of compiled instructions removed by OptimizeProgram() when the function was compiled
+  icUInt32Number GetNumRemovedInstructions() const { return m_nRemovedInst; }
+
 protected:
 
   bool InitSelectOps();
@@ -409,6 +444,19 @@ protected:
                         icUInt32Number nOps, SIccCalcOp *op, int nBlanks);
   bool ApplySequence(CIccApplyMpeCalculator *pApply, icUInt32Number nOps, SIccCalcOp *op) const;
 
+  bool CompileSequence(icUInt32Number nOps, SIccCalcOp *op, icUInt32Number &nDepth, icUInt32Number &nMaxDepth,
+                       icUInt32Number &nScratch, std::vector<SIccCalcInst> &prog, std::vector<icUInt32Number> &jumps);
+  bool ApplyProgram(CIccApplyMpeCalculator *pApply, icUInt32Number nStart=0) const
+  { return ExecProgram(pApply, m_Inst, m_nInst, nStart); }
+  bool ExecProgram(CIccApplyMpeCalculator *pApply, const SIccCalcInst *inst, icUInt32Number nInst, icUInt32Number nStart) const;
+  icUInt32Number OptimizeProgram(std::vector<SIccCalcInst> &prog, std::vector<icUInt32Number> &jumps,
+                                 icUInt32Number nScratch, icUInt32Number nSlots);
+  bool FoldConstants(std::vector<SIccCalcInst> &prog, std::vector<icUInt32Number> &jumps,
+                     icUInt32Number nScratch, icUInt32Number nSlots);
+  bool ApplyProgramLanes(CIccApplyMpeCalculator *pApply, icUInt32Number nLanes) const;
+  void ApplyProgramFromLanes(CIccApplyMpeCalculator *pApply, icUInt32Number nLanes, icUInt32Number nStart) const;
+  void FreeProgram();
+
   const char *ParseFuncDef(const char *szFuncDef, CIccCalcOpList &m_list, std::string &sReport);
 
   CIccMpeCalculator *m_pCalc;
@@ -418,6 +466,12 @@ protected:
   icUInt32Number m_nOps;
   SIccCalcOp *m_Op;
 
+  ///Compiled form of m_Op used by Apply when no debugger is set (see Compile)
+  icUInt32Number m_nInst;
+  SIccCalcInst *m_Inst;
+  icUInt32Number *m_Jump;
+  icUInt32Number m_nProgStack;
+  icUInt32Number m_nRemovedInst;
 };
 
 typedef CIccCalculatorFunc* icCalculatorFuncPtr;
@@ -433,6 +487,8 @@ public:
 
   void Apply(icFloatNumber *pDestPixel, const icFloatNumber *pSrcPixel) { if (m_pApply) m_pApply->Apply(pDestPixel, pSrcPixel); }
 
+  CIccApplyMpe *GetApply() { return m_pApply; }
+
 protected:
   CIccApplyMpe *m_pApply;
 };
@@ -459,6 +515,7 @@ public:
 
   icFuncParseStatus SetCalcFunc(icCalculatorFuncPtr newFunc);
   icFuncParseStatus SetCalcFunc(const char *szFuncDef, std::string &sReport);
+  icCalculatorFuncPtr GetCalcFunc() const { return m_calcFunc; }
 
   bool SetSubElem(icUInt32Number idx, CIccMultiProcessElement *pElem) { return SetElem(idx, pElem, m_nSubElem, &m_SubElem); }
 
@@ -473,10 +530,13 @@ public:
   virtual bool Begin(icElemInterp nInterp, CIccTagMultiProcessElement *pMPE);
   virtual CIccApplyMpe *GetNewApply(CIccApplyTagMpe *pApplyTag);
   virtual void Apply(CIccApplyMpe *pApply, icFloatNumber *pDestPixel, const icFloatNumber *pSrcPixel) const;
+  virtual void ApplyN(CIccApplyMpe *pApply, icFloatNumber *pDestPixels, const icFloatNumber *pSrcPixels, icUInt32Number nPixels) const;
   virtual icValidateStatus Validate(std::string sigPath, std::string &sReport, const CIccTagMultiProcessElement* pMPE=NULL, const CIccProfile* pProfile = NULL) const;
 
   CIccMultiProcessElement *GetElem(icSigCalcOp op, icUInt16Number index);
 
+  IIccCmmEnvVarLookup *GetCmmEnvVarLookup() const { return m_pCmmEnvVarLookup; }
+
   virtual bool IsLateBinding() const;
   virtual bool IsLateBindingReflectance() const;
 
@@ -506,6 +566,7 @@ protected:
 class CIccApplyMpeCalculator : public CIccApplyMpe
 {
   friend class CIccMpeCalculator;
+  friend class CIccCalculatorFunc;
 public:
   virtual ~CIccApplyMpeCalculator();
 
@@ -519,6 +580,13 @@ public:
   CIccFloatVector *GetStack() { return m_stack; }
 
   CIccFloatVector *GetScratch() { return m_scratch; }
+  icFloatNumber *GetProgramStack() { return m_progStack; }
+
+  ///Structure of arrays storage used by ApplyLanes (row k of each holds value k of every lane)
+  icFloatNumber *GetLaneStack() { return m_laneStack; }
+  icFloatNumber *GetLaneInput() { return m_laneIn; }
+  icFloatNumber *GetLaneOutput() { return m_laneOut; }
+  icFloatNumber *GetLaneTemp() { return m_laneTemp; }
 
   CIccSubCalcApply* GetApply(icUInt16Number index);
 
@@ -530,6 +598,17 @@ protected:
   CIccFloatVector *m_stack;
   CIccFloatVector *m_scratch;
 
+  //Stack used by compiled calculator functions
+  icFloatNumber *m_progStack;
+
+  //Lane storage used by ApplyN (all in one allocation starting at m_laneStack)
+  icFloatNumber *m_laneStack;
+  icFloatNumber *m_laneIn;
+  icFloatNumber *m_laneOut;
+  icFloatNumber *m_laneTemp;
+  icFloatNumber *m_lanePixel;
+  icUInt32Number m_nTempChannels;
+
   //Use member storage for calls between Apply and ApplySequence
   const icFloatNumber *m_input;
   icFloatNumber *m_output;
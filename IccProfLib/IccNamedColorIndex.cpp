@@ -0,0 +1,354 @@
+/** @file
+    File:       IccNamedColorIndex.cpp
+
+    Contains:   Implementation of nearest match and name indexes of named colors
+
+    Version:    V1
+
+    Copyright:  (c) see Software License
+*/
+
+/*
+ * Copyright (c) International Color Consortium.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer. 
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. In the absence of prior written permission, the names "ICC" and "The
+ *    International Color Consortium" must not be used to imply that the
+ *    ICC organization endorses or promotes products derived from this
+ *    software.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE INTERNATIONAL COLOR CONSORTIUM OR
+ * ITS CONTRIBUTING MEMBERS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by many
+ * individuals on behalf of the The International Color Consortium. 
+ *
+ *
+ * Membership in the ICC is encouraged when this software is used for
+ * commercial purposes. 
+ *
+ *  
+ * For more information on The International Color Consortium, please
+ * see <http://www.color.org/>.
+ *  
+ * 
+ */
+
+//////////////////////////////////////////////////////////////////////
+// HISTORY:
+//
+// -Initial implementation of named color indexes 10-17-2026
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "IccNamedColorIndex.h"
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#if defined(USEICCDEVNAMESPACE)
+namespace iccDEV {
+#endif
+
+/**
+ ****************************************************************************
+ * Name: CIccKdTree::CIccKdTree
+ * 
+ * Purpose: Constructor
+ *****************************************************************************
+ */
+CIccKdTree::CIccKdTree()
+{
+  m_nDims = 0;
+  m_nPoints = 0;
+  m_pPoints = NULL;
+  m_pIds = NULL;
+  m_pAxis = NULL;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccKdTree::~CIccKdTree
+ * 
+ * Purpose: Destructor
+ *****************************************************************************
+ */
+CIccKdTree::~CIccKdTree()
+{
+  Reset();
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccKdTree::Reset
+ * 
+ * Purpose: Frees the tree
+ *****************************************************************************
+ */
+void CIccKdTree::Reset()
+{
+  if (m_pPoints)
+    free(m_pPoints);
+  if (m_pIds)
+    free(m_pIds);
+  if (m_pAxis)
+    free(m_pAxis);
+
+  m_pPoints = NULL;
+  m_pIds = NULL;
+  m_pAxis = NULL;
+  m_nPoints = 0;
+  m_nDims = 0;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccKdTree::Build
+ * 
+ * Purpose: Builds the tree from an array of points
+ * 
+ * Args: 
+ *  nDims = number of values in each point (1 to 255),
+ *  nPoints = number of points,
+ *  pPoints = nPoints*nDims point values,
+ *  pIds = id returned by FindNearest() for each point, NULL uses the
+ *   position of the point in pPoints
+ * 
+ * Return: 
+ *  true if successful, false if out of memory or nDims is out of range
+ *****************************************************************************
+ */
+bool CIccKdTree::Build(icUInt32Number nDims, icUInt32Number nPoints, const icFloatNumber *pPoints, const icUInt32Number *pIds/*=NULL*/)
+{
+  Reset();
+
+  if (!nDims || nDims>255)
+    return false;
+
+  if (!nPoints)
+    return true;
+
+  icUInt32Number *pPerm = (icUInt32Number*)malloc(nPoints*sizeof(icUInt32Number));
+  m_pPoints = (icFloatNumber*)malloc((size_t)nPoints*nDims*sizeof(icFloatNumber));
+  m_pIds = (icUInt32Number*)malloc(nPoints*sizeof(icUInt32Number));
+  m_pAxis = (icUInt8Number*)calloc(nPoints, sizeof(icUInt8Number));
+
+  if (!pPerm || !m_pPoints || !m_pIds || !m_pAxis) {
+    if (pPerm)
+      free(pPerm);
+    Reset();
+    return false;
+  }
+
+  m_nDims = nDims;
+
+  icUInt32Number i;
+  for (i=0; i<nPoints; i++)
+    pPerm[i] = i;
+
+  BuildNode(pPerm, 0, nPoints, pPoints);
+
+  //Store points in tree order so that searches walk memory in order
+  for (i=0; i<nPoints; i++) {
+    memcpy(m_pPoints + (size_t)i*nDims, pPoints + (size_t)pPerm[i]*nDims, nDims*sizeof(icFloatNumber));
+    m_pIds[i] = pIds ? pIds[pPerm[i]] : pPerm[i];
+  }
+  m_nPoints = nPoints;
+
+  free(pPerm);
+
+  return true;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccKdTree::BuildNode
+ * 
+ * Purpose: Orders pPerm[nLo..nHi-1] so that the median point of the axis
+ *  with the largest spread is at the middle position with smaller points
+ *  before it and larger points after it, then builds both halves.
+ *****************************************************************************
+ */
+void CIccKdTree::BuildNode(icUInt32Number *pPerm, icUInt32Number nLo, icUInt32Number nHi, const icFloatNumber *pPoints)
+{
+  if (nHi-nLo <= icKdTreeLeafSize)
+    return;
+
+  icUInt32Number i, d, nAxis=0;
+  icFloatNumber dSpread=-1.0;
+
+  for (d=0; d<m_nDims; d++) {
+    icFloatNumber vMin = pPoints[(size_t)pPerm[nLo]*m_nDims + d];
+    icFloatNumber vMax = vMin;
+    for (i=nLo+1; i<nHi; i++) {
+      icFloatNumber v = pPoints[(size_t)pPerm[i]*m_nDims + d];
+      if (v<vMin)
+        vMin = v;
+      else if (v>vMax)
+        vMax = v;
+    }
+    if (vMax-vMin > dSpread) {
+      dSpread = vMax-vMin;
+      nAxis = d;
+    }
+  }
+
+  icUInt32Number nMid = nLo + (nHi-nLo)/2;
+  icUInt32Number nDims = m_nDims;
+
+  std::nth_element(pPerm+nLo, pPerm+nMid, pPerm+nHi,
+                   [pPoints, nDims, nAxis](icUInt32Number a, icUInt32Number b) {
+                     return pPoints[(size_t)a*nDims + nAxis] < pPoints[(size_t)b*nDims + nAxis];
+                   });
+
+  m_pAxis[nMid] = (icUInt8Number)nAxis;
+
+  BuildNode(pPerm, nLo, nMid, pPoints);
+  BuildNode(pPerm, nMid+1, nHi, pPoints);
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccKdTree::Dist2
+ * 
+ * Purpose: Returns the squared distance from pPoint to the point at tree
+ *  position nPos
+ *****************************************************************************
+ */
+icFloat64Number CIccKdTree::Dist2(const icFloatNumber *pPoint, icUInt32Number nPos) const
+{
+  const icFloatNumber *p = m_pPoints + (size_t)nPos*m_nDims;
+  icFloat64Number d2 = 0.0;
+
+  for (icUInt32Number d=0; d<m_nDims; d++) {
+    icFloat64Number v = (icFloat64Number)pPoint[d] - p[d];
+    d2 += v*v;
+  }
+
+  return d2;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccKdTree::SearchNode
+ * 
+ * Purpose: Updates dBest (squared distance) and nBest (id) with the nearest
+ *  point in positions nLo..nHi-1.  Points at equal distances resolve to
+ *  the lowest id so that results match a linear search.
+ *****************************************************************************
+ */
+void CIccKdTree::SearchNode(icUInt32Number nLo, icUInt32Number nHi, const icFloatNumber *pPoint,
+                            icFloat64Number &dBest, icUInt32Number &nBest) const
+{
+  icFloat64Number d2;
+
+  if (nHi-nLo <= icKdTreeLeafSize) {
+    for (icUInt32Number i=nLo; i<nHi; i++) {
+      d2 = Dist2(pPoint, i);
+      if (d2<dBest || (d2==dBest && m_pIds[i]<nBest)) {
+        dBest = d2;
+        nBest = m_pIds[i];
+      }
+    }
+    return;
+  }
+
+  icUInt32Number nMid = nLo + (nHi-nLo)/2;
+  icUInt32Number nAxis = m_pAxis[nMid];
+  icFloat64Number dPlane = (icFloat64Number)pPoint[nAxis] - m_pPoints[(size_t)nMid*m_nDims + nAxis];
+
+  d2 = Dist2(pPoint, nMid);
+  if (d2<dBest || (d2==dBest && m_pIds[nMid]<nBest)) {
+    dBest = d2;
+    nBest = m_pIds[nMid];
+  }
+
+  if (dPlane<0) {
+    SearchNode(nLo, nMid, pPoint, dBest, nBest);
+    if (dPlane*dPlane <= dBest)
+      SearchNode(nMid+1, nHi, pPoint, dBest, nBest);
+  }
+  else {
+    SearchNode(nMid+1, nHi, pPoint, dBest, nBest);
+    if (dPlane*dPlane <= dBest)
+      SearchNode(nLo, nMid, pPoint, dBest, nBest);
+  }
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccKdTree::FindNearest
+ * 
+ * Purpose: Finds the point nearest to pPoint
+ * 
+ * Args: 
+ *  pPoint = GetNumDims() values of the point to search for,
+ *  pDist = optional location for the distance to the nearest point
+ * 
+ * Return: 
+ *  id of the nearest point, or -1 if the tree is empty
+ *****************************************************************************
+ */
+icInt32Number CIccKdTree::FindNearest(const icFloatNumber *pPoint, icFloatNumber *pDist/*=NULL*/) const
+{
+  if (!m_nPoints)
+    return -1;
+
+  icFloat64Number dBest = HUGE_VAL;
+  icUInt32Number nBest = 0xffffffff;
+
+  SearchNode(0, m_nPoints, pPoint, dBest, nBest);
+
+  if (pDist)
+    *pDist = (icFloatNumber)sqrt(dBest);
+
+  return (icInt32Number)nBest;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccNameIndex::Find
+ * 
+ * Purpose: Finds the index of the entry with the given name
+ * 
+ * Return: 
+ *  index of the first entry added with the name, or -1 if not found
+ *****************************************************************************
+ */
+icInt32Number CIccNameIndex::Find(const std::string &sName) const
+{
+  std::unordered_map<std::string, icUInt32Number>::const_iterator i = m_map.find(sName);
+
+  if (i==m_map.end())
+    return -1;
+
+  return (icInt32Number)i->second;
+}
+
+#if defined(USEICCDEVNAMESPACE)
+}; //namespace iccDEV
+#endif
@@ -0,0 +1,152 @@
+/** @file
+    File:       IccNamedColorIndex.h
+
+    Contains:   Header for nearest match and name indexes of named colors
+
+    Version:    V1
+
+    Copyright:  (c) see Software License
+*/
+
+/*
+ * Copyright (c) International Color Consortium.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer. 
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. In the absence of prior written permission, the names "ICC" and "The
+ *    International Color Consortium" must not be used to imply that the
+ *    ICC organization endorses or promotes products derived from this
+ *    software.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE INTERNATIONAL COLOR CONSORTIUM OR
+ * ITS CONTRIBUTING MEMBERS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by many
+ * individuals on behalf of the The International Color Consortium. 
+ *
+ *
+ * Membership in the ICC is encouraged when this software is used for
+ * commercial purposes. 
+ *
+ *  
+ * For more information on The International Color Consortium, please
+ * see <http://www.color.org/>.
+ *  
+ * 
+ */
+
+//////////////////////////////////////////////////////////////////////
+// HISTORY:
+//
+// -Initial implementation of named color indexes 10-17-2026
+//
+//////////////////////////////////////////////////////////////////////
+
+#if !defined(_ICCNAMEDCOLORINDEX_H)
+#define _ICCNAMEDCOLORINDEX_H
+
+#include "IccDefs.h"
+#include <string>
+#include <unordered_map>
+
+#if defined(USEICCDEVNAMESPACE)
+namespace iccDEV {
+#endif
+
+/// Maximum number of points in a leaf of a CIccKdTree
+#define icKdTreeLeafSize 8
+
+/**
+**************************************************************************
+* Type: Class
+*
+* Purpose: A balanced KD-tree used to find the exact nearest neighbour of a
+*  point under the euclidean distance.  With Lab points this is the nearest
+*  color by deltaE 1976.  Points are copied when the tree is built and the
+*  tree is read only afterwards, so one tree can be searched by any number
+*  of threads at the same time.
+**************************************************************************
+*/
+class ICCPROFLIB_API CIccKdTree
+{
+public:
+  CIccKdTree();
+  virtual ~CIccKdTree();
+
+  bool Build(icUInt32Number nDims, icUInt32Number nPoints, const icFloatNumber *pPoints, const icUInt32Number *pIds=NULL);
+  void Reset();
+
+  bool IsEmpty() const { return !m_nPoints; }
+  icUInt32Number GetNumDims() const { return m_nDims; }
+  icUInt32Number GetNumPoints() const { return m_nPoints; }
+
+  icInt32Number FindNearest(const icFloatNumber *pPoint, icFloatNumber *pDist=NULL) const;
+
+protected:
+  void BuildNode(icUInt32Number *pPerm, icUInt32Number nLo, icUInt32Number nHi, const icFloatNumber *pPoints);
+  void SearchNode(icUInt32Number nLo, icUInt32Number nHi, const icFloatNumber *pPoint,
+                  icFloat64Number &dBest, icUInt32Number &nBest) const;
+
+  icFloat64Number Dist2(const icFloatNumber *pPoint, icUInt32Number nPos) const;
+
+  icUInt32Number m_nDims;
+  icUInt32Number m_nPoints;
+
+  icFloatNumber *m_pPoints;  //Points in tree order
+  icUInt32Number *m_pIds;    //Id of each point in tree order
+  icUInt8Number *m_pAxis;    //Split axis of the node at each position
+};
+
+/**
+**************************************************************************
+* Type: Class
+*
+* Purpose: Hashed lookup of named color entries by name.  When a name is
+*  used by more than one entry the first entry is found, as with a linear
+*  search.
+**************************************************************************
+*/
+class ICCPROFLIB_API CIccNameIndex
+{
+public:
+  CIccNameIndex() {}
+
+  void Add(const std::string &sName, icUInt32Number nIndex) { m_map.insert(std::make_pair(sName, nIndex)); }
+  void Reset() { m_map.clear(); }
+
+  bool IsEmpty() const { return m_map.empty(); }
+  icUInt32Number GetSize() const { return (icUInt32Number)m_map.size(); }
+
+  icInt32Number Find(const std::string &sName) const;
+
+protected:
+  std::unordered_map<std::string, icUInt32Number> m_map;
+};
+
+#if defined(USEICCDEVNAMESPACE)
+}; //namespace iccDEV
+#endif
+
+#endif //_ICCNAMEDCOLORINDEX_H
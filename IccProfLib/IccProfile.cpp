@@ -77,6 +77,8 @@
 #include <vector>
 #include <unordered_map>
 #include <algorithm>
+#include <atomic>
+#include <thread>
 #include "IccProfile.h"
 #include "IccTag.h"
 #include "IccArrayBasic.h"
@@ -84,6 +86,7 @@
 #include "IccUtil.h"
 #include "IccMatrixMath.h"
 #include "IccMD5.h"
+#include "IccProfileID.h"
 
 
 #ifdef USEICCDEVNAMESPACE
@@ -107,6 +110,7 @@ CIccProfile::CIccProfile()
   m_pAttachIO = NULL;
   m_bSharedIO = false;
   memset(&m_Header, 0, sizeof(m_Header));
+  m_nTagIndexChanges = m_Tags.GetChanges();
 
   m_parentColorSpace = icSigNoColorData;
 }
@@ -128,6 +132,7 @@ CIccProfile::CIccProfile()
 CIccProfile::CIccProfile(const CIccProfile &Profile)
 {
   m_pAttachIO = NULL;
+  m_nTagIndexChanges = m_Tags.GetChanges();
   memset(&m_Header, 0, sizeof(m_Header));
   memcpy(&m_Header, &Profile.m_Header, sizeof(m_Header));
 
@@ -162,9 +167,11 @@ CIccProfile::CIccProfile(const CIccProfile &Profile)
       memcpy(&entry.TagInfo, &i->TagInfo, sizeof(icTag));
       m_Tags.push_back(entry);
     }
+    IndexTags();
   }
 
   m_pAttachIO = NULL;  
+  m_pSourceProfile = Profile.m_pSourceProfile;
 }
 
 /**
@@ -222,9 +229,11 @@ CIccProfile &CIccProfile::operator=(const CIccProfile &Profile)
       memcpy(&entry.TagInfo, &i->TagInfo, sizeof(icTag));
       m_Tags.push_back(entry);
     }
+    IndexTags();
   }
 
   m_pAttachIO = NULL;
+  m_pSourceProfile = Profile.m_pSourceProfile;
 
   return *this;  
 }
@@ -255,6 +264,7 @@ void CIccProfile::Cleanup()
     delete m_pAttachIO;
   }
   m_pAttachIO = nullptr;
+  m_pSourceProfile.reset();
 
   TagPtrList::iterator i;
 
@@ -263,12 +273,181 @@ void CIccProfile::Cleanup()
       delete i->ptr;
     }
   }
+  ReleaseTagReaders();
+
   m_Tags.clear();
+  m_TagIndex.clear();
+  m_nTagIndexChanges = m_Tags.GetChanges();
   m_TagVals.clear();
   memset(&m_Header, 0, sizeof(m_Header));
   m_parentColorSpace = icSigNoColorData;
 }
 
+/**
+ ***************************************************************************
+ * Name: CIccProfile::ReleaseTagReaders
+ * 
+ * Purpose: Deletes the IO objects used by LoadAttachedTag() to read tags.
+ *  Tags that were read with them must have been deleted or detached first.
+ ***************************************************************************
+ */
+void CIccProfile::ReleaseTagReaders()
+{
+  std::list<CIccIO*>::iterator i;
+
+  for (i=m_TagReaders.begin(); i!=m_TagReaders.end(); i++) {
+    delete *i;
+  }
+  m_TagReaders.clear();
+}
+
+/// Tag directories up to this size are scanned rather than searched with the index
+#define icTagIndexScanSize 16
+
+/**
+ ****************************************************************************
+ * Name: icTagIndexLess
+ * 
+ * Purpose: Signature orderings of tag index entries
+ *****************************************************************************
+ */
+static bool icTagIndexLess(const IccTagIndexEntry &a, const IccTagIndexEntry &b)
+{
+  return a.sig < b.sig;
+}
+
+static bool icTagIndexSigLess(const IccTagIndexEntry &entry, icUInt32Number sig)
+{
+  return entry.sig < sig;
+}
+
+static bool icTagIndexSigGreater(icUInt32Number sig, const IccTagIndexEntry &entry)
+{
+  return sig < entry.sig;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccProfile::IndexTags
+ * 
+ * Purpose: Rebuilds the signature index of the tag directory
+ *****************************************************************************
+ */
+void CIccProfile::IndexTags()
+{
+  TagEntryList::iterator i;
+  IccTagIndexEntry entry;
+
+  m_TagIndex.clear();
+  m_TagIndex.reserve(m_Tags.size());
+
+  for (i=m_Tags.begin(); i!=m_Tags.end(); i++) {
+    entry.sig = i->TagInfo.sig;
+    entry.pos = i;
+    m_TagIndex.push_back(entry);
+  }
+
+  std::stable_sort(m_TagIndex.begin(), m_TagIndex.end(), icTagIndexLess);
+  m_nTagIndexChanges = m_Tags.GetChanges();
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccProfile::IndexTag
+ * 
+ * Purpose: Adds a tag directory entry that was appended to m_Tags to the
+ *  signature index
+ *****************************************************************************
+ */
+void CIccProfile::IndexTag(TagEntryList::iterator pos)
+{
+  IccTagIndexEntry entry;
+
+  entry.sig = pos->TagInfo.sig;
+  entry.pos = pos;
+
+  m_TagIndex.insert(std::upper_bound(m_TagIndex.begin(), m_TagIndex.end(), entry.sig, icTagIndexSigGreater), entry);
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccProfile::EraseTagEntry
+ * 
+ * Purpose: Removes a tag directory entry from m_Tags and the signature index
+ * 
+ * Args: 
+ *  pos - position of the entry in m_Tags
+ * 
+ * Return: 
+ *  Position of the entry that followed the removed entry
+ *****************************************************************************
+ */
+TagEntryList::iterator CIccProfile::EraseTagEntry(TagEntryList::iterator pos)
+{
+  bool bIndexed = false;
+
+  if (m_nTagIndexChanges==m_Tags.GetChanges()) {
+    icUInt32Number sig = pos->TagInfo.sig;
+    TagIndexList::iterator i = std::lower_bound(m_TagIndex.begin(), m_TagIndex.end(), sig, icTagIndexSigLess);
+
+    for (; i!=m_TagIndex.end() && i->sig==sig; i++) {
+      if (i->pos==pos) {
+        m_TagIndex.erase(i);
+        bIndexed = true;
+        break;
+      }
+    }
+  }
+
+  pos = m_Tags.erase(pos);
+
+  //The rest of the index is still valid unless the entry was not found in it
+  //(e.g. it was renamed directly in m_Tags)
+  if (bIndexed)
+    m_nTagIndexChanges = m_Tags.GetChanges();
+
+  return pos;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccProfile::GetTagPos
+ * 
+ * Purpose: Get the position in m_Tags of the tag entry with a given signature
+ * 
+ * Args: 
+ *  sig - signature id to find in tag directory
+ *  pos - returned position
+ * 
+ * Return: 
+ *  true if found, false otherwise.
+ *****************************************************************************
+ */
+bool CIccProfile::GetTagPos(icSignature sig, TagEntryList::iterator &pos)
+{
+  //Entries in the index may have been freed if m_Tags was changed from outside the class
+  if (m_nTagIndexChanges!=m_Tags.GetChanges())
+    IndexTags();
+
+  TagIndexList::iterator i = std::lower_bound(m_TagIndex.begin(), m_TagIndex.end(), (icUInt32Number)sig, icTagIndexSigLess);
+
+  //m_Tags is public so make sure the entry still has the signature it was indexed with
+  if (i!=m_TagIndex.end() && i->sig==(icUInt32Number)sig && i->pos->TagInfo.sig==(icTagSignature)sig) {
+    pos = i->pos;
+    return true;
+  }
+
+  //The entry may have been renamed or appended directly in m_Tags
+  for (pos=m_Tags.begin(); pos!=m_Tags.end(); pos++) {
+    if (pos->TagInfo.sig==(icTagSignature)sig) {
+      IndexTags();
+      return true;
+    }
+  }
+
+  return false;
+}
+
 /**
  ****************************************************************************
  * Name: CIccProfile::GetTag
@@ -284,6 +463,19 @@ void CIccProfile::Cleanup()
  */
 IccTagEntry* CIccProfile::GetTag(icSignature sig) const
 {
+  size_t nTags = m_Tags.size();
+
+  //Entries in the index may have been freed if m_Tags was changed from outside the class
+  if (nTags>icTagIndexScanSize && m_nTagIndexChanges==m_Tags.GetChanges()) {
+    TagIndexList::const_iterator i = std::lower_bound(m_TagIndex.begin(), m_TagIndex.end(), (icUInt32Number)sig, icTagIndexSigLess);
+
+    //m_Tags is public so make sure the entry still has the signature it was indexed with
+    if (i!=m_TagIndex.end() && i->sig==(icUInt32Number)sig && i->pos->TagInfo.sig==(icTagSignature)sig)
+      return &(*i->pos);
+  }
+
+  //The entry may have been renamed or appended directly in m_Tags
+
   TagEntryList::const_iterator i;
 
   for (i=m_Tags.begin(); i!=m_Tags.end(); i++) {
@@ -311,12 +503,10 @@ IccTagEntry* CIccProfile::GetTag(icSignature sig) const
  */
 IccTagEntry* CIccProfile::GetTag(icSignature sig, const CIccProfile *pParentProfile) const
 {
-  TagEntryList::const_iterator i;
+  IccTagEntry *pEntry = GetTag(sig);
 
-  for (i = m_Tags.begin(); i != m_Tags.end(); i++) {
-    if (i->TagInfo.sig == (icTagSignature)sig)
-      return (IccTagEntry*)&(i->TagInfo);
-  }
+  if (pEntry)
+    return pEntry;
 
   if (pParentProfile)
     return pParentProfile->GetTag(sig);
@@ -433,8 +623,9 @@ CIccTag* CIccProfile::FindTag(icSignature sig)
  */
 CIccTag* CIccProfile::FindTag(IccTagEntry &entry)
 {
-  if (!entry.pTag && m_pAttachIO)
-    LoadTag(&entry, m_pAttachIO);
+  if (m_pAttachIO || m_pSourceProfile)
+    return LoadAttachedTag(&entry);
+
   return entry.pTag;
 }
 
@@ -526,10 +717,18 @@ CIccMemIO* CIccProfile::GetTagIO(icSignature sig)
       return NULL;
     }
 
-    m_pAttachIO->Seek(pEntry->TagInfo.offset, icSeekSet);
-    
     const size_t expected_length = pIO->GetLength();
-    size_t read_length = m_pAttachIO->Read8(pIO->GetData(), expected_length);
+    size_t read_length;
+
+    if (m_pAttachIO->CanReadAt()) {
+      read_length = m_pAttachIO->ReadAt(pEntry->TagInfo.offset, pIO->GetData(), expected_length);
+    }
+    else {
+      std::lock_guard<std::mutex> lock(m_TagLoadLock);
+
+      m_pAttachIO->Seek(pEntry->TagInfo.offset, icSeekSet);
+      read_length = m_pAttachIO->Read8(pIO->GetData(), expected_length);
+    }
     if (read_length == expected_length)
       return pIO;
     else {
@@ -576,6 +775,7 @@ bool CIccProfile::AttachTag(icSignature sig, CIccTag *pTag)
   Entry.pTag = pTag;
 
   m_Tags.push_back(Entry);
+  IndexTag(--m_Tags.end());
 
   TagPtrList::iterator i;
 
@@ -612,13 +812,9 @@ bool CIccProfile::DeleteTag(icSignature sig)
 {
   TagEntryList::iterator i;
 
-  for (i=m_Tags.begin(); i!=m_Tags.end(); i++) {
-    if (i->TagInfo.sig==(icTagSignature)sig)
-      break;
-  }
-  if (i!=m_Tags.end()) {
+  if (GetTagPos(sig, i)) {
     CIccTag *pTag = i->pTag;
-    m_Tags.erase(i);
+    EraseTagEntry(i);
 
     if (pTag && !GetTag(pTag)) {
       DetachTag(pTag);
@@ -718,6 +914,48 @@ bool CIccProfile::Attach(CIccIO *pIO, bool bUseSubProfile/*=false*/)
   return true;
 }
 
+/**
+******************************************************************************
+* Name: CIccProfile::AttachSource
+* 
+* Purpose: Sets up the profile as a lazy copy of a fully read profile.  The
+*  header and tag directory are copied right away, and each tag is copied
+*  from the source profile the first time it is used.  The source profile
+*  is kept alive by the profile and must not be changed while shared.
+* 
+* Args: 
+*  pSource - shared pointer to the fully read source profile
+* 
+* Return: 
+*  true - profile set up,
+*  false - no source profile
+*******************************************************************************
+*/
+bool CIccProfile::AttachSource(CIccSharedProfilePtr pSource)
+{
+  if (!pSource)
+    return false;
+
+  Cleanup();
+
+  memcpy(&m_Header, &pSource->m_Header, sizeof(m_Header));
+  m_parentColorSpace = pSource->m_parentColorSpace;
+
+  TagEntryList::const_iterator i;
+  IccTagEntry entry = {};
+
+  for (i=pSource->m_Tags.begin(); i!=pSource->m_Tags.end(); i++) {
+    memcpy(&entry.TagInfo, &i->TagInfo, sizeof(icTag));
+    entry.pTag = NULL;
+    m_Tags.push_back(entry);
+  }
+  IndexTags();
+
+  m_pSourceProfile = pSource;
+
+  return true;
+}
+
 /**
 ******************************************************************************
 * Name: CIccProfile::Detach
@@ -733,6 +971,11 @@ bool CIccProfile::Attach(CIccIO *pIO, bool bUseSubProfile/*=false*/)
 */
 bool CIccProfile::Detach()
 {
+  if (m_pSourceProfile) {
+    m_pSourceProfile.reset();
+    return true;
+  }
+
   if (m_pAttachIO && !m_bSharedIO) {
     TagEntryList::iterator i;
 
@@ -741,6 +984,7 @@ bool CIccProfile::Detach()
         i->pTag->DetachIO();
     }
 
+    ReleaseTagReaders();
     delete m_pAttachIO;
 
     m_pAttachIO = NULL;
@@ -810,7 +1054,7 @@ bool CIccProfile::ReadTags(CIccProfile* pProfile)
   //loaded in
   if (!pIO) {
     for (i = m_Tags.begin(); i != m_Tags.end(); i++) {
-      if (!i->pTag) {
+      if (!i->pTag && !(m_pSourceProfile && LoadAttachedTag(&(*i)))) {
         return false;
       }
     }
@@ -820,7 +1064,17 @@ bool CIccProfile::ReadTags(CIccProfile* pProfile)
 	size_t pos = pIO->Tell();
 
 	for (i=m_Tags.begin(); i!=m_Tags.end(); i++) {
-		if (!LoadTag((IccTagEntry*)&(i->TagInfo), pIO, true)) {
+		bool bLoaded;
+
+		if (pIO == m_pAttachIO) {
+			CIccTag *pTag = LoadAttachedTag(&(*i));
+			bLoaded = pTag && pTag->ReadAll();
+		}
+		else {
+			bLoaded = LoadTag((IccTagEntry*)&(i->TagInfo), pIO, true);
+		}
+
+		if (!bLoaded) {
 			pIO->Seek(pos, icSeekSet);
 			return false;
 		}
@@ -908,6 +1162,13 @@ icValidateStatus CIccProfile::ReadValidate(CIccIO *pIO, std::string &sReport)
   if (m_Tags.size())
     Cleanup();
 
+  //The profile ID is calculated from the bytes as they are read.  Tags of
+  //an attached profile may keep the IO object so it is used directly then.
+  CIccMD5IO md5IO;
+
+  if (!m_pAttachIO && md5IO.Attach(pIO))
+    pIO = &md5IO;
+
   if (!ReadBasic(pIO)) {
     sReport += icMsgValidateCriticalError;
     sReport += " - Unable to read profile!**\n\tProfile has invalid structure!\n";
@@ -924,29 +1185,9 @@ icValidateStatus CIccProfile::ReadValidate(CIccIO *pIO, std::string &sReport)
   }
 
   CIccInfo Info;
-  icProfileID profileID;
-  // check if bytes 84..89 are zero, if not we assume a profile id
-  if (Info.IsProfileIDCalculated(&m_Header.profileID)) {
-      CalcProfileID(pIO, &profileID);
-      // if the provided and the calculated profileid missmatch
-      if (memcmp((char *) profileID.ID8, (char *) m_Header.profileID.ID8, 16) != 0) {
-          if (m_Header.version >= icVersionNumberV4) { // error with bad profile ID on v4.x.y profiles (or higher)
-              sReport += icMsgValidateNonCompliant;
-              sReport += "Bad Profile ID\n";
-              rv = icMaxStatus(rv, icValidateNonCompliant);
-          } else { // on older profiles the reserved bytes are (mis-)interpreted as profile id
-              sReport += icMsgValidateWarning;
-              sReport += "Version 2 profile has non-zero reserved data that doesn't match calculated Profile ID\n";
-              rv = icMaxStatus(rv, icValidateWarning);
-          }
-      } else { // the provided and the calculated profileid match
-          if (m_Header.version < icVersionNumberV4) { // the profileid should only be used in v4.x.y profiles (or higher)
-              sReport += icMsgValidateWarning;
-              sReport += "Version 2 profile has non-zero reserved data that matches calculated Profile ID\n";
-              rv = icMaxStatus(rv, icValidateWarning);
-          }
-      }
-  }
+
+  //Profile ID messages are reported here once all tags have been read
+  size_t nIDReportPos = sReport.size();
 
   TagEntryList::iterator i;
 
@@ -968,6 +1209,38 @@ icValidateStatus CIccProfile::ReadValidate(CIccIO *pIO, std::string &sReport)
     }
   }
 
+  // check if bytes 84..89 are zero, if not we assume a profile id
+  if (Info.IsProfileIDCalculated(&m_Header.profileID)) {
+      std::string sIDReport;
+      icProfileID profileID;
+
+      if (pIO==&md5IO)
+        md5IO.GetProfileID(&profileID);
+      else
+        CalcProfileID(pIO, &profileID);
+
+      // if the provided and the calculated profileid missmatch
+      if (memcmp((char *) profileID.ID8, (char *) m_Header.profileID.ID8, 16) != 0) {
+          if (m_Header.version >= icVersionNumberV4) { // error with bad profile ID on v4.x.y profiles (or higher)
+              sIDReport += icMsgValidateNonCompliant;
+              sIDReport += "Bad Profile ID\n";
+              rv = icMaxStatus(rv, icValidateNonCompliant);
+          } else { // on older profiles the reserved bytes are (mis-)interpreted as profile id
+              sIDReport += icMsgValidateWarning;
+              sIDReport += "Version 2 profile has non-zero reserved data that doesn't match calculated Profile ID\n";
+              rv = icMaxStatus(rv, icValidateWarning);
+          }
+      } else { // the provided and the calculated profileid match
+          if (m_Header.version < icVersionNumberV4) { // the profileid should only be used in v4.x.y profiles (or higher)
+              sIDReport += icMsgValidateWarning;
+              sIDReport += "Version 2 profile has non-zero reserved data that matches calculated Profile ID\n";
+              rv = icMaxStatus(rv, icValidateWarning);
+          }
+      }
+
+      sReport.insert(nIDReportPos, sIDReport);
+  }
+
   if (rv==icValidateCriticalError)
     Cleanup();
 
@@ -975,6 +1248,40 @@ icValidateStatus CIccProfile::ReadValidate(CIccIO *pIO, std::string &sReport)
 }
 
 
+/**
+ ******************************************************************************
+ * Name: icTagShareGroup
+ * 
+ * Purpose: Tags read from the same data share one tag object, and ReadTag()
+ *  sets up the color spaces of some tag types by signature.  Only tags of
+ *  the same group share identical data when writing.
+ *******************************************************************************
+ */
+static char icTagShareGroup(icTagSignature sig)
+{
+  switch(sig) {
+  case icSigAToB0Tag:
+  case icSigAToB1Tag:
+  case icSigAToB2Tag:
+    return 1;
+
+  case icSigBToA0Tag:
+  case icSigBToA1Tag:
+  case icSigBToA2Tag:
+    return 2;
+
+  case icSigGamutTag:
+    return 3;
+
+  case icSigNamedColor2Tag:
+    return 4;
+
+  default:
+    return 0;
+  }
+}
+
+
 /**
  ******************************************************************************
  * Name: CIccProfile::Write
@@ -984,13 +1291,41 @@ icValidateStatus CIccProfile::ReadValidate(CIccIO *pIO, std::string &sReport)
  * 
  * Args: 
  *  pIO - pointer to IO object to write data to
+ *  nWriteId - when the profile ID is written
+ *  nShareTags - whether tags with identical data share a single copy
+ *  pnBytesSaved - optional returned number of bytes saved by sharing
+ *   identical tag data
  * 
  * Return: 
  *  true - success, false - failure
  *******************************************************************************
  */
-bool CIccProfile::Write(CIccIO *pIO, icProfileIDSaveMethod nWriteId)
+bool CIccProfile::Write(CIccIO *pIO, icProfileIDSaveMethod nWriteId, icTagShareMethod nShareTags,
+                        icUInt32Number *pnBytesSaved)
 {
+  bool bWriteId;
+
+  switch (nWriteId) {
+    case icVersionBasedID:
+    default:
+      bWriteId = (m_Header.version>=icVersionNumberV4);
+      break;
+    case icAlwaysWriteID:
+      bWriteId = true;
+      break;
+    case icNeverWriteID:
+      bWriteId = false;
+  }
+  if (m_Header.deviceClass==icSigColorEncodingClass) {
+    bWriteId = false;
+  }
+
+  //Keep what is written so the profile ID doesn't require reading the profile back
+  CIccMD5IO md5IO;
+
+  if (bWriteId && md5IO.Attach(pIO))
+    pIO = &md5IO;
+
   //Write Header
   pIO->Seek(0, icSeekSet);
 
@@ -1053,6 +1388,10 @@ bool CIccProfile::Write(CIccIO *pIO, icProfileIDSaveMethod nWriteId)
     }
   }
 
+  //Written tag data (prefixed by icTagShareGroup) when identical tags share data
+  std::unordered_map<std::string, TagEntryList::iterator> tagData;
+  icUInt32Number nBytesSaved = 0;
+
   //Write Tags
   for (i=m_Tags.begin(); i!= m_Tags.end(); i++) {
     if (i->pTag) {
@@ -1061,7 +1400,34 @@ bool CIccProfile::Write(CIccIO *pIO, icProfileIDSaveMethod nWriteId)
           break;
       }
 
-      if (i==j) {
+      CIccMemIO tagIO;
+
+      if (i==j && nShareTags==icShareIdenticalTags && tagIO.Alloc(1024, true, true)) {
+        i->pTag->Write(&tagIO);
+
+        std::string data(1, icTagShareGroup(i->TagInfo.sig));
+        data.append((const char*)tagIO.GetData(), tagIO.GetLength());
+        tagIO.Close();
+
+        std::unordered_map<std::string, TagEntryList::iterator>::iterator found = tagData.find(data);
+
+        if (found!=tagData.end()) {
+          i->TagInfo.offset = found->second->TagInfo.offset;
+          i->TagInfo.size = found->second->TagInfo.size;
+
+          nBytesSaved += (i->TagInfo.size + 3) & ~3;
+        }
+        else {
+          i->TagInfo.offset = (icUInt32Number) pIO->GetLength();
+          pIO->Write8(&data[1], data.size()-1);
+          i->TagInfo.size = (icUInt32Number)( pIO->GetLength() - i->TagInfo.offset );
+
+          pIO->Align32();
+
+          tagData.emplace(std::move(data), i);
+        }
+      }
+      else if (i==j) {
         i->TagInfo.offset = (icUInt32Number) pIO->GetLength();
         i->pTag->Write(pIO);
         i->TagInfo.size = (icUInt32Number)( pIO->GetLength() - i->TagInfo.offset );
@@ -1075,6 +1441,9 @@ bool CIccProfile::Write(CIccIO *pIO, icProfileIDSaveMethod nWriteId)
     }
   }
 
+  if (pnBytesSaved)
+    *pnBytesSaved = nBytesSaved;
+
   pIO->Seek(dirpos, icSeekSet);
 
   //Write TagDir with offsets and sizes
@@ -1091,26 +1460,12 @@ bool CIccProfile::Write(CIccIO *pIO, icProfileIDSaveMethod nWriteId)
   pIO->Seek(0, icSeekSet);
   pIO->Write32(&m_Header.size);
 
-  bool bWriteId;
-
-  switch (nWriteId) {
-    case icVersionBasedID:
-    default:
-      bWriteId = (m_Header.version>=icVersionNumberV4);
-      break;
-    case icAlwaysWriteID:
-      bWriteId = true;
-      break;
-    case icNeverWriteID:
-      bWriteId = false;
-  }
-  if (m_Header.deviceClass==icSigColorEncodingClass) {
-    bWriteId = false;
-  }
-
   //Write the profile ID if version 4 profile
   if(bWriteId) {
-    CalcProfileID(pIO, &m_Header.profileID);
+    if (pIO==&md5IO)
+      md5IO.GetProfileID(&m_Header.profileID);
+    else
+      CalcProfileID(pIO, &m_Header.profileID);
     pIO->Seek(84, icSeekSet);
     pIO->Write8(&m_Header.profileID, sizeof(m_Header.profileID));
   }
@@ -1270,77 +1625,122 @@ bool CIccProfile::ReadBasic(CIccIO *pIO)
     m_Tags.push_back(TagEntry);
   }
 
+  IndexTags();
+
+  return true;
+}
+
+
+/**
+ ******************************************************************************
+ * Name: CIccProfile::LoadTag
+ * 
+ * Purpose: This will load from the indicated IO object and associate a tag
+ *  object to a tag directory entry.  Nothing happens if tag directory entry
+ *  is associated with a tag object.
+ * 
+ * Args: 
+ *  pTagEntry - pointer to tag directory entry,
+ *  pIO - pointer to IO object to read tag object data from
+ * 
+ * Return: 
+ *  true - tag directory object associated with tag directory entry,
+ *  false - failure
+ *******************************************************************************
+ */
+bool CIccProfile::LoadTag(IccTagEntry *pTagEntry, CIccIO *pIO, bool bReadAll/*=false*/)
+{
+  if (!pTagEntry)
+    return false;
+
+  if (pTagEntry->pTag)
+    return pTagEntry->pTag->ReadAll();
+
+  CIccTag *pTag = ReadTag(pTagEntry, pIO, bReadAll);
+
+  if (!pTag)
+    return false;
+
+  pTagEntry->pTag = pTag;
+
+  IccTagPtr TagPtr = {};
+
+  TagPtr.ptr = pTag;
+
+  m_TagVals.push_back(TagPtr);
+
+  TagEntryList::iterator i;
 
+  for (i=m_Tags.begin(); i!= m_Tags.end(); i++) {
+    if (i->TagInfo.offset == pTagEntry->TagInfo.offset &&
+        i->pTag != pTag)
+      i->pTag = pTag; 
+  }
+  
   return true;
 }
 
 
 /**
  ******************************************************************************
- * Name: CIccProfile::LoadTag
+ * Name: CIccProfile::ReadTag
  * 
- * Purpose: This will load from the indicated IO object and associate a tag
- *  object to a tag directory entry.  Nothing happens if tag directory entry
- *  is associated with a tag object.
+ * Purpose: Creates and reads the tag object for a tag directory entry from
+ *  the indicated IO object.  The tag object is not associated with the
+ *  directory entry, and the profile object is not changed.
  * 
  * Args: 
  *  pTagEntry - pointer to tag directory entry,
- *  pIO - pointer to IO object to read tag object data from
+ *  pIO - pointer to IO object to read tag object data from,
+ *  bReadAll - whether all sub data of the tag should be read in
  * 
  * Return: 
- *  true - tag directory object associated with tag directory entry,
- *  false - failure
+ *  Pointer to the new tag object, or NULL on failure
  *******************************************************************************
  */
-bool CIccProfile::LoadTag(IccTagEntry *pTagEntry, CIccIO *pIO, bool bReadAll/*=false*/)
+CIccTag* CIccProfile::ReadTag(const IccTagEntry *pTagEntry, CIccIO *pIO, bool bReadAll/*=false*/)
 {
-  if (!pTagEntry)
-    return false;
-
-  if (pTagEntry->pTag)
-    return pTagEntry->pTag->ReadAll();
-
   // if the tag claims to be inside the header, or zero length, return an error
   if (pTagEntry->TagInfo.offset<sizeof(m_Header) ||
     !pTagEntry->TagInfo.size) {
-    return false;
+    return NULL;
   }
   
   // if the tag claims to be longer than the actual file, return an error
   // NOTE - ccox - it would be nice to cache the file length instead of calculating it per tag
   if ( (pTagEntry->TagInfo.offset + pTagEntry->TagInfo.size) > pIO->GetLength())
-    return false;
+    return NULL;
 
   icTagTypeSignature sigType;
 
   //First we need to get the tag type to create the right kind of tag
   if (pIO->Seek(pTagEntry->TagInfo.offset, icSeekSet)!= pTagEntry->TagInfo.offset)
-    return false;
+    return NULL;
 
   if (!pIO->Read32(&sigType))
-    return false;
+    return NULL;
 
   CIccTag *pTag = CIccTag::Create(sigType);
 
   if (!pTag)
-    return false;
+    return NULL;
 
   //Now seek back to where the tag starts so the created tag object can read
   //in its data.
   if (pIO->Seek(pTagEntry->TagInfo.offset, icSeekSet)!= pTagEntry->TagInfo.offset) {
     delete pTag;
-    return false;
+    return NULL;
   }
 
   if (!pTag->Read(pTagEntry->TagInfo.size, pIO, this)) {
     delete pTag;
-    return false;
+    return NULL;
   }
 
   if (bReadAll) {
     if (!pTag->ReadAll()) {
       delete pTag;
-      return false;
+      return NULL;
     }
   }
 
@@ -1382,23 +1782,138 @@ bool CIccProfile::LoadTag(IccTagEntry *pTagEntry, CIccIO *pIO, bool bReadAll/*=f
     break;
   }
 
-  pTagEntry->pTag = pTag;
+  return pTag;
+}
 
-  IccTagPtr TagPtr = {};
 
-  TagPtr.ptr = pTag;
+/**
+ ******************************************************************************
+ * Name: CIccProfile::LoadAttachedTag
+ * 
+ * Purpose: Thread safe on demand loading of a tag from the attached IO object
+ *  or source profile.  Each tag is read and associated with its directory
+ *  entries exactly once.  Tags are copied from a source profile, or parsed
+ *  through a CIccPositionalIO of their own if the attached IO supports
+ *  positional reads, outside of the lock so different tags can be loaded
+ *  by several threads at once.  Otherwise loading is serialized.  Threads
+ *  asking for a tag that is being loaded wait for it.  Loaded tags are
+ *  published in the entry's LoadState and found without the lock.
+ * 
+ * Args: 
+ *  pTagEntry - pointer to tag directory entry
+ * 
+ * Return: 
+ *  Pointer to the tag object associated with the entry, or NULL on failure
+ *******************************************************************************
+ */
+CIccTag* CIccProfile::LoadAttachedTag(IccTagEntry *pTagEntry)
+{
+  //A tag that has been published is not changed by loading so it can be
+  //returned without taking the lock
+  CIccTag *pTag = pTagEntry->LoadState.m_pTag.load(std::memory_order_acquire);
 
-  m_TagVals.push_back(TagPtr);
+  if (pTag && pTag==pTagEntry->pTag)
+    return pTag;
 
-  TagEntryList::iterator i;
+  std::unique_lock<std::mutex> lock(m_TagLoadLock);
 
-  for (i=m_Tags.begin(); i!= m_Tags.end(); i++) {
-    if (i->TagInfo.offset == pTagEntry->TagInfo.offset &&
-        i->pTag != pTag)
-      i->pTag = pTag; 
+  while (!pTagEntry->pTag && pTagEntry->LoadState.m_bLoading)
+    m_TagLoaded.wait(lock);
+
+  if (pTagEntry->pTag || (!m_pAttachIO && !m_pSourceProfile)) {
+    pTagEntry->LoadState.m_pTag.store(pTagEntry->pTag, std::memory_order_release);
+    return pTagEntry->pTag;
   }
-  
-  return true;
+
+  CIccPositionalIO *pReader = NULL;
+
+  if (!m_pSourceProfile) {
+    pReader = new CIccPositionalIO;
+
+    if (!pReader->Attach(m_pAttachIO)) {
+      delete pReader;
+
+      LoadTag(pTagEntry, m_pAttachIO);
+      pTagEntry->LoadState.m_pTag.store(pTagEntry->pTag, std::memory_order_release);
+      return pTagEntry->pTag;
+    }
+  }
+
+  pTagEntry->LoadState.m_bLoading = true;
+  lock.unlock();
+
+  pTag = pReader ? ReadTag(pTagEntry, pReader) : CopySourceTag(pTagEntry);
+
+  lock.lock();
+  pTagEntry->LoadState.m_bLoading = false;
+
+  if (pTag) {
+    //Another entry sharing the same tag data may have been loaded meanwhile
+    TagEntryList::iterator i;
+    for (i=m_Tags.begin(); i!=m_Tags.end(); i++) {
+      if (i->TagInfo.offset == pTagEntry->TagInfo.offset && i->pTag) {
+        delete pTag;
+        pTag = i->pTag;
+        break;
+      }
+    }
+
+    if (i==m_Tags.end()) {
+      IccTagPtr TagPtr = {};
+
+      TagPtr.ptr = pTag;
+      m_TagVals.push_back(TagPtr);
+
+      //Tags can retain the IO they were read from so keep it until the
+      //profile is cleaned up or detached
+      if (pReader)
+        m_TagReaders.push_back(pReader);
+      pReader = NULL;
+    }
+
+    //Entries that already have a tag may have published it
+    for (i=m_Tags.begin(); i!=m_Tags.end(); i++) {
+      if (i->TagInfo.offset == pTagEntry->TagInfo.offset && !i->pTag)
+        i->pTag = pTag;
+    }
+
+    pTagEntry->LoadState.m_pTag.store(pTagEntry->pTag, std::memory_order_release);
+  }
+
+  if (pReader)
+    delete pReader;
+
+  m_TagLoaded.notify_all();
+
+  return pTagEntry->pTag;
+}
+
+
+/**
+ ******************************************************************************
+ * Name: CIccProfile::CopySourceTag
+ * 
+ * Purpose: Creates a copy of the tag of the source profile that belongs to
+ *  a tag directory entry.
+ * 
+ * Args: 
+ *  pTagEntry - pointer to tag directory entry
+ * 
+ * Return: 
+ *  Pointer to the new tag object, or NULL if the source has no such tag
+ *******************************************************************************
+ */
+CIccTag* CIccProfile::CopySourceTag(const IccTagEntry *pTagEntry) const
+{
+  if (!m_pSourceProfile)
+    return NULL;
+
+  const IccTagEntry *pSrcEntry = m_pSourceProfile->GetTag(pTagEntry->TagInfo.sig);
+
+  if (!pSrcEntry || !pSrcEntry->pTag)
+    return NULL;
+
+  return pSrcEntry->pTag->NewCopy();
 }
 
 
@@ -1440,7 +1955,7 @@ bool CIccProfile::DetachTag(CIccTag *pTag)
   TagEntryList::iterator j;
   for (j=m_Tags.begin(); j!=m_Tags.end();) {
     if (j->pTag == pTag) {
-      j=m_Tags.erase(j);
+      j=EraseTagEntry(j);
     }
     else
       j++;
@@ -2973,14 +3488,23 @@ bool CIccProfile::CheckFileSize(CIccIO *pIO) const
  * Purpose: Check the data integrity of the profile, and conformance to
  *  the ICC specification
  * 
+ *  Tags are validated independently on up to nThreads threads.  Each tag
+ *  reports to its own string and the strings are added to sReport in tag
+ *  directory order, so the report does not depend on the number of threads.
+ *  Directory entries that share a tag object are validated by one thread.
+ * 
  * Args:
  *  sReport = String to put report into
+ *  sSigPath = signature path of the profile
+ *  pParentProfile = profile that this profile is embedded in
+ *  nThreads = number of threads to validate tags with (0 = number of hardware threads)
  * 
  * Return: 
  *  icValidateOK if profile is valid, warning/error level otherwise
  *****************************************************************************
  */
-icValidateStatus CIccProfile::Validate(std::string &sReport, std::string sSigPath/*=""*/, const CIccProfile *pParentProfile) const
+icValidateStatus CIccProfile::Validate(std::string &sReport, std::string sSigPath/*=""*/, const CIccProfile *pParentProfile,
+                                       icUInt32Number nThreads/*=1*/) const
 {
   icValidateStatus rv = icValidateOK;
 
@@ -3000,9 +3524,80 @@ icValidateStatus CIccProfile::Validate(std::string &sReport, std::string sSigPat
   // Per Tag tests
   rv = icMaxStatus(rv, CheckTagTypes(sReport));
   TagEntryList::const_iterator i;
+
+  if (!nThreads)
+    nThreads = std::thread::hardware_concurrency();
+
+  if (nThreads<=1 || m_Tags.size()<2) {
+    for (i=m_Tags.begin(); i!=m_Tags.end(); i++) {
+      if (i->pTag)        // should we give an error if pTag is NULL/Not loaded?
+        rv = icMaxStatus(rv, i->pTag->Validate(sSigPath + icGetSigPath(i->TagInfo.sig), sReport, this));
+    }
+
+    return rv;
+  }
+
+  //Entries are grouped by tag object.  Each group is a job, listed by its first entry.
+  std::vector<const IccTagEntry*> entries;
+  std::vector<size_t> nextInGroup(m_Tags.size(), (size_t)-1);
+  std::vector<size_t> jobs;
+  std::unordered_map<const CIccTag*, size_t> lastOfTag;
+  size_t n;
+
   for (i=m_Tags.begin(); i!=m_Tags.end(); i++) {
-    if (i->pTag)        // should we give an error if pTag is NULL/Not loaded?
-      rv = icMaxStatus(rv, i->pTag->Validate(sSigPath + icGetSigPath(i->TagInfo.sig), sReport, this));
+    n = entries.size();
+    entries.push_back(&(*i));
+
+    if (!i->pTag)
+      continue;
+
+    std::unordered_map<const CIccTag*, size_t>::iterator t = lastOfTag.find(i->pTag);
+    if (t==lastOfTag.end()) {
+      jobs.push_back(n);
+      lastOfTag[i->pTag] = n;
+    }
+    else {
+      nextInGroup[t->second] = n;
+      t->second = n;
+    }
+  }
+
+  std::vector<std::string> reports(entries.size());
+  std::vector<icValidateStatus> status(entries.size(), icValidateOK);
+  std::atomic<size_t> nNext(0);
+  size_t nJobs = jobs.size();
+
+  auto worker = [&]() {
+    size_t j, e;
+
+    while ((j = nNext++) < nJobs) {
+      for (e=jobs[j]; e!=(size_t)-1; e=nextInGroup[e])
+        status[e] = entries[e]->pTag->Validate(sSigPath + icGetSigPath(entries[e]->TagInfo.sig), reports[e], this);
+    }
+  };
+
+  if (nThreads > nJobs)
+    nThreads = (icUInt32Number)nJobs;
+
+  std::vector<std::thread> threads;
+  for (icUInt32Number t=1; t<nThreads; t++) {
+    try {
+      threads.push_back(std::thread(worker));
+    }
+    catch (...) {
+      //Tags of workers that could not be started are validated by the others
+      break;
+    }
+  }
+
+  worker();
+
+  for (n=0; n<threads.size(); n++)
+    threads[n].join();
+
+  for (n=0; n<entries.size(); n++) {
+    sReport += reports[n];
+    rv = icMaxStatus(rv, status[n]);
   }
 
   return rv;
@@ -3642,6 +4237,82 @@ CIccProfile* OpenIccProfile(const icUInt8Number *pMem, icUInt32Number nSize, boo
   return pIcc;
 }
 
+/**
+******************************************************************************
+* Name: OpenIccProfileMapped
+* 
+* Purpose: Open an ICC profile file by memory mapping it.  This will only
+*  read the profile header and tag directory.  Tags are read from the mapped
+*  file when they are referenced by FindTag(), so the file is never copied
+*  into memory as a whole and only the parts that are used are paged in.
+*  The mapping is released when the returned profile is deleted.
+* 
+* Args: 
+*  szFilename - zero terminated string with filename of ICC profile to read
+*  bUseSubProfile - will attempt to open a subprofile if present
+* 
+* Return: 
+*  Pointer to icc profile object, or NULL on failure
+*******************************************************************************
+*/
+CIccProfile* OpenIccProfileMapped(const icChar *szFilename, bool bUseSubProfile/*=false*/)
+{
+  CIccMappedIO *pMappedIO = new CIccMappedIO;
+
+  if (!pMappedIO->Open(szFilename)) {
+    delete pMappedIO;
+    return NULL;
+  }
+
+  CIccProfile *pIcc = new CIccProfile;
+
+  if (!pIcc->Attach(pMappedIO, bUseSubProfile)) {
+    delete pIcc;
+    delete pMappedIO;
+    return NULL;
+  }
+
+  return pIcc;
+}
+
+#ifdef WIN32
+/**
+******************************************************************************
+* Name: OpenIccProfileMapped
+* 
+* Purpose: Open an ICC profile file by memory mapping it.  This will only
+*  read the profile header and tag directory.  Tags are read from the mapped
+*  file when they are referenced by FindTag().
+* 
+* Args: 
+*  szFilename - zero terminated string with filename of ICC profile to read 
+*  bUseSubProfile - will attempt to open a subprofile if present
+*
+* Return: 
+*  Pointer to icc profile object, or NULL on failure
+*******************************************************************************
+*/
+CIccProfile* OpenIccProfileMapped(const icWChar *szFilename, bool bUseSubProfile/*=false*/)
+{
+  CIccMappedIO *pMappedIO = new CIccMappedIO;
+
+  if (!pMappedIO->Open(szFilename)) {
+    delete pMappedIO;
+    return NULL;
+  }
+
+  CIccProfile *pIcc = new CIccProfile;
+
+  if (!pIcc->Attach(pMappedIO, bUseSubProfile)) {
+    delete pIcc;
+    delete pMappedIO;
+    return NULL;
+  }
+
+  return pIcc;
+}
+#endif
+
 /**
 ******************************************************************************
 * Name: ValidateIccProfile
@@ -3828,6 +4499,166 @@ CIccProfile* ValidateIccProfile(const icUInt8Number* pMem, icUInt32Number nSize,
 }
 
 
+/**
+******************************************************************************
+* Name: ValidateIccProfiles
+*
+* Purpose: Validates several profile files at once.  The files are divided
+*  between worker threads and the results are passed to pSink in the order
+*  of the files with the same reports as ValidateIccProfile().  Workers
+*  stay at most nMaxPending files ahead of the next file to report, so that
+*  at most nMaxPending reports (and nThreads profiles) are held at a time.
+*
+* Args:
+*  files - paths of profile files
+*  pSink - object that receives the results
+*  nThreads - number of worker threads (0 = number of hardware threads)
+*  nMaxPending - number of files that can be validated ahead of the next
+*   file to report (0 = four per thread)
+*******************************************************************************
+*/
+void ValidateIccProfiles(const std::vector<std::string> &files, IIccValidateSink *pSink,
+                         icUInt32Number nThreads/*=0*/, icUInt32Number nMaxPending/*=0*/)
+{
+  size_t nFiles = files.size();
+
+  if (!nFiles || !pSink)
+    return;
+
+  if (!nThreads)
+    nThreads = std::thread::hardware_concurrency();
+  if (!nThreads)
+    nThreads = 1;
+  if (nThreads > nFiles)
+    nThreads = (icUInt32Number)nFiles;
+  if (!nMaxPending)
+    nMaxPending = 4 * nThreads;
+  if (nMaxPending < nThreads)
+    nMaxPending = nThreads;
+
+  std::mutex lock;
+  std::condition_variable ready;
+  std::vector<icProfileValidation*> pending(nMaxPending, NULL);  //Results by file index modulo nMaxPending
+  size_t nNext = 0;       //Next file to validate
+  size_t nReport = 0;     //Next file to report
+  bool bReporting = false;
+
+  auto worker = [&]() {
+    std::unique_lock<std::mutex> l(lock);
+
+    for (;;) {
+      while (nNext < nFiles && nNext >= nReport + nMaxPending)
+        ready.wait(l);
+      if (nNext >= nFiles)
+        break;
+
+      size_t n = nNext++;
+      l.unlock();
+
+      icProfileValidation *pResult = new icProfileValidation;
+      pResult->nStatus = icValidateOK;
+
+      CIccProfile *pIcc = ValidateIccProfile(files[n].c_str(), pResult->sReport, pResult->nStatus);
+      if (!pIcc)
+        pResult->nStatus = icValidateCriticalError;
+
+      pSink->Validated(n, pIcc, pResult->nStatus, pResult->sReport);
+
+      if (pIcc)
+        delete pIcc;
+
+      l.lock();
+      pending[n % nMaxPending] = pResult;
+
+      //One worker at a time reports the results that are ready in order
+      if (!bReporting) {
+        bReporting = true;
+
+        while (nReport < nFiles && pending[nReport % nMaxPending]) {
+          size_t r = nReport;
+          pResult = pending[r % nMaxPending];
+          pending[r % nMaxPending] = NULL;
+          l.unlock();
+
+          pSink->Report(r, pResult->nStatus, pResult->sReport);
+          delete pResult;
+
+          l.lock();
+          nReport++;
+          ready.notify_all();
+        }
+
+        bReporting = false;
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (icUInt32Number t=1; t<nThreads; t++) {
+    try {
+      threads.push_back(std::thread(worker));
+    }
+    catch (...) {
+      //Files of workers that could not be started are validated by the others
+      break;
+    }
+  }
+
+  worker();
+
+  for (size_t i=0; i<threads.size(); i++)
+    threads[i].join();
+}
+
+
+/**
+******************************************************************************
+* Name: CIccValidateResults
+*
+* Purpose: Sink that keeps the results of ValidateIccProfiles()
+*******************************************************************************
+*/
+class CIccValidateResults : public IIccValidateSink
+{
+public:
+  CIccValidateResults(std::vector<icProfileValidation> &results) : m_results(results) {}
+
+  virtual void Report(size_t nIndex, icValidateStatus nStatus, const std::string &sReport)
+  {
+    m_results[nIndex].nStatus = nStatus;
+    m_results[nIndex].sReport = sReport;
+  }
+
+protected:
+  std::vector<icProfileValidation> &m_results;
+};
+
+
+/**
+******************************************************************************
+* Name: ValidateIccProfiles
+*
+* Purpose: Validates several profile files at once.  The files are divided
+*  between worker threads.
+*
+* Args:
+*  files - paths of profile files
+*  results - returned results in the same order as files
+*  nThreads - number of worker threads (0 = number of hardware threads)
+*******************************************************************************
+*/
+void ValidateIccProfiles(const std::vector<std::string> &files, std::vector<icProfileValidation> &results,
+                         icUInt32Number nThreads/*=0*/)
+{
+  CIccValidateResults sink(results);
+
+  results.resize(files.size());
+
+  //All results are kept, so workers need not wait for them to be reported
+  ValidateIccProfiles(files, &sink, nThreads, (icUInt32Number)(files.size() < 0xffffffff ? files.size() : 0xffffffff));
+}
+
+
 /**
  ******************************************************************************
  * Name: SaveIccProfile
@@ -3841,7 +4672,8 @@ CIccProfile* ValidateIccProfile(const icUInt8Number* pMem, icUInt32Number nSize,
  *  true = success, false = failure
  *******************************************************************************
  */
-bool SaveIccProfile(const icChar *szFilename, CIccProfile *pIcc, icProfileIDSaveMethod nWriteId)
+bool SaveIccProfile(const icChar *szFilename, CIccProfile *pIcc, icProfileIDSaveMethod nWriteId, icTagShareMethod nShareTags,
+                    icUInt32Number *pnBytesSaved)
 {
   CIccFileIO FileIO;
 
@@ -3852,7 +4684,7 @@ bool SaveIccProfile(const icChar *szFilename, CIccProfile *pIcc, icProfileIDSave
     return false;
   }
 
-  if (!pIcc->Write(&FileIO, nWriteId)) {
+  if (!pIcc->Write(&FileIO, nWriteId, nShareTags, pnBytesSaved)) {
     return false;
   }
 
@@ -3872,7 +4704,8 @@ bool SaveIccProfile(const icChar *szFilename, CIccProfile *pIcc, icProfileIDSave
 *  true = success, false = failure
 *******************************************************************************
 */
-bool SaveIccProfile(FILE *f, CIccProfile *pIcc, icProfileIDSaveMethod nWriteId)
+bool SaveIccProfile(FILE *f, CIccProfile *pIcc, icProfileIDSaveMethod nWriteId, icTagShareMethod nShareTags,
+                    icUInt32Number *pnBytesSaved)
 {
   CIccFileIO FileIO;
 
@@ -3883,7 +4716,7 @@ bool SaveIccProfile(FILE *f, CIccProfile *pIcc, icProfileIDSaveMethod nWriteId)
     return false;
   }
 
-  if (!pIcc->Write(&FileIO, nWriteId)) {
+  if (!pIcc->Write(&FileIO, nWriteId, nShareTags, pnBytesSaved)) {
     return false;
   }
 
@@ -3906,7 +4739,8 @@ bool SaveIccProfile(FILE *f, CIccProfile *pIcc, icProfileIDSaveMethod nWriteId)
 *  true = success, false = failure
 *******************************************************************************
 */
-bool SaveIccProfile(const icWChar *szFilename, CIccProfile *pIcc, icProfileIDSaveMethod nWriteId)
+bool SaveIccProfile(const icWChar *szFilename, CIccProfile *pIcc, icProfileIDSaveMethod nWriteId, icTagShareMethod nShareTags,
+                    icUInt32Number *pnBytesSaved)
 {
   CIccFileIO FileIO;
 
@@ -3917,7 +4751,7 @@ bool SaveIccProfile(const icWChar *szFilename, CIccProfile *pIcc, icProfileIDSav
     return false;
   }
 
-  if (!pIcc->Write(&FileIO, nWriteId)) {
+  if (!pIcc->Write(&FileIO, nWriteId, nShareTags, pnBytesSaved)) {
     return false;
   }
 
@@ -3939,37 +4773,15 @@ bool SaveIccProfile(const icWChar *szFilename, CIccProfile *pIcc, icProfileIDSav
  */
 void CalcProfileID(CIccIO *pIO, icProfileID *pProfileID)
 {
-  icUInt32Number nBlock;
-  MD5_CTX context;
-  icUInt8Number buffer[1024] = {0};
+  CIccMD5IO md5IO;
 
-  //remember where we are
-  size_t pos = pIO->Tell();
-
-  //Get length and set up to read entire file
-  size_t len = pIO->GetLength();
-  pIO->Seek(0, icSeekSet);
+  if (!md5IO.Attach(pIO)) {
+    memset(pProfileID, 0, sizeof(icProfileID));
+    return;
+  }
 
-  //read file updating checksum as we go
-  icMD5Init(&context);
-  nBlock = 0;
-  while(len) {
-    size_t num = pIO->Read8(&buffer[0],1024);
-    if (num == 0)
-        break;              // can't give a useful error here, but we need to break the infinite loop
-    if (!nBlock) {  // Zero out 3 header contents in Profile ID calculation
-      memset(buffer+44, 0, 4); //Profile flags
-      memset(buffer+64, 0, 4);  //Rendering Intent
-      memset(buffer+84, 0, 16); //Profile Id
-    }
-    icMD5Update(&context,buffer, (unsigned int) num);
-    nBlock++;
-    len -= num;
-  }
-  icMD5Final(&pProfileID->ID8[0],&context);
-
-  //go back where we were
-  pIO->Seek(pos, icSeekSet);
+  //hashes the whole IO object and leaves the position where it was
+  md5IO.GetProfileID(pProfileID);
 }
 
 /**
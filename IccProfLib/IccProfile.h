@@ -70,7 +70,13 @@
 #include "IccDefs.h"
 #include "IccPcc.h"
 #include <list>
+#include <vector>
 #include <string>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <atomic>
+#include <utility>
 
 #if defined(__cplusplus) && defined(USEICCDEVNAMESPACE)
 namespace iccDEV {
@@ -82,6 +88,27 @@ class ICCPROFLIB_API CIccTag;
 class ICCPROFLIB_API CIccIO;
 class ICCPROFLIB_API CIccMemIO;
 
+/**
+ **************************************************************************
+ * Type: Class
+ * 
+ * Purpose: On demand loading state of a tag directory entry.  The tag is
+ *  published to other threads through m_pTag once it has been loaded so
+ *  they can find it without taking the profile's tag load lock.  Copies
+ *  only take the published tag.
+ **************************************************************************
+ */
+class CIccTagLoadState
+{
+public:
+  CIccTagLoadState() : m_pTag(NULL), m_bLoading(false) {}
+  CIccTagLoadState(const CIccTagLoadState &state) : m_pTag(state.m_pTag.load(std::memory_order_acquire)), m_bLoading(false) {}
+  CIccTagLoadState &operator=(const CIccTagLoadState &state) { m_pTag.store(state.m_pTag.load(std::memory_order_acquire), std::memory_order_release); return *this; }
+
+  std::atomic<CIccTag*> m_pTag;
+  bool m_bLoading;  //Guarded by CIccProfile::m_TagLoadLock
+};
+
 /**
  **************************************************************************
  * Type: Structure
@@ -96,17 +123,76 @@ struct IccTagEntry
 
   icTag TagInfo;
   CIccTag* pTag;
+  CIccTagLoadState LoadState;
 };
 
 /**
  **************************************************************************
- * Type: List
+ * Type: Class
  * 
- * Purpose: List of all the tag entries.
+ * Purpose: List of all the tag entries.  Changes that can free or move
+ *  entries are counted so that CIccProfile knows when the positions in its
+ *  signature index can no longer be used.
  *
  **************************************************************************
  */
-typedef std::list<IccTagEntry> TagEntryList;
+class CIccTagEntryList : public std::list<IccTagEntry>
+{
+  typedef std::list<IccTagEntry> TagEntryBase;
+public:
+  CIccTagEntryList() : m_nChanges(0) {}
+  CIccTagEntryList(const CIccTagEntryList &list) : TagEntryBase(list), m_nChanges(0) {}
+  CIccTagEntryList &operator=(const CIccTagEntryList &list) { m_nChanges++; TagEntryBase::operator=(list); return *this; }
+
+  /// Number of changes that removed, inserted or reordered entries (entries appended with push_back() are not counted)
+  size_t GetChanges() const { return m_nChanges; }
+
+  template<typename... T> decltype(auto) assign(T&&... args) { m_nChanges++; return TagEntryBase::assign(std::forward<T>(args)...); }
+  template<typename... T> decltype(auto) insert(T&&... args) { m_nChanges++; return TagEntryBase::insert(std::forward<T>(args)...); }
+  template<typename... T> decltype(auto) emplace(T&&... args) { m_nChanges++; return TagEntryBase::emplace(std::forward<T>(args)...); }
+  template<typename... T> decltype(auto) push_front(T&&... args) { m_nChanges++; return TagEntryBase::push_front(std::forward<T>(args)...); }
+  template<typename... T> decltype(auto) emplace_front(T&&... args) { m_nChanges++; return TagEntryBase::emplace_front(std::forward<T>(args)...); }
+  template<typename... T> decltype(auto) erase(T&&... args) { m_nChanges++; return TagEntryBase::erase(std::forward<T>(args)...); }
+  template<typename... T> decltype(auto) remove(T&&... args) { m_nChanges++; return TagEntryBase::remove(std::forward<T>(args)...); }
+  template<typename... T> decltype(auto) remove_if(T&&... args) { m_nChanges++; return TagEntryBase::remove_if(std::forward<T>(args)...); }
+  template<typename... T> decltype(auto) unique(T&&... args) { m_nChanges++; return TagEntryBase::unique(std::forward<T>(args)...); }
+  template<typename... T> decltype(auto) resize(T&&... args) { m_nChanges++; return TagEntryBase::resize(std::forward<T>(args)...); }
+  template<typename... T> decltype(auto) splice(T&&... args) { m_nChanges++; return TagEntryBase::splice(std::forward<T>(args)...); }
+  template<typename... T> decltype(auto) merge(T&&... args) { m_nChanges++; return TagEntryBase::merge(std::forward<T>(args)...); }
+  template<typename... T> decltype(auto) sort(T&&... args) { m_nChanges++; return TagEntryBase::sort(std::forward<T>(args)...); }
+  void pop_front() { m_nChanges++; TagEntryBase::pop_front(); }
+  void pop_back() { m_nChanges++; TagEntryBase::pop_back(); }
+  void clear() { m_nChanges++; TagEntryBase::clear(); }
+  void reverse() { m_nChanges++; TagEntryBase::reverse(); }
+  void swap(CIccTagEntryList &list) { m_nChanges++; list.m_nChanges++; TagEntryBase::swap(list); }
+
+protected:
+  size_t m_nChanges;
+};
+
+typedef CIccTagEntryList TagEntryList;
+
+/**
+ **************************************************************************
+ * Type: Structure
+ * 
+ * Purpose: Entry of the signature index of a tag directory
+ **************************************************************************
+ */
+typedef struct {
+  icUInt32Number sig;
+  TagEntryList::iterator pos;
+} IccTagIndexEntry;
+
+/**
+ **************************************************************************
+ * Type: List
+ * 
+ * Purpose: Tag directory entries sorted by signature.  Entries with the
+ *  same signature are kept in directory order.
+ **************************************************************************
+ */
+typedef std::vector<IccTagIndexEntry> TagIndexList;
 
 /**
  **************************************************************************
@@ -127,12 +213,29 @@ typedef struct {CIccTag *ptr;} IccTagPtr;
  */
 typedef std::list<IccTagPtr> TagPtrList;
 
+class CIccProfile;
+
+/**
+ **************************************************************************
+ * Type: Shared pointer
+ * 
+ * Purpose: Reference counted pointer to a profile that is not changed
+ *  while it is shared (see CIccProfile::AttachSource).
+ **************************************************************************
+ */
+typedef std::shared_ptr<const CIccProfile> CIccSharedProfilePtr;
+
 typedef enum {
   icVersionBasedID,
   icAlwaysWriteID,
   icNeverWriteID,
 }icProfileIDSaveMethod;
 
+typedef enum {
+  icShareTagObjects,      //Only directory entries with the same tag object share tag data
+  icShareIdenticalTags,   //Tags that are written with identical data also share tag data
+}icTagShareMethod;
+
 /**
  **************************************************************************
  * Type: Class
@@ -165,6 +268,7 @@ public:
 	bool ReadTags(CIccProfile* pProfile); // will read in all the tags using the IO of the passed profile
 
   bool Attach(CIccIO *pIO, bool bUseSubProfile=false);
+  bool AttachSource(CIccSharedProfilePtr pSource);
   bool Detach();
   bool HasIO() { return m_pAttachIO != NULL;  }
 
@@ -172,14 +276,17 @@ public:
 
   bool Read(CIccIO *pIO, bool bUseSubProfile=false);
   icValidateStatus ReadValidate(CIccIO *pIO, std::string &sReport);
-  bool Write(CIccIO *pIO, icProfileIDSaveMethod nWriteId=icVersionBasedID);
+  bool Write(CIccIO *pIO, icProfileIDSaveMethod nWriteId=icVersionBasedID, icTagShareMethod nShareTags=icShareTagObjects,
+             icUInt32Number *pnBytesSaved=NULL);
 
   bool ReadProfileID(icProfileID &profileID); //works if HasIO() is true 
 
   bool ReadPccTags();
 
   void InitHeader();
-  icValidateStatus Validate(std::string &sReport, std::string sSigPath="", const CIccProfile *pParentProfile=NULL) const;
+  ///Tags are validated by nThreads threads (0 = number of hardware threads) with the same report as one thread
+  icValidateStatus Validate(std::string &sReport, std::string sSigPath="", const CIccProfile *pParentProfile=NULL,
+                            icUInt32Number nThreads=1) const;
 
   icUInt16Number GetSpaceSamples() const;
   icUInt16Number GetParentSpaceSamples() const;
@@ -217,8 +324,16 @@ protected:
   IccTagEntry* GetTag(icSignature sig) const;
   IccTagEntry* GetTag(icSignature sig, const CIccProfile* pParent) const;
   IccTagEntry* GetTag(CIccTag *pTag) const;
+  bool GetTagPos(icSignature sig, TagEntryList::iterator &pos);
+  void IndexTags();
+  void IndexTag(TagEntryList::iterator pos);
+  TagEntryList::iterator EraseTagEntry(TagEntryList::iterator pos);
   bool ReadBasic(CIccIO *pIO);
   bool LoadTag(IccTagEntry *pTagEntry, CIccIO *pIO, bool bReadAll=false);
+  CIccTag* ReadTag(const IccTagEntry *pTagEntry, CIccIO *pIO, bool bReadAll=false);
+  CIccTag* LoadAttachedTag(IccTagEntry *pTagEntry);
+  CIccTag* CopySourceTag(const IccTagEntry *pTagEntry) const;
+  void ReleaseTagReaders();
   bool DetachTag(CIccTag *pTag);
 
   CIccIO* ConnectSubProfile(CIccIO *pIO, bool bOwnIO) const;
@@ -244,8 +359,23 @@ protected:
   CIccIO *m_pAttachIO;
   bool m_bSharedIO = false;
 
+  //Fully read profile that tags are copied from on demand
+  CIccSharedProfilePtr m_pSourceProfile;
+
   TagPtrList m_TagVals;
 
+  //Signature index of m_Tags.  It is kept in sync by the member functions
+  //and is only used while m_nTagIndexChanges matches m_Tags.GetChanges().
+  //Lookups fall back to a scan of m_Tags if the signature is not indexed or
+  //the indexed entry was renamed from outside the class.
+  TagIndexList m_TagIndex;
+  size_t m_nTagIndexChanges;
+
+  //State used to load tags from m_pAttachIO on demand from several threads
+  std::mutex m_TagLoadLock;
+  std::condition_variable m_TagLoaded;
+  std::list<CIccIO*> m_TagReaders;
+
   icColorSpaceSignature m_parentColorSpace = icSigNoColorData;
 };
 
@@ -253,13 +383,53 @@ CIccProfile ICCPROFLIB_API *ReadIccProfile(const icChar *szFilename, bool bUseSu
 CIccProfile ICCPROFLIB_API *ReadIccProfile(const icUInt8Number *pMem, icUInt32Number nSize, bool bUseSubProfile=false);
 CIccProfile ICCPROFLIB_API *OpenIccProfile(const icChar *szFilename, bool bUseSubProfile=false);
 CIccProfile ICCPROFLIB_API *OpenIccProfile(const icUInt8Number *pMem, icUInt32Number nSize, bool bUseSubProfile=false);  //pMem must be available for entire life of returned CIccProfile Object
+CIccProfile ICCPROFLIB_API *OpenIccProfileMapped(const icChar *szFilename, bool bUseSubProfile=false);
 
 CIccProfile ICCPROFLIB_API *ValidateIccProfile(CIccIO *pIO, std::string &sReport, icValidateStatus &nStatus);
 CIccProfile ICCPROFLIB_API *ValidateIccProfile(const icChar *szFilename, std::string &sReport, icValidateStatus &nStatus);
 CIccProfile ICCPROFLIB_API* ValidateIccProfile(const icUInt8Number* pMem, icUInt32Number nSize, std::string& sReport, icValidateStatus& nStatus);
 
-bool ICCPROFLIB_API SaveIccProfile(const icChar *szFilename, CIccProfile *pIcc, icProfileIDSaveMethod nWriteId=icVersionBasedID);
-bool ICCPROFLIB_API SaveIccProfile(FILE *f, CIccProfile *pIcc, icProfileIDSaveMethod nWriteId = icVersionBasedID);
+/**
+**************************************************************************
+* Type: Class
+*
+* Purpose: Receives the results of ValidateIccProfiles()
+**************************************************************************
+*/
+class ICCPROFLIB_API IIccValidateSink
+{
+public:
+  virtual ~IIccValidateSink() {}
+
+  ///Called by the worker thread that validated file nIndex before the profile is deleted
+  ///(pIcc is NULL if the file could not be read).  Further checks can be added to nStatus and sReport.
+  virtual void Validated(size_t /*nIndex*/, CIccProfile * /*pIcc*/, icValidateStatus & /*nStatus*/, std::string & /*sReport*/) {}
+
+  ///Called in the order of the files by one thread at a time
+  virtual void Report(size_t nIndex, icValidateStatus nStatus, const std::string &sReport) = 0;
+};
+
+/**
+**************************************************************************
+* Type: Structure
+*
+* Purpose: Validation of a file by ValidateIccProfiles()
+**************************************************************************
+*/
+typedef struct {
+  icValidateStatus nStatus;   //icValidateCriticalError if the file could not be read
+  std::string sReport;        //Report of ValidateIccProfile()
+} icProfileValidation;
+
+void ICCPROFLIB_API ValidateIccProfiles(const std::vector<std::string> &files, IIccValidateSink *pSink,
+                                        icUInt32Number nThreads=0, icUInt32Number nMaxPending=0);
+void ICCPROFLIB_API ValidateIccProfiles(const std::vector<std::string> &files, std::vector<icProfileValidation> &results,
+                                        icUInt32Number nThreads=0);
+
+bool ICCPROFLIB_API SaveIccProfile(const icChar *szFilename, CIccProfile *pIcc, icProfileIDSaveMethod nWriteId=icVersionBasedID,
+                                   icTagShareMethod nShareTags=icShareTagObjects, icUInt32Number *pnBytesSaved=NULL);
+bool ICCPROFLIB_API SaveIccProfile(FILE *f, CIccProfile *pIcc, icProfileIDSaveMethod nWriteId = icVersionBasedID,
+                                   icTagShareMethod nShareTags=icShareTagObjects, icUInt32Number *pnBytesSaved=NULL);
 
 void ICCPROFLIB_API CalcProfileID(CIccIO *pIO, icProfileID *profileID);
 bool ICCPROFLIB_API CalcProfileID(const icChar *szFilename, icProfileID *profileID);
@@ -267,8 +437,10 @@ bool ICCPROFLIB_API CalcProfileID(const icChar *szFilename, icProfileID *profile
 #ifdef WIN32
 CIccProfile ICCPROFLIB_API *ReadIccProfile(const icWChar *szFilename, bool bUseSubProfile=false);
 CIccProfile ICCPROFLIB_API *OpenIccProfile(const icWChar *szFilename, bool bUseSubProfile=false);
+CIccProfile ICCPROFLIB_API *OpenIccProfileMapped(const icWChar *szFilename, bool bUseSubProfile=false);
 CIccProfile ICCPROFLIB_API *ValidateIccProfile(const icWChar *szFilename, std::string &sReport, icValidateStatus &nStatus);
-bool ICCPROFLIB_API SaveIccProfile(const icWChar *szFilename, CIccProfile *pIcc, icProfileIDSaveMethod nWriteId=icVersionBasedID);
+bool ICCPROFLIB_API SaveIccProfile(const icWChar *szFilename, CIccProfile *pIcc, icProfileIDSaveMethod nWriteId=icVersionBasedID,
+                                   icTagShareMethod nShareTags=icShareTagObjects, icUInt32Number *pnBytesSaved=NULL);
 bool ICCPROFLIB_API CalcProfileID(const icWChar *szFilename, icProfileID *profileID);
 #endif
 
@@ -0,0 +1,466 @@
+/** @file
+    File:       IccProfileCache.cpp
+
+    Contains:   Implementation of the process wide cache of parsed profiles
+
+    Version:    V1
+
+    Copyright:  (c) see Software License
+*/
+
+/*
+ * Copyright (c) International Color Consortium.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer. 
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. In the absence of prior written permission, the names "ICC" and "The
+ *    International Color Consortium" must not be used to imply that the
+ *    ICC organization endorses or promotes products derived from this
+ *    software.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE INTERNATIONAL COLOR CONSORTIUM OR
+ * ITS CONTRIBUTING MEMBERS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by many
+ * individuals on behalf of the The International Color Consortium. 
+ *
+ *
+ * Membership in the ICC is encouraged when this software is used for
+ * commercial purposes. 
+ *
+ *  
+ * For more information on The International Color Consortium, please
+ * see <http://www.color.org/>.
+ *  
+ * 
+ */
+
+//////////////////////////////////////////////////////////////////////
+// HISTORY:
+//
+// -Initial implementation of profile cache 10-17-2026
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "IccProfileCache.h"
+#include "IccProfile.h"
+#include <cstdio>
+#include <cstring>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#if defined(USEICCDEVNAMESPACE)
+namespace iccDEV {
+#endif
+
+/**
+ ****************************************************************************
+ * Name: icProfileCacheKeys
+ * 
+ * Purpose: Builds the path key and profile ID key of a profile file.  The
+ *  ID key is left empty if the header has no profile ID.
+ * 
+ * Return: 
+ *  true if the file exists, false otherwise
+ *****************************************************************************
+ */
+static bool icProfileCacheKeys(const icChar *szFilename, bool bUseSubProfile,
+                               std::string &sKey, std::string &sId, size_t &nSize)
+{
+  struct stat st;
+
+  if (!szFilename || stat(szFilename, &st) || !(st.st_mode & S_IFREG))
+    return false;
+
+  char buf[64];
+  nSize = (size_t)st.st_size;
+  sprintf(buf, "|%llu|%lld|%d", (unsigned long long)st.st_size, (long long)st.st_mtime, bUseSubProfile ? 1 : 0);
+
+  sKey = szFilename;
+  sKey += buf;
+
+  sId.clear();
+
+  //The header of a file with a sub-profile describes the outer profile
+  if (!bUseSubProfile) {
+    FILE *f = fopen(szFilename, "rb");
+
+    if (f) {
+      icUInt8Number header[128];
+
+      if (fread(header, 1, sizeof(header), f) == sizeof(header)) {
+        icUInt8Number *pId = header + 84;
+        int i;
+
+        for (i=0; i<16 && !pId[i]; i++);
+
+        if (i<16) {
+          sId.assign((const char*)pId, 16);
+          sprintf(buf, "|%llu", (unsigned long long)st.st_size);
+          sId += buf;
+        }
+      }
+      fclose(f);
+    }
+  }
+
+  return true;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccProfileCache::CIccProfileCache
+ * 
+ * Purpose: Constructor
+ * 
+ * Args:
+ *  nMaxBytes - memory budget of the cache
+ *****************************************************************************
+ */
+CIccProfileCache::CIccProfileCache(size_t nMaxBytes/*=icProfileCacheDefaultSize*/)
+{
+  m_bEnabled = false;
+  m_nMaxBytes = nMaxBytes;
+  m_nBytes = 0;
+
+  m_nHits = 0;
+  m_nMisses = 0;
+  m_nEvictions = 0;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccProfileCache::~CIccProfileCache
+ * 
+ * Purpose: Destructor
+ *****************************************************************************
+ */
+CIccProfileCache::~CIccProfileCache()
+{
+  while (!m_lru.empty())
+    RemoveEntry(m_lru.front());
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccProfileCache::GetProcessCache
+ * 
+ * Purpose: Returns the process wide cache.  It is disabled until
+ *  SetEnabled(true) is called.
+ *****************************************************************************
+ */
+CIccProfileCache *CIccProfileCache::GetProcessCache()
+{
+  static CIccProfileCache cache;
+
+  return &cache;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccProfileCache::SetMaxBytes
+ * 
+ * Purpose: Changes the memory budget and evicts profiles if needed
+ *****************************************************************************
+ */
+void CIccProfileCache::SetMaxBytes(size_t nMaxBytes)
+{
+  std::lock_guard<std::mutex> lock(m_lock);
+
+  m_nMaxBytes = nMaxBytes;
+  Evict();
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccProfileCache::GetMaxBytes
+ * 
+ * Purpose: Returns the memory budget
+ *****************************************************************************
+ */
+size_t CIccProfileCache::GetMaxBytes()
+{
+  std::lock_guard<std::mutex> lock(m_lock);
+
+  return m_nMaxBytes;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccProfileCache::Acquire
+ * 
+ * Purpose: Returns the cached profile for a file, reading the whole file if
+ *  it is not in the cache.  The profile must not be changed.
+ * 
+ * Args:
+ *  szFilename - path of profile file
+ *  bUseSubProfile - will attempt to open a sub-profile if present
+ * 
+ * Return: 
+ *  Shared pointer to the cached profile, empty if the file cannot be read
+ *****************************************************************************
+ */
+CIccSharedProfilePtr CIccProfileCache::Acquire(const icChar *szFilename, bool bUseSubProfile/*=false*/)
+{
+  std::string sKey, sId;
+  size_t nSize;
+
+  if (!icProfileCacheKeys(szFilename, bUseSubProfile, sKey, sId, nSize))
+    return CIccSharedProfilePtr();
+
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    CIccProfileCacheEntry *pEntry = FindEntry(sKey, sId);
+    if (pEntry) {
+      m_nHits++;
+      return pEntry->pProfile;
+    }
+
+    m_nMisses++;
+  }
+
+  //Read without holding the lock.  If another thread adds the same
+  //profile in the mean time then AddEntry() keeps the first one.
+  CIccProfile *pProfile = ReadIccProfile(szFilename, bUseSubProfile);
+  if (!pProfile)
+    return CIccSharedProfilePtr();
+
+  std::lock_guard<std::mutex> lock(m_lock);
+
+  CIccSharedProfilePtr pShared = AddEntry(sKey, sId, pProfile, nSize)->pProfile;
+
+  Evict();
+
+  return pShared;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccProfileCache::OpenProfile
+ * 
+ * Purpose: Returns a new profile for a file that the caller owns and may
+ *  change.  Its tags are copied from the cached profile as they are used.
+ *  A profile that cannot be fully read (for instance because one of its
+ *  tags is damaged) is opened with OpenIccProfile() and is not cached.
+ * 
+ * Args:
+ *  szFilename - path of profile file
+ *  bUseSubProfile - will attempt to open a sub-profile if present
+ * 
+ * Return: 
+ *  Pointer to new profile object, or NULL if the file cannot be opened
+ *****************************************************************************
+ */
+CIccProfile *CIccProfileCache::OpenProfile(const icChar *szFilename, bool bUseSubProfile/*=false*/)
+{
+  CIccSharedProfilePtr pCached = Acquire(szFilename, bUseSubProfile);
+
+  if (!pCached)
+    return OpenIccProfile(szFilename, bUseSubProfile);
+
+  CIccProfile *pProfile = pCached->NewProfile();
+
+  if (!pProfile->AttachSource(pCached)) {
+    delete pProfile;
+    return NULL;
+  }
+
+  return pProfile;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccProfileCache::Clear
+ * 
+ * Purpose: Removes all profiles from the cache.  Profiles that are still
+ *  in use are deleted when they are no longer used.
+ *****************************************************************************
+ */
+void CIccProfileCache::Clear()
+{
+  std::lock_guard<std::mutex> lock(m_lock);
+
+  std::list<CIccProfileCacheEntry*>::iterator i, next;
+
+  for (i=m_lru.begin(); i!=m_lru.end(); i=next) {
+    next = i;
+    next++;
+
+    RemoveEntry(*i);
+  }
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccProfileCache::GetStats
+ * 
+ * Purpose: Returns the usage counters of the cache
+ *****************************************************************************
+ */
+void CIccProfileCache::GetStats(icProfileCacheStats &stats)
+{
+  std::lock_guard<std::mutex> lock(m_lock);
+
+  stats.nHits = m_nHits;
+  stats.nMisses = m_nMisses;
+  stats.nEvictions = m_nEvictions;
+  stats.nEntries = m_lru.size();
+  stats.nBytes = m_nBytes;
+  stats.nMaxBytes = m_nMaxBytes;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccProfileCache::ResetStats
+ * 
+ * Purpose: Sets the hit, miss and eviction counters to zero
+ *****************************************************************************
+ */
+void CIccProfileCache::ResetStats()
+{
+  std::lock_guard<std::mutex> lock(m_lock);
+
+  m_nHits = 0;
+  m_nMisses = 0;
+  m_nEvictions = 0;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccProfileCache::FindEntry
+ * 
+ * Purpose: Finds the entry of a file by path key, or else by profile ID
+ *  key.  An entry found by ID is also registered under the path key.
+ *  Must be called with m_lock held.
+ *****************************************************************************
+ */
+CIccProfileCache::CIccProfileCacheEntry *CIccProfileCache::FindEntry(const std::string &sKey, const std::string &sId)
+{
+  CIccProfileCacheEntry *pEntry = NULL;
+  CIccProfileCacheMap::iterator i = m_keys.find(sKey);
+
+  if (i != m_keys.end()) {
+    pEntry = i->second;
+  }
+  else if (!sId.empty()) {
+    i = m_ids.find(sId);
+
+    if (i != m_ids.end()) {
+      pEntry = i->second;
+      pEntry->keys.push_back(sKey);
+      m_keys[sKey] = pEntry;
+    }
+  }
+
+  if (pEntry)
+    m_lru.splice(m_lru.begin(), m_lru, pEntry->lru);
+
+  return pEntry;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccProfileCache::AddEntry
+ * 
+ * Purpose: Adds a parsed profile to the cache.  If the file was added by
+ *  another thread in the mean time pProfile is deleted and the existing
+ *  entry is returned.  Must be called with m_lock held.
+ *****************************************************************************
+ */
+CIccProfileCache::CIccProfileCacheEntry *CIccProfileCache::AddEntry(const std::string &sKey, const std::string &sId,
+                                                                    CIccProfile *pProfile, size_t nSize)
+{
+  CIccProfileCacheEntry *pEntry = FindEntry(sKey, sId);
+
+  if (pEntry) {
+    delete pProfile;
+    return pEntry;
+  }
+
+  pEntry = new CIccProfileCacheEntry;
+  pEntry->pProfile = CIccSharedProfilePtr(pProfile);
+  pEntry->nSize = nSize;
+  pEntry->sId = sId;
+  pEntry->keys.push_back(sKey);
+
+  m_lru.push_front(pEntry);
+  pEntry->lru = m_lru.begin();
+
+  m_keys[sKey] = pEntry;
+  if (!sId.empty())
+    m_ids[sId] = pEntry;
+
+  m_nBytes += nSize;
+
+  return pEntry;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccProfileCache::Evict
+ * 
+ * Purpose: Removes least recently used entries until the cache is within
+ *  its budget.  Must be called with m_lock held.
+ *****************************************************************************
+ */
+void CIccProfileCache::Evict()
+{
+  while (m_nBytes > m_nMaxBytes && !m_lru.empty()) {
+    RemoveEntry(m_lru.back());
+    m_nEvictions++;
+  }
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccProfileCache::RemoveEntry
+ * 
+ * Purpose: Removes an entry from the cache.  The profile is deleted once
+ *  it is no longer used.
+ *****************************************************************************
+ */
+void CIccProfileCache::RemoveEntry(CIccProfileCacheEntry *pEntry)
+{
+  std::list<std::string>::iterator k;
+
+  for (k=pEntry->keys.begin(); k!=pEntry->keys.end(); k++)
+    m_keys.erase(*k);
+
+  if (!pEntry->sId.empty()) {
+    CIccProfileCacheMap::iterator i = m_ids.find(pEntry->sId);
+    if (i != m_ids.end() && i->second == pEntry)
+      m_ids.erase(i);
+  }
+
+  m_lru.erase(pEntry->lru);
+  m_nBytes -= pEntry->nSize;
+
+  delete pEntry;
+}
+
+#if defined(USEICCDEVNAMESPACE)
+}; //namespace iccDEV
+#endif
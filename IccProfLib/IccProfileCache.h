@@ -0,0 +1,176 @@
+/** @file
+    File:       IccProfileCache.h
+
+    Contains:   Header for the process wide cache of parsed profiles
+
+    Version:    V1
+
+    Copyright:  (c) see Software License
+*/
+
+/*
+ * Copyright (c) International Color Consortium.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer. 
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. In the absence of prior written permission, the names "ICC" and "The
+ *    International Color Consortium" must not be used to imply that the
+ *    ICC organization endorses or promotes products derived from this
+ *    software.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE INTERNATIONAL COLOR CONSORTIUM OR
+ * ITS CONTRIBUTING MEMBERS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by many
+ * individuals on behalf of the The International Color Consortium. 
+ *
+ *
+ * Membership in the ICC is encouraged when this software is used for
+ * commercial purposes. 
+ *
+ *  
+ * For more information on The International Color Consortium, please
+ * see <http://www.color.org/>.
+ *  
+ * 
+ */
+
+//////////////////////////////////////////////////////////////////////
+// HISTORY:
+//
+// -Initial implementation of profile cache 10-17-2026
+//
+//////////////////////////////////////////////////////////////////////
+
+#if !defined(_ICCPROFILECACHE_H)
+#define _ICCPROFILECACHE_H
+
+#include "IccProfile.h"
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+
+#if defined(USEICCDEVNAMESPACE)
+namespace iccDEV {
+#endif
+
+/// Default memory budget of a CIccProfileCache in bytes
+#define icProfileCacheDefaultSize (256*1024*1024)
+
+/**
+**************************************************************************
+* Type: Structure
+*
+* Purpose: Usage counters of a CIccProfileCache
+**************************************************************************
+*/
+typedef struct {
+  icUInt64Number nHits;       //Lookups served from the cache
+  icUInt64Number nMisses;     //Lookups that had to read and parse a file
+  icUInt64Number nEvictions;  //Entries removed to stay within the budget
+  size_t nEntries;            //Profiles currently held
+  size_t nBytes;              //Bytes currently charged against the budget
+  size_t nMaxBytes;           //Memory budget
+} icProfileCacheStats;
+
+/**
+**************************************************************************
+* Type: Class
+*
+* Purpose: Cache of fully read profiles shared by a process.  Profiles are
+*  keyed by file path, size and modification time.  A file that is not in
+*  the cache under its path, but whose header has a non-zero profile ID
+*  that matches a cached profile of the same size, reuses that profile.
+*
+*  Cached profiles are never changed and are handed out as reference
+*  counted CIccSharedProfilePtr objects, so a profile stays valid for as
+*  long as it is used even if it is evicted.  OpenProfile() returns a new
+*  profile owned by the caller that copies tags from the cached profile as
+*  they are used (see CIccProfile::AttachSource), which is what transforms
+*  need since they prepare and change their tags.
+*
+*  Each profile is charged with its file size against the memory budget.
+*  When the budget is exceeded the least recently used profiles are
+*  evicted.  All member functions may be called from several threads.
+**************************************************************************
+*/
+class ICCPROFLIB_API CIccProfileCache
+{
+public:
+  CIccProfileCache(size_t nMaxBytes=icProfileCacheDefaultSize);
+  virtual ~CIccProfileCache();
+
+  ///Returns the process wide cache used by CIccCmm::AddXform() when enabled
+  static CIccProfileCache *GetProcessCache();
+
+  void SetEnabled(bool bEnabled) { m_bEnabled = bEnabled; }
+  bool IsEnabled() const { return m_bEnabled; }
+
+  void SetMaxBytes(size_t nMaxBytes);
+  size_t GetMaxBytes();
+
+  CIccSharedProfilePtr Acquire(const icChar *szFilename, bool bUseSubProfile=false);
+  CIccProfile *OpenProfile(const icChar *szFilename, bool bUseSubProfile=false);
+
+  void Clear();
+  void GetStats(icProfileCacheStats &stats);
+  void ResetStats();
+
+protected:
+  struct CIccProfileCacheEntry {
+    CIccSharedProfilePtr pProfile;
+    size_t nSize;
+    std::string sId;
+    std::list<std::string> keys;
+    std::list<CIccProfileCacheEntry*>::iterator lru;
+  };
+  typedef std::unordered_map<std::string, CIccProfileCacheEntry*> CIccProfileCacheMap;
+
+  CIccProfileCacheEntry *FindEntry(const std::string &sKey, const std::string &sId);
+  CIccProfileCacheEntry *AddEntry(const std::string &sKey, const std::string &sId, CIccProfile *pProfile, size_t nSize);
+  void Evict();
+  void RemoveEntry(CIccProfileCacheEntry *pEntry);
+
+  std::mutex m_lock;
+  std::atomic<bool> m_bEnabled;
+  size_t m_nMaxBytes;
+  size_t m_nBytes;
+
+  std::list<CIccProfileCacheEntry*> m_lru;  //Most recently used first
+  CIccProfileCacheMap m_keys;               //Entries by path key
+  CIccProfileCacheMap m_ids;                //Entries by profile ID key
+
+  icUInt64Number m_nHits;
+  icUInt64Number m_nMisses;
+  icUInt64Number m_nEvictions;
+};
+
+#if defined(USEICCDEVNAMESPACE)
+}; //namespace iccDEV
+#endif
+
+#endif //_ICCPROFILECACHE_H
@@ -0,0 +1,617 @@
+/** @file
+    File:       IccProfileID.cpp
+
+    Contains:   Implementation of streaming profile ID (MD5) calculation
+
+    Version:    V1
+
+    Copyright:  (c) see Software License
+*/
+
+/*
+ * Copyright (c) International Color Consortium.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer. 
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. In the absence of prior written permission, the names "ICC" and "The
+ *    International Color Consortium" must not be used to imply that the
+ *    ICC organization endorses or promotes products derived from this
+ *    software.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE INTERNATIONAL COLOR CONSORTIUM OR
+ * ITS CONTRIBUTING MEMBERS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by many
+ * individuals on behalf of the The International Color Consortium. 
+ *
+ *
+ * Membership in the ICC is encouraged when this software is used for
+ * commercial purposes. 
+ *
+ *  
+ * For more information on The International Color Consortium, please
+ * see <http://www.color.org/>.
+ *  
+ * 
+ */
+
+
+//////////////////////////////////////////////////////////////////////
+// HISTORY:
+//
+// -Initial implementation of streaming profile ID calculation 10-18-2026
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "IccProfileID.h"
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <thread>
+
+#ifndef __min
+#define __min(a,b)  (((a) < (b)) ? (a) : (b))
+#endif
+
+#if defined(USEICCDEVNAMESPACE)
+namespace iccDEV {
+#endif
+
+/**
+ ****************************************************************************
+ * Name: icMD5ProfileUpdate
+ * 
+ * Purpose: Adds profile bytes starting at nOffset to an MD5 calculation.
+ *  The profile flags (44), rendering intent (64) and profile ID (84)
+ *  header fields are hashed as zeros.
+ *****************************************************************************
+ */
+static void icMD5ProfileUpdate(MD5_CTX *pContext, const icUInt8Number *pData, size_t nOffset, size_t nNum)
+{
+  if (nOffset < 100 && nNum) {
+    icUInt8Number head[100];
+    size_t i, n = __min(nNum, 100 - nOffset);
+
+    memcpy(head, pData, n);
+    for (i=0; i<n; i++) {
+      size_t nPos = nOffset + i;
+
+      if ((nPos>=44 && nPos<48) || (nPos>=64 && nPos<68) || nPos>=84)
+        head[i] = 0;
+    }
+    icMD5Update(pContext, head, (unsigned int)n);
+
+    pData += n;
+    nNum -= n;
+  }
+
+  while (nNum) {
+    unsigned int n = (unsigned int)__min(nNum, (size_t)0x40000000);
+
+    icMD5Update(pContext, (unsigned char*)pData, n);
+    pData += n;
+    nNum -= n;
+  }
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccMD5IO::CIccMD5IO
+ * 
+ * Purpose: Constructor
+ *****************************************************************************
+ */
+CIccMD5IO::CIccMD5IO() : CIccIO()
+{
+  m_pIO = NULL;
+  m_bOwnIO = false;
+  m_nPos = 0;
+
+  icMD5Init(&m_context);
+  m_nHashed = 0;
+  m_pChunk = NULL;
+
+  m_bWritten = false;
+  m_pMirror = NULL;
+  m_nMirrorSize = 0;
+  m_nMirrorAvail = 0;
+  m_bMirrorValid = true;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccMD5IO::~CIccMD5IO
+ * 
+ * Purpose: Destructor
+ *****************************************************************************
+ */
+CIccMD5IO::~CIccMD5IO()
+{
+  Close();
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccMD5IO::Attach
+ * 
+ * Purpose: Starts a profile ID calculation of the profile in pIO
+ * 
+ * Args:
+ *  pIO - IO object that holds the profile at offset zero
+ *  bOwnIO - pIO is deleted when this object is closed
+ *****************************************************************************
+ */
+bool CIccMD5IO::Attach(CIccIO *pIO, bool bOwnIO/*=false*/)
+{
+  if (!pIO)
+    return false;
+
+  Close();
+
+  int64_t nPos = pIO->Tell();
+  if (nPos<0)
+    return false;
+
+  m_pIO = pIO;
+  m_bOwnIO = bOwnIO;
+  m_nPos = (size_t)nPos;
+
+  return true;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccMD5IO::Close
+ * 
+ * Purpose: Detaches the IO object and discards the calculation
+ *****************************************************************************
+ */
+void CIccMD5IO::Close()
+{
+  if (m_pIO && m_bOwnIO)
+    delete m_pIO;
+  m_pIO = NULL;
+  m_bOwnIO = false;
+  m_nPos = 0;
+
+  icMD5Init(&m_context);
+  m_nHashed = 0;
+  if (m_pChunk) {
+    free(m_pChunk);
+    m_pChunk = NULL;
+  }
+
+  m_bWritten = false;
+  if (m_pMirror) {
+    free(m_pMirror);
+    m_pMirror = NULL;
+  }
+  m_nMirrorSize = 0;
+  m_nMirrorAvail = 0;
+  m_bMirrorValid = true;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccMD5IO::Hash
+ * 
+ * Purpose: Hashes the part of nNum bytes at nOffset that follows the bytes
+ *  already hashed.  Bytes that were skipped are read and hashed first.
+ *****************************************************************************
+ */
+void CIccMD5IO::Hash(const icUInt8Number *pData, size_t nOffset, size_t nNum)
+{
+  if (m_bWritten || !nNum)
+    return;
+
+  if (nOffset > m_nHashed && !CatchUp(nOffset))
+    return;
+
+  if (nOffset + nNum > m_nHashed) {
+    size_t nSkip = m_nHashed - nOffset;
+
+    icMD5ProfileUpdate(&m_context, pData + nSkip, m_nHashed, nNum - nSkip);
+    m_nHashed = nOffset + nNum;
+  }
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccMD5IO::CatchUp
+ * 
+ * Purpose: Reads and hashes the bytes from the end of the hashed bytes up
+ *  to nEnd without moving the read position
+ * 
+ * Return:
+ *  true if all bytes up to nEnd have been hashed
+ *****************************************************************************
+ */
+bool CIccMD5IO::CatchUp(size_t nEnd)
+{
+  //Positional reads of a file would not see data that is still buffered for writing
+  bool bReadAt = !m_bWritten && m_pIO->CanReadAt();
+  bool bSeek = false;
+
+  while (m_nHashed < nEnd) {
+    size_t nNum = __min(nEnd - m_nHashed, (size_t)icMD5IOChunkSize);
+    const icUInt8Number *pData = m_pIO->ViewAt(m_nHashed, nNum);
+
+    if (!pData) {
+      if (!m_pChunk) {
+        m_pChunk = (icUInt8Number*)malloc(icMD5IOChunkSize);
+        if (!m_pChunk)
+          break;
+      }
+
+      if (bReadAt) {
+        nNum = m_pIO->ReadAt(m_nHashed, m_pChunk, nNum);
+      }
+      else {
+        bSeek = true;
+        if (m_pIO->Seek((int64_t)m_nHashed, icSeekSet)<0)
+          break;
+        nNum = m_pIO->Read8(m_pChunk, nNum);
+      }
+      pData = m_pChunk;
+    }
+
+    if (!nNum)
+      break;
+
+    icMD5ProfileUpdate(&m_context, pData, m_nHashed, nNum);
+    m_nHashed += nNum;
+  }
+
+  if (bSeek)
+    m_pIO->Seek((int64_t)m_nPos, icSeekSet);
+
+  return m_nHashed >= nEnd;
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccMD5IO::Mirror
+ * 
+ * Purpose: Keeps a copy of written bytes until the profile gets too large
+ *****************************************************************************
+ */
+void CIccMD5IO::Mirror(const icUInt8Number *pData, size_t nOffset, size_t nNum)
+{
+  if (!m_bMirrorValid || !nNum)
+    return;
+
+  size_t nEnd = nOffset + nNum;
+
+  if (nEnd > m_nMirrorAvail) {
+    size_t nAvail = m_nMirrorAvail ? m_nMirrorAvail : icMD5IOChunkSize;
+
+    while (nAvail < nEnd)
+      nAvail *= 2;
+
+    icUInt8Number *pMirror = NULL;
+    if (nEnd <= icMD5IOMaxMirrorSize)
+      pMirror = (icUInt8Number*)realloc(m_pMirror, nAvail);
+
+    if (!pMirror) {
+      free(m_pMirror);
+      m_pMirror = NULL;
+      m_nMirrorSize = 0;
+      m_nMirrorAvail = 0;
+      m_bMirrorValid = false;
+      return;
+    }
+    m_pMirror = pMirror;
+    m_nMirrorAvail = nAvail;
+  }
+
+  //Bytes skipped by a seek past the end read back as zeros
+  if (nOffset > m_nMirrorSize)
+    memset(m_pMirror + m_nMirrorSize, 0, nOffset - m_nMirrorSize);
+
+  memcpy(m_pMirror + nOffset, pData, nNum);
+  if (nEnd > m_nMirrorSize)
+    m_nMirrorSize = nEnd;
+}
+
+size_t CIccMD5IO::Read8(void *pBuf, size_t nNum/*=1*/)
+{
+  if (!m_pIO)
+    return 0;
+
+  size_t nOffset = m_nPos;
+
+  nNum = m_pIO->Read8(pBuf, nNum);
+  m_nPos += nNum;
+
+  Hash((const icUInt8Number*)pBuf, nOffset, nNum);
+
+  return nNum;
+}
+
+size_t CIccMD5IO::Write8(void *pBuf, size_t nNum/*=1*/)
+{
+  if (!m_pIO)
+    return 0;
+
+  size_t nOffset = m_nPos;
+
+  nNum = m_pIO->Write8(pBuf, nNum);
+  m_nPos += nNum;
+
+  m_bWritten = true;
+  Mirror((const icUInt8Number*)pBuf, nOffset, nNum);
+
+  return nNum;
+}
+
+size_t CIccMD5IO::GetLength()
+{
+  if (!m_pIO)
+    return 0;
+
+  return m_pIO->GetLength();
+}
+
+int64_t CIccMD5IO::Seek(int64_t nOffset, icSeekVal pos)
+{
+  if (!m_pIO)
+    return -1;
+
+  int64_t nPos = m_pIO->Seek(nOffset, pos);
+
+  if (nPos>=0)
+    m_nPos = (size_t)nPos;
+
+  return nPos;
+}
+
+int64_t CIccMD5IO::Tell()
+{
+  if (!m_pIO)
+    return -1;
+
+  return (int64_t)m_nPos;
+}
+
+const icUInt8Number *CIccMD5IO::ReadView(size_t nNum)
+{
+  if (!m_pIO)
+    return NULL;
+
+  size_t nOffset = m_nPos;
+  const icUInt8Number *pData = m_pIO->ReadView(nNum);
+
+  if (pData) {
+    m_nPos += nNum;
+    Hash(pData, nOffset, nNum);
+  }
+
+  return pData;
+}
+
+bool CIccMD5IO::CanReadAt()
+{
+  return m_pIO && m_pIO->CanReadAt();
+}
+
+size_t CIccMD5IO::ReadAt(size_t nOffset, void *pBuf, size_t nNum)
+{
+  if (!m_pIO)
+    return 0;
+
+  return m_pIO->ReadAt(nOffset, pBuf, nNum);
+}
+
+const icUInt8Number *CIccMD5IO::ViewAt(size_t nOffset, size_t nNum)
+{
+  if (!m_pIO)
+    return NULL;
+
+  return m_pIO->ViewAt(nOffset, nNum);
+}
+
+/**
+ ****************************************************************************
+ * Name: CIccMD5IO::GetProfileID
+ * 
+ * Purpose: Returns the profile ID of the whole IO object.  Bytes that were
+ *  not read through this object are read without moving the read position.
+ *  After writes the ID is calculated from the written bytes, or from the
+ *  IO object if the profile was too large to keep.
+ * 
+ * Args:
+ *  pProfileID - returned profile ID
+ * 
+ * Return:
+ *  true if the whole IO object could be hashed
+ *****************************************************************************
+ */
+bool CIccMD5IO::GetProfileID(icProfileID *pProfileID)
+{
+  if (!m_pIO)
+    return false;
+
+  size_t nLength = m_pIO->GetLength();
+  MD5_CTX context;
+  bool rv;
+
+  if (m_bWritten) {
+    icMD5Init(&context);
+
+    if (m_bMirrorValid && m_nMirrorSize==nLength) {
+      icMD5ProfileUpdate(&context, m_pMirror, 0, m_nMirrorSize);
+      rv = true;
+    }
+    else {
+      m_context = context;
+      m_nHashed = 0;
+      rv = CatchUp(nLength);
+      context = m_context;
+    }
+  }
+  else {
+    rv = CatchUp(nLength);
+    context = m_context;
+  }
+
+  icMD5Final(&pProfileID->ID8[0], &context);
+
+  return rv;
+}
+
+/**
+ ****************************************************************************
+ * Name: VerifyProfileID
+ * 
+ * Purpose: Checks the profile ID in the header of a profile with a single
+ *  pass over the IO object
+ * 
+ * Args:
+ *  pIO - IO object that holds the profile at offset zero
+ *  pCheck - optional returned header and calculated IDs
+ * 
+ * Return:
+ *  Result of the check
+ *****************************************************************************
+ */
+icProfileIDStatus VerifyProfileID(CIccIO *pIO, icProfileIDCheck *pCheck/*=NULL*/)
+{
+  icProfileIDCheck check;
+  CIccMD5IO md5IO;
+  icUInt8Number header[128];
+
+  memset(&check, 0, sizeof(check));
+
+  if (!pIO || pIO->Seek(0, icSeekSet)<0 || !md5IO.Attach(pIO) ||
+      md5IO.Read8(header, sizeof(header))!=sizeof(header) || !md5IO.GetProfileID(&check.calcID)) {
+    check.nStatus = icProfileIDReadError;
+  }
+  else {
+    int i;
+
+    memcpy(&check.headerID.ID8[0], header + 84, sizeof(check.headerID.ID8));
+
+    for (i=0; i<16 && !check.headerID.ID8[i]; i++);
+
+    if (i==16)
+      check.nStatus = icProfileIDMissing;
+    else if (memcmp(&check.headerID.ID8[0], &check.calcID.ID8[0], sizeof(check.headerID.ID8)))
+      check.nStatus = icProfileIDMismatch;
+    else
+      check.nStatus = icProfileIDOk;
+  }
+
+  if (pCheck)
+    *pCheck = check;
+
+  return check.nStatus;
+}
+
+/**
+ ****************************************************************************
+ * Name: VerifyProfileID
+ * 
+ * Purpose: Checks the profile ID in the header of a profile file with a
+ *  single pass over the file
+ * 
+ * Args:
+ *  szFilename - path of profile file
+ *  pCheck - optional returned header and calculated IDs
+ * 
+ * Return:
+ *  Result of the check
+ *****************************************************************************
+ */
+icProfileIDStatus VerifyProfileID(const icChar *szFilename, icProfileIDCheck *pCheck/*=NULL*/)
+{
+  CIccFileIO FileIO;
+
+  if (!FileIO.Open(szFilename, "rb")) {
+    if (pCheck) {
+      memset(pCheck, 0, sizeof(*pCheck));
+      pCheck->nStatus = icProfileIDReadError;
+    }
+    return icProfileIDReadError;
+  }
+
+  return VerifyProfileID(&FileIO, pCheck);
+}
+
+/**
+ ****************************************************************************
+ * Name: VerifyProfileIDs
+ * 
+ * Purpose: Checks the profile IDs of several profile files at once.  The
+ *  files are divided between worker threads.
+ * 
+ * Args:
+ *  files - paths of profile files
+ *  checks - returned checks in the same order as files
+ *  nThreads - number of worker threads (0 = number of hardware threads)
+ *****************************************************************************
+ */
+void VerifyProfileIDs(const std::vector<std::string> &files, std::vector<icProfileIDCheck> &checks,
+                      icUInt32Number nThreads/*=0*/)
+{
+  size_t nFiles = files.size();
+
+  checks.resize(nFiles);
+
+  if (!nThreads)
+    nThreads = std::thread::hardware_concurrency();
+  if (!nThreads)
+    nThreads = 1;
+  if (nThreads > nFiles)
+    nThreads = (icUInt32Number)nFiles;
+
+  std::atomic<size_t> nNext(0);
+
+  auto worker = [&]() {
+    size_t n;
+
+    while ((n = nNext++) < nFiles)
+      VerifyProfileID(files[n].c_str(), &checks[n]);
+  };
+
+  std::vector<std::thread> threads;
+  for (icUInt32Number t=1; t<nThreads; t++) {
+    try {
+      threads.push_back(std::thread(worker));
+    }
+    catch (...) {
+      //Files of workers that could not be started are checked by the others
+      break;
+    }
+  }
+
+  worker();
+
+  for (size_t i=0; i<threads.size(); i++)
+    threads[i].join();
+}
+
+#if defined(USEICCDEVNAMESPACE)
+}; //namespace iccDEV
+#endif
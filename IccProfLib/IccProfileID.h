@@ -0,0 +1,189 @@
+/** @file
+    File:       IccProfileID.h
+
+    Contains:   Header for streaming profile ID (MD5) calculation
+
+    Version:    V1
+
+    Copyright:  (c) see Software License
+*/
+
+/*
+ * Copyright (c) International Color Consortium.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer. 
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. In the absence of prior written permission, the names "ICC" and "The
+ *    International Color Consortium" must not be used to imply that the
+ *    ICC organization endorses or promotes products derived from this
+ *    software.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE INTERNATIONAL COLOR CONSORTIUM OR
+ * ITS CONTRIBUTING MEMBERS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by many
+ * individuals on behalf of the The International Color Consortium. 
+ *
+ *
+ * Membership in the ICC is encouraged when this software is used for
+ * commercial purposes. 
+ *
+ *  
+ * For more information on The International Color Consortium, please
+ * see <http://www.color.org/>.
+ *  
+ * 
+ */
+
+
+//////////////////////////////////////////////////////////////////////
+// HISTORY:
+//
+// -Initial implementation of streaming profile ID calculation 10-18-2026
+//
+//////////////////////////////////////////////////////////////////////
+
+#if !defined(_ICCPROFILEID_H)
+#define _ICCPROFILEID_H
+
+#include "IccIO.h"
+#include "IccMD5.h"
+#include <string>
+#include <vector>
+
+#if defined(USEICCDEVNAMESPACE)
+namespace iccDEV {
+#endif
+
+/// Number of bytes read at a time when hashing data that was not read through a CIccMD5IO
+#define icMD5IOChunkSize (64*1024)
+
+/// Largest profile whose writes a CIccMD5IO keeps in memory (larger ones are read back)
+#define icMD5IOMaxMirrorSize (256*1024*1024)
+
+/**
+**************************************************************************
+* Type: Class
+*
+* Purpose: Calculates the profile ID (MD5 with the profile flags,
+*  rendering intent and profile ID header fields taken as zero) of the
+*  profile in an IO object while it is read or written through this one.
+*
+*  Bytes read with Read8() or ReadView() are hashed as they pass.  When a
+*  read skips ahead, the skipped bytes are read from the IO object and
+*  hashed first, so each byte is hashed once and the profile is read only
+*  once when its tags are read in order.  Positional reads (ReadAt and
+*  ViewAt) are passed on without being hashed.
+*
+*  Writes are kept in memory (up to icMD5IOMaxMirrorSize bytes) since a
+*  profile writer seeks back to fill in the header and tag directory.
+*  The ID is then calculated from memory rather than by reading the IO
+*  object back.
+**************************************************************************
+*/
+class ICCPROFLIB_API CIccMD5IO : public CIccIO
+{
+public:
+  CIccMD5IO();
+  virtual ~CIccMD5IO();
+
+  ///The profile starts at offset 0 of pIO
+  bool Attach(CIccIO *pIO, bool bOwnIO=false);
+  virtual void Close();
+
+  virtual size_t Read8(void *pBuf, size_t nNum = 1);
+  virtual size_t Write8(void *pBuf, size_t nNum = 1);
+
+  virtual size_t GetLength();
+
+  virtual int64_t Seek(int64_t nOffset, icSeekVal pos);
+  virtual int64_t Tell();
+
+  virtual const icUInt8Number *ReadView(size_t nNum);
+
+  virtual bool CanReadAt();
+  virtual size_t ReadAt(size_t nOffset, void *pBuf, size_t nNum);
+  virtual const icUInt8Number *ViewAt(size_t nOffset, size_t nNum);
+
+  ///Hashes any bytes up to the end of the IO object that were not read and returns the ID
+  bool GetProfileID(icProfileID *pProfileID);
+
+protected:
+  void Hash(const icUInt8Number *pData, size_t nOffset, size_t nNum);
+  bool CatchUp(size_t nEnd);
+  void Mirror(const icUInt8Number *pData, size_t nOffset, size_t nNum);
+
+  CIccIO *m_pIO;
+  bool m_bOwnIO;
+  size_t m_nPos;
+
+  MD5_CTX m_context;
+  size_t m_nHashed;     //Bytes from offset zero that have been hashed
+  icUInt8Number *m_pChunk;
+
+  bool m_bWritten;
+  icUInt8Number *m_pMirror;
+  size_t m_nMirrorSize;
+  size_t m_nMirrorAvail;
+  bool m_bMirrorValid;
+};
+
+/**
+**************************************************************************
+* Type: Enum
+*
+* Purpose: Result of checking the profile ID of a file
+**************************************************************************
+*/
+typedef enum {
+  icProfileIDOk = 0,      //Header ID matches the calculated ID
+  icProfileIDMissing,     //Header ID is zero
+  icProfileIDMismatch,    //Header ID differs from the calculated ID
+  icProfileIDReadError,   //File could not be read
+} icProfileIDStatus;
+
+/**
+**************************************************************************
+* Type: Structure
+*
+* Purpose: Profile ID check of a file
+**************************************************************************
+*/
+typedef struct {
+  icProfileIDStatus nStatus;
+  icProfileID headerID;
+  icProfileID calcID;
+} icProfileIDCheck;
+
+icProfileIDStatus ICCPROFLIB_API VerifyProfileID(CIccIO *pIO, icProfileIDCheck *pCheck=NULL);
+icProfileIDStatus ICCPROFLIB_API VerifyProfileID(const icChar *szFilename, icProfileIDCheck *pCheck=NULL);
+void ICCPROFLIB_API VerifyProfileIDs(const std::vector<std::string> &files, std::vector<icProfileIDCheck> &checks,
+                                     icUInt32Number nThreads=0);
+
+#if defined(USEICCDEVNAMESPACE)
+}; //namespace iccDEV
+#endif
+
+#endif //_ICCPROFILEID_H
@@ -0,0 +1,1440 @@
+/** @file
+    File:       IccSimd.cpp
+
+    Contains:   Implementation of runtime selected SIMD interpolation kernels
+
+    Version:    V1
+
+    Copyright:  (c) see Software License
+*/
+
+/*
+ * Copyright (c) International Color Consortium.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer. 
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. In the absence of prior written permission, the names "ICC" and "The
+ *    International Color Consortium" must not be used to imply that the
+ *    ICC organization endorses or promotes products derived from this
+ *    software.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE INTERNATIONAL COLOR CONSORTIUM OR
+ * ITS CONTRIBUTING MEMBERS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by many
+ * individuals on behalf of the The International Color Consortium. 
+ *
+ *
+ * Membership in the ICC is encouraged when this software is used for
+ * commercial purposes. 
+ *
+ *  
+ * For more information on The International Color Consortium, please
+ * see <http://www.color.org/>.
+ *  
+ * 
+ */
+
+//////////////////////////////////////////////////////////////////////
+// HISTORY:
+//
+// -Initial implementation of SIMD CLUT kernels 10-17-2026
+//
+//////////////////////////////////////////////////////////////////////
+
+#include "IccSimd.h"
+#include "IccUtil.h"
+#include <atomic>
+
+//Define ICC_DISABLE_SIMD to build only the scalar kernels
+#if !defined(ICC_DISABLE_SIMD)
+  #if defined(__x86_64__) || defined(_M_X64)
+    #define ICC_SIMD_X86
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+      #include <intrin.h>
+      #define ICC_TARGET_AVX2
+    #else
+      #define ICC_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+  #elif defined(__aarch64__)
+    #define ICC_SIMD_NEON
+    #include <arm_neon.h>
+  #endif
+#endif
+
+#if defined(USEICCDEVNAMESPACE)
+namespace iccDEV {
+#endif
+
+/**
+ **************************************************************************
+ * Name: icDetectSimdLevel
+ * 
+ * Purpose: 
+ *  Determines the best instruction set supported by the CPU and OS.
+ **************************************************************************
+ */
+static icSimdLevel icDetectSimdLevel()
+{
+#if defined(ICC_SIMD_X86)
+  #if defined(_MSC_VER)
+  int info[4];
+
+  __cpuid(info, 0);
+  if (info[0]>=7) {
+    __cpuid(info, 1);
+    //AVX state must be enabled by the OS
+    if ((info[2] & (1<<27)) && (info[2] & (1<<28)) && (_xgetbv(0) & 6)==6) {
+      __cpuidex(info, 7, 0);
+      if (info[1] & (1<<5))
+        return icSimdAVX2;
+    }
+  }
+  #else
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return icSimdAVX2;
+  #endif
+  return icSimdSSE2;
+#elif defined(ICC_SIMD_NEON)
+  return icSimdNEON;
+#else
+  return icSimdNone;
+#endif
+}
+
+static std::atomic<int> g_nSimdLevel(-1);
+
+/**
+ **************************************************************************
+ * Name: icGetSimdLevel
+ * 
+ * Purpose: 
+ *  Returns the instruction set used by the SIMD kernels.
+ **************************************************************************
+ */
+icSimdLevel icGetSimdLevel()
+{
+  int nLevel = g_nSimdLevel.load(std::memory_order_relaxed);
+
+  if (nLevel<0) {
+    nLevel = icDetectSimdLevel();
+    g_nSimdLevel.store(nLevel, std::memory_order_relaxed);
+  }
+
+  return (icSimdLevel)nLevel;
+}
+
+/**
+ **************************************************************************
+ * Name: icSetSimdLevel
+ * 
+ * Purpose: 
+ *  Restricts the instruction set used by the SIMD kernels.
+ * 
+ * Args:
+ *  nLevel = icSimdNone to use scalar kernels, otherwise the highest level
+ *   to use.
+ **************************************************************************
+ */
+void icSetSimdLevel(icSimdLevel nLevel)
+{
+  icSimdLevel nBest = icDetectSimdLevel();
+
+  if (nLevel==icSimdNone)
+    nBest = icSimdNone;
+  else if (nLevel==icSimdSSE2 && nBest==icSimdAVX2)
+    nBest = icSimdSSE2;
+
+  g_nSimdLevel.store(nBest, std::memory_order_relaxed);
+}
+
+/**
+ **************************************************************************
+ * Name: icGetSimdLevelName
+ * 
+ * Purpose: 
+ *  Returns the name of a SIMD level.
+ **************************************************************************
+ */
+const icChar *icGetSimdLevelName(icSimdLevel nLevel)
+{
+  switch(nLevel) {
+    case icSimdSSE2:
+      return "SSE2";
+    case icSimdAVX2:
+      return "AVX2";
+    case icSimdNEON:
+      return "NEON";
+    default:
+      return "None";
+  }
+}
+
+
+/**
+ **************************************************************************
+ * Name: icScalarGridCells
+ * 
+ * Purpose: 
+ *  Scalar grid cell search of pixels nStart to nPixels-1.
+ **************************************************************************
+ */
+static void icScalarGridCells(icUInt32Number *pIndex, icFloatNumber *pFrac, icUInt32Number nFracStride,
+                              const icFloatNumber *pSrc, icUInt32Number nSrcStride, icUInt8Number nInput,
+                              const icUInt8Number *pMaxGrid, const icUInt32Number *pDimSize, icUInt32Number nStart, icUInt32Number nPixels)
+{
+  for (icUInt32Number k=nStart; k<nPixels; k++) {
+    const icFloatNumber *src = pSrc + k*nSrcStride;
+    icUInt32Number index = 0;
+
+    for (icUInt8Number d=0; d<nInput; d++) {
+      icUInt8Number m = pMaxGrid[d];
+      icFloatNumber v = src[d];
+
+      if (!(v>=0.0f)) //Also maps NaN
+        v = 0.0f;
+      else if (v>1.0f)
+        v = 1.0f;
+
+      icFloatNumber g = v * m;
+      icUInt32Number ig = (icUInt32Number)g;
+      icFloatNumber f = g - ig;
+
+      if (ig>=m) {
+        ig = m-1;
+        f = 1.0f;
+      }
+      pFrac[d*nFracStride + k] = f;
+      index += ig*pDimSize[d];
+    }
+    pIndex[k] = index;
+  }
+}
+
+/**
+ **************************************************************************
+ * Name: icScalarGridWeights
+ * 
+ * Purpose: 
+ *  Scalar corner weights of pixels nStart to nPixels-1.
+ **************************************************************************
+ */
+static void icScalarGridWeights(icFloatNumber *pWeight, icUInt32Number nWeightStride, const icFloatNumber *pFrac, icUInt32Number nFracStride,
+                                icUInt8Number nInput, icUInt32Number nStart, icUInt32Number nPixels)
+{
+  for (icUInt32Number k=nStart; k<nPixels; k++) {
+    icFloatNumber *w = pWeight + k;
+    icUInt32Number nW = 1, j;
+    icUInt8Number d = nInput;
+
+    w[0] = 1.0f;
+    while (d--) {
+      icFloatNumber f = pFrac[d*nFracStride + k];
+      icFloatNumber nf = 1.0f - f;
+
+      for (j=nW; j--;) {
+        w[(2*j+1)*nWeightStride] = w[j*nWeightStride] * f;
+        w[2*j*nWeightStride] = w[j*nWeightStride] * nf;
+      }
+      nW *= 2;
+    }
+  }
+}
+
+/**
+ **************************************************************************
+ * Name: icScalarInterpLinear
+ * 
+ * Purpose: 
+ *  Scalar multilinear interpolation of pixels nStart to nPixels-1.
+ **************************************************************************
+ */
+static void icScalarInterpLinear(icFloatNumber *pDst, icUInt32Number nDstStride, const icFloatNumber *pData, icUInt16Number nOutput,
+                                 const icUInt32Number *pBase, const icUInt32Number *pOffset, icUInt32Number nCorners,
+                                 const icFloatNumber *pWeight, icUInt32Number nWeightStride, icUInt32Number nStart, icUInt32Number nPixels)
+{
+  for (icUInt32Number k=nStart; k<nPixels; k++) {
+    const icFloatNumber *p = pData + pBase[k];
+    const icFloatNumber *w = pWeight + k;
+    icFloatNumber *pOut = pDst + k*nDstStride;
+
+    for (icUInt16Number i=0; i<nOutput; i++, p++) {
+      icFloatNumber pv = p[pOffset[0]] * w[0];
+
+      for (icUInt32Number j=1; j<nCorners; j++)
+        pv += p[pOffset[j]] * w[j*nWeightStride];
+
+      pOut[i] = pv;
+    }
+  }
+}
+
+/**
+ **************************************************************************
+ * Name: icScalarInterpTetra
+ * 
+ * Purpose: 
+ *  Scalar tetrahedral interpolation of pixels nStart to nPixels-1.
+ **************************************************************************
+ */
+static void icScalarInterpTetra(icFloatNumber *pDst, icUInt32Number nDstStride, const icFloatNumber *pData, icUInt16Number nOutput,
+                                const icUInt32Number *pCorner, const icFloatNumber *pFrac, icUInt32Number nStart, icUInt32Number nPixels)
+{
+  for (icUInt32Number k=nStart; k<nPixels; k++) {
+    const icUInt32Number *c = pCorner + k*8;
+    icUInt32Number p0 = c[0], a1 = c[1], a0 = c[2], b1 = c[3], b0 = c[4], c1 = c[5], c0 = c[6];
+    icFloatNumber t = pFrac[k*4], u = pFrac[k*4 + 1], v = pFrac[k*4 + 2];
+    const icFloatNumber *p = pData;
+    icFloatNumber *pOut = pDst + k*nDstStride;
+
+    for (icUInt16Number i=0; i<nOutput; i++, p++) {
+      pOut[i] = p[p0] + t*(p[a1]-p[a0]) + u*(p[b1]-p[b0]) + v*(p[c1]-p[c0]);
+    }
+  }
+}
+
+
+#if defined(ICC_SIMD_X86)
+
+/**
+ **************************************************************************
+ * Name: icSSE2GridCells
+ * 
+ * Purpose: 
+ *  Grid cell search of 4 pixels at a time using SSE2.
+ **************************************************************************
+ */
+static void icSSE2GridCells(icUInt32Number *pIndex, icFloatNumber *pFrac, icUInt32Number nFracStride,
+                            const icFloatNumber *pSrc, icUInt32Number nSrcStride, icUInt8Number nInput,
+                            const icUInt8Number *pMaxGrid, const icUInt32Number *pDimSize, icUInt32Number nPixels)
+{
+  icUInt32Number k;
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  icInt32Number ig[4];
+
+  for (k=0; k+4<=nPixels; k+=4) {
+    const icFloatNumber *src = pSrc + k*nSrcStride;
+    icUInt32Number *index = pIndex + k;
+
+    index[0] = index[1] = index[2] = index[3] = 0;
+
+    for (icUInt8Number d=0; d<nInput; d++) {
+      icUInt8Number m = pMaxGrid[d];
+      __m128 v = _mm_setr_ps(src[d], src[nSrcStride + d], src[2*nSrcStride + d], src[3*nSrcStride + d]);
+
+      //max returns its second operand for NaN
+      v = _mm_min_ps(_mm_max_ps(v, zero), one);
+
+      __m128 g = _mm_mul_ps(v, _mm_set1_ps((icFloatNumber)m));
+      __m128i vi = _mm_cvttps_epi32(g);
+      __m128 f = _mm_sub_ps(g, _mm_cvtepi32_ps(vi));
+      __m128i top = _mm_cmpgt_epi32(vi, _mm_set1_epi32(m-1));
+
+      vi = _mm_or_si128(_mm_andnot_si128(top, vi), _mm_and_si128(top, _mm_set1_epi32(m-1)));
+      f = _mm_or_ps(_mm_andnot_ps(_mm_castsi128_ps(top), f), _mm_and_ps(_mm_castsi128_ps(top), one));
+
+      _mm_storeu_ps(pFrac + d*nFracStride + k, f);
+      _mm_storeu_si128((__m128i*)ig, vi);
+
+      icUInt32Number nDim = pDimSize[d];
+      index[0] += ig[0]*nDim;
+      index[1] += ig[1]*nDim;
+      index[2] += ig[2]*nDim;
+      index[3] += ig[3]*nDim;
+    }
+  }
+
+  icScalarGridCells(pIndex, pFrac, nFracStride, pSrc, nSrcStride, nInput, pMaxGrid, pDimSize, k, nPixels);
+}
+
+/**
+ **************************************************************************
+ * Name: icSSE2GridWeights
+ * 
+ * Purpose: 
+ *  Corner weights of 4 pixels at a time using SSE2.
+ **************************************************************************
+ */
+static void icSSE2GridWeights(icFloatNumber *pWeight, icUInt32Number nWeightStride, const icFloatNumber *pFrac, icUInt32Number nFracStride,
+                              icUInt8Number nInput, icUInt32Number nPixels)
+{
+  icUInt32Number k;
+  const __m128 one = _mm_set1_ps(1.0f);
+
+  for (k=0; k+4<=nPixels; k+=4) {
+    icFloatNumber *w = pWeight + k;
+    icUInt32Number nW = 1, j;
+    icUInt8Number d = nInput;
+
+    _mm_storeu_ps(w, one);
+    while (d--) {
+      __m128 f = _mm_loadu_ps(pFrac + d*nFracStride + k);
+      __m128 nf = _mm_sub_ps(one, f);
+
+      for (j=nW; j--;) {
+        __m128 wj = _mm_loadu_ps(w + j*nWeightStride);
+        _mm_storeu_ps(w + (2*j+1)*nWeightStride, _mm_mul_ps(wj, f));
+        _mm_storeu_ps(w + 2*j*nWeightStride, _mm_mul_ps(wj, nf));
+      }
+      nW *= 2;
+    }
+  }
+
+  icScalarGridWeights(pWeight, nWeightStride, pFrac, nFracStride, nInput, k, nPixels);
+}
+
+/**
+ **************************************************************************
+ * Name: icSSE2InterpLinear
+ * 
+ * Purpose: 
+ *  Multilinear interpolation with 4 output channels at a time using SSE2.
+ *  Output channels of a grid node are contiguous so each corner is a
+ *  single unaligned load.  Pixels whose last load would pass the end of
+ *  the grid data use the scalar code.
+ **************************************************************************
+ */
+static void icSSE2InterpLinear(icFloatNumber *pDst, icUInt32Number nDstStride, const icFloatNumber *pData, icUInt32Number nDataSize,
+                               icUInt16Number nOutput, const icUInt32Number *pBase, const icUInt32Number *pOffset, icUInt32Number nCorners,
+                               const icFloatNumber *pWeight, icUInt32Number nWeightStride, icUInt32Number nPixels)
+{
+  icUInt32Number nVecOut = (nOutput+3) & ~3;
+  icUInt32Number nLast = pOffset[nCorners-1] + nVecOut;
+  float r[4];
+
+  for (icUInt32Number k=0; k<nPixels; k++) {
+    if (pBase[k] + nLast > nDataSize) {
+      icScalarInterpLinear(pDst, nDstStride, pData, nOutput, pBase, pOffset, nCorners, pWeight, nWeightStride, k, k+1);
+      continue;
+    }
+
+    const icFloatNumber *p = pData + pBase[k];
+    const icFloatNumber *w = pWeight + k;
+    icFloatNumber *pOut = pDst + k*nDstStride;
+
+    for (icUInt32Number i=0; i<nOutput; i+=4, p+=4) {
+      __m128 acc = _mm_mul_ps(_mm_loadu_ps(p + pOffset[0]), _mm_set1_ps(w[0]));
+
+      for (icUInt32Number j=1; j<nCorners; j++)
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(p + pOffset[j]), _mm_set1_ps(w[j*nWeightStride])));
+
+      if (i+4<=nOutput)
+        _mm_storeu_ps(pOut + i, acc);
+      else {
+        _mm_storeu_ps(r, acc);
+        for (icUInt32Number l=0; i+l<nOutput; l++)
+          pOut[i+l] = r[l];
+      }
+    }
+  }
+}
+
+/**
+ **************************************************************************
+ * Name: icSSE2InterpTetra
+ * 
+ * Purpose: 
+ *  Tetrahedral interpolation with 4 output channels at a time using SSE2.
+ **************************************************************************
+ */
+static void icSSE2InterpTetra(icFloatNumber *pDst, icUInt32Number nDstStride, const icFloatNumber *pData, icUInt32Number nDataSize,
+                              icUInt16Number nOutput, const icUInt32Number *pCorner,
+                              const icFloatNumber *pFrac, icUInt32Number nPixels)
+{
+  icUInt32Number nVecOut = (nOutput+3) & ~3;
+  float r[4];
+
+  for (icUInt32Number k=0; k<nPixels; k++) {
+    const icUInt32Number *c = pCorner + k*8;
+    icUInt32Number p0 = c[0], a1 = c[1], a0 = c[2], b1 = c[3], b0 = c[4], c1 = c[5], c0 = c[6];
+
+    //The largest offset is always one of a1, b1 or c1
+    icUInt32Number nMax = a1 > b1 ? a1 : b1;
+    if (c1 > nMax)
+      nMax = c1;
+
+    if (nMax + nVecOut > nDataSize) {
+      icScalarInterpTetra(pDst, nDstStride, pData, nOutput, pCorner, pFrac, k, k+1);
+      continue;
+    }
+
+    __m128 t = _mm_set1_ps(pFrac[k*4]);
+    __m128 u = _mm_set1_ps(pFrac[k*4 + 1]);
+    __m128 v = _mm_set1_ps(pFrac[k*4 + 2]);
+    const icFloatNumber *p = pData;
+    icFloatNumber *pOut = pDst + k*nDstStride;
+
+    for (icUInt32Number i=0; i<nOutput; i+=4, p+=4) {
+      __m128 acc = _mm_add_ps(_mm_loadu_ps(p + p0), _mm_mul_ps(t, _mm_sub_ps(_mm_loadu_ps(p + a1), _mm_loadu_ps(p + a0))));
+      acc = _mm_add_ps(acc, _mm_mul_ps(u, _mm_sub_ps(_mm_loadu_ps(p + b1), _mm_loadu_ps(p + b0))));
+      acc = _mm_add_ps(acc, _mm_mul_ps(v, _mm_sub_ps(_mm_loadu_ps(p + c1), _mm_loadu_ps(p + c0))));
+
+      if (i+4<=nOutput)
+        _mm_storeu_ps(pOut + i, acc);
+      else {
+        _mm_storeu_ps(r, acc);
+        for (icUInt32Number l=0; i+l<nOutput; l++)
+          pOut[i+l] = r[l];
+      }
+    }
+  }
+}
+
+/**
+ **************************************************************************
+ * Name: icAVX2GridCells
+ * 
+ * Purpose: 
+ *  Grid cell search of 8 pixels at a time using AVX2.
+ **************************************************************************
+ */
+ICC_TARGET_AVX2
+static void icAVX2GridCells(icUInt32Number *pIndex, icFloatNumber *pFrac, icUInt32Number nFracStride,
+                            const icFloatNumber *pSrc, icUInt32Number nSrcStride, icUInt8Number nInput,
+                            const icUInt8Number *pMaxGrid, const icUInt32Number *pDimSize, icUInt32Number nPixels)
+{
+  icUInt32Number k;
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256i lanes = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32((int)nSrcStride));
+
+  for (k=0; k+8<=nPixels; k+=8) {
+    const icFloatNumber *src = pSrc + k*nSrcStride;
+    __m256i index = _mm256_setzero_si256();
+
+    for (icUInt8Number d=0; d<nInput; d++) {
+      __m256i m1 = _mm256_set1_epi32(pMaxGrid[d]-1);
+      __m256 v = _mm256_i32gather_ps(src + d, lanes, 4);
+
+      //max returns its second operand for NaN
+      v = _mm256_min_ps(_mm256_max_ps(v, zero), one);
+
+      __m256 g = _mm256_mul_ps(v, _mm256_set1_ps((icFloatNumber)pMaxGrid[d]));
+      __m256i vi = _mm256_cvttps_epi32(g);
+      __m256 f = _mm256_sub_ps(g, _mm256_cvtepi32_ps(vi));
+      __m256i top = _mm256_cmpgt_epi32(vi, m1);
+
+      vi = _mm256_blendv_epi8(vi, m1, top);
+      f = _mm256_blendv_ps(f, one, _mm256_castsi256_ps(top));
+
+      _mm256_storeu_ps(pFrac + d*nFracStride + k, f);
+      index = _mm256_add_epi32(index, _mm256_mullo_epi32(vi, _mm256_set1_epi32((int)pDimSize[d])));
+    }
+    _mm256_storeu_si256((__m256i*)(pIndex + k), index);
+  }
+
+  icScalarGridCells(pIndex, pFrac, nFracStride, pSrc, nSrcStride, nInput, pMaxGrid, pDimSize, k, nPixels);
+}
+
+/**
+ **************************************************************************
+ * Name: icAVX2GridWeights
+ * 
+ * Purpose: 
+ *  Corner weights of 8 pixels at a time using AVX2.
+ **************************************************************************
+ */
+ICC_TARGET_AVX2
+static void icAVX2GridWeights(icFloatNumber *pWeight, icUInt32Number nWeightStride, const icFloatNumber *pFrac, icUInt32Number nFracStride,
+                              icUInt8Number nInput, icUInt32Number nPixels)
+{
+  icUInt32Number k;
+  const __m256 one = _mm256_set1_ps(1.0f);
+
+  for (k=0; k+8<=nPixels; k+=8) {
+    icFloatNumber *w = pWeight + k;
+    icUInt32Number nW = 1, j;
+    icUInt8Number d = nInput;
+
+    _mm256_storeu_ps(w, one);
+    while (d--) {
+      __m256 f = _mm256_loadu_ps(pFrac + d*nFracStride + k);
+      __m256 nf = _mm256_sub_ps(one, f);
+
+      for (j=nW; j--;) {
+        __m256 wj = _mm256_loadu_ps(w + j*nWeightStride);
+        _mm256_storeu_ps(w + (2*j+1)*nWeightStride, _mm256_mul_ps(wj, f));
+        _mm256_storeu_ps(w + 2*j*nWeightStride, _mm256_mul_ps(wj, nf));
+      }
+      nW *= 2;
+    }
+  }
+
+  icScalarGridWeights(pWeight, nWeightStride, pFrac, nFracStride, nInput, k, nPixels);
+}
+
+/**
+ **************************************************************************
+ * Name: icAVX2InterpLinear
+ * 
+ * Purpose: 
+ *  Multilinear interpolation with 8 output channels at a time using AVX2.
+ *  CLUTs with 4 or fewer outputs use the SSE2 kernel.
+ **************************************************************************
+ */
+ICC_TARGET_AVX2
+static void icAVX2InterpLinear(icFloatNumber *pDst, icUInt32Number nDstStride, const icFloatNumber *pData, icUInt32Number nDataSize,
+                               icUInt16Number nOutput, const icUInt32Number *pBase, const icUInt32Number *pOffset, icUInt32Number nCorners,
+                               const icFloatNumber *pWeight, icUInt32Number nWeightStride, icUInt32Number nPixels)
+{
+  icUInt32Number nVecOut = (nOutput+7) & ~7;
+  icUInt32Number nLast = pOffset[nCorners-1] + nVecOut;
+  float r[8];
+
+  for (icUInt32Number k=0; k<nPixels; k++) {
+    if (pBase[k] + nLast > nDataSize) {
+      icScalarInterpLinear(pDst, nDstStride, pData, nOutput, pBase, pOffset, nCorners, pWeight, nWeightStride, k, k+1);
+      continue;
+    }
+
+    const icFloatNumber *p = pData + pBase[k];
+    const icFloatNumber *w = pWeight + k;
+    icFloatNumber *pOut = pDst + k*nDstStride;
+
+    for (icUInt32Number i=0; i<nOutput; i+=8, p+=8) {
+      __m256 acc = _mm256_mul_ps(_mm256_loadu_ps(p + pOffset[0]), _mm256_set1_ps(w[0]));
+
+      for (icUInt32Number j=1; j<nCorners; j++)
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(p + pOffset[j]), _mm256_set1_ps(w[j*nWeightStride])));
+
+      if (i+8<=nOutput)
+        _mm256_storeu_ps(pOut + i, acc);
+      else {
+        _mm256_storeu_ps(r, acc);
+        for (icUInt32Number l=0; i+l<nOutput; l++)
+          pOut[i+l] = r[l];
+      }
+    }
+  }
+}
+
+/**
+ **************************************************************************
+ * Name: icAVX2InterpTetra
+ * 
+ * Purpose: 
+ *  Tetrahedral interpolation with 8 output channels at a time using AVX2.
+ *  CLUTs with 4 or fewer outputs use the SSE2 kernel.
+ **************************************************************************
+ */
+ICC_TARGET_AVX2
+static void icAVX2InterpTetra(icFloatNumber *pDst, icUInt32Number nDstStride, const icFloatNumber *pData, icUInt32Number nDataSize,
+                              icUInt16Number nOutput, const icUInt32Number *pCorner,
+                              const icFloatNumber *pFrac, icUInt32Number nPixels)
+{
+  icUInt32Number nVecOut = (nOutput+7) & ~7;
+  float r[8];
+
+  for (icUInt32Number k=0; k<nPixels; k++) {
+    const icUInt32Number *c = pCorner + k*8;
+    icUInt32Number p0 = c[0], a1 = c[1], a0 = c[2], b1 = c[3], b0 = c[4], c1 = c[5], c0 = c[6];
+
+    icUInt32Number nMax = a1 > b1 ? a1 : b1;
+    if (c1 > nMax)
+      nMax = c1;
+
+    if (nMax + nVecOut > nDataSize) {
+      icScalarInterpTetra(pDst, nDstStride, pData, nOutput, pCorner, pFrac, k, k+1);
+      continue;
+    }
+
+    __m256 t = _mm256_set1_ps(pFrac[k*4]);
+    __m256 u = _mm256_set1_ps(pFrac[k*4 + 1]);
+    __m256 v = _mm256_set1_ps(pFrac[k*4 + 2]);
+    const icFloatNumber *p = pData;
+    icFloatNumber *pOut = pDst + k*nDstStride;
+
+    for (icUInt32Number i=0; i<nOutput; i+=8, p+=8) {
+      __m256 acc = _mm256_add_ps(_mm256_loadu_ps(p + p0), _mm256_mul_ps(t, _mm256_sub_ps(_mm256_loadu_ps(p + a1), _mm256_loadu_ps(p + a0))));
+      acc = _mm256_add_ps(acc, _mm256_mul_ps(u, _mm256_sub_ps(_mm256_loadu_ps(p + b1), _mm256_loadu_ps(p + b0))));
+      acc = _mm256_add_ps(acc, _mm256_mul_ps(v, _mm256_sub_ps(_mm256_loadu_ps(p + c1), _mm256_loadu_ps(p + c0))));
+
+      if (i+8<=nOutput)
+        _mm256_storeu_ps(pOut + i, acc);
+      else {
+        _mm256_storeu_ps(r, acc);
+        for (icUInt32Number l=0; i+l<nOutput; l++)
+          pOut[i+l] = r[l];
+      }
+    }
+  }
+}
+
+#endif //ICC_SIMD_X86
+
+
+#if defined(ICC_SIMD_NEON)
+
+/**
+ **************************************************************************
+ * Name: icNEONGridCells
+ * 
+ * Purpose: 
+ *  Grid cell search of 4 pixels at a time using NEON.
+ **************************************************************************
+ */
+static void icNEONGridCells(icUInt32Number *pIndex, icFloatNumber *pFrac, icUInt32Number nFracStride,
+                            const icFloatNumber *pSrc, icUInt32Number nSrcStride, icUInt8Number nInput,
+                            const icUInt8Number *pMaxGrid, const icUInt32Number *pDimSize, icUInt32Number nPixels)
+{
+  icUInt32Number k;
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  const float32x4_t one = vdupq_n_f32(1.0f);
+
+  for (k=0; k+4<=nPixels; k+=4) {
+    const icFloatNumber *src = pSrc + k*nSrcStride;
+    uint32x4_t index = vdupq_n_u32(0);
+
+    for (icUInt8Number d=0; d<nInput; d++) {
+      uint32x4_t m1 = vdupq_n_u32(pMaxGrid[d]-1);
+      float32x4_t v = { src[d], src[nSrcStride + d], src[2*nSrcStride + d], src[3*nSrcStride + d] };
+
+      //maxnm returns the number when the other operand is NaN
+      v = vminq_f32(vmaxnmq_f32(v, zero), one);
+
+      float32x4_t g = vmulq_f32(v, vdupq_n_f32((icFloatNumber)pMaxGrid[d]));
+      uint32x4_t vi = vcvtq_u32_f32(g);
+      float32x4_t f = vsubq_f32(g, vcvtq_f32_u32(vi));
+      uint32x4_t top = vcgtq_u32(vi, m1);
+
+      vi = vbslq_u32(top, m1, vi);
+      f = vbslq_f32(top, one, f);
+
+      vst1q_f32(pFrac + d*nFracStride + k, f);
+      index = vmlaq_u32(index, vi, vdupq_n_u32(pDimSize[d]));
+    }
+    vst1q_u32(pIndex + k, index);
+  }
+
+  icScalarGridCells(pIndex, pFrac, nFracStride, pSrc, nSrcStride, nInput, pMaxGrid, pDimSize, k, nPixels);
+}
+
+/**
+ **************************************************************************
+ * Name: icNEONGridWeights
+ * 
+ * Purpose: 
+ *  Corner weights of 4 pixels at a time using NEON.
+ **************************************************************************
+ */
+static void icNEONGridWeights(icFloatNumber *pWeight, icUInt32Number nWeightStride, const icFloatNumber *pFrac, icUInt32Number nFracStride,
+                              icUInt8Number nInput, icUInt32Number nPixels)
+{
+  icUInt32Number k;
+  const float32x4_t one = vdupq_n_f32(1.0f);
+
+  for (k=0; k+4<=nPixels; k+=4) {
+    icFloatNumber *w = pWeight + k;
+    icUInt32Number nW = 1, j;
+    icUInt8Number d = nInput;
+
+    vst1q_f32(w, one);
+    while (d--) {
+      float32x4_t f = vld1q_f32(pFrac + d*nFracStride + k);
+      float32x4_t nf = vsubq_f32(one, f);
+
+      for (j=nW; j--;) {
+        float32x4_t wj = vld1q_f32(w + j*nWeightStride);
+        vst1q_f32(w + (2*j+1)*nWeightStride, vmulq_f32(wj, f));
+        vst1q_f32(w + 2*j*nWeightStride, vmulq_f32(wj, nf));
+      }
+      nW *= 2;
+    }
+  }
+
+  icScalarGridWeights(pWeight, nWeightStride, pFrac, nFracStride, nInput, k, nPixels);
+}
+
+/**
+ **************************************************************************
+ * Name: icNEONInterpLinear
+ * 
+ * Purpose: 
+ *  Multilinear interpolation with 4 output channels at a time using NEON.
+ **************************************************************************
+ */
+static void icNEONInterpLinear(icFloatNumber *pDst, icUInt32Number nDstStride, const icFloatNumber *pData, icUInt32Number nDataSize,
+                               icUInt16Number nOutput, const icUInt32Number *pBase, const icUInt32Number *pOffset, icUInt32Number nCorners,
+                               const icFloatNumber *pWeight, icUInt32Number nWeightStride, icUInt32Number nPixels)
+{
+  icUInt32Number nVecOut = (nOutput+3) & ~3;
+  icUInt32Number nLast = pOffset[nCorners-1] + nVecOut;
+  float r[4];
+
+  for (icUInt32Number k=0; k<nPixels; k++) {
+    if (pBase[k] + nLast > nDataSize) {
+      icScalarInterpLinear(pDst, nDstStride, pData, nOutput, pBase, pOffset, nCorners, pWeight, nWeightStride, k, k+1);
+      continue;
+    }
+
+    const icFloatNumber *p = pData + pBase[k];
+    const icFloatNumber *w = pWeight + k;
+    icFloatNumber *pOut = pDst + k*nDstStride;
+
+    for (icUInt32Number i=0; i<nOutput; i+=4, p+=4) {
+      float32x4_t acc = vmulq_f32(vld1q_f32(p + pOffset[0]), vdupq_n_f32(w[0]));
+
+      for (icUInt32Number j=1; j<nCorners; j++)
+        acc = vaddq_f32(acc, vmulq_f32(vld1q_f32(p + pOffset[j]), vdupq_n_f32(w[j*nWeightStride])));
+
+      if (i+4<=nOutput)
+        vst1q_f32(pOut + i, acc);
+      else {
+        vst1q_f32(r, acc);
+        for (icUInt32Number l=0; i+l<nOutput; l++)
+          pOut[i+l] = r[l];
+      }
+    }
+  }
+}
+
+/**
+ **************************************************************************
+ * Name: icNEONInterpTetra
+ * 
+ * Purpose: 
+ *  Tetrahedral interpolation with 4 output channels at a time using NEON.
+ **************************************************************************
+ */
+static void icNEONInterpTetra(icFloatNumber *pDst, icUInt32Number nDstStride, const icFloatNumber *pData, icUInt32Number nDataSize,
+                              icUInt16Number nOutput, const icUInt32Number *pCorner,
+                              const icFloatNumber *pFrac, icUInt32Number nPixels)
+{
+  icUInt32Number nVecOut = (nOutput+3) & ~3;
+  float r[4];
+
+  for (icUInt32Number k=0; k<nPixels; k++) {
+    const icUInt32Number *c = pCorner + k*8;
+    icUInt32Number p0 = c[0], a1 = c[1], a0 = c[2], b1 = c[3], b0 = c[4], c1 = c[5], c0 = c[6];
+
+    icUInt32Number nMax = a1 > b1 ? a1 : b1;
+    if (c1 > nMax)
+      nMax = c1;
+
+    if (nMax + nVecOut > nDataSize) {
+      icScalarInterpTetra(pDst, nDstStride, pData, nOutput, pCorner, pFrac, k, k+1);
+      continue;
+    }
+
+    float32x4_t t = vdupq_n_f32(pFrac[k*4]);
+    float32x4_t u = vdupq_n_f32(pFrac[k*4 + 1]);
+    float32x4_t v = vdupq_n_f32(pFrac[k*4 + 2]);
+    const icFloatNumber *p = pData;
+    icFloatNumber *pOut = pDst + k*nDstStride;
+
+    for (icUInt32Number i=0; i<nOutput; i+=4, p+=4) {
+      float32x4_t acc = vaddq_f32(vld1q_f32(p + p0), vmulq_f32(t, vsubq_f32(vld1q_f32(p + a1), vld1q_f32(p + a0))));
+      acc = vaddq_f32(acc, vmulq_f32(u, vsubq_f32(vld1q_f32(p + b1), vld1q_f32(p + b0))));
+      acc = vaddq_f32(acc, vmulq_f32(v, vsubq_f32(vld1q_f32(p + c1), vld1q_f32(p + c0))));
+
+      if (i+4<=nOutput)
+        vst1q_f32(pOut + i, acc);
+      else {
+        vst1q_f32(r, acc);
+        for (icUInt32Number l=0; i+l<nOutput; l++)
+          pOut[i+l] = r[l];
+      }
+    }
+  }
+}
+
+#endif //ICC_SIMD_NEON
+
+
+/**
+ **************************************************************************
+ * Name: icSimdGridCells
+ * 
+ * Purpose: 
+ *  Finds the grid cell and fractional position within the cell of a
+ *  block of pixels using the kernel of the current SIMD level.  Inputs
+ *  are clipped to 0.0 to 1.0 (NaN to 0.0) as by the default CIccCLUT
+ *  clip function.
+ * 
+ * Args:
+ *  pIndex = data offset of the grid cell of each pixel,
+ *  pFrac = nInput rows of fractions,
+ *  nFracStride = number of entries in each row of pFrac,
+ *  pSrc = source pixels,
+ *  nSrcStride = number of samples between source pixels,
+ *  nInput = number of inputs,
+ *  pMaxGrid = index of the last grid point of each input,
+ *  pDimSize = data offset between grid points of each input,
+ *  nPixels = number of pixels.
+ **************************************************************************
+ */
+void icSimdGridCells(icUInt32Number *pIndex, icFloatNumber *pFrac, icUInt32Number nFracStride,
+                     const icFloatNumber *pSrc, icUInt32Number nSrcStride, icUInt8Number nInput,
+                     const icUInt8Number *pMaxGrid, const icUInt32Number *pDimSize, icUInt32Number nPixels)
+{
+  switch(icGetSimdLevel()) {
+#if defined(ICC_SIMD_X86)
+    case icSimdAVX2:
+      icAVX2GridCells(pIndex, pFrac, nFracStride, pSrc, nSrcStride, nInput, pMaxGrid, pDimSize, nPixels);
+      break;
+    case icSimdSSE2:
+      icSSE2GridCells(pIndex, pFrac, nFracStride, pSrc, nSrcStride, nInput, pMaxGrid, pDimSize, nPixels);
+      break;
+#endif
+#if defined(ICC_SIMD_NEON)
+    case icSimdNEON:
+      icNEONGridCells(pIndex, pFrac, nFracStride, pSrc, nSrcStride, nInput, pMaxGrid, pDimSize, nPixels);
+      break;
+#endif
+    default:
+      icScalarGridCells(pIndex, pFrac, nFracStride, pSrc, nSrcStride, nInput, pMaxGrid, pDimSize, 0, nPixels);
+      break;
+  }
+}
+
+/**
+ **************************************************************************
+ * Name: icSimdGridWeights
+ * 
+ * Purpose: 
+ *  Finds the multilinear corner weights of a block of pixels using the
+ *  kernel of the current SIMD level.
+ * 
+ * Args:
+ *  pWeight = 2^nInput rows of corner weights,
+ *  nWeightStride = number of entries in each row of pWeight,
+ *  pFrac = nInput rows of fractions,
+ *  nFracStride = number of entries in each row of pFrac,
+ *  nInput = number of inputs,
+ *  nPixels = number of pixels.
+ **************************************************************************
+ */
+void icSimdGridWeights(icFloatNumber *pWeight, icUInt32Number nWeightStride, const icFloatNumber *pFrac, icUInt32Number nFracStride,
+                       icUInt8Number nInput, icUInt32Number nPixels)
+{
+  switch(icGetSimdLevel()) {
+#if defined(ICC_SIMD_X86)
+    case icSimdAVX2:
+      icAVX2GridWeights(pWeight, nWeightStride, pFrac, nFracStride, nInput, nPixels);
+      break;
+    case icSimdSSE2:
+      icSSE2GridWeights(pWeight, nWeightStride, pFrac, nFracStride, nInput, nPixels);
+      break;
+#endif
+#if defined(ICC_SIMD_NEON)
+    case icSimdNEON:
+      icNEONGridWeights(pWeight, nWeightStride, pFrac, nFracStride, nInput, nPixels);
+      break;
+#endif
+    default:
+      icScalarGridWeights(pWeight, nWeightStride, pFrac, nFracStride, nInput, 0, nPixels);
+      break;
+  }
+}
+
+/**
+ **************************************************************************
+ * Name: icSimdInterpLinear
+ * 
+ * Purpose: 
+ *  Multilinear interpolation of a block of pixels using the kernel of the
+ *  current SIMD level.
+ * 
+ * Args:
+ *  pDst = destination of nPixels pixels with nOutput channels,
+ *  nDstStride = number of samples between destination pixels,
+ *  pData = grid data,
+ *  nDataSize = number of values in pData,
+ *  nOutput = number of output channels,
+ *  pBase = data offset of the grid cell of each pixel,
+ *  pOffset = data offsets of the cell corners relative to the cell,
+ *  nCorners = number of cell corners,
+ *  pWeight = nCorners rows of corner weights,
+ *  nWeightStride = number of entries in each row of pWeight,
+ *  nPixels = number of pixels to interpolate.
+ **************************************************************************
+ */
+void icSimdInterpLinear(icFloatNumber *pDst, icUInt32Number nDstStride, const icFloatNumber *pData, icUInt32Number nDataSize,
+                        icUInt16Number nOutput, const icUInt32Number *pBase, const icUInt32Number *pOffset, icUInt32Number nCorners,
+                        const icFloatNumber *pWeight, icUInt32Number nWeightStride, icUInt32Number nPixels)
+{
+  switch(icGetSimdLevel()) {
+#if defined(ICC_SIMD_X86)
+    case icSimdAVX2:
+      if (nOutput<=4) {
+        icSSE2InterpLinear(pDst, nDstStride, pData, nDataSize, nOutput, pBase, pOffset, nCorners, pWeight, nWeightStride, nPixels);
+        break;
+      }
+      icAVX2InterpLinear(pDst, nDstStride, pData, nDataSize, nOutput, pBase, pOffset, nCorners, pWeight, nWeightStride, nPixels);
+      break;
+    case icSimdSSE2:
+      icSSE2InterpLinear(pDst, nDstStride, pData, nDataSize, nOutput, pBase, pOffset, nCorners, pWeight, nWeightStride, nPixels);
+      break;
+#endif
+#if defined(ICC_SIMD_NEON)
+    case icSimdNEON:
+      icNEONInterpLinear(pDst, nDstStride, pData, nDataSize, nOutput, pBase, pOffset, nCorners, pWeight, nWeightStride, nPixels);
+      break;
+#endif
+    default:
+      icScalarInterpLinear(pDst, nDstStride, pData, nOutput, pBase, pOffset, nCorners, pWeight, nWeightStride, 0, nPixels);
+      break;
+  }
+}
+
+/**
+ **************************************************************************
+ * Name: icSimdInterpTetra
+ * 
+ * Purpose: 
+ *  Tetrahedral interpolation of a block of pixels using the kernel of the
+ *  current SIMD level.
+ * 
+ * Args:
+ *  pDst = destination of nPixels pixels with nOutput channels,
+ *  nDstStride = number of samples between destination pixels,
+ *  pData = grid data,
+ *  nDataSize = number of values in pData,
+ *  nOutput = number of output channels,
+ *  pCorner = 8 entries for each pixel with data offsets (p0, a1, a0, b1, b0, c1, c0, unused),
+ *  pFrac = 4 entries for each pixel with fractions (t, u, v, unused),
+ *  nPixels = number of pixels to interpolate.
+ **************************************************************************
+ */
+void icSimdInterpTetra(icFloatNumber *pDst, icUInt32Number nDstStride, const icFloatNumber *pData, icUInt32Number nDataSize,
+                       icUInt16Number nOutput, const icUInt32Number *pCorner,
+                       const icFloatNumber *pFrac, icUInt32Number nPixels)
+{
+  switch(icGetSimdLevel()) {
+#if defined(ICC_SIMD_X86)
+    case icSimdAVX2:
+      if (nOutput<=4) {
+        icSSE2InterpTetra(pDst, nDstStride, pData, nDataSize, nOutput, pCorner, pFrac, nPixels);
+        break;
+      }
+      icAVX2InterpTetra(pDst, nDstStride, pData, nDataSize, nOutput, pCorner, pFrac, nPixels);
+      break;
+    case icSimdSSE2:
+      icSSE2InterpTetra(pDst, nDstStride, pData, nDataSize, nOutput, pCorner, pFrac, nPixels);
+      break;
+#endif
+#if defined(ICC_SIMD_NEON)
+    case icSimdNEON:
+      icNEONInterpTetra(pDst, nDstStride, pData, nDataSize, nOutput, pCorner, pFrac, nPixels);
+      break;
+#endif
+    default:
+      icScalarInterpTetra(pDst, nDstStride, pData, nOutput, pCorner, pFrac, 0, nPixels);
+      break;
+  }
+}
+
+/**
+ **************************************************************************
+ * Name: icScalarUInt8ToFloat
+ * 
+ * Purpose: 
+ *  Scalar conversion of 8-bit values nStart to nNum-1.
+ **************************************************************************
+ */
+static void icScalarUInt8ToFloat(icFloatNumber *pDst, const icUInt8Number *pSrc, size_t nStart, size_t nNum)
+{
+  for (size_t i=nStart; i<nNum; i++)
+    pDst[i] = (icFloatNumber)((icFloatNumber)pSrc[i] / 255.0);
+}
+
+/**
+ **************************************************************************
+ * Name: icScalarUInt16BEToFloat
+ * 
+ * Purpose: 
+ *  Scalar conversion of big-endian 16-bit values nStart to nNum-1.
+ **************************************************************************
+ */
+static void icScalarUInt16BEToFloat(icFloatNumber *pDst, const icUInt8Number *pSrc, size_t nStart, size_t nNum)
+{
+  for (size_t i=nStart; i<nNum; i++) {
+    icUInt16Number v = (icUInt16Number)((pSrc[2*i]<<8) | pSrc[2*i+1]);
+    pDst[i] = (icFloatNumber)((icFloatNumber)v / 65535.0);
+  }
+}
+
+/**
+ **************************************************************************
+ * Name: icScalarSwap16Array / icScalarSwap32Array
+ * 
+ * Purpose: 
+ *  Scalar byte order reversal of values nStart to nNum-1.
+ **************************************************************************
+ */
+static void icScalarSwap16Array(icUInt8Number *pBuf, size_t nStart, size_t nNum)
+{
+  for (size_t i=nStart; i<nNum; i++) {
+    icUInt8Number *p = pBuf + 2*i;
+    icUInt8Number tmp = p[0]; p[0] = p[1]; p[1] = tmp;
+  }
+}
+
+static void icScalarSwap32Array(icUInt8Number *pBuf, size_t nStart, size_t nNum)
+{
+  for (size_t i=nStart; i<nNum; i++) {
+    icUInt8Number *p = pBuf + 4*i;
+    icUInt8Number tmp;
+    tmp = p[0]; p[0] = p[3]; p[3] = tmp;
+    tmp = p[1]; p[1] = p[2]; p[2] = tmp;
+  }
+}
+
+#if defined(ICC_SIMD_X86)
+
+/**
+ **************************************************************************
+ * Name: icSSE2UInt8ToFloat
+ * 
+ * Purpose: 
+ *  Converts 16 8-bit values at a time using SSE2.  Single precision
+ *  division by 255 gives the same result as the scalar double precision
+ *  division (checked for all 256 values).
+ **************************************************************************
+ */
+static void icSSE2UInt8ToFloat(icFloatNumber *pDst, const icUInt8Number *pSrc, size_t nNum)
+{
+  const __m128 scale = _mm_set1_ps(255.0f);
+  const __m128i zero = _mm_setzero_si128();
+  size_t i;
+
+  for (i=0; i+16<=nNum; i+=16) {
+    __m128i v = _mm_loadu_si128((const __m128i*)(pSrc+i));
+    __m128i lo = _mm_unpacklo_epi8(v, zero);
+    __m128i hi = _mm_unpackhi_epi8(v, zero);
+
+    _mm_storeu_ps(pDst+i,    _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+    _mm_storeu_ps(pDst+i+4,  _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+    _mm_storeu_ps(pDst+i+8,  _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+    _mm_storeu_ps(pDst+i+12, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+  }
+
+  icScalarUInt8ToFloat(pDst, pSrc, i, nNum);
+}
+
+/**
+ **************************************************************************
+ * Name: icSSE2UInt16BEToFloat
+ * 
+ * Purpose: 
+ *  Converts 8 big-endian 16-bit values at a time using SSE2.  Single
+ *  precision division by 65535 gives the same result as the scalar double
+ *  precision division (checked for all 65536 values).
+ **************************************************************************
+ */
+static void icSSE2UInt16BEToFloat(icFloatNumber *pDst, const icUInt8Number *pSrc, size_t nNum)
+{
+  const __m128 scale = _mm_set1_ps(65535.0f);
+  const __m128i zero = _mm_setzero_si128();
+  size_t i;
+
+  for (i=0; i+8<=nNum; i+=8) {
+    __m128i v = _mm_loadu_si128((const __m128i*)(pSrc+2*i));
+    v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+
+    _mm_storeu_ps(pDst+i,   _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero)), scale));
+    _mm_storeu_ps(pDst+i+4, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(v, zero)), scale));
+  }
+
+  icScalarUInt16BEToFloat(pDst, pSrc, i, nNum);
+}
+
+/**
+ **************************************************************************
+ * Name: icSSE2Swap16Array / icSSE2Swap32Array
+ * 
+ * Purpose: 
+ *  Reverses the byte order of 16 bytes at a time using SSE2.
+ **************************************************************************
+ */
+static void icSSE2Swap16Array(icUInt8Number *pBuf, size_t nNum)
+{
+  size_t i;
+
+  for (i=0; i+8<=nNum; i+=8) {
+    __m128i v = _mm_loadu_si128((const __m128i*)(pBuf+2*i));
+    _mm_storeu_si128((__m128i*)(pBuf+2*i), _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+  }
+
+  icScalarSwap16Array(pBuf, i, nNum);
+}
+
+static void icSSE2Swap32Array(icUInt8Number *pBuf, size_t nNum)
+{
+  size_t i;
+
+  for (i=0; i+4<=nNum; i+=4) {
+    __m128i v = _mm_loadu_si128((const __m128i*)(pBuf+4*i));
+    v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+    v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2,3,0,1)), _MM_SHUFFLE(2,3,0,1));
+    _mm_storeu_si128((__m128i*)(pBuf+4*i), v);
+  }
+
+  icScalarSwap32Array(pBuf, i, nNum);
+}
+
+#endif //ICC_SIMD_X86
+
+#if defined(ICC_SIMD_NEON)
+
+/**
+ **************************************************************************
+ * Name: icNEONUInt8ToFloat
+ * 
+ * Purpose: 
+ *  Converts 16 8-bit values at a time using NEON.
+ **************************************************************************
+ */
+static void icNEONUInt8ToFloat(icFloatNumber *pDst, const icUInt8Number *pSrc, size_t nNum)
+{
+  const float32x4_t scale = vdupq_n_f32(255.0f);
+  size_t i;
+
+  for (i=0; i+16<=nNum; i+=16) {
+    uint8x16_t v = vld1q_u8(pSrc+i);
+    uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+    uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+
+    vst1q_f32(pDst+i,    vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo))), scale));
+    vst1q_f32(pDst+i+4,  vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))), scale));
+    vst1q_f32(pDst+i+8,  vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi))), scale));
+    vst1q_f32(pDst+i+12, vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))), scale));
+  }
+
+  icScalarUInt8ToFloat(pDst, pSrc, i, nNum);
+}
+
+/**
+ **************************************************************************
+ * Name: icNEONUInt16BEToFloat
+ * 
+ * Purpose: 
+ *  Converts 8 big-endian 16-bit values at a time using NEON.
+ **************************************************************************
+ */
+static void icNEONUInt16BEToFloat(icFloatNumber *pDst, const icUInt8Number *pSrc, size_t nNum)
+{
+  const float32x4_t scale = vdupq_n_f32(65535.0f);
+  size_t i;
+
+  for (i=0; i+8<=nNum; i+=8) {
+    uint16x8_t v = vreinterpretq_u16_u8(vrev16q_u8(vld1q_u8(pSrc+2*i)));
+
+    vst1q_f32(pDst+i,   vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(v))), scale));
+    vst1q_f32(pDst+i+4, vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(v))), scale));
+  }
+
+  icScalarUInt16BEToFloat(pDst, pSrc, i, nNum);
+}
+
+/**
+ **************************************************************************
+ * Name: icNEONSwap16Array / icNEONSwap32Array
+ * 
+ * Purpose: 
+ *  Reverses the byte order of 16 bytes at a time using NEON.
+ **************************************************************************
+ */
+static void icNEONSwap16Array(icUInt8Number *pBuf, size_t nNum)
+{
+  size_t i;
+
+  for (i=0; i+8<=nNum; i+=8)
+    vst1q_u8(pBuf+2*i, vrev16q_u8(vld1q_u8(pBuf+2*i)));
+
+  icScalarSwap16Array(pBuf, i, nNum);
+}
+
+static void icNEONSwap32Array(icUInt8Number *pBuf, size_t nNum)
+{
+  size_t i;
+
+  for (i=0; i+4<=nNum; i+=4)
+    vst1q_u8(pBuf+4*i, vrev32q_u8(vld1q_u8(pBuf+4*i)));
+
+  icScalarSwap32Array(pBuf, i, nNum);
+}
+
+#endif //ICC_SIMD_NEON
+
+/**
+ **************************************************************************
+ * Name: icSimdUInt8ToFloat
+ * 
+ * Purpose: 
+ *  Converts 8-bit values to floats in the range 0.0 to 1.0.
+ **************************************************************************
+ */
+void icSimdUInt8ToFloat(icFloatNumber *pDst, const icUInt8Number *pSrc, size_t nNum)
+{
+  switch(icGetSimdLevel()) {
+#if defined(ICC_SIMD_X86)
+    case icSimdAVX2:
+    case icSimdSSE2:
+      icSSE2UInt8ToFloat(pDst, pSrc, nNum);
+      break;
+#endif
+#if defined(ICC_SIMD_NEON)
+    case icSimdNEON:
+      icNEONUInt8ToFloat(pDst, pSrc, nNum);
+      break;
+#endif
+    default:
+      icScalarUInt8ToFloat(pDst, pSrc, 0, nNum);
+      break;
+  }
+}
+
+/**
+ **************************************************************************
+ * Name: icSimdUInt16BEToFloat
+ * 
+ * Purpose: 
+ *  Converts big-endian 16-bit values to floats in the range 0.0 to 1.0.
+ **************************************************************************
+ */
+void icSimdUInt16BEToFloat(icFloatNumber *pDst, const icUInt8Number *pSrc, size_t nNum)
+{
+  switch(icGetSimdLevel()) {
+#if defined(ICC_SIMD_X86)
+    case icSimdAVX2:
+    case icSimdSSE2:
+      icSSE2UInt16BEToFloat(pDst, pSrc, nNum);
+      break;
+#endif
+#if defined(ICC_SIMD_NEON)
+    case icSimdNEON:
+      icNEONUInt16BEToFloat(pDst, pSrc, nNum);
+      break;
+#endif
+    default:
+      icScalarUInt16BEToFloat(pDst, pSrc, 0, nNum);
+      break;
+  }
+}
+
+/**
+ **************************************************************************
+ * Name: icGetFloat16Table
+ * 
+ * Purpose: 
+ *  Returns a table with the icF16toF() value of every half float.  A
+ *  table lookup keeps the NaN and denormal handling of icF16toF(), which
+ *  hardware half float conversions do not.
+ **************************************************************************
+ */
+static const icFloatNumber *icGetFloat16Table()
+{
+  struct CIccFloat16Table {
+    CIccFloat16Table() {
+      for (icUInt32Number i=0; i<65536; i++)
+        v[i] = icF16toF((icFloat16Number)i);
+    }
+    icFloatNumber v[65536];
+  };
+  static CIccFloat16Table table;
+
+  return table.v;
+}
+
+/**
+ **************************************************************************
+ * Name: icSimdFloat16BEToFloat
+ * 
+ * Purpose: 
+ *  Converts big-endian half floats to floats.
+ **************************************************************************
+ */
+void icSimdFloat16BEToFloat(icFloatNumber *pDst, const icUInt8Number *pSrc, size_t nNum)
+{
+  const icFloatNumber *pTable = icGetFloat16Table();
+
+  for (size_t i=0; i<nNum; i++, pSrc+=2)
+    pDst[i] = pTable[(pSrc[0]<<8) | pSrc[1]];
+}
+
+/**
+ **************************************************************************
+ * Name: icSimdSwap16Array
+ * 
+ * Purpose: 
+ *  Reverses the byte order of 16-bit values in place.
+ **************************************************************************
+ */
+void icSimdSwap16Array(void *pBuf, size_t nNum)
+{
+  switch(icGetSimdLevel()) {
+#if defined(ICC_SIMD_X86)
+    case icSimdAVX2:
+    case icSimdSSE2:
+      icSSE2Swap16Array((icUInt8Number*)pBuf, nNum);
+      break;
+#endif
+#if defined(ICC_SIMD_NEON)
+    case icSimdNEON:
+      icNEONSwap16Array((icUInt8Number*)pBuf, nNum);
+      break;
+#endif
+    default:
+      icScalarSwap16Array((icUInt8Number*)pBuf, 0, nNum);
+      break;
+  }
+}
+
+/**
+ **************************************************************************
+ * Name: icSimdSwap32Array
+ * 
+ * Purpose: 
+ *  Reverses the byte order of 32-bit values in place.
+ **************************************************************************
+ */
+void icSimdSwap32Array(void *pBuf, size_t nNum)
+{
+  switch(icGetSimdLevel()) {
+#if defined(ICC_SIMD_X86)
+    case icSimdAVX2:
+    case icSimdSSE2:
+      icSSE2Swap32Array((icUInt8Number*)pBuf, nNum);
+      break;
+#endif
+#if defined(ICC_SIMD_NEON)
+    case icSimdNEON:
+      icNEONSwap32Array((icUInt8Number*)pBuf, nNum);
+      break;
+#endif
+    default:
+      icScalarSwap32Array((icUInt8Number*)pBuf, 0, nNum);
+      break;
+  }
+}
+
+
+#if defined(USEICCDEVNAMESPACE)
+}; //namespace iccDEV
+#endif
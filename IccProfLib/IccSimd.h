@@ -0,0 +1,161 @@
+/** @file
+    File:       IccSimd.h
+
+    Contains:   Header for runtime selected SIMD interpolation kernels
+
+    Version:    V1
+
+    Copyright:  (c) see Software License
+*/
+
+/*
+ * Copyright (c) International Color Consortium.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer. 
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. In the absence of prior written permission, the names "ICC" and "The
+ *    International Color Consortium" must not be used to imply that the
+ *    ICC organization endorses or promotes products derived from this
+ *    software.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE INTERNATIONAL COLOR CONSORTIUM OR
+ * ITS CONTRIBUTING MEMBERS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by many
+ * individuals on behalf of the The International Color Consortium. 
+ *
+ *
+ * Membership in the ICC is encouraged when this software is used for
+ * commercial purposes. 
+ *
+ *  
+ * For more information on The International Color Consortium, please
+ * see <http://www.color.org/>.
+ *  
+ * 
+ */
+
+//////////////////////////////////////////////////////////////////////
+// HISTORY:
+//
+// -Initial implementation of SIMD CLUT kernels 10-17-2026
+//
+//////////////////////////////////////////////////////////////////////
+
+#if !defined(_ICCSIMD_H)
+#define _ICCSIMD_H
+
+#include "IccDefs.h"
+
+#if defined(USEICCDEVNAMESPACE)
+namespace iccDEV {
+#endif
+
+/// Instruction sets that can be used by the SIMD kernels
+typedef enum {
+  icSimdNone  = 0,  //Scalar code only
+  icSimdSSE2  = 1,  //4 output channels at a time (x86-64)
+  icSimdAVX2  = 2,  //8 output channels at a time (x86-64)
+  icSimdNEON  = 3,  //4 output channels at a time (ARM64)
+} icSimdLevel;
+
+/// Returns the instruction set used by the SIMD kernels
+ICCPROFLIB_API icSimdLevel icGetSimdLevel();
+
+/**
+ * Restricts the instruction set used by the SIMD kernels.  Passing icSimdNone
+ * forces the scalar kernels, passing a level that is not supported by the CPU
+ * selects the best supported level.  Intended for testing and benchmarking.
+ */
+ICCPROFLIB_API void icSetSimdLevel(icSimdLevel nLevel);
+
+/// Returns the name of a SIMD level
+ICCPROFLIB_API const icChar *icGetSimdLevelName(icSimdLevel nLevel);
+
+/**
+ * Finds the grid cell and the fractional position within the cell of
+ * nPixels pixels.  Inputs are clipped to 0.0 to 1.0 (NaN to 0.0).  pIndex
+ * receives the data offset of each cell and pFrac receives nInput rows of
+ * nFracStride fractions.
+ */
+ICCPROFLIB_API void icSimdGridCells(icUInt32Number *pIndex, icFloatNumber *pFrac, icUInt32Number nFracStride,
+                                    const icFloatNumber *pSrc, icUInt32Number nSrcStride, icUInt8Number nInput,
+                                    const icUInt8Number *pMaxGrid, const icUInt32Number *pDimSize, icUInt32Number nPixels);
+
+/**
+ * Finds the 2^nInput multilinear corner weights of nPixels pixels from
+ * the fractions found by icSimdGridCells().  Bit d of the corner index
+ * selects the upper grid point of input d and weights are products of the
+ * fractions from the last input to the first, as in CIccCLUT::Interp3d().
+ */
+ICCPROFLIB_API void icSimdGridWeights(icFloatNumber *pWeight, icUInt32Number nWeightStride, const icFloatNumber *pFrac, icUInt32Number nFracStride,
+                                      icUInt8Number nInput, icUInt32Number nPixels);
+
+/**
+ * Multilinear interpolation of nPixels pixels.  For each pixel k and output
+ * channel i the result is the sum over the nCorners grid cell corners j of
+ * pData[pBase[k] + pOffset[j] + i] * pWeight[j*nWeightStride + k],
+ * accumulated in corner order so that results match the scalar CIccCLUT
+ * kernels.
+ */
+ICCPROFLIB_API void icSimdInterpLinear(icFloatNumber *pDst, icUInt32Number nDstStride, const icFloatNumber *pData, icUInt32Number nDataSize,
+                                       icUInt16Number nOutput, const icUInt32Number *pBase, const icUInt32Number *pOffset, icUInt32Number nCorners,
+                                       const icFloatNumber *pWeight, icUInt32Number nWeightStride, icUInt32Number nPixels);
+
+/**
+ * Tetrahedral interpolation of nPixels pixels.  pCorner holds 8 entries
+ * per pixel with the data offsets (p0, a1, a0, b1, b0, c1, c0, unused) and
+ * pFrac holds 4 entries per pixel with the fractions (t, u, v, unused).
+ * Each output channel i is p0 + t*(a1-a0) + u*(b1-b0) + v*(c1-c0)
+ * evaluated from pData + i.
+ */
+ICCPROFLIB_API void icSimdInterpTetra(icFloatNumber *pDst, icUInt32Number nDstStride, const icFloatNumber *pData, icUInt32Number nDataSize,
+                                      icUInt16Number nOutput, const icUInt32Number *pCorner, const icFloatNumber *pFrac, icUInt32Number nPixels);
+
+/**
+ * Array conversion kernels used by CIccIO to decode and encode tag data.
+ * Results match the scalar conversions in CIccIO and icF16toF().
+ */
+
+/// Converts nNum 8-bit values to floats in the range 0.0 to 1.0 (v/255)
+ICCPROFLIB_API void icSimdUInt8ToFloat(icFloatNumber *pDst, const icUInt8Number *pSrc, size_t nNum);
+
+/// Converts nNum big-endian 16-bit values to floats in the range 0.0 to 1.0 (v/65535)
+ICCPROFLIB_API void icSimdUInt16BEToFloat(icFloatNumber *pDst, const icUInt8Number *pSrc, size_t nNum);
+
+/// Converts nNum big-endian half floats to floats
+ICCPROFLIB_API void icSimdFloat16BEToFloat(icFloatNumber *pDst, const icUInt8Number *pSrc, size_t nNum);
+
+/// Reverses the byte order of nNum 16-bit values in place
+ICCPROFLIB_API void icSimdSwap16Array(void *pBuf, size_t nNum);
+
+/// Reverses the byte order of nNum 32-bit values in place
+ICCPROFLIB_API void icSimdSwap32Array(void *pBuf, size_t nNum);
+
+#if defined(USEICCDEVNAMESPACE)
+}; //namespace iccDEV
+#endif
+
+#endif //_ICCSIMD_H
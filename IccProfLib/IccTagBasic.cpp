@@ -82,6 +82,7 @@
 #include "IccTagFactory.h"
 #include "IccConvertUTF.h"
 #include "IccSparseMatrix.h"
+#include "IccNamedColorIndex.h"
 #include "IccCmm.h"
 
 #ifdef ICC_USE_ZLIB
@@ -2733,6 +2734,9 @@ CIccTagNamedColor2::CIccTagNamedColor2(int nSize/*=1*/, int nDeviceCoords/*=0*/)
   m_NamedColor = (SIccNamedColorEntry*)calloc(nSize, m_nColorEntrySize);
 
   m_NamedLab = NULL;
+  m_pLabIndex = NULL;
+  m_pDeviceIndex = NULL;
+  m_pNameIndex = NULL;
 }
 
 
@@ -2763,6 +2767,9 @@ CIccTagNamedColor2::CIccTagNamedColor2(const CIccTagNamedColor2 &ITNC)
   memcpy(m_NamedColor, ITNC.m_NamedColor, m_nColorEntrySize*m_nSize);
 
   m_NamedLab = NULL;
+  m_pLabIndex = NULL;
+  m_pDeviceIndex = NULL;
+  m_pNameIndex = NULL;
 }
 
 
@@ -2797,7 +2804,7 @@ CIccTagNamedColor2 &CIccTagNamedColor2::operator=(const CIccTagNamedColor2 &Name
   m_NamedColor = (SIccNamedColorEntry*)calloc(m_nSize, m_nColorEntrySize);
   memcpy(m_NamedColor, NamedColor2Tag.m_NamedColor, m_nColorEntrySize*m_nSize);
 
-  m_NamedLab = NULL;
+  ResetPCSCache();
 
   return *this;
 }
@@ -2816,8 +2823,7 @@ CIccTagNamedColor2::~CIccTagNamedColor2()
   if (m_NamedColor)
     free(m_NamedColor);
 
-  if (m_NamedLab)
-    delete [] m_NamedLab;
+  ResetPCSCache();
 }
 
 /**
@@ -3142,7 +3148,7 @@ void CIccTagNamedColor2::SetColorSpaces(icColorSpaceSignature csPCS, icColorSpac
 icInt32Number CIccTagNamedColor2::FindRootColor(const icChar *szRootColor) const
 {
   for (icUInt32Number i=0; i<m_nSize; i++) {
-    if (stricmp(m_NamedColor[i].rootName,szRootColor) == 0)
+    if (stricmp(GetEntry(i)->rootName,szRootColor) == 0)
       return i;
   }
 
@@ -3164,13 +3170,28 @@ void CIccTagNamedColor2::ResetPCSCache()
     delete [] m_NamedLab;
     m_NamedLab = NULL;
   }
+  if (m_pLabIndex) {
+    delete m_pLabIndex;
+    m_pLabIndex = NULL;
+  }
+  if (m_pDeviceIndex) {
+    delete m_pDeviceIndex;
+    m_pDeviceIndex = NULL;
+  }
+  if (m_pNameIndex) {
+    delete m_pNameIndex;
+    m_pNameIndex = NULL;
+  }
 }
 
 /**
 ****************************************************************************
 * Name: CIccTagNamedColor2::InitFindPCSColor
 * 
-* Purpose: Initialization needed for using FindPCSColor
+* Purpose: Initialization needed for using FindPCSColor.  Also builds the
+*  indexes used by FindCachedPCSColor, FindColor and FindDeviceColor.  The
+*  indexes are only read by the Find functions so once built they can be
+*  shared by any number of threads.
 * 
 * Return: 
 *  true if successfull, false if failure
@@ -3188,7 +3209,7 @@ bool CIccTagNamedColor2::InitFindCachedPCSColor()
     if (m_csPCS != icSigLabData) {
       for (icUInt32Number i=0; i<m_nSize; i++) {
         pLab = m_NamedLab[i].lab;
-        pXYZ = m_NamedColor[i].pcsCoords;
+        pXYZ = GetEntry(i)->pcsCoords;
         icXyzFromPcs(pXYZ);
         icXYZtoLab(pLab, pXYZ);
       }
@@ -3196,12 +3217,43 @@ bool CIccTagNamedColor2::InitFindCachedPCSColor()
     else {
       for (icUInt32Number i=0; i<m_nSize; i++) {
         pLab = m_NamedLab[i].lab;
-        Lab2ToLab4(pLab, m_NamedColor[i].pcsCoords);
+        Lab2ToLab4(pLab, GetEntry(i)->pcsCoords);
         icLabFromPcs(pLab);
       }
     }
   }
 
+  //Find functions fall back to linear searches if an index cannot be built
+  if (!m_pLabIndex) {
+    m_pLabIndex = new CIccKdTree();
+    if (!m_pLabIndex->Build(3, m_nSize, m_NamedLab[0].lab)) {
+      delete m_pLabIndex;
+      m_pLabIndex = NULL;
+    }
+  }
+
+  if (!m_pDeviceIndex && m_nDeviceCoords) {
+    icFloatNumber *pDevice = (icFloatNumber*)malloc((size_t)m_nSize*m_nDeviceCoords*sizeof(icFloatNumber));
+
+    if (pDevice) {
+      for (icUInt32Number i=0; i<m_nSize; i++)
+        memcpy(pDevice + (size_t)i*m_nDeviceCoords, GetEntry(i)->deviceCoords, m_nDeviceCoords*sizeof(icFloatNumber));
+
+      m_pDeviceIndex = new CIccKdTree();
+      if (!m_pDeviceIndex->Build(m_nDeviceCoords, m_nSize, pDevice)) {
+        delete m_pDeviceIndex;
+        m_pDeviceIndex = NULL;
+      }
+      free(pDevice);
+    }
+  }
+
+  if (!m_pNameIndex) {
+    m_pNameIndex = new CIccNameIndex();
+    for (icUInt32Number i=0; i<m_nSize; i++)
+      m_pNameIndex->Add(GetEntry(i)->rootName, i);
+  }
+
   return true;
 }
 
@@ -3238,6 +3290,15 @@ icInt32Number CIccTagNamedColor2::FindCachedPCSColor(icFloatNumber *pPCS, icFloa
   if (!m_NamedLab)
     return -1;
 
+  if (m_pLabIndex) {
+    //Entry 0 is returned unless an entry is found within dMinDE
+    leastDEindex = m_pLabIndex->FindNearest(pLabIn, &dLeastDE);
+    if (leastDEindex<0 || !(dLeastDE<dMinDE))
+      leastDEindex = 0;
+
+    return leastDEindex;
+  }
+
   for (icUInt32Number i=0; i<m_nSize; i++) {
     pLab = m_NamedLab[i].lab;
 
@@ -3308,14 +3369,22 @@ icInt32Number CIccTagNamedColor2::FindColor(const icChar *szColor) const
   j = (icInt32Number)strlen(m_szSufix);
   i = (icInt32Number)strlen(szColor);
   if (j != 0) {
-    if (strncmp(szColor+(i-j), m_szSufix, j))
+    if (i<j || strncmp(szColor+(i-j), m_szSufix, j))
       return -1;    
   }
 
+  if (m_pNameIndex) {
+    icInt32Number nPrefix = (icInt32Number)strlen(m_szPrefix);
+
+    if (i < nPrefix + j)
+      return -1;
+
+    return m_pNameIndex->Find(std::string(szColor + nPrefix, i - nPrefix - j));
+  }
 
   for ( i=0; i<(icInt32Number)m_nSize; i++) {
     sColorName = m_szPrefix;
-    sColorName += m_NamedColor[i].rootName;
+    sColorName += GetEntry(i)->rootName;
     sColorName += m_szSufix;
 
     if (strcmp(sColorName.c_str(),szColor) == 0)
@@ -3347,9 +3416,13 @@ icInt32Number CIccTagNamedColor2::FindDeviceColor(icFloatNumber *pDevColor) cons
   icFloatNumber *pDevOut;
   icInt32Number leastDiffindex = -1;
 
+  if (m_pDeviceIndex) {
+    leastDiffindex = m_pDeviceIndex->FindNearest(pDevColor);
+    return leastDiffindex<0 ? 0 : leastDiffindex;
+  }
 
   for (icUInt32Number i=0; i<m_nSize; i++) {
-    pDevOut = m_NamedColor[i].deviceCoords;
+    pDevOut = GetEntry(i)->deviceCoords;
 
     for (icUInt32Number j=0; j<m_nDeviceCoords; j++) {
       dCalcDiff += (pDevColor[j]-pDevOut[j])*(pDevColor[j]-pDevOut[j]);
@@ -81,6 +81,8 @@ class CIccIO;
 class ICCPROFLIB_API CIccProfile;
 
 class CIccSparseMatrix;
+class CIccKdTree;
+class CIccNameIndex;
 
 class IIccExtensionTag
 {
@@ -609,6 +611,7 @@ public:
   icInt32Number FindDeviceColor(icFloatNumber *pDevColor) const;
   icInt32Number FindPCSColor(icFloatNumber *pPCS, icFloatNumber dMinDE=1000.0);
 
+  ///Builds the Lab cache and the name, Lab and device indexes used by the Find functions
   bool InitFindCachedPCSColor();
   //FindPCSColor returns the zero based index of the color or -1 to indicate that the color was not found.
   //InitFindPCSColor must be called before FindPCSColor
@@ -643,6 +646,9 @@ protected:
   
   SIccNamedColorEntry *m_NamedColor;
   SIccNamedLabEntry *m_NamedLab; ///For quick response of repeated FindPCSColor
+  CIccKdTree *m_pLabIndex;       ///Nearest m_NamedLab entry search
+  CIccKdTree *m_pDeviceIndex;    ///Nearest device coordinate search
+  CIccNameIndex *m_pNameIndex;   ///Root name lookup
   icUInt32Number m_nColorEntrySize;
 
   icUInt32Number m_nVendorFlags;
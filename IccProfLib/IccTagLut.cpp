@@ -82,6 +82,7 @@
 #include "IccUtil.h"
 #include "IccProfile.h"
 #include "IccMpeBasic.h"
+#include "IccSimd.h"
 
 #ifdef USEICCDEVNAMESPACE
 namespace iccDEV {
@@ -1709,6 +1710,7 @@ CIccCLUT::CIccCLUT(icUInt8Number nInputChannels, icUInt16Number nOutputChannels,
   m_nOutput = nOutputChannels;
   m_nPrecision = nPrecision;
   m_pData = NULL;
+  m_bOwnData = true;
   m_nOffset = NULL;
   m_pOutText = NULL;
   m_pVal = NULL;
@@ -1751,6 +1753,7 @@ CIccCLUT::CIccCLUT(const CIccCLUT &ICLUT)
 
   int num = NumPoints()*m_nOutput;
   m_pData = new icFloatNumber[num];
+  m_bOwnData = true;
   memcpy(m_pData, ICLUT.m_pData, num*sizeof(icFloatNumber));
 
   UnitClip = ICLUT.UnitClip;
@@ -1786,10 +1789,11 @@ CIccCLUT &CIccCLUT::operator=(const CIccCLUT &CLUTTag)
   memcpy(m_nReserved2, &CLUTTag.m_nReserved2, sizeof(m_nReserved2));
 
   int num;
-  if (m_pData)
+  if (m_pData && m_bOwnData)
     delete [] m_pData;
   num = NumPoints()*m_nOutput;
   m_pData = new icFloatNumber[num];
+  m_bOwnData = true;
   memcpy(m_pData, CLUTTag.m_pData, num*sizeof(icFloatNumber));
 
   UnitClip = CLUTTag.UnitClip;
@@ -1809,7 +1813,7 @@ CIccCLUT &CIccCLUT::operator=(const CIccCLUT &CLUTTag)
  */
 CIccCLUT::~CIccCLUT()
 {
-  if (m_pData)
+  if (m_pData && m_bOwnData)
     delete [] m_pData;
 
   if (m_nOffset)
@@ -1848,6 +1852,58 @@ bool CIccCLUT::Init(icUInt8Number nGridPoints, icUInt32Number nMaxSize, icUInt8N
  *****************************************************************************
  */
 bool CIccCLUT::Init(const icUInt8Number *pGridPoints, icUInt32Number nMaxSize, icUInt8Number nBytesPerPoint)
+{
+  if (!InitSize(pGridPoints, nMaxSize, nBytesPerPoint))
+    return false;
+
+  icUInt32Number nSize = NumPoints() * m_nOutput;
+
+  if (!nSize)
+    return false;
+
+  m_pData = new icFloatNumber[nSize];
+  m_bOwnData = true;
+
+  return (m_pData != NULL);
+}
+
+
+/**
+ ****************************************************************************
+ * Name: CIccCLUT::AttachData
+ * 
+ * Purpose: Sets the size of the CLUT and uses grid data that is owned by
+ *  the caller (such as a memory mapped file) without copying it.  The data
+ *  must remain valid and unchanged for the life of the CLUT.
+ * 
+ * Args:
+ *  pGridPoints = number of grid points in the CLUT
+ *  pData = NumPoints()*GetOutputChannels() grid values
+ *****************************************************************************
+ */
+bool CIccCLUT::AttachData(const icUInt8Number *pGridPoints, icFloatNumber *pData)
+{
+  if (!pData || !InitSize(pGridPoints, 0, 4))
+    return false;
+
+  m_pData = pData;
+  m_bOwnData = false;
+
+  return true;
+}
+
+
+/**
+ ****************************************************************************
+ * Name: CIccCLUT::InitSize
+ * 
+ * Purpose: Sets the size of the CLUT and releases any grid data
+ * 
+ * Args:
+ *  pGridPoints = number of grid points in the CLUT
+ *****************************************************************************
+ */
+bool CIccCLUT::InitSize(const icUInt8Number *pGridPoints, icUInt32Number nMaxSize, icUInt8Number nBytesPerPoint)
 {
   if (nMaxSize && !nBytesPerPoint)
     return false;
@@ -1874,7 +1930,8 @@ bool CIccCLUT::Init(const icUInt8Number *pGridPoints, icUInt32Number nMaxSize, i
   }
 
   if (m_pData) {
-    delete [] m_pData;
+    if (m_bOwnData)
+      delete [] m_pData;
     m_pData = NULL;
   }
 
@@ -1894,14 +1951,10 @@ bool CIccCLUT::Init(const icUInt8Number *pGridPoints, icUInt32Number nMaxSize, i
   }
   m_nNumPoints = (icUInt32Number)nNumPoints;
 
-  icUInt32Number nSize = NumPoints() * m_nOutput;
-
-  if (!nSize)
+  if (!NumPoints())
     return false;
 
-  m_pData = new icFloatNumber[nSize];
-
-  return (m_pData != NULL);
+  return true;
 }
 
 
@@ -3132,6 +3185,151 @@ void CIccCLUT::InterpND(icFloatNumber *destPixel, const icFloatNumber *srcPixel,
 }
 
 
+/**
+ ******************************************************************************
+ * Name: CIccCLUT::InterpN
+ * 
+ * Purpose: Interpolates a span of pixels.  Grid cells and corner weights
+ *  are found for blocks of icCLUTBlockPixels pixels which are then
+ *  interpolated by the SIMD kernel selected for the CPU (see IccSimd.h).
+ *  Results match the single pixel functions.  CLUTs with more than 6
+ *  inputs, or when SIMD is disabled, use the single pixel functions.
+ *
+ * Args:
+ *  destPixels = destination pixels,
+ *  srcPixels = source pixels, may be the same as destPixels only if
+ *   nDstStride is the same as nSrcStride,
+ *  nPixels = number of pixels,
+ *  nDstStride = number of samples between destination pixels,
+ *  nSrcStride = number of samples between source pixels,
+ *  bTetra = use tetrahedral rather than trilinear interpolation for 3 input CLUTs,
+ *  pApply = apply object used by InterpND for CLUTs with more than 6 inputs.
+ *******************************************************************************
+ */
+void CIccCLUT::InterpN(icFloatNumber *destPixels, const icFloatNumber *srcPixels, icUInt32Number nPixels,
+                       icUInt32Number nDstStride, icUInt32Number nSrcStride, bool bTetra/*=true*/, CIccApplyCLUT *pApply/*=NULL*/) const
+{
+  icUInt32Number k, d, j;
+
+  if (m_nInput>6 || icGetSimdLevel()==icSimdNone) {
+    for (k=0; k<nPixels; k++, destPixels+=nDstStride, srcPixels+=nSrcStride) {
+      switch(m_nInput) {
+        case 1:
+          Interp1d(destPixels, srcPixels);
+          break;
+        case 2:
+          Interp2d(destPixels, srcPixels);
+          break;
+        case 3:
+          if (bTetra)
+            Interp3dTetra(destPixels, srcPixels);
+          else
+            Interp3d(destPixels, srcPixels);
+          break;
+        case 4:
+          Interp4d(destPixels, srcPixels);
+          break;
+        case 5:
+          Interp5d(destPixels, srcPixels);
+          break;
+        case 6:
+          Interp6d(destPixels, srcPixels);
+          break;
+        default:
+          InterpND(destPixels, srcPixels, pApply);
+          break;
+      }
+    }
+    return;
+  }
+
+  bool bUseTetra = bTetra && m_nInput==3;
+  icUInt32Number nCorners = (icUInt32Number)1 << m_nInput;
+  icUInt32Number nDataSize = m_nNumPoints * m_nOutput;
+  icUInt32Number nIndex[icCLUTBlockPixels];
+  icUInt32Number nCorner[8*icCLUTBlockPixels];
+  icFloatNumber dS[6*icCLUTBlockPixels];
+  icFloatNumber dF[64*icCLUTBlockPixels];
+
+  //Corner offsets (a1, a0, b1, b0, c1, c0) of the six tetrahedra in the order used by Interp3dTetra
+  const icUInt32Number nTetra[6][6] = {
+    { n110, n010, n010, n000, n111, n110 },
+    { n111, n011, n011, n001, n001, n000 },
+    { n111, n011, n010, n000, n011, n010 },
+    { n101, n001, n111, n101, n001, n000 },
+    { n100, n000, n111, n101, n101, n100 },
+    { n100, n000, n110, n100, n111, n110 },
+  };
+
+  while (nPixels) {
+    icUInt32Number nBlock = nPixels < icCLUTBlockPixels ? nPixels : icCLUTBlockPixels;
+
+    if (UnitClip==ClutUnitClip) {
+      icSimdGridCells(nIndex, dS, icCLUTBlockPixels, srcPixels, nSrcStride, m_nInput, m_MaxGridPoint, m_DimSize, nBlock);
+    }
+    else {
+      const icFloatNumber *src = srcPixels;
+
+      for (k=0; k<nBlock; k++, src+=nSrcStride) {
+        icUInt32Number index = 0;
+
+        for (d=0; d<m_nInput; d++) {
+          icUInt8Number m = m_MaxGridPoint[d];
+          icFloatNumber g = UnitClip(src[d]) * m;
+
+          if (g<0.0f)
+            g = 0.0f;
+
+          icUInt32Number ig = (icUInt32Number)g;
+          icFloatNumber s = g - ig;
+
+          if (ig>=m) {
+            ig = m-1;
+            s = 1.0f;
+          }
+          dS[d*icCLUTBlockPixels + k] = s;
+          index += ig*m_DimSize[d];
+        }
+        nIndex[k] = index;
+      }
+    }
+
+    if (bUseTetra) {
+      for (k=0; k<nBlock; k++) {
+        icUInt32Number *pCorner = &nCorner[k*8];
+        icFloatNumber *pFrac = &dF[k*4];
+        icFloatNumber v = dS[k], u = dS[icCLUTBlockPixels + k], t = dS[2*icCLUTBlockPixels + k];
+        icUInt32Number index = nIndex[k];
+        int nCase;
+
+        if (t<u)
+          nCase = t>v ? 0 : (u<v ? 1 : 2);
+        else
+          nCase = t<v ? 3 : (u<v ? 4 : 5);
+
+        pCorner[0] = index;
+        for (j=0; j<6; j++)
+          pCorner[j+1] = index + nTetra[nCase][j];
+
+        pFrac[0] = t;
+        pFrac[1] = u;
+        pFrac[2] = v;
+      }
+
+      icSimdInterpTetra(destPixels, nDstStride, m_pData, nDataSize, m_nOutput, nCorner, dF, nBlock);
+    }
+    else {
+      icSimdGridWeights(dF, icCLUTBlockPixels, dS, icCLUTBlockPixels, m_nInput, nBlock);
+      icSimdInterpLinear(destPixels, nDstStride, m_pData, nDataSize, m_nOutput, nIndex, m_nOffset, nCorners, dF, icCLUTBlockPixels, nBlock);
+    }
+
+    nPixels -= nBlock;
+    destPixels += nBlock*nDstStride;
+    srcPixels += nBlock*nSrcStride;
+  }
+}
+
+
 /**
 ******************************************************************************
 * Name: CIccCLUT::Validate
@@ -3179,6 +3377,359 @@ icValidateStatus CIccCLUT::Validate(std::string sigPath, std::string &sReport, c
 }
 
 
+/**
+ ****************************************************************************
+ * Name: CIccCLUTFixed::CIccCLUTFixed
+ * 
+ * Purpose: Constructor
+ * 
+ *****************************************************************************
+ */
+CIccCLUTFixed::CIccCLUTFixed()
+{
+  m_nInput = 0;
+  m_nOutput = 0;
+  m_nInputBits = 0;
+
+  m_pData = NULL;
+  m_pIndex = NULL;
+  m_pFrac = NULL;
+
+  memset(m_nOffset, 0, sizeof(m_nOffset));
+  n001 = n010 = n011 = n100 = n101 = n110 = n111 = 0;
+}
+
+
+/**
+ ****************************************************************************
+ * Name: CIccCLUTFixed::~CIccCLUTFixed
+ * 
+ * Purpose: Destructor
+ * 
+ *****************************************************************************
+ */
+CIccCLUTFixed::~CIccCLUTFixed()
+{
+  Cleanup();
+}
+
+
+/**
+ ****************************************************************************
+ * Name: CIccCLUTFixed::Cleanup
+ * 
+ * Purpose: Frees the tables
+ * 
+ *****************************************************************************
+ */
+void CIccCLUTFixed::Cleanup()
+{
+  if (m_pData)
+    free(m_pData);
+  if (m_pIndex)
+    free(m_pIndex);
+  if (m_pFrac)
+    free(m_pFrac);
+
+  m_pData = NULL;
+  m_pIndex = NULL;
+  m_pFrac = NULL;
+  m_nInput = 0;
+  m_nOutput = 0;
+  m_nInputBits = 0;
+}
+
+
+/**
+ ****************************************************************************
+ * Name: CIccCLUTFixed::Init
+ * 
+ * Purpose: Builds the fixed point grid and tables from a CLUT
+ * 
+ * Args:
+ *  pCLUT = CLUT with 3 or 4 inputs to convert,
+ *  nInputBits = number of bits of the input codes (8 or 16),
+ *  pInputCurves = optional curves applied to each input before the CLUT.
+ *
+ * Return:
+ *  true if successful, false if the CLUT is not supported or allocation failed
+ *****************************************************************************
+ */
+bool CIccCLUTFixed::Init(const CIccCLUT *pCLUT, icUInt8Number nInputBits, const LPIccCurve *pInputCurves/*=NULL*/)
+{
+  Cleanup();
+
+  if (!pCLUT || (nInputBits!=8 && nInputBits!=16))
+    return false;
+
+  icUInt8Number nInput = pCLUT->GetInputDim();
+  icUInt16Number nOutput = pCLUT->GetOutputChannels();
+
+  if ((nInput!=3 && nInput!=4) || !nOutput || nOutput>16 || !pCLUT->NumPoints())
+    return false;
+
+  icUInt32Number i, c, n;
+  icUInt32Number nCodes = (icUInt32Number)1<<nInputBits;
+  size_t nData = (size_t)pCLUT->NumPoints() * nOutput;
+
+  m_pData = (icInt32Number*)malloc(nData * sizeof(icInt32Number));
+  m_pIndex = (icUInt32Number*)malloc((size_t)nInput * nCodes * sizeof(icUInt32Number));
+  m_pFrac = (icUInt32Number*)malloc((size_t)nInput * nCodes * sizeof(icUInt32Number));
+
+  if (!m_pData || !m_pIndex || !m_pFrac) {
+    Cleanup();
+    return false;
+  }
+
+  m_nInput = nInput;
+  m_nOutput = nOutput;
+  m_nInputBits = nInputBits;
+
+  //Grid values outside of 0.0 to 1.0 are kept so that results match the float path.
+  //Clipping larger values would change results so such CLUTs are left to the float path.
+  const icFloatNumber *pData = const_cast<CIccCLUT*>(pCLUT)->GetData(0);
+  for (n=0; n<nData; n++) {
+    icFloatNumber v = pData[n];
+
+    if (!(v >= -icFixedGridLimit && v <= icFixedGridLimit)) { //Also rejects NaN
+      Cleanup();
+      return false;
+    }
+
+    m_pData[n] = (icInt32Number)floor(v * 65535.0f + 0.5f);
+  }
+
+  icFloatNumber fScale = 1.0f / (icFloatNumber)(nCodes-1);
+
+  for (i=0; i<nInput; i++) {
+    icUInt32Number nMax = pCLUT->GridPoint(i) - 1;
+
+    if (!nMax) {
+      Cleanup();
+      return false;
+    }
+
+    icUInt32Number nStride = pCLUT->GetDimSize((icUInt8Number)i);
+    icUInt32Number *pIndex = m_pIndex + i*nCodes;
+    icUInt32Number *pFrac = m_pFrac + i*nCodes;
+
+    for (c=0; c<nCodes; c++) {
+      icFloatNumber x = (icFloatNumber)c * fScale;
+
+      if (pInputCurves)
+        x = pInputCurves[i]->Apply(x);
+
+      x = ClutUnitClip(x) * nMax;
+
+      icUInt32Number ix = (icUInt32Number)x;
+      icFloatNumber f = x - ix;
+
+      if (ix==nMax) {
+        ix--;
+        f = 1.0f;
+      }
+
+      pIndex[c] = ix * nStride;
+      pFrac[c] = (icUInt32Number)(f * icFixedFracOne + 0.5f);
+    }
+  }
+
+  //Offsets of the corners of a grid cell
+  for (n=0; n<16; n++) {
+    m_nOffset[n] = 0;
+    for (i=0; i<nInput; i++) {
+      if (n & (1<<i))
+        m_nOffset[n] += pCLUT->GetDimSize((icUInt8Number)i);
+    }
+  }
+
+  n001 = m_nOffset[1];
+  n010 = m_nOffset[2];
+  n011 = m_nOffset[3];
+  n100 = m_nOffset[4];
+  n101 = m_nOffset[5];
+  n110 = m_nOffset[6];
+  n111 = m_nOffset[7];
+
+  return true;
+}
+
+
+/**
+ ****************************************************************************
+ * Name: icFixedClip
+ * 
+ * Purpose: Clips a fixed point interpolation result to a 16 bit value
+ *****************************************************************************
+ */
+static inline icUInt16Number icFixedClip(icInt32Number v)
+{
+  return (icUInt16Number)(v < 0 ? 0 : (v > 65535 ? 65535 : v));
+}
+
+
+/**
+ ****************************************************************************
+ * Name: icFixedTetra
+ * 
+ * Purpose: Interpolates all outputs within the tetrahedron of a grid cell
+ *  selected by the fractions (v, u, t) using fixed point math.
+ *
+ * Args:
+ *  pOut = 16 bit results,
+ *  p = first grid value of the cell,
+ *  nOutput = number of outputs,
+ *  v, u, t = fractions of the first, second and third tetrahedral inputs,
+ *  n001 ... n111 = offsets of the cell corners.
+ *****************************************************************************
+ */
+static inline void icFixedTetra(icInt32Number *pOut, const icInt32Number *p, icUInt16Number nOutput,
+                                icInt32Number v, icInt32Number u, icInt32Number t,
+                                icUInt32Number n001, icUInt32Number n010, icUInt32Number n011, icUInt32Number n100,
+                                icUInt32Number n101, icUInt32Number n110, icUInt32Number n111)
+{
+  icUInt32Number c1, c2;
+  icInt64Number f1, f2, f3;
+
+  //Order fractions from largest to smallest with path of corners through the cell
+  if (t<u) {
+    if (t>v) {
+      c1 = n010; c2 = n110; f1 = u; f2 = t; f3 = v;
+    }
+    else if (u<v) {
+      c1 = n001; c2 = n011; f1 = v; f2 = u; f3 = t;
+    }
+    else {
+      c1 = n010; c2 = n011; f1 = u; f2 = v; f3 = t;
+    }
+  }
+  else {
+    if (t<v) {
+      c1 = n001; c2 = n101; f1 = v; f2 = t; f3 = u;
+    }
+    else if (u<v) {
+      c1 = n100; c2 = n101; f1 = t; f2 = v; f3 = u;
+    }
+    else {
+      c1 = n100; c2 = n110; f1 = t; f2 = u; f3 = v;
+    }
+  }
+
+  for (icUInt16Number i=0; i<nOutput; i++, p++) {
+    icInt32Number p0 = p[0], p1 = p[c1], p2 = p[c2], p3 = p[n111];
+
+    pOut[i] = p0 + (icInt32Number)((f1*(p1-p0) + f2*(p2-p1) + f3*(p3-p2) + (icFixedFracOne>>1)) >> icFixedFracBits);
+  }
+}
+
+
+/**
+ ****************************************************************************
+ * Name: CIccCLUTFixed::Interp3dTetra
+ * 
+ * Purpose: Fixed point tetrahedral interpolation of 3 input CLUTs
+ *
+ * Args:
+ *  pDst = nPixels*GetOutputChannels() 16 bit results,
+ *  pSrc = nPixels*3 input codes,
+ *  nPixels = number of pixels to interpolate.
+ *****************************************************************************
+ */
+void CIccCLUTFixed::Interp3dTetra(icUInt16Number *pDst, const icUInt16Number *pSrc, icUInt32Number nPixels) const
+{
+  icUInt32Number nCodes = (icUInt32Number)1<<m_nInputBits;
+  const icUInt32Number *pIndex0 = m_pIndex, *pIndex1 = pIndex0 + nCodes, *pIndex2 = pIndex1 + nCodes;
+  const icUInt32Number *pFrac0 = m_pFrac, *pFrac1 = pFrac0 + nCodes, *pFrac2 = pFrac1 + nCodes;
+  icInt32Number Out[16];
+  icUInt16Number i;
+
+  for (icUInt32Number k=0; k<nPixels; k++, pSrc+=3, pDst+=m_nOutput) {
+    icUInt32Number x = pSrc[0], y = pSrc[1], z = pSrc[2];
+
+    icFixedTetra(Out, m_pData + pIndex0[x] + pIndex1[y] + pIndex2[z], m_nOutput,
+                 pFrac0[x], pFrac1[y], pFrac2[z], n001, n010, n011, n100, n101, n110, n111);
+
+    for (i=0; i<m_nOutput; i++)
+      pDst[i] = icFixedClip(Out[i]);
+  }
+}
+
+
+/**
+ ****************************************************************************
+ * Name: CIccCLUTFixed::Interp4d
+ * 
+ * Purpose: Fixed point quadrilinear interpolation of 4 input CLUTs using
+ *  corner weights that are computed once per pixel.
+ *
+ * Args:
+ *  pDst = nPixels*GetOutputChannels() 16 bit results,
+ *  pSrc = nPixels*4 input codes,
+ *  nPixels = number of pixels to interpolate.
+ *****************************************************************************
+ */
+void CIccCLUTFixed::Interp4d(icUInt16Number *pDst, const icUInt16Number *pSrc, icUInt32Number nPixels) const
+{
+  icUInt32Number nCodes = (icUInt32Number)1<<m_nInputBits;
+  const icUInt32Number *pIndex0 = m_pIndex, *pIndex1 = pIndex0 + nCodes, *pIndex2 = pIndex1 + nCodes, *pIndex3 = pIndex2 + nCodes;
+  const icUInt32Number *pFrac0 = m_pFrac, *pFrac1 = pFrac0 + nCodes, *pFrac2 = pFrac1 + nCodes, *pFrac3 = pFrac2 + nCodes;
+  icInt64Number dF[16], dA[4], dB[4];
+  icUInt16Number i;
+  int j;
+
+  for (icUInt32Number m=0; m<nPixels; m++, pSrc+=4, pDst+=m_nOutput) {
+    icUInt32Number w = pSrc[0], x = pSrc[1], y = pSrc[2], z = pSrc[3];
+    const icInt32Number *p = m_pData + pIndex0[w] + pIndex1[x] + pIndex2[y] + pIndex3[z];
+
+    icInt64Number v = pFrac0[w], u = pFrac1[x], t = pFrac2[y], s = pFrac3[z];
+    icInt64Number nv = icFixedFracOne - v, nu = icFixedFracOne - u, nt = icFixedFracOne - t, ns = icFixedFracOne - s;
+
+    //Weights of input pairs reduced to icFixedWeightBits so that their products fit in 64 bits
+    dA[0] = nu*nv; dA[1] = nu*v; dA[2] = u*nv; dA[3] = u*v;
+    dB[0] = ns*nt; dB[1] = ns*t; dB[2] = s*nt; dB[3] = s*t;
+
+    for (j=0; j<4; j++) {
+      dA[j] = (dA[j] + ((icInt64Number)1<<(2*icFixedFracBits-icFixedWeightBits-1))) >> (2*icFixedFracBits-icFixedWeightBits);
+      dB[j] = (dB[j] + ((icInt64Number)1<<(2*icFixedFracBits-icFixedWeightBits-1))) >> (2*icFixedFracBits-icFixedWeightBits);
+    }
+
+    //Corner weights with icFixedWeightBits bits of precision (bit k of corner index selects upper point of input k)
+    for (j=0; j<16; j++)
+      dF[j] = (dA[j&3] * dB[j>>2] + ((icInt64Number)1<<(icFixedWeightBits-1))) >> icFixedWeightBits;
+
+    for (i=0; i<m_nOutput; i++, p++) {
+      icInt64Number pv = 0;
+
+      for (j=0; j<16; j++)
+        pv += dF[j] * p[m_nOffset[j]];
+
+      pDst[i] = icFixedClip((icInt32Number)((pv + ((icInt64Number)1<<(icFixedWeightBits-1))) >> icFixedWeightBits));
+    }
+  }
+}
+
+
+/**
+ ****************************************************************************
+ * Name: CIccCLUTFixed::Interp
+ * 
+ * Purpose: Interpolates pixels of input codes (0 to 2^GetInputBits()-1)
+ *
+ * Args:
+ *  pDst = nPixels*GetOutputChannels() 16 bit results,
+ *  pSrc = nPixels*GetInputChannels() input codes,
+ *  nPixels = number of pixels to interpolate.
+ *****************************************************************************
+ */
+void CIccCLUTFixed::Interp(icUInt16Number *pDst, const icUInt16Number *pSrc, icUInt32Number nPixels) const
+{
+  if (m_nInput==3)
+    Interp3dTetra(pDst, pSrc, nPixels);
+  else if (m_nInput==4)
+    Interp4d(pDst, pSrc, nPixels);
+}
+
+
 /**
  ****************************************************************************
  * Name: CIccMBB::CIccMBB
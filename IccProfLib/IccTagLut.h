@@ -311,6 +311,9 @@ protected:
 };
 
 
+/// Number of pixels whose grid cells are found before running the CIccCLUT::InterpN() kernels
+#define icCLUTBlockPixels 64
+
 /**
 ****************************************************************************
 * Class: CIccCLUT
@@ -328,6 +331,8 @@ public:
 
   bool Init(icUInt8Number nGridPoints, icUInt32Number nMaxSize = 0, icUInt8Number nBytesPerPoint = 4);
   bool Init(const icUInt8Number *pGridPoints, icUInt32Number nMaxSize=0, icUInt8Number nBytesPerPoint=4);
+  ///Uses grid data owned by the caller (NumPoints()*GetOutputChannels() values) that must not change while in use
+  bool AttachData(const icUInt8Number *pGridPoints, icFloatNumber *pData);
 
   bool ReadData(icUInt32Number size, CIccIO *pIO, icUInt8Number nPrecision);
   bool WriteData(CIccIO *pIO, icUInt8Number nPrecision);
@@ -369,6 +374,9 @@ public:
   void Interp6d(icFloatNumber *destPixel, const icFloatNumber *srcPixel) const;
   void InterpND(icFloatNumber *destPixel, const icFloatNumber *srcPixel, CIccApplyCLUT *pApply) const;
 
+  void InterpN(icFloatNumber *destPixels, const icFloatNumber *srcPixels, icUInt32Number nPixels,
+               icUInt32Number nDstStride, icUInt32Number nSrcStride, bool bTetra=true, CIccApplyCLUT *pApply=NULL) const;
+
   void Iterate(IIccCLUTExec* pExec);
   icValidateStatus Validate(std::string sigPath, std::string &sReport, const CIccProfile* pProfile=NULL)  const;
 
@@ -378,6 +386,8 @@ public:
   void SetPrecision(icUInt8Number nPrecision) { m_nPrecision = nPrecision; }
 
 protected:
+  bool InitSize(const icUInt8Number *pGridPoints, icUInt32Number nMaxSize, icUInt8Number nBytesPerPoint);
+
   void Iterate(std::string &sDescription, icUInt8Number nIndex, icUInt32Number nPos, size_t bufSize, bool bUseLegacy=false );
   void SubIterate(IIccCLUTExec* pExec, icUInt8Number nIndex, icUInt32Number nPos);
 
@@ -394,6 +404,7 @@ protected:
 
   icUInt32Number m_DimSize[16];
   icFloatNumber *m_pData;
+  bool m_bOwnData;
 
   //Iteration temporary variables
   icUInt8Number m_GridAdr[16];
@@ -412,6 +423,75 @@ protected:
 
 
 
+/// Number of fraction bits used by CIccCLUTFixed interpolation
+#define icFixedFracBits 20
+#define icFixedFracOne  (1<<icFixedFracBits)
+/// Number of fraction bits of the corner weights of 4 input CIccCLUTFixed interpolation
+#define icFixedWeightBits 30
+/// CIccCLUTFixed can only be used for CLUTs with grid values within +/- icFixedGridLimit
+#define icFixedGridLimit 8.0f
+/// Largest difference in 8 or 16 bit output code values between CIccCLUTFixed and the float path
+#define icFixedMaxCodeDiff 1
+
+/**
+****************************************************************************
+* Class: CIccCLUTFixed
+* 
+* Purpose: Fixed point interpolation engine for 3 and 4 input CLUTs applied
+*  to 8 or 16 bit integer samples.  Grid values are scaled by 65535 and kept
+*  as signed 32 bit values so that tables with values outside of 0.0 to 1.0
+*  interpolate the same as the float path.  Init() fails for tables with
+*  values beyond +/- icFixedGridLimit.
+*  Each input channel gets a table that maps input codes (through optional
+*  input curves) to grid offsets and icFixedFracBits fractions.  Output
+*  curves are not supported since steep curves would amplify the rounding
+*  of the 16 bit interpolation results.  3 input CLUTs use tetrahedral
+*  interpolation and 4 input CLUTs use quadrilinear interpolation to match
+*  CIccCLUT::Interp3dTetra and CIccCLUT::Interp4d.  Results are 16 bit
+*  values (0 to 65535).
+*
+*  Measured against the float path with results rounded to the output
+*  sample size, the maximum difference for profile and collapsed link
+*  CLUTs is icFixedMaxCodeDiff code values for both 8 and 16 bit outputs
+*  (checked by Testing/LibTests/iccFixedInterpTest).
+*****************************************************************************
+*/
+class ICCPROFLIB_API CIccCLUTFixed
+{
+public:
+  CIccCLUTFixed();
+  virtual ~CIccCLUTFixed();
+
+  bool Init(const CIccCLUT *pCLUT, icUInt8Number nInputBits, const LPIccCurve *pInputCurves=NULL);
+
+  icUInt8Number GetInputBits() const { return m_nInputBits; }
+  icUInt8Number GetInputChannels() const { return m_nInput; }
+  icUInt16Number GetOutputChannels() const { return m_nOutput; }
+
+  ///Interpolates nPixels pixels of pixel interleaved input codes to 16 bit pixel interleaved results
+  void Interp(icUInt16Number *pDst, const icUInt16Number *pSrc, icUInt32Number nPixels) const;
+
+protected:
+  void Interp3dTetra(icUInt16Number *pDst, const icUInt16Number *pSrc, icUInt32Number nPixels) const;
+  void Interp4d(icUInt16Number *pDst, const icUInt16Number *pSrc, icUInt32Number nPixels) const;
+
+  void Cleanup();
+
+  icUInt8Number m_nInput;
+  icUInt16Number m_nOutput;
+  icUInt8Number m_nInputBits;
+
+  icInt32Number *m_pData;
+
+  //Input tables of grid offsets and fractions (one set of 2^m_nInputBits entries per input)
+  icUInt32Number *m_pIndex;
+  icUInt32Number *m_pFrac;
+
+  icUInt32Number m_nOffset[16];
+  icUInt32Number n001, n010, n011, n100, n101, n110, n111;
+};
+
+
 /**
 ****************************************************************************
 * Class: CIccMBB
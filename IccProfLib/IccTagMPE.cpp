@@ -148,6 +148,30 @@ CIccApplyMpe* CIccMultiProcessElement::GetNewApply( CIccApplyTagMpe * /* 'pApply
   return new CIccApplyMpe(this);
 }
 
+/**
+ ******************************************************************************
+ * Name: CIccMultiProcessElement::ApplyN
+ * 
+ * Purpose: 
+ *  Applies the element to a block of packed pixels.  Elements that can
+ *  process several pixels at once override this.
+ * 
+ * Args: 
+ *  pApply = apply object of the element
+ *  pDestPixels = NumOutputChannels() samples per pixel
+ *  pSrcPixels = NumInputChannels() samples per pixel
+ *  nPixels = number of pixels
+******************************************************************************/
+void CIccMultiProcessElement::ApplyN(CIccApplyMpe *pApply, icFloatNumber *pDestPixels, const icFloatNumber *pSrcPixels,
+                                     icUInt32Number nPixels) const
+{
+  icUInt32Number nSrc = NumInputChannels();
+  icUInt32Number nDst = NumOutputChannels();
+
+  for (icUInt32Number k=0; k<nPixels; k++, pDestPixels+=nDst, pSrcPixels+=nSrc)
+    Apply(pApply, pDestPixels, pSrcPixels);
+}
+
 
 /**
  ******************************************************************************
@@ -632,6 +656,9 @@ CIccApplyTagMpe::CIccApplyTagMpe(CIccTagMultiProcessElement *pTag)
 {
   m_pTag = pTag;
   m_list = NULL;
+
+  m_nBlockChannels = 0;
+  m_pBlockBuf = NULL;
 }
 
 
@@ -656,6 +683,49 @@ CIccApplyTagMpe::~CIccApplyTagMpe()
 
     delete m_list;
   }
+
+  if (m_pBlockBuf)
+    free(m_pBlockBuf);
+}
+
+
+/**
+******************************************************************************
+* Name: CIccApplyTagMpe::GetBlockBuf
+* 
+* Purpose: 
+*  Gets one of the three pixel blocks used by
+*  CIccTagMultiProcessElement::ApplyN().  Each block holds icMpeBlockPixels
+*  pixels of GetBlockChannels() samples.
+* 
+* Args: 
+*  nIndex = block index (0 to 2)
+* 
+* Return: 
+*  pointer to block, or NULL if it could not be allocated
+******************************************************************************/
+icFloatNumber *CIccApplyTagMpe::GetBlockBuf(int nIndex)
+{
+  if (!m_pBlockBuf) {
+    icUInt32Number nChannels = m_applyBuf.GetMaxChannels();
+
+    if (m_pTag) {
+      if (m_pTag->NumInputChannels()>nChannels)
+        nChannels = m_pTag->NumInputChannels();
+      if (m_pTag->NumOutputChannels()>nChannels)
+        nChannels = m_pTag->NumOutputChannels();
+    }
+    if (!nChannels)
+      return NULL;
+
+    m_pBlockBuf = (icFloatNumber*)malloc(3*nChannels*icMpeBlockPixels*sizeof(icFloatNumber));
+    if (!m_pBlockBuf)
+      return NULL;
+
+    m_nBlockChannels = nChannels;
+  }
+
+  return m_pBlockBuf + nIndex*m_nBlockChannels*icMpeBlockPixels;
 }
 
 
@@ -1521,6 +1591,84 @@ void CIccTagMultiProcessElement::Apply(CIccApplyTagMpe *pApply, icFloatNumber *p
 }
 
 
+/**
+ ******************************************************************************
+ * Name: CIccTagMultiProcessElement::ApplyN
+ * 
+ * Purpose: 
+ *  Applies the elements to a span of pixels.  Pixels are passed through
+ *  the elements in blocks of icMpeBlockPixels so that each element can
+ *  process a whole block with a single ApplyN() call.
+ * 
+ * Args: 
+ *  pApply = apply object from GetNewApply()
+ *  pDestPixels = destination pixels
+ *  pSrcPixels = source pixels (may be the same as pDestPixels)
+ *  nPixels = number of pixels
+ *  nDstStride = samples between destination pixels
+ *  nSrcStride = samples between source pixels
+ ******************************************************************************/
+void CIccTagMultiProcessElement::ApplyN(CIccApplyTagMpe *pApply, icFloatNumber *pDestPixels, const icFloatNumber *pSrcPixels,
+                                        icUInt32Number nPixels, icUInt32Number nDstStride, icUInt32Number nSrcStride) const
+{
+  icUInt32Number k, n, nBlock;
+
+  icFloatNumber *pStage = pApply ? pApply->GetBlockBuf(0) : NULL;
+
+  if (!pStage || !pApply->GetList() || !pApply->GetList()->size()) {
+    for (k=0; k<nPixels; k++, pDestPixels+=nDstStride, pSrcPixels+=nSrcStride)
+      Apply(pApply, pDestPixels, pSrcPixels);
+    return;
+  }
+
+  icFloatNumber *pBuf[2] = { pApply->GetBlockBuf(1), pApply->GetBlockBuf(2) };
+  bool bPackedSrc = nSrcStride==m_nInputChannels;
+  bool bPackedDst = nDstStride==m_nOutputChannels && (const icFloatNumber*)pDestPixels!=pSrcPixels;
+
+  for (n=0; n<nPixels; n+=nBlock) {
+    nBlock = nPixels - n;
+    if (nBlock>icMpeBlockPixels)
+      nBlock = icMpeBlockPixels;
+
+    const icFloatNumber *pSrc = pSrcPixels + n*nSrcStride;
+    icFloatNumber *pDst = pDestPixels + n*nDstStride;
+
+    if (!bPackedSrc) {
+      for (k=0; k<nBlock; k++)
+        memcpy(pStage + k*m_nInputChannels, pSrc + k*nSrcStride, m_nInputChannels*sizeof(icFloatNumber));
+      pSrc = pStage;
+    }
+
+    //Same element order as Apply() - Acs elements are only applied at the ends
+    CIccApplyMpeIter i = pApply->begin(), next;
+    int nBuf = 0;
+
+    for (; i!=pApply->end(); i=next) {
+      next = i;
+      next++;
+
+      if (i!=pApply->begin() && next!=pApply->end() && i->ptr->GetElem()->IsAcs())
+        continue;
+
+      if (next==pApply->end() && bPackedDst) {
+        i->ptr->ApplyN(pDst, pSrc, nBlock);
+        pSrc = pDst;
+      }
+      else {
+        i->ptr->ApplyN(pBuf[nBuf], pSrc, nBlock);
+        pSrc = pBuf[nBuf];
+        nBuf ^= 1;
+      }
+    }
+
+    if (pSrc!=pDst) {
+      for (k=0; k<nBlock; k++)
+        memcpy(pDst + k*nDstStride, pSrc + k*m_nOutputChannels, m_nOutputChannels*sizeof(icFloatNumber));
+    }
+  }
+}
+
+
 /**
  ******************************************************************************
  * Name: CIccTagMultiProcessElement::Validate
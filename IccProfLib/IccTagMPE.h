@@ -99,6 +99,9 @@ class CIccApplyMpe;
 
 class IIccCmmEnvVarLookup;
 
+/// Number of pixels passed between elements by CIccTagMultiProcessElement::ApplyN()
+#define icMpeBlockPixels 64
+
 /**
 ****************************************************************************
 * Class: CIccProcessElementPtr
@@ -167,6 +170,9 @@ public:
   virtual CIccApplyMpe* GetNewApply(CIccApplyTagMpe *pApplyTag);
   virtual void Apply(CIccApplyMpe *pApply, icFloatNumber *pDestPixel, const icFloatNumber *pSrcPixel) const = 0;
 
+  ///Applies the element to nPixels packed pixels (pDestPixels must not overlap pSrcPixels)
+  virtual void ApplyN(CIccApplyMpe *pApply, icFloatNumber *pDestPixels, const icFloatNumber *pSrcPixels, icUInt32Number nPixels) const;
+
   virtual icValidateStatus Validate(std::string sigPath, std::string &sReport, const CIccTagMultiProcessElement* pMPE=NULL, const CIccProfile* pProfile = NULL) const = 0;
 
   //Future Acs Expansion Element Accessors
@@ -207,6 +213,8 @@ public:
   CIccMultiProcessElement *GetElem() const { return m_pElem; }
 
   void Apply(icFloatNumber *pDestPixel, const icFloatNumber *pSrcPixel) { m_pElem->Apply(this, pDestPixel, pSrcPixel); }
+  void ApplyN(icFloatNumber *pDestPixels, const icFloatNumber *pSrcPixels, icUInt32Number nPixels)
+  { m_pElem->ApplyN(this, pDestPixels, pSrcPixels, nPixels); }
 
 protected:
   CIccApplyTagMpe *m_pApplyTag;
@@ -329,6 +337,9 @@ public:
   CIccApplyMpeIter begin() { return m_list->begin(); }
   CIccApplyMpeIter end() { return m_list->end(); }
 
+  icFloatNumber *GetBlockBuf(int nIndex);
+  icUInt32Number GetBlockChannels() { return m_nBlockChannels; }
+
 protected:
   CIccTagMultiProcessElement *m_pTag;
 
@@ -337,6 +348,10 @@ protected:
 
   //Pixel data for Apply 
   CIccDblPixelBuffer m_applyBuf;
+
+  //Pixel blocks for ApplyN (allocated on first use)
+  icUInt32Number m_nBlockChannels;
+  icFloatNumber *m_pBlockBuf;
 };
 
 
@@ -383,6 +398,8 @@ public:
   virtual CIccApplyTagMpe *GetNewApply();
 
   virtual void Apply(CIccApplyTagMpe *pApply, icFloatNumber *pDestPixel, const icFloatNumber *pSrcPixel) const;
+  virtual void ApplyN(CIccApplyTagMpe *pApply, icFloatNumber *pDestPixels, const icFloatNumber *pSrcPixels, icUInt32Number nPixels,
+                      icUInt32Number nDstStride, icUInt32Number nSrcStride) const;
 
   virtual icValidateStatus Validate(std::string sigPath, std::string &sReport, const CIccProfile* pProfile=NULL) const;
 
@@ -2503,11 +2503,16 @@ icValidateStatus CIccInfo::CheckData(std::string &sReport, const icDateTimeNumbe
 {
   icValidateStatus rv = icValidateOK;
 
-  struct tm *newtime;
+  struct tm tmNow;
+  struct tm *newtime = &tmNow;
   time_t long_time;
 
   time( &long_time );                /* Get time as long integer. */
-  newtime = localtime( &long_time );
+#if defined(_WIN32)
+  localtime_s(&tmNow, &long_time);   /* Reentrant: profiles may be validated concurrently */
+#else
+  localtime_r(&long_time, &tmNow);
+#endif
 
   const size_t bufSize = 128;
   icChar buf[bufSize];
@@ -14,7 +14,7 @@
 int main(int argc, char* argv[])
 {
   if (argc<=2) {
-    printf("IccFromXml built with IccProfLib Version " ICCPROFLIBVER ", IccLibXML Version " ICCLIBXMLVER "\n\nUsage: IccFromXml xml_file saved_profile_file {-noid -v{=[relax_ng_schema_file - optional]}}\n");
+    printf("IccFromXml built with IccProfLib Version " ICCPROFLIBVER ", IccLibXML Version " ICCLIBXMLVER "\n\nUsage: IccFromXml xml_file saved_profile_file {-noid -share -v{=[relax_ng_schema_file - optional]}}\n");
     return -1;
   }
 
@@ -26,6 +26,8 @@ int main(int argc, char* argv[])
 
   std::string szRelaxNGDir;
   bool bNoId = false;
+  icTagShareMethod nShareTags = icShareTagObjects;
+  icUInt32Number nBytesSaved = 0;
 
   const char* szRelaxNGFileName = "SampleIccRELAX.rng";
   int i;
@@ -33,6 +35,9 @@ int main(int argc, char* argv[])
     if (!stricmp(argv[i], "-noid")) {
       bNoId = true;
     }
+    else if (!stricmp(argv[i], "-share")) {
+      nShareTags = icShareIdenticalTags;
+    }
     else if (!strncmp(argv[i], "-v", 2) || !strncmp(argv[i], "-V", 2)) {// user specified schema validation
       if (argv[i][2]=='=') {
         szRelaxNGDir = argv[i]+3;
@@ -83,8 +88,11 @@ int main(int argc, char* argv[])
       if (profile.m_Header.profileID.ID8[i])
         break;
     }
-    if (SaveIccProfile(argv[2], &profile, bNoId ? icNeverWriteID : (i<16 ? icAlwaysWriteID : icVersionBasedID))) {
+    if (SaveIccProfile(argv[2], &profile, bNoId ? icNeverWriteID : (i<16 ? icAlwaysWriteID : icVersionBasedID),
+                       nShareTags, &nBytesSaved)) {
       printf("Profile parsed and saved correctly\n");
+      if (nBytesSaved)
+        printf("Identical tags share data (%u bytes saved)\n", nBytesSaved);
     }
     else {
       printf("Unable to save profile as '%s'\n", argv[2]);
@@ -98,8 +106,11 @@ int main(int argc, char* argv[])
       if (profile.m_Header.profileID.ID8[i])
         break;
     }
-    if (SaveIccProfile(argv[2], &profile, bNoId ? icNeverWriteID : (i<16 ? icAlwaysWriteID : icVersionBasedID))) {
+    if (SaveIccProfile(argv[2], &profile, bNoId ? icNeverWriteID : (i<16 ? icAlwaysWriteID : icVersionBasedID),
+                       nShareTags, &nBytesSaved)) {
       printf("Profile parsed.  Profile is invalid, but saved correctly\n");
+      if (nBytesSaved)
+        printf("Identical tags share data (%u bytes saved)\n", nBytesSaved);
     }
     else {
       printf("Unable to save profile - profile is invalid!\n");
@@ -0,0 +1,220 @@
+/*
+    File:       iccClutLoadBench.cpp
+
+    Contains:   Console app that times reading and writing CLUT data in
+                each storage precision
+
+    Version:    V1
+
+    Copyright:  (c) see below
+*/
+
+/*
+ * The ICC Software License, Version 0.2
+ *
+ *
+ * Copyright (c) 2003-2026 The International Color Consortium. All rights
+ * reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. In the absence of prior written permission, the names "ICC" and "The
+ *    International Color Consortium" must not be used to imply that the
+ *    ICC organization endorses or promotes products derived from this
+ *    software.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE INTERNATIONAL COLOR CONSORTIUM OR
+ * ITS CONTRIBUTING MEMBERS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by many
+ * individuals on behalf of the The International Color Consortium.
+ *
+ *
+ * Membership in the ICC is encouraged when this software is used for
+ * commercial purposes.
+ *
+ *
+ * For more information on The International Color Consortium, please
+ * see <http://www.color.org/>.
+ *
+ *
+ */
+
+//////////////////////////////////////////////////////////////////////
+// HISTORY:
+//
+// -Initial implementation of CLUT load benchmark 10-18-2026
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include "IccMpeBasic.h"
+#include "IccIO.h"
+#include "IccUtil.h"
+
+//Returns the current time in milliseconds
+static double msNow()
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//Creates an extended CLUT element with nInput inputs, 3 outputs and nGrid grid points
+static CIccMpeExtCLUT *newCLUT(icUInt16Number nStorageType, icUInt8Number nInput, icUInt8Number nGrid)
+{
+  CIccCLUT *pCLUT = new CIccCLUT(nInput, 3);
+
+  if (!pCLUT->Init(nGrid)) {
+    delete pCLUT;
+    return NULL;
+  }
+
+  icFloatNumber *pData = pCLUT->GetData(0);
+  icUInt32Number i, nData = pCLUT->NumPoints()*3;
+
+  for (i=0; i<nData; i++)
+    pData[i] = (icFloatNumber)(i % 1000) / 1000.0f;
+
+  CIccMpeExtCLUT *pElem = new CIccMpeExtCLUT();
+  pElem->SetStorageType(nStorageType);
+  pElem->SetCLUT(pCLUT);
+
+  return pElem;
+}
+
+//Times reading and writing a CLUT with the given storage type
+static bool benchCLUT(const char *szName, icUInt16Number nStorageType, icUInt8Number nInput, icUInt8Number nGrid,
+                      int nRepeat, const char *szTempFile)
+{
+  CIccMpeExtCLUT *pElem = newCLUT(nStorageType, nInput, nGrid);
+  double fStart, fTime, fWriteFile = 1e30, fReadMem = 1e30, fReadFile = 1e30;
+  int i;
+
+  if (!pElem) {
+    printf("%-8s unable to allocate CLUT\n", szName);
+    return false;
+  }
+
+  CIccMemIO mem;
+  if (!mem.Alloc(0, true, true) || !pElem->Write(&mem)) {
+    printf("%-8s unable to write CLUT to memory\n", szName);
+    delete pElem;
+    return false;
+  }
+  icUInt32Number nSize = (icUInt32Number)mem.GetLength();
+
+  for (i=0; i<nRepeat; i++) {
+    CIccFileIO fileOut;
+    if (!fileOut.Open(szTempFile, "wb")) {
+      printf("%-8s unable to open %s\n", szName, szTempFile);
+      delete pElem;
+      return false;
+    }
+    fStart = msNow();
+    pElem->Write(&fileOut);
+    fileOut.Close();
+    fTime = msNow() - fStart;
+    if (fTime < fWriteFile)
+      fWriteFile = fTime;
+
+    CIccMpeExtCLUT readMem;
+    mem.Seek(0, icSeekSet);
+    fStart = msNow();
+    if (!readMem.Read(nSize, &mem)) {
+      printf("%-8s unable to read CLUT from memory\n", szName);
+      delete pElem;
+      return false;
+    }
+    fTime = msNow() - fStart;
+    if (fTime < fReadMem)
+      fReadMem = fTime;
+
+    CIccMpeExtCLUT readFile;
+    CIccFileIO fileIn;
+    if (!fileIn.Open(szTempFile, "rb")) {
+      printf("%-8s unable to open %s\n", szName, szTempFile);
+      delete pElem;
+      return false;
+    }
+    fStart = msNow();
+    if (!readFile.Read(nSize, &fileIn)) {
+      printf("%-8s unable to read CLUT from %s\n", szName, szTempFile);
+      delete pElem;
+      return false;
+    }
+    fTime = msNow() - fStart;
+    if (fTime < fReadFile)
+      fReadFile = fTime;
+  }
+
+  printf("%-8s %10u %12.2f %12.2f %12.2f\n", szName, nSize, fReadMem, fReadFile, fWriteFile);
+
+  delete pElem;
+  return true;
+}
+
+int main(int argc, const char *argv[])
+{
+  int nInput = 4, nGrid = 33, nRepeat = 5, i;
+  const char *szTempFile = "iccClutLoadBench.tmp";
+
+  for (i=1; i<argc; i++) {
+    if (!strcmp(argv[i], "-i") && i+1<argc)
+      nInput = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-g") && i+1<argc)
+      nGrid = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-n") && i+1<argc)
+      nRepeat = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-f") && i+1<argc)
+      szTempFile = argv[++i];
+    else {
+      printf("Usage: iccClutLoadBench {-i inputs} {-g grid_points} {-n repeat} {-f temp_file}\n\n");
+      printf("  Times reading a CLUT with 3 outputs from memory and from a file, and\n");
+      printf("  writing it to a file, for 8 bit, 16 bit, float16 and float32 data.\n");
+      printf("  Times are the best of the repeats (default is 4 inputs, 33 grid points\n");
+      printf("  and 5 repeats).\n");
+      return argc>1 && (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) ? 0 : 1;
+    }
+  }
+
+  if (nInput<1 || nInput>15 || nGrid<2 || nGrid>255 || nRepeat<1) {
+    printf("Invalid arguments\n");
+    return 1;
+  }
+
+  printf("CLUT with %d inputs, 3 outputs and %d grid points (best of %d, ms)\n\n", nInput, nGrid, nRepeat);
+  printf("%-8s %10s %12s %12s %12s\n", "Type", "Bytes", "Read mem", "Read file", "Write file");
+
+  bool bOk = benchCLUT("uint8", icValueTypeUInt8, (icUInt8Number)nInput, (icUInt8Number)nGrid, nRepeat, szTempFile) &&
+             benchCLUT("uint16", icValueTypeUInt16, (icUInt8Number)nInput, (icUInt8Number)nGrid, nRepeat, szTempFile) &&
+             benchCLUT("float16", icValueTypeFloat16, (icUInt8Number)nInput, (icUInt8Number)nGrid, nRepeat, szTempFile) &&
+             benchCLUT("float32", icValueTypeFloat32, (icUInt8Number)nInput, (icUInt8Number)nGrid, nRepeat, szTempFile);
+
+  remove(szTempFile);
+
+  return bOk ? 0 : 1;
+}
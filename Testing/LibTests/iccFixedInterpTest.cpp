@@ -0,0 +1,351 @@
+/*
+    File:       iccFixedInterpTest.cpp
+
+    Contains:   Console app that checks fixed point CLUT interpolation
+                against the float path
+
+    Version:    V1
+
+    Copyright:  (c) see below
+*/
+
+/*
+ * The ICC Software License, Version 0.2
+ *
+ *
+ * Copyright (c) 2003-2026 The International Color Consortium. All rights
+ * reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. In the absence of prior written permission, the names "ICC" and "The
+ *    International Color Consortium" must not be used to imply that the
+ *    ICC organization endorses or promotes products derived from this
+ *    software.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE INTERNATIONAL COLOR CONSORTIUM OR
+ * ITS CONTRIBUTING MEMBERS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by many
+ * individuals on behalf of the The International Color Consortium.
+ *
+ *
+ * Membership in the ICC is encouraged when this software is used for
+ * commercial purposes.
+ *
+ *
+ * For more information on The International Color Consortium, please
+ * see <http://www.color.org/>.
+ *
+ *
+ */
+
+//////////////////////////////////////////////////////////////////////
+// HISTORY:
+//
+// -Initial implementation of fixed point interpolation test 10-18-2026
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include "IccCmm.h"
+#include "IccTagLut.h"
+#include "IccUtil.h"
+
+//Number of random test pixels applied to each CLUT
+#define TEST_PIXELS 65536
+
+//Small deterministic generator so that every run tests the same values
+static icUInt32Number g_seed = 12345;
+
+static icUInt32Number nextRand()
+{
+  g_seed = g_seed * 1103515245 + 12345;
+  return g_seed >> 8;
+}
+
+//Creates a device link with a single lutAtoBType CLUT and identity B curves.  bCurves
+//adds gamma A curves and bOutOfRange adds grid values outside of 0.0 to 1.0.
+static CIccProfile *newLink(icUInt8Number nInput, icUInt8Number nOutput, icUInt8Number nGrid, bool bCurves, bool bOutOfRange)
+{
+  CIccProfile *pProfile = new CIccProfile();
+
+  pProfile->InitHeader();
+  pProfile->m_Header.version = icVersionNumberV4_3;
+  pProfile->m_Header.deviceClass = icSigLinkClass;
+  pProfile->m_Header.colorSpace = nInput==3 ? icSigRgbData : icSigCmykData;
+  pProfile->m_Header.pcs = nOutput==3 ? icSigRgbData : icSigCmykData;
+
+  CIccTagLutAtoB *pTagLut = new CIccTagLutAtoB();
+  pTagLut->Init(nInput, nOutput);
+
+  LPIccCurve *pCurves = pTagLut->NewCurvesA();
+  icUInt16Number i;
+  for (i=0; i<nInput; i++) {
+    CIccTagParametricCurve *pCurve = new CIccTagParametricCurve();
+    pCurve->SetFunctionType(0);
+    pCurve->GetParams()[0] = bCurves ? 1.8f + 0.2f*i : 1.0f;
+    pCurves[i] = pCurve;
+  }
+  pCurves = pTagLut->NewCurvesB();
+  for (i=0; i<nOutput; i++)
+    pCurves[i] = new CIccTagCurve();
+
+  CIccCLUT *pCLUT = pTagLut->NewCLUT(nGrid);
+  icFloatNumber *pData = pCLUT->GetData(0);
+  icUInt32Number n, nPoints = pCLUT->NumPoints();
+  icFloatNumber fMin = bOutOfRange ? -0.25f : 0.0f, fMax = bOutOfRange ? 1.25f : 1.0f;
+
+  //Smooth but non-linear function of the grid node with some noise
+  for (n=0; n<nPoints; n++) {
+    icUInt32Number nNode = n;
+    icFloatNumber fSum = 0.0f;
+
+    for (i=0; i<nInput; i++) {
+      fSum += (icFloatNumber)(nNode % nGrid) / (icFloatNumber)(nGrid-1) * (i+1);
+      nNode /= nGrid;
+    }
+    for (i=0; i<nOutput; i++) {
+      icFloatNumber v = 0.5f + 0.5f*(icFloatNumber)sin(fSum*(i+1)) + (icFloatNumber)(nextRand()&0xff)/8192.0f;
+      pData[n*nOutput+i] = fMin + (fMax - fMin) * (v > 1.0f ? 1.0f : v);
+    }
+  }
+
+  pProfile->AttachTag(icSigAToB0Tag, pTagLut);
+
+  return pProfile;
+}
+
+//Fills nPixels test pixels with grid corners followed by random codes
+template<class T>
+static void fillPixels(std::vector<T> &src, icUInt32Number nSamples, icUInt32Number nPixels, icUInt32Number nMax)
+{
+  icUInt32Number i, j;
+
+  src.resize(nPixels*nSamples);
+  for (i=0; i<nPixels; i++) {
+    for (j=0; j<nSamples; j++) {
+      if (i < (1U<<nSamples))
+        src[i*nSamples+j] = (T)((i>>j)&1 ? nMax : 0);
+      else
+        src[i*nSamples+j] = (T)(nextRand() % (nMax+1));
+    }
+  }
+}
+
+//Applies pixels to both CMMs returning the largest difference in output codes
+template<class S, class D>
+static int maxDiff(CIccCmm &floatCmm, CIccCmm &fixedCmm, icBufferSampleType nSrcType, icBufferSampleType nDstType)
+{
+  icUInt32Number nSrc = floatCmm.GetSourceSamples(), nDst = floatCmm.GetDestSamples();
+  std::vector<S> src;
+  std::vector<D> floatDst(TEST_PIXELS*nDst), fixedDst(TEST_PIXELS*nDst);
+
+  fillPixels(src, nSrc, TEST_PIXELS, sizeof(S)==1 ? 255 : 65535);
+
+  if (floatCmm.ApplyBuffer(&floatDst[0], icBufferFormat(nDstType), &src[0], icBufferFormat(nSrcType), TEST_PIXELS)!=icCmmStatOk ||
+      fixedCmm.ApplyBuffer(&fixedDst[0], icBufferFormat(nDstType), &src[0], icBufferFormat(nSrcType), TEST_PIXELS)!=icCmmStatOk)
+    return 0x10000;
+
+  int nMax = 0;
+  for (size_t i=0; i<floatDst.size(); i++) {
+    int d = abs((int)floatDst[i] - (int)fixedDst[i]);
+    if (d > nMax)
+      nMax = d;
+  }
+
+  return nMax;
+}
+
+//Checks the fixed point path of a CMM against the float path for 8 and 16 bit samples.
+//pFloatCmm and pFixedCmm are set up the same except for SetFixedInterp().
+static int testCmm(const char *szName, CIccCmm *floatCmms[2], CIccCmm *fixedCmms[2])
+{
+  int nErrors = 0;
+  int d[4];
+
+  if (!fixedCmms[0]->HasFixedInterp() || !fixedCmms[1]->HasFixedInterp()) {
+    printf("%s: fixed point interpolation not used\n", szName);
+    return 1;
+  }
+
+  d[0] = maxDiff<icUInt8Number, icUInt8Number>(*floatCmms[0], *fixedCmms[0], icBufferUInt8, icBufferUInt8);
+  d[1] = maxDiff<icUInt8Number, icUInt16Number>(*floatCmms[0], *fixedCmms[0], icBufferUInt8, icBufferUInt16);
+  d[2] = maxDiff<icUInt16Number, icUInt8Number>(*floatCmms[1], *fixedCmms[1], icBufferUInt16, icBufferUInt8);
+  d[3] = maxDiff<icUInt16Number, icUInt16Number>(*floatCmms[1], *fixedCmms[1], icBufferUInt16, icBufferUInt16);
+
+  for (int i=0; i<4; i++) {
+    if (d[i] > icFixedMaxCodeDiff)
+      nErrors++;
+  }
+
+  printf("%s: 8->8 %d, 8->16 %d, 16->8 %d, 16->16 %d%s\n", szName, d[0], d[1], d[2], d[3], nErrors ? " FAILED" : "");
+
+  return nErrors;
+}
+
+//Checks a synthetic device link
+static int testLink(icUInt8Number nInput, icUInt8Number nOutput, icUInt8Number nGrid, bool bCurves, bool bOutOfRange)
+{
+  CIccCmm *floatCmms[2], *fixedCmms[2];
+  int i, nErrors = 0;
+
+  for (i=0; i<2; i++) {
+    g_seed = nInput*1000 + nOutput*100 + nGrid + (bCurves ? 7 : 0) + (bOutOfRange ? 13 : 0);
+    floatCmms[i] = new CIccCmm();
+    floatCmms[i]->AddXform(newLink(nInput, nOutput, nGrid, bCurves, bOutOfRange), icUnknownIntent, icInterpTetrahedral);
+
+    g_seed = nInput*1000 + nOutput*100 + nGrid + (bCurves ? 7 : 0) + (bOutOfRange ? 13 : 0);
+    fixedCmms[i] = new CIccCmm();
+    fixedCmms[i]->AddXform(newLink(nInput, nOutput, nGrid, bCurves, bOutOfRange), icUnknownIntent, icInterpTetrahedral);
+    fixedCmms[i]->SetFixedInterp(i ? 16 : 8);
+
+    if (floatCmms[i]->Begin()!=icCmmStatOk || fixedCmms[i]->Begin()!=icCmmStatOk)
+      nErrors++;
+  }
+
+  char szName[80];
+  sprintf(szName, "Link %dx%d grid %d%s%s", nInput, nOutput, nGrid, bCurves ? " curves" : "", bOutOfRange ? " out of range" : "");
+
+  if (nErrors)
+    printf("%s: unable to begin CMM\n", szName);
+  else
+    nErrors = testCmm(szName, floatCmms, fixedCmms);
+
+  for (i=0; i<2; i++) {
+    delete floatCmms[i];
+    delete fixedCmms[i];
+  }
+
+  return nErrors;
+}
+
+//Checks the collapsed link of a 3 or 4 channel device profile.  Other profiles are skipped.
+static int testProfile(const char *szPath, int &nTested)
+{
+  CIccProfile *pProfile = OpenIccProfile(szPath);
+
+  if (!pProfile)
+    return 0;
+
+  icUInt32Number nSamples = icGetSpaceSamples(pProfile->m_Header.colorSpace);
+  bool bDevice = pProfile->m_Header.deviceClass==icSigInputClass || pProfile->m_Header.deviceClass==icSigDisplayClass ||
+                 pProfile->m_Header.deviceClass==icSigOutputClass;
+  bool bLut = pProfile->FindTag(icSigAToB0Tag) || pProfile->FindTag(icSigAToB1Tag);
+  delete pProfile;
+
+  if (!bDevice || !bLut || (nSamples!=3 && nSamples!=4))
+    return 0;
+
+  CIccCmm *floatCmms[2], *fixedCmms[2];
+  int i, nErrors = 0;
+
+  for (i=0; i<2; i++) {
+    floatCmms[i] = new CIccCmm();
+    fixedCmms[i] = new CIccCmm();
+    floatCmms[i]->SetCollapseLink(17, icInterpTetrahedral, false);
+    fixedCmms[i]->SetCollapseLink(17, icInterpTetrahedral, false);
+    fixedCmms[i]->SetFixedInterp(i ? 16 : 8);
+
+    if (floatCmms[i]->AddXform(szPath)!=icCmmStatOk || fixedCmms[i]->AddXform(szPath)!=icCmmStatOk ||
+        floatCmms[i]->Begin()!=icCmmStatOk || fixedCmms[i]->Begin()!=icCmmStatOk ||
+        !floatCmms[i]->GetCollapseStats().bCollapsed)
+      nErrors++;
+  }
+
+  //Collapsed links with grid values beyond icFixedGridLimit keep the float path
+  if (!nErrors && fixedCmms[0]->HasFixedInterp()) {
+    const char *szName = strrchr(szPath, '/');
+    nErrors = testCmm(szName ? szName+1 : szPath, floatCmms, fixedCmms);
+    nTested++;
+  }
+
+  for (i=0; i<2; i++) {
+    delete floatCmms[i];
+    delete fixedCmms[i];
+  }
+
+  return nErrors;
+}
+
+int main(int argc, const char *argv[])
+{
+  if (argc>1 && (!strcmp(argv[1], "-h") || !strcmp(argv[1], "--help"))) {
+    printf("Usage: iccFixedInterpTest {profile_path ...}\n\n");
+    printf("  Compares fixed point CLUT interpolation against the float path for\n");
+    printf("  synthetic 3 and 4 input device links and for collapsed links of the\n");
+    printf("  3 and 4 channel device profiles passed to it, with 8 and 16 bit input\n");
+    printf("  and output samples.  Returns 0 if no output code differs by more\n");
+    printf("  than %d.\n", icFixedMaxCodeDiff);
+    return 0;
+  }
+
+  int nErrors = 0, nLinks = 0, nProfiles = 0, i;
+
+  static const icUInt8Number grids[] = { 2, 9, 17, 33 };
+
+  for (icUInt8Number nInput=3; nInput<=4; nInput++) {
+    for (icUInt8Number nOutput=3; nOutput<=4; nOutput++) {
+      for (i=0; i<(int)(sizeof(grids)/sizeof(grids[0])); i++) {
+        if (nInput==4 && grids[i]>17)
+          continue;
+        nErrors += testLink(nInput, nOutput, grids[i], false, false);
+        nErrors += testLink(nInput, nOutput, grids[i], true, false);
+        nErrors += testLink(nInput, nOutput, grids[i], false, true);
+        nLinks += 3;
+      }
+    }
+  }
+  printf("Tested %d synthetic links\n", nLinks);
+
+  //Grid values beyond icFixedGridLimit cannot be represented so the float path must be kept
+  CIccProfile *pLink = newLink(3, 3, 9, false, false);
+  CIccTagLutAtoB *pTagLut = (CIccTagLutAtoB*)pLink->FindTag(icSigAToB0Tag);
+  pTagLut->GetCLUT()->GetData(0)[5] = icFixedGridLimit * 2.0f;
+
+  CIccCmm cmm;
+  cmm.AddXform(pLink, icUnknownIntent, icInterpTetrahedral);
+  cmm.SetFixedInterp(8);
+  if (cmm.Begin()!=icCmmStatOk || cmm.HasFixedInterp()) {
+    printf("Link with grid values beyond %g: fixed point interpolation used\n", icFixedGridLimit);
+    nErrors++;
+  }
+
+  for (i=1; i<argc; i++)
+    nErrors += testProfile(argv[i], nProfiles);
+  printf("Tested %d of %d profiles\n", nProfiles, argc-1);
+
+  if (nErrors) {
+    printf("Fixed point interpolation FAILED with %d differences above %d\n", nErrors, icFixedMaxCodeDiff);
+    return 1;
+  }
+
+  printf("Fixed point interpolation passed\n");
+  return 0;
+}
@@ -0,0 +1,342 @@
+/*
+    File:       iccSimdConformance.cpp
+
+    Contains:   Console app that checks that every SIMD level gives the
+                same results as the scalar kernels
+
+    Version:    V1
+
+    Copyright:  (c) see below
+*/
+
+/*
+ * The ICC Software License, Version 0.2
+ *
+ *
+ * Copyright (c) 2003-2026 The International Color Consortium. All rights
+ * reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. In the absence of prior written permission, the names "ICC" and "The
+ *    International Color Consortium" must not be used to imply that the
+ *    ICC organization endorses or promotes products derived from this
+ *    software.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE INTERNATIONAL COLOR CONSORTIUM OR
+ * ITS CONTRIBUTING MEMBERS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by many
+ * individuals on behalf of the The International Color Consortium.
+ *
+ *
+ * Membership in the ICC is encouraged when this software is used for
+ * commercial purposes.
+ *
+ *
+ * For more information on The International Color Consortium, please
+ * see <http://www.color.org/>.
+ *
+ *
+ */
+
+//////////////////////////////////////////////////////////////////////
+// HISTORY:
+//
+// -Initial implementation of SIMD conformance test 10-18-2026
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "IccCmm.h"
+#include "IccTagLut.h"
+#include "IccSimd.h"
+#include "IccUtil.h"
+
+//Number of test pixels applied to each profile and synthetic CLUT
+#define TEST_PIXELS 4099
+
+//Levels that are compared against icSimdNone when supported by the CPU
+static const icSimdLevel g_levels[] = { icSimdSSE2, icSimdAVX2, icSimdNEON };
+
+//Small deterministic generator so that every run tests the same values
+static icUInt32Number g_seed = 12345;
+
+static icUInt32Number nextRand()
+{
+  g_seed = g_seed * 1103515245 + 12345;
+  return g_seed >> 8;
+}
+
+//Returns a value in the range fMin to fMax
+static icFloatNumber randValue(icFloatNumber fMin, icFloatNumber fMax)
+{
+  return fMin + (fMax - fMin) * (icFloatNumber)(nextRand() & 0xffff) / 65535.0f;
+}
+
+//Fills nPixels test pixels with grid edges, out of range values and random values
+static void fillPixels(icFloatNumber *pSrc, icUInt32Number nSamples, icUInt32Number nPixels)
+{
+  static const icFloatNumber edges[] = { 0.0f, 1.0f, 0.5f, -0.25f, 1.25f };
+  icUInt32Number i, j;
+
+  for (i=0; i<nPixels; i++) {
+    for (j=0; j<nSamples; j++) {
+      if (i < 5*nSamples)
+        pSrc[i*nSamples+j] = edges[(i+j) % 5];
+      else
+        pSrc[i*nSamples+j] = randValue(-0.05f, 1.05f);
+    }
+  }
+}
+
+//Compares results bit for bit (NaN results match any NaN)
+static bool sameResults(const icFloatNumber *pRef, const icFloatNumber *pTest, size_t nNum, size_t &nFirst)
+{
+  for (nFirst=0; nFirst<nNum; nFirst++) {
+    if (memcmp(pRef+nFirst, pTest+nFirst, sizeof(icFloatNumber)) &&
+        !(pRef[nFirst]!=pRef[nFirst] && pTest[nFirst]!=pTest[nFirst]))
+      return false;
+  }
+  return true;
+}
+
+//Selects nLevel returning false if it is not supported by the CPU
+static bool useLevel(icSimdLevel nLevel)
+{
+  icSetSimdLevel(nLevel);
+  return icGetSimdLevel()==nLevel;
+}
+
+//Checks CIccCLUT::InterpN() on a CLUT with random grid values
+static int testCLUT(icUInt8Number nInput, icUInt16Number nOutput, icUInt8Number nGrid, bool bTetra)
+{
+  CIccCLUT clut(nInput, nOutput);
+
+  if (!clut.Init(nGrid)) {
+    printf("Unable to allocate %d input CLUT\n", nInput);
+    return 1;
+  }
+
+  icFloatNumber *pData = clut.GetData(0);
+  icUInt32Number i, nData = clut.NumPoints()*nOutput;
+
+  for (i=0; i<nData; i++)
+    pData[i] = randValue(-0.2f, 1.2f);
+  clut.Begin();
+
+  CIccApplyCLUT *pApply = clut.GetNewApply();
+  std::vector<icFloatNumber> src((size_t)TEST_PIXELS*nInput), ref((size_t)TEST_PIXELS*nOutput), dst((size_t)TEST_PIXELS*nOutput);
+
+  fillPixels(&src[0], nInput, TEST_PIXELS);
+
+  icSetSimdLevel(icSimdNone);
+  clut.InterpN(&ref[0], &src[0], TEST_PIXELS, nOutput, nInput, bTetra, pApply);
+
+  int nErrors = 0;
+  for (i=0; i<sizeof(g_levels)/sizeof(g_levels[0]); i++) {
+    if (!useLevel(g_levels[i]))
+      continue;
+
+    memset(&dst[0], 0, dst.size()*sizeof(icFloatNumber));
+    clut.InterpN(&dst[0], &src[0], TEST_PIXELS, nOutput, nInput, bTetra, pApply);
+
+    size_t nFirst;
+    if (!sameResults(&ref[0], &dst[0], dst.size(), nFirst)) {
+      printf("CLUT %dx%d grid=%d%s: %s differs at pixel %u channel %u (%.9g != %.9g)\n", nInput, nOutput, nGrid,
+             bTetra ? " tetra" : "", icGetSimdLevelName(g_levels[i]), (icUInt32Number)(nFirst/nOutput),
+             (icUInt32Number)(nFirst%nOutput), ref[nFirst], dst[nFirst]);
+      nErrors++;
+    }
+  }
+
+  delete pApply;
+  return nErrors;
+}
+
+//Checks the CIccIO array conversion kernels on every 8 and 16 bit code
+static int testArrays()
+{
+  std::vector<icUInt8Number> bytes(256), codes(65536*2), swap(65536*2), swapRef(65536*2);
+  std::vector<icFloatNumber> ref(65536), dst(65536);
+  icUInt32Number i, l;
+  int nErrors = 0;
+
+  for (i=0; i<256; i++)
+    bytes[i] = (icUInt8Number)i;
+  for (i=0; i<65536; i++) {
+    codes[i*2] = (icUInt8Number)(i>>8);
+    codes[i*2+1] = (icUInt8Number)i;
+  }
+
+  for (l=0; l<sizeof(g_levels)/sizeof(g_levels[0]); l++) {
+    for (int nKernel=0; nKernel<5; nKernel++) {
+      size_t nNum = nKernel==0 ? 256 : 65536, nFirst;
+
+      icSetSimdLevel(icSimdNone);
+      if (nKernel==0)
+        icSimdUInt8ToFloat(&ref[0], &bytes[0], nNum);
+      else if (nKernel==1)
+        icSimdUInt16BEToFloat(&ref[0], &codes[0], nNum);
+      else if (nKernel==2)
+        icSimdFloat16BEToFloat(&ref[0], &codes[0], nNum);
+      else {
+        //Odd lengths exercise the scalar tails
+        nNum = nKernel==3 ? 65535 : 32767;
+        swapRef = codes;
+        if (nKernel==3)
+          icSimdSwap16Array(&swapRef[0], nNum);
+        else
+          icSimdSwap32Array(&swapRef[0], nNum);
+      }
+
+      if (!useLevel(g_levels[l]))
+        break;
+
+      bool bSame;
+      if (nKernel<3) {
+        if (nKernel==0)
+          icSimdUInt8ToFloat(&dst[0], &bytes[0], nNum);
+        else if (nKernel==1)
+          icSimdUInt16BEToFloat(&dst[0], &codes[0], nNum);
+        else
+          icSimdFloat16BEToFloat(&dst[0], &codes[0], nNum);
+        bSame = sameResults(&ref[0], &dst[0], nNum, nFirst);
+      }
+      else {
+        swap = codes;
+        if (nKernel==3)
+          icSimdSwap16Array(&swap[0], nNum);
+        else
+          icSimdSwap32Array(&swap[0], nNum);
+        bSame = swap==swapRef;
+        nFirst = 0;
+      }
+
+      if (!bSame) {
+        static const char *szKernels[] = { "icSimdUInt8ToFloat", "icSimdUInt16BEToFloat", "icSimdFloat16BEToFloat",
+                                           "icSimdSwap16Array", "icSimdSwap32Array" };
+        printf("%s: %s differs at entry %u\n", szKernels[nKernel], icGetSimdLevelName(g_levels[l]), (icUInt32Number)nFirst);
+        nErrors++;
+      }
+    }
+  }
+
+  return nErrors;
+}
+
+//Checks CIccCmm::Apply() of a span of pixels through a profile
+static int testProfile(const char *szPath, int &nTested)
+{
+  CIccCmm cmm;
+
+  if (cmm.AddXform(szPath, icPerceptual)!=icCmmStatOk || cmm.Begin()!=icCmmStatOk)
+    return 0;
+
+  icUInt16Number nSrc = cmm.GetSourceSamples();
+  icUInt16Number nDst = cmm.GetDestSamples();
+
+  if (!nSrc || !nDst)
+    return 0;
+
+  std::vector<icFloatNumber> src((size_t)TEST_PIXELS*nSrc), ref((size_t)TEST_PIXELS*nDst), dst((size_t)TEST_PIXELS*nDst);
+
+  fillPixels(&src[0], nSrc, TEST_PIXELS);
+
+  icSetSimdLevel(icSimdNone);
+  if (cmm.Apply(&ref[0], &src[0], TEST_PIXELS)!=icCmmStatOk)
+    return 0;
+
+  nTested++;
+
+  int nErrors = 0;
+  for (icUInt32Number i=0; i<sizeof(g_levels)/sizeof(g_levels[0]); i++) {
+    if (!useLevel(g_levels[i]))
+      continue;
+
+    memset(&dst[0], 0, dst.size()*sizeof(icFloatNumber));
+    cmm.Apply(&dst[0], &src[0], TEST_PIXELS);
+
+    size_t nFirst;
+    if (!sameResults(&ref[0], &dst[0], dst.size(), nFirst)) {
+      printf("%s: %s differs at pixel %u channel %u (%.9g != %.9g)\n", szPath, icGetSimdLevelName(g_levels[i]),
+             (icUInt32Number)(nFirst/nDst), (icUInt32Number)(nFirst%nDst), ref[nFirst], dst[nFirst]);
+      nErrors++;
+    }
+  }
+
+  return nErrors;
+}
+
+int main(int argc, const char *argv[])
+{
+  if (argc>1 && (!strcmp(argv[1], "-h") || !strcmp(argv[1], "--help"))) {
+    printf("Usage: iccSimdConformance {profile_path ...}\n\n");
+    printf("  Compares the results of each SIMD level supported by the CPU against\n");
+    printf("  the scalar kernels for synthetic CLUTs, the IO array conversions and\n");
+    printf("  a span of pixels applied through each profile.  Returns 0 if all\n");
+    printf("  results are identical.\n");
+    return 0;
+  }
+
+  icSimdLevel nBest = icGetSimdLevel();
+  int nErrors = 0, nCLUTs = 0, nProfiles = 0, i;
+
+  printf("Best SIMD level: %s\n", icGetSimdLevelName(nBest));
+
+  static const icUInt16Number outputs[] = { 1, 2, 3, 4, 5, 7, 8, 9, 15, 16 };
+  static const icUInt8Number grids[] = { 33, 17, 9, 5, 4, 3, 3, 2 };
+
+  for (icUInt8Number nInput=1; nInput<=8; nInput++) {
+    for (i=0; i<(int)(sizeof(outputs)/sizeof(outputs[0])); i++) {
+      nErrors += testCLUT(nInput, outputs[i], grids[nInput-1], false);
+      nCLUTs++;
+      if (nInput==3) {
+        nErrors += testCLUT(nInput, outputs[i], grids[nInput-1], true);
+        nCLUTs++;
+      }
+    }
+  }
+  printf("Tested %d synthetic CLUTs\n", nCLUTs);
+
+  nErrors += testArrays();
+  printf("Tested IO array conversions\n");
+
+  for (i=1; i<argc; i++)
+    nErrors += testProfile(argv[i], nProfiles);
+  printf("Tested %d of %d profiles\n", nProfiles, argc-1);
+
+  icSetSimdLevel(nBest);
+
+  if (nErrors) {
+    printf("SIMD conformance FAILED with %d differences\n", nErrors);
+    return 1;
+  }
+
+  printf("SIMD conformance passed\n");
+  return 0;
+}
@@ -0,0 +1,238 @@
+/*
+    File:       iccTagLookupBench.cpp
+
+    Contains:   Console app that times looking up tags in profiles with
+                different numbers of tags
+
+    Version:    V1
+
+    Copyright:  (c) see below
+*/
+
+/*
+ * The ICC Software License, Version 0.2
+ *
+ *
+ * Copyright (c) 2003-2026 The International Color Consortium. All rights
+ * reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * 3. In the absence of prior written permission, the names "ICC" and "The
+ *    International Color Consortium" must not be used to imply that the
+ *    ICC organization endorses or promotes products derived from this
+ *    software.
+ *
+ *
+ * THIS SOFTWARE IS PROVIDED ``AS IS'' AND ANY EXPRESSED OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED.  IN NO EVENT SHALL THE INTERNATIONAL COLOR CONSORTIUM OR
+ * ITS CONTRIBUTING MEMBERS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ * ====================================================================
+ *
+ * This software consists of voluntary contributions made by many
+ * individuals on behalf of the The International Color Consortium.
+ *
+ *
+ * Membership in the ICC is encouraged when this software is used for
+ * commercial purposes.
+ *
+ *
+ * For more information on The International Color Consortium, please
+ */
+
+//////////////////////////////////////////////////////////////////////
+// HISTORY:
+//
+// -Initial implementation of tag lookup benchmark 10-18-2026
+//
+//////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include "IccProfile.h"
+#include "IccTagBasic.h"
+
+//Returns the current time in milliseconds
+static double msNow()
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//Signature of the n'th private tag (spread out so the directory is not in signature order)
+static icSignature tagSig(icUInt32Number n)
+{
+  return (icSignature)(0x70000000 + ((n * 2654435761U) & 0x0fffffff));
+}
+
+//Returns the tag that a lookup of sig should find by scanning the tag directory
+static CIccTag *scanTag(CIccProfile &profile, icSignature sig)
+{
+  TagEntryList::iterator i;
+
+  for (i=profile.m_Tags.begin(); i!=profile.m_Tags.end(); i++) {
+    if (i->TagInfo.sig==(icTagSignature)sig)
+      return i->pTag;
+  }
+  return NULL;
+}
+
+//Checks that FindTag() agrees with a scan of the tag directory for every tag and for a missing tag
+static bool checkTags(CIccProfile &profile, icUInt32Number nTags)
+{
+  icUInt32Number i;
+
+  for (i=0; i<nTags+1; i++) {
+    if (profile.FindTag(tagSig(i))!=scanTag(profile, tagSig(i)))
+      return false;
+  }
+  return true;
+}
+
+//Times lookups of tags in a profile with nTags tags
+static bool benchTags(icUInt32Number nTags, icUInt32Number nLookups, int nRepeat)
+{
+  CIccProfile profile;
+  icUInt32Number i, nFound;
+  double fStart, fTime, fHit = 1e30, fMiss = 1e30, fScan = 1e30;
+  int r;
+
+  for (i=0; i<nTags; i++) {
+    CIccTagSignature *pTag = new CIccTagSignature();
+    pTag->SetValue(i);
+    profile.AttachTag(tagSig(i), pTag);
+  }
+
+  if (!checkTags(profile, nTags)) {
+    printf("%8u lookups do not match the tag directory\n", nTags);
+    return false;
+  }
+
+  for (r=0; r<nRepeat; r++) {
+    nFound = 0;
+    fStart = msNow();
+    for (i=0; i<nLookups; i++) {
+      if (profile.FindTag(tagSig(i % nTags)))
+        nFound++;
+    }
+    fTime = msNow() - fStart;
+    if (fTime < fHit)
+      fHit = fTime;
+    if (nFound!=nLookups) {
+      printf("%8u tags not found\n", nTags);
+      return false;
+    }
+
+    fStart = msNow();
+    for (i=0; i<nLookups; i++) {
+      if (profile.FindTag(tagSig(nTags + i % nTags)))
+        nFound++;
+    }
+    fTime = msNow() - fStart;
+    if (fTime < fMiss)
+      fMiss = fTime;
+
+    fStart = msNow();
+    for (i=0; i<nLookups; i++) {
+      if (scanTag(profile, tagSig(i % nTags)))
+        nFound--;
+    }
+    fTime = msNow() - fStart;
+    if (fTime < fScan)
+      fScan = fTime;
+
+    if (nFound!=0) {
+      printf("%8u unexpected tags found\n", nTags);
+      return false;
+    }
+  }
+
+  //m_Tags is public so lookups must still work after it is changed directly
+  CIccTag *pFirst = profile.m_Tags.front().pTag;
+  icTagSignature lastSig = profile.m_Tags.back().TagInfo.sig;
+  profile.m_Tags.back().TagInfo.sig = profile.m_Tags.front().TagInfo.sig;
+  profile.m_Tags.front().TagInfo.sig = lastSig;
+  bool bOk = checkTags(profile, nTags) && profile.FindTag(lastSig)==pFirst;
+
+  IccTagEntry entry = {};
+  entry.TagInfo.sig = (icTagSignature)tagSig(nTags);
+  entry.pTag = pFirst;
+  profile.m_Tags.push_back(entry);
+  bOk = bOk && checkTags(profile, nTags) && profile.FindTag(tagSig(nTags))==pFirst;
+
+  //Removing an entry and appending another leaves the number of entries unchanged
+  profile.m_Tags.erase(profile.m_Tags.begin());
+  entry.TagInfo.sig = (icTagSignature)tagSig(nTags+1);
+  profile.m_Tags.push_back(entry);
+  bOk = bOk && checkTags(profile, nTags) && profile.FindTag(tagSig(nTags+1))==pFirst;
+
+  //Renaming an entry to a signature that is not in the directory
+  CIccTag *pRenamed = profile.m_Tags.front().pTag;
+  profile.m_Tags.front().TagInfo.sig = (icTagSignature)tagSig(nTags+2);
+  bOk = bOk && checkTags(profile, nTags) && profile.FindTag(tagSig(nTags+2))==pRenamed;
+
+  if (!bOk) {
+    printf("%8u lookups do not match the changed tag directory\n", nTags);
+    return false;
+  }
+
+  printf("%8u %12.3f %12.3f %12.3f\n", nTags, fHit, fMiss, fScan);
+
+  return true;
+}
+
+int main(int argc, const char *argv[])
+{
+  int nLookups = 1000000, nRepeat = 5, i;
+
+  for (i=1; i<argc; i++) {
+    if (!strcmp(argv[i], "-l") && i+1<argc)
+      nLookups = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-n") && i+1<argc)
+      nRepeat = atoi(argv[++i]);
+    else {
+      printf("Usage: iccTagLookupBench {-l lookups} {-n repeat}\n\n");
+      printf("  Times finding tags that are present and tags that are missing with\n");
+      printf("  CIccProfile::FindTag() and with a scan of the tag directory, for\n");
+      printf("  profiles with 8 to 2048 tags.  Times are the best of the repeats\n");
+      printf("  (default is 1000000 lookups and 5 repeats).\n");
+      return argc>1 && (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) ? 0 : 1;
+    }
+  }
+
+  if (nLookups<1 || nRepeat<1) {
+    printf("Invalid arguments\n");
+    return 1;
+  }
+
+  printf("%d lookups (best of %d, ms)\n\n", nLookups, nRepeat);
+  printf("%8s %12s %12s %12s\n", "Tags", "Find hit", "Find miss", "Scan hit");
+
+  icUInt32Number nTags;
+  for (nTags=8; nTags<=2048; nTags*=4) {
+    if (!benchTags(nTags, (icUInt32Number)nLookups, nRepeat))
+      return 1;
+  }
+
+  return 0;
+}
@@ -431,7 +431,7 @@ int main(int argc, const char* argv[])
   int nDestSamples = icGetSpaceSamples(DestspaceSig);
   
   //Allocate pixel buffers for performing encoding transformations
-  char SrcNameBuf[256], DestNameBuf[256];
+  char DestNameBuf[256];
   CIccPixelBuf SrcPixel(nSrcSamples+16), DestPixel(nDestSamples+16), Pixel(icIntMax(nSrcSamples, nDestSamples)+16);
 
   CIccCfgColorData outData;
@@ -498,7 +498,7 @@ int main(int argc, const char* argv[])
           }
         case icApplyNamed2Named:
           {
-            if(namedCmm.Apply(DestNameBuf, SrcNameBuf, tint)) {
+            if(namedCmm.Apply(DestNameBuf, szName, tint)) {
               printf("Profile application failed.\n");
               return -1;
             }
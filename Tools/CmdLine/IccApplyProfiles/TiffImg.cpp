@@ -91,8 +91,13 @@ CTiffImg::CTiffImg()
   m_nBitsPerSample = 0;
   m_nSamples = 0;
   m_nExtraSamples = 0;
+  m_nRowsPerStrip = 0;
+  m_nTileWidth = 0;
+  m_nTileHeight = 0;
+  m_bTiled = false;
 
   m_hTif = NULL;
+  m_pBandBuf = NULL;
   m_pStripBuf = NULL;
 }
 
@@ -103,11 +108,19 @@ CTiffImg::~CTiffImg()
 
 void CTiffImg::Close()
 {
+  //Write out any rows buffered for a partially written band of an incomplete image
+  if (m_hTif && !m_bRead && m_pBandBuf && m_nCurLine < m_nHeight && m_nCurLine % m_nBandRows)
+    WriteBand();
+
   m_nWidth = 0;
   m_nHeight = 0;
   m_nBitsPerSample = 0;
   m_nSamples = 0;
   m_nExtraSamples = 0;
+  m_nRowsPerStrip = 0;
+  m_nTileWidth = 0;
+  m_nTileHeight = 0;
+  m_bTiled = false;
 
   if (m_hTif) {
     TIFFClose(m_hTif);
@@ -115,6 +128,11 @@ void CTiffImg::Close()
     m_hTif = NULL;
   }
 
+  if (m_pBandBuf) {
+    free(m_pBandBuf);
+    m_pBandBuf = NULL;
+  }
+
   if (m_pStripBuf) {
     free(m_pStripBuf);
     m_pStripBuf = NULL;
@@ -123,7 +141,8 @@ void CTiffImg::Close()
 
 bool CTiffImg::Create(const char *szFname, unsigned int nWidth, unsigned int nHeight,
               unsigned int nBPS, unsigned int nPhoto, unsigned int nSamples, unsigned int nExtraSamples,
-              float fXRes, float fYRes, bool bCompress, bool bSep)
+              float fXRes, float fYRes, bool bCompress, bool bSep,
+              unsigned int nRowsPerStrip, unsigned int nTileWidth, unsigned int nTileHeight)
 {
   Close();
   m_bRead = false;
@@ -133,11 +152,42 @@ bool CTiffImg::Create(const char *szFname, unsigned int nWidth, unsigned int nHe
   m_nBitsPerSample = (icUInt16Number)nBPS;
   m_nSamples = (icUInt16Number)nSamples;
   m_nExtraSamples = (icUInt16Number)nExtraSamples;
-  m_nRowsPerStrip = 1;
   m_fXRes = fXRes;
   m_fYRes = fYRes;
   m_nPlanar = bSep ? PLANARCONFIG_SEPARATE : PLANARCONFIG_CONTIG;
   m_nCompress = bCompress ? COMPRESSION_LZW : COMPRESSION_NONE;
+  m_bTiled = nTileWidth && nTileHeight;
+  m_nBytesPerSample = m_nBitsPerSample / 8;
+  m_nBytesPerLine = (unsigned int)(((icUInt64Number)m_nWidth * m_nBitsPerSample * m_nSamples + 7)>>3);
+
+  //Separate planes and tiles are only supported for samples that fit on byte boundaries
+  if ((m_bTiled || (bSep && m_nSamples>1)) && (m_nBitsPerSample % 8)) {
+    Close();
+    return false;
+  }
+
+  if (m_bTiled) {
+    //TIFF requires tile dimensions to be multiples of 16
+    if ((nTileWidth % 16) || (nTileHeight % 16)) {
+      Close();
+      return false;
+    }
+    m_nTileWidth = nTileWidth;
+    m_nTileHeight = nTileHeight;
+    m_nBandRows = m_nTileHeight;
+  }
+  else {
+    if (!nRowsPerStrip) {
+      unsigned int nStripLineBytes = (bSep && m_nSamples>1) ? m_nWidth * m_nBytesPerSample : m_nBytesPerLine;
+      nRowsPerStrip = nStripLineBytes ? TIFFIMG_STRIP_BYTES / nStripLineBytes : 1;
+    }
+    if (nRowsPerStrip > m_nHeight)
+      nRowsPerStrip = m_nHeight;
+    if (nRowsPerStrip < 1)
+      nRowsPerStrip = 1;
+    m_nRowsPerStrip = nRowsPerStrip;
+    m_nBandRows = m_nRowsPerStrip;
+  }
 
   switch(nPhoto) {
   case PHOTO_RGB:
@@ -167,7 +217,10 @@ bool CTiffImg::Create(const char *szFname, unsigned int nWidth, unsigned int nHe
     break;
   }
 
-  m_hTif = TIFFOpen(szFname, "w");
+  //Classic TIFF offsets are limited to 4GB so large images are written as BigTIFF
+  bool bBigTiff = (icUInt64Number)m_nBytesPerLine * m_nHeight > TIFFIMG_BIGTIFF_BYTES;
+
+  m_hTif = TIFFOpen(szFname, bBigTiff ? "w8" : "w");
   if (!m_hTif) {
     TIFFError(szFname,"Can not open output image");
     return false;
@@ -187,7 +240,13 @@ bool CTiffImg::Create(const char *szFname, unsigned int nWidth, unsigned int nHe
   TIFFSetField(m_hTif, TIFFTAG_BITSPERSAMPLE, m_nBitsPerSample);
   if (m_nBitsPerSample==32)
     TIFFSetField(m_hTif, TIFFTAG_SAMPLEFORMAT, SAMPLEFORMAT_IEEEFP);
-  TIFFSetField(m_hTif, TIFFTAG_ROWSPERSTRIP, m_nRowsPerStrip);
+  if (m_bTiled) {
+    TIFFSetField(m_hTif, TIFFTAG_TILEWIDTH, (uint32_t) m_nTileWidth);
+    TIFFSetField(m_hTif, TIFFTAG_TILELENGTH, (uint32_t) m_nTileHeight);
+  }
+  else {
+    TIFFSetField(m_hTif, TIFFTAG_ROWSPERSTRIP, (uint32_t) m_nRowsPerStrip);
+  }
   TIFFSetField(m_hTif, TIFFTAG_COMPRESSION, m_nCompress);
   TIFFSetField(m_hTif, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT);
   TIFFSetField(m_hTif, TIFFTAG_XRESOLUTION, fXRes);
@@ -202,36 +261,10 @@ bool CTiffImg::Create(const char *szFname, unsigned int nWidth, unsigned int nHe
   }
 
   m_nCurLine = 0;
-  m_nCurStrip = 0;
-
-  if (bSep && m_nSamples>1) {
-    m_nStripSamples = m_nSamples;
-    if (m_nBitsPerSample % 8) {
-      Close();
-      return false;
-    }
-    m_nBytesPerSample = m_nBitsPerSample / 8;
-
-    m_nStripSize = (unsigned int)TIFFStripSize(m_hTif);
-    m_nBytesPerStripLine = m_nWidth * m_nBytesPerSample;
 
-    if (m_nStripSize!=m_nBytesPerStripLine) {
-      Close();
-      return false;
-    }
-    m_nBytesPerLine = m_nWidth * m_nBytesPerSample * m_nSamples;
-
-    m_pStripBuf = (unsigned char*)malloc(m_nStripSize*m_nStripSamples);
-
-    if (!m_pStripBuf) {
-      Close();
-      return false;
-    }
-    m_nStripsPerSample = m_nHeight / m_nRowsPerStrip;
-  }
-  else {
-    m_nBytesPerLine = m_nStripSize = (unsigned int)TIFFStripSize(m_hTif);
-    m_nStripSamples = 1;
+  if (!InitBuffers()) {
+    Close();
+    return false;
   }
 
   return true;
@@ -260,22 +293,31 @@ bool CTiffImg::Open(const char *szFname)
   TIFFGetField(m_hTif, TIFFTAG_EXTRASAMPLES, &m_nExtraSamples, &nSampleInfo);
   TIFFGetField(m_hTif, TIFFTAG_BITSPERSAMPLE, &m_nBitsPerSample);
   TIFFGetField(m_hTif, TIFFTAG_SAMPLEFORMAT, &nSampleFormat);
-  TIFFGetField(m_hTif, TIFFTAG_ROWSPERSTRIP, &m_nRowsPerStrip);
   TIFFGetField(m_hTif, TIFFTAG_ORIENTATION, &nOrientation);
   TIFFGetField(m_hTif, TIFFTAG_XRESOLUTION, &m_fXRes);
   TIFFGetField(m_hTif, TIFFTAG_YRESOLUTION, &m_fYRes);
   TIFFGetField(m_hTif, TIFFTAG_COMPRESSION, &m_nCompress);
+
+  m_bTiled = TIFFIsTiled(m_hTif)!=0;
+  if (m_bTiled) {
+    TIFFGetField(m_hTif, TIFFTAG_TILEWIDTH, &m_nTileWidth);
+    TIFFGetField(m_hTif, TIFFTAG_TILELENGTH, &m_nTileHeight);
+    m_nBandRows = m_nTileHeight;
+  }
+  else {
+    TIFFGetField(m_hTif, TIFFTAG_ROWSPERSTRIP, &m_nRowsPerStrip);
+    if (m_nRowsPerStrip > m_nHeight)
+      m_nRowsPerStrip = m_nHeight;    // best guess, to limit memory allocated
+    m_nBandRows = m_nRowsPerStrip;
+  }
   
-  if (m_nRowsPerStrip == 0 || m_nSamples == 0 || m_nBitsPerSample == 0) {
+  if (m_nBandRows == 0 || m_nSamples == 0 || m_nBitsPerSample == 0 || (m_bTiled && m_nTileWidth == 0)) {
     // Corrupt parameters - can't read the file
     // If the file is uncompressed, we might guess some of the values,
     // but it would take a bit of testing to get right.  Probably not worth it.
     Close();
     return false;
   }
-  
-  if (m_nRowsPerStrip > m_nHeight)
-    m_nRowsPerStrip = m_nHeight;    // best guess, to limit memory allocated
 
   //Validate what we expect to work with
   if ((m_nBitsPerSample==32 && nSampleFormat!=SAMPLEFORMAT_IEEEFP) ||
@@ -284,134 +326,280 @@ bool CTiffImg::Open(const char *szFname)
     Close();
     return false;
   }
+
+  //Only support separate planes and tiles with bitspersample that fits on byte boundary
+  if ((m_bTiled || (m_nSamples>1 && m_nPlanar==PLANARCONFIG_SEPARATE)) && (m_nBitsPerSample%8)) {
+    Close();
+    return false;
+  }
   
-  m_nCurStrip=(unsigned int)-1;
+  m_nCurBand=(unsigned int)-1;
   m_nCurLine = 0;
 
-  m_nStripSize = (unsigned int)TIFFStripSize(m_hTif);
+  m_nBytesPerSample = m_nBitsPerSample / 8;
+  m_nBytesPerLine = (unsigned int)(((icUInt64Number)m_nWidth * m_nBitsPerSample * m_nSamples + 7)>>3);
 
-  if (m_nSamples>1 && m_nPlanar==PLANARCONFIG_SEPARATE) {
-    m_nStripSamples = m_nSamples;
-    m_nBytesPerLine = (m_nWidth * m_nBitsPerSample * m_nSamples + 7)>>3;
-    m_nBytesPerSample = m_nBitsPerSample / 8;
-    m_nBytesPerStripLine = m_nWidth * m_nBytesPerSample;
-    //Only support bitspersample that fits on byte boundary
-    if (m_nBitsPerSample%8) {
-      Close();
+  if (!InitBuffers()) {
+    Close();
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * Allocates the band buffer and, for separate planes or tiles, a buffer
+ * holding one strip or tile in its encoded layout.
+ */
+bool CTiffImg::InitBuffers()
+{
+  icUInt64Number nBandSize = (icUInt64Number)m_nBandRows * m_nBytesPerLine;
+  if (!nBandSize || nBandSize != (size_t)nBandSize)
+    return false;
+
+  m_pBandBuf = (unsigned char*)malloc((size_t)nBandSize);
+  if (!m_pBandBuf)
+    return false;
+
+  if (m_bTiled || (m_nSamples>1 && m_nPlanar==PLANARCONFIG_SEPARATE)) {
+    tmsize_t nSize = m_bTiled ? TIFFTileSize(m_hTif) : TIFFStripSize(m_hTif);
+    if (nSize <= 0 || (icUInt64Number)nSize != (unsigned int)nSize)
       return false;
-    }
-    m_nStripsPerSample = m_nHeight / m_nRowsPerStrip;
-    //Only support separations that evenly fit into strips
-    if (m_nHeight % m_nRowsPerStrip) {
-      Close();
+    m_nStripSize = (unsigned int)nSize;
+
+    m_pStripBuf = (unsigned char*)malloc(m_nStripSize);
+    if (!m_pStripBuf)
       return false;
-    }
   }
   else {
-    m_nStripSamples = 1;
-    m_nBytesPerLine = (m_nWidth * m_nBitsPerSample * m_nSamples + 7)>>3;
+    m_nStripSize = (unsigned int)nBandSize;
   }
 
-  m_pStripBuf = (unsigned char*)malloc(m_nStripSize*m_nStripSamples);
+  return true;
+}
 
-  if (!m_pStripBuf) {
-    Close();
-    return false;
-  }
+//Copies nCols pixels of sample plane nPlane from pPlane into contiguous pixels of nSamples samples
+static void PlaneToContig(unsigned char *pDst, const unsigned char *pPlane, unsigned int nCols,
+                          unsigned int nSamples, unsigned int nBytesPerSample, unsigned int nPlane)
+{
+  unsigned int nPixelBytes = nSamples * nBytesPerSample;
 
-  return true;
+  pDst += nPlane * nBytesPerSample;
+  for (unsigned int w=0; w<nCols; w++) {
+    memcpy(pDst, pPlane, nBytesPerSample);
+    pDst += nPixelBytes;
+    pPlane += nBytesPerSample;
+  }
 }
 
+//Copies sample plane nPlane of nCols contiguous pixels of nSamples samples into pPlane
+static void ContigToPlane(unsigned char *pPlane, const unsigned char *pSrc, unsigned int nCols,
+                          unsigned int nSamples, unsigned int nBytesPerSample, unsigned int nPlane)
+{
+  unsigned int nPixelBytes = nSamples * nBytesPerSample;
 
-bool CTiffImg::ReadLine(unsigned char *pBuf)
+  pSrc += nPlane * nBytesPerSample;
+  for (unsigned int w=0; w<nCols; w++) {
+    memcpy(pPlane, pSrc, nBytesPerSample);
+    pPlane += nBytesPerSample;
+    pSrc += nPixelBytes;
+  }
+}
+
+/**
+ * Decodes the strip or row of tiles nBand into contiguous rows in m_pBandBuf.
+ */
+bool CTiffImg::ReadBand(unsigned int nBand)
 {
-  if (!m_bRead || m_nRowsPerStrip == 0)
+  unsigned int nStart = nBand * m_nBandRows;
+  if (nStart >= m_nHeight)
     return false;
 
-  unsigned int nStrip = m_nCurLine / m_nRowsPerStrip;
-  unsigned int nRowOffset = m_nCurLine % m_nRowsPerStrip;
+  unsigned int nLines = m_nHeight - nStart;
+  if (nLines > m_nBandRows)
+    nLines = m_nBandRows;
 
-  if (nStrip != m_nCurStrip) {
-    m_nCurStrip = nStrip;
+  bool bSep = m_nSamples>1 && m_nPlanar==PLANARCONFIG_SEPARATE;
+  unsigned int nPlanes = bSep ? m_nSamples : 1;
+  unsigned int l, s;
 
-    if (m_nStripSamples>1) {
-      unsigned int s;
-      unsigned char *pos = m_pStripBuf;
-      unsigned int nStripOffset = 0;
-      for (s=0; s<m_nStripSamples; s++) {
-        if (TIFFReadEncodedStrip(m_hTif, m_nCurStrip+nStripOffset, pos, m_nStripSize) < 0) {
+  if (!m_bTiled) {
+    if (!bSep) {
+      if (TIFFReadEncodedStrip(m_hTif, TIFFComputeStrip(m_hTif, nStart, 0), m_pBandBuf, (tmsize_t)nLines * m_nBytesPerLine) < 0)
+        return false;
+    }
+    else {
+      unsigned int nPlaneLine = m_nWidth * m_nBytesPerSample;
+      for (s=0; s<nPlanes; s++) {
+        if (TIFFReadEncodedStrip(m_hTif, TIFFComputeStrip(m_hTif, nStart, (uint16_t)s), m_pStripBuf, m_nStripSize) < 0)
           return false;
+        for (l=0; l<nLines; l++) {
+          PlaneToContig(m_pBandBuf + l*m_nBytesPerLine, m_pStripBuf + l*nPlaneLine, m_nWidth, m_nSamples, m_nBytesPerSample, s);
         }
-        nStripOffset += m_nStripsPerSample;
-        pos += m_nBytesPerStripLine;
       }
     }
-    else if (TIFFReadEncodedStrip(m_hTif, m_nCurStrip, m_pStripBuf, m_nStripSize) < 0) {
-      return false;
-    }
   }
+  else {
+    unsigned int nPixelBytes = bSep ? m_nBytesPerSample : m_nSamples * m_nBytesPerSample;
+    unsigned int nTileLine = m_nTileWidth * nPixelBytes;
+
+    for (unsigned int x=0; x<m_nWidth; x+=m_nTileWidth) {
+      unsigned int nCols = m_nWidth - x;
+      if (nCols > m_nTileWidth)
+        nCols = m_nTileWidth;
 
-  if (m_nStripSamples>1) { //Sep to contig
-    unsigned char *src, *dst;
-    src = m_pStripBuf+nRowOffset*m_nBytesPerStripLine;
-    dst = pBuf;
-    unsigned int w, s;
-    for (w=0; w<m_nWidth; w++) {
-      unsigned char *pos = src;
-      for (s=0; s<m_nSamples; s++) {
-        memcpy(dst, pos, m_nBytesPerSample);
-        dst += m_nBytesPerSample;
-        pos += m_nStripSize;
+      for (s=0; s<nPlanes; s++) {
+        if (TIFFReadEncodedTile(m_hTif, TIFFComputeTile(m_hTif, x, nStart, 0, (uint16_t)s), m_pStripBuf, m_nStripSize) < 0)
+          return false;
+
+        for (l=0; l<nLines; l++) {
+          unsigned char *pDst = m_pBandBuf + l*m_nBytesPerLine + x*m_nSamples*m_nBytesPerSample;
+          if (bSep)
+            PlaneToContig(pDst, m_pStripBuf + l*nTileLine, nCols, m_nSamples, m_nBytesPerSample, s);
+          else
+            memcpy(pDst, m_pStripBuf + l*nTileLine, nCols*nPixelBytes);
+        }
       }
-      src += m_nBytesPerSample;
     }
   }
-  else {
-    memcpy(pBuf, m_pStripBuf+nRowOffset*m_nBytesPerLine, m_nBytesPerLine);
-  }
-  m_nCurLine++;
 
   return true;
 }
 
-bool CTiffImg::WriteLine(unsigned char *pBuf)
+/**
+ * Encodes the rows buffered in m_pBandBuf for the band containing the last
+ * written row as a strip or row of tiles.
+ */
+bool CTiffImg::WriteBand()
 {
-  if (m_bRead)
-    return false;
+  if (!m_nCurLine)
+    return true;
 
-  if (m_nCurStrip < m_nHeight) { //Contig to Sep
-    if (m_nStripSamples>1) {
-      unsigned char *src, *dst;
-      src = pBuf;
-      dst = m_pStripBuf;
-      unsigned int w, s, offset;
-      for (w=0; w<m_nWidth; w++) {
-        unsigned char *pos = dst;
-        for (s=0; s<m_nSamples; s++) {
-          memcpy(pos, src, m_nBytesPerSample);
-          src += m_nBytesPerSample;
-          pos += m_nStripSize;
+  unsigned int nStart = ((m_nCurLine-1) / m_nBandRows) * m_nBandRows;
+  unsigned int nLines = m_nCurLine - nStart;
+
+  bool bSep = m_nSamples>1 && m_nPlanar==PLANARCONFIG_SEPARATE;
+  unsigned int nPlanes = bSep ? m_nSamples : 1;
+  unsigned int l, s;
+
+  if (!m_bTiled) {
+    if (!bSep) {
+      if (TIFFWriteEncodedStrip(m_hTif, TIFFComputeStrip(m_hTif, nStart, 0), m_pBandBuf, (tmsize_t)nLines * m_nBytesPerLine) < 0)
+        return false;
+    }
+    else {
+      unsigned int nPlaneLine = m_nWidth * m_nBytesPerSample;
+      for (s=0; s<nPlanes; s++) {
+        for (l=0; l<nLines; l++) {
+          ContigToPlane(m_pStripBuf + l*nPlaneLine, m_pBandBuf + l*m_nBytesPerLine, m_nWidth, m_nSamples, m_nBytesPerSample, s);
         }
-        dst += m_nBytesPerSample;
-      }
-      offset = 0;
-      src = m_pStripBuf;
-      for (s=0; s<m_nSamples; s++) {
-        if (TIFFWriteEncodedStrip(m_hTif, m_nCurStrip+offset, src, m_nStripSize) < 0)
+        if (TIFFWriteEncodedStrip(m_hTif, TIFFComputeStrip(m_hTif, nStart, (uint16_t)s), m_pStripBuf, (tmsize_t)nLines * nPlaneLine) < 0)
           return false;
-        offset += m_nStripsPerSample;
-        src += m_nStripSize;
       }
     }
-    else if (TIFFWriteEncodedStrip(m_hTif, m_nCurStrip, pBuf, m_nBytesPerLine) < 0)
-      return false;
+  }
+  else {
+    unsigned int nPixelBytes = bSep ? m_nBytesPerSample : m_nSamples * m_nBytesPerSample;
+    unsigned int nTileLine = m_nTileWidth * nPixelBytes;
+
+    for (unsigned int x=0; x<m_nWidth; x+=m_nTileWidth) {
+      unsigned int nCols = m_nWidth - x;
+      if (nCols > m_nTileWidth)
+        nCols = m_nTileWidth;
+
+      for (s=0; s<nPlanes; s++) {
+        //Edge tiles are padded with zeros
+        if (nCols < m_nTileWidth || nLines < m_nTileHeight)
+          memset(m_pStripBuf, 0, m_nStripSize);
+
+        for (l=0; l<nLines; l++) {
+          unsigned char *pSrc = m_pBandBuf + l*m_nBytesPerLine + x*m_nSamples*m_nBytesPerSample;
+          if (bSep)
+            ContigToPlane(m_pStripBuf + l*nTileLine, pSrc, nCols, m_nSamples, m_nBytesPerSample, s);
+          else
+            memcpy(m_pStripBuf + l*nTileLine, pSrc, nCols*nPixelBytes);
+        }
 
-    m_nCurStrip++;
+        if (TIFFWriteEncodedTile(m_hTif, TIFFComputeTile(m_hTif, x, nStart, 0, (uint16_t)s), m_pStripBuf, m_nStripSize) < 0)
+          return false;
+      }
+    }
   }
 
   return true;
 }
 
+unsigned int CTiffImg::ReadRows(unsigned char *pBuf, unsigned int nRows)
+{
+  if (!m_bRead || !m_pBandBuf)
+    return 0;
+
+  unsigned int nRead = 0;
+  while (nRead < nRows && m_nCurLine < m_nHeight) {
+    unsigned int nBand = m_nCurLine / m_nBandRows;
+
+    if (nBand != m_nCurBand) {
+      if (!ReadBand(nBand))
+        break;
+      m_nCurBand = nBand;
+    }
+
+    unsigned int nOffset = m_nCurLine - nBand * m_nBandRows;
+    unsigned int n = m_nBandRows - nOffset;
+    if (n > m_nHeight - m_nCurLine)
+      n = m_nHeight - m_nCurLine;
+    if (n > nRows - nRead)
+      n = nRows - nRead;
+
+    memcpy(pBuf, m_pBandBuf + (size_t)nOffset * m_nBytesPerLine, (size_t)n * m_nBytesPerLine);
+    pBuf += (size_t)n * m_nBytesPerLine;
+    nRead += n;
+    m_nCurLine += n;
+  }
+
+  return nRead;
+}
+
+unsigned int CTiffImg::WriteRows(unsigned char *pBuf, unsigned int nRows)
+{
+  if (m_bRead || !m_pBandBuf)
+    return 0;
+
+  unsigned int nWritten = 0;
+  while (nWritten < nRows && m_nCurLine < m_nHeight) {
+    unsigned int nOffset = m_nCurLine % m_nBandRows;
+    unsigned int n = m_nBandRows - nOffset;
+    if (n > m_nHeight - m_nCurLine)
+      n = m_nHeight - m_nCurLine;
+    if (n > nRows - nWritten)
+      n = nRows - nWritten;
+
+    memcpy(m_pBandBuf + (size_t)nOffset * m_nBytesPerLine, pBuf, (size_t)n * m_nBytesPerLine);
+    pBuf += (size_t)n * m_nBytesPerLine;
+    nWritten += n;
+    m_nCurLine += n;
+
+    //Encode the band once it is full or the image is complete
+    if (!(m_nCurLine % m_nBandRows) || m_nCurLine == m_nHeight) {
+      if (!WriteBand())
+        return nWritten - n;
+    }
+  }
+
+  //Rows past the end of the image are ignored
+  return nRows;
+}
+
+bool CTiffImg::ReadLine(unsigned char *pBuf)
+{
+  return ReadRows(pBuf, 1)==1;
+}
+
+bool CTiffImg::WriteLine(unsigned char *pBuf)
+{
+  return WriteRows(pBuf, 1)==1;
+}
+
 unsigned int CTiffImg::GetPhoto()
 {
   if (m_nPhoto == PHOTOMETRIC_RGB) {
@@ -77,6 +77,19 @@
 #define PHOTO_ICCLAB      3
 #define PHOTO_RGB         4
 
+//Target size in bytes of strips written when Create is not given a number of rows per strip
+#define TIFFIMG_STRIP_BYTES     0x40000
+
+//Images with more uncompressed bytes than this are written as BigTIFF
+#define TIFFIMG_BIGTIFF_BYTES   0xC0000000
+
+/**
+ * Reads and writes stripped or tiled TIFF images one or more rows at a time.
+ * Rows passed to and from the caller always have contiguous (interleaved)
+ * samples.  Only one strip or one row of tiles (a band) is held in memory
+ * at a time, so memory use is bounded by the strip or tile size regardless
+ * of the image size.
+ */
 class CTiffImg  
 {
 public:
@@ -85,13 +98,20 @@ public:
 
   void Close();
 
+  //nRowsPerStrip of zero selects strips of about TIFFIMG_STRIP_BYTES.  Non-zero nTileWidth and nTileHeight
+  //(multiples of 16) write a tiled image instead.
   bool Create(const char *szFname, unsigned int nWidth, unsigned int nHeight,
               unsigned int nBPS, unsigned int nPhoto, unsigned int nSamples, unsigned int nExtraSamples,
-              float fXRes, float fYRes, bool bCompress=true, bool bSep=false);
+              float fXRes, float fYRes, bool bCompress=true, bool bSep=false,
+              unsigned int nRowsPerStrip=0, unsigned int nTileWidth=0, unsigned int nTileHeight=0);
   bool Open(const char *szFname);
 
   bool ReadLine(unsigned char *pBuf);
   bool WriteLine(unsigned char *pBuf);
+
+  //Read/write the next nRows rows of GetBytesPerLine() bytes each.  Returns the number of rows transferred.
+  unsigned int ReadRows(unsigned char *pBuf, unsigned int nRows);
+  unsigned int WriteRows(unsigned char *pBuf, unsigned int nRows);
   
   unsigned int GetWidth() { return m_nWidth;}
   unsigned int GetHeight() { return m_nHeight;}
@@ -106,14 +126,24 @@ public:
   float GetXRes() {return m_fXRes;}
   float GetYRes() {return m_fYRes;}
 
+  bool IsTiled() { return m_bTiled; }
+  unsigned int GetRowsPerStrip() { return m_nRowsPerStrip; }
+  unsigned int GetTileWidth() { return m_nTileWidth; }
+  unsigned int GetTileHeight() { return m_nTileHeight; }
+
   unsigned int GetBytesPerLine() { return m_nBytesPerLine; }
 
   bool GetIccProfile(unsigned char *&pProfile, unsigned int  &nLen);
   bool SetIccProfile(unsigned char *pProfile, unsigned int  nLen);
 
 protected:
+  bool InitBuffers();
+  bool ReadBand(unsigned int nBand);
+  bool WriteBand();
+
   TIFF *m_hTif;
   bool m_bRead;
+  bool m_bTiled;
 
   unsigned int m_nWidth;
   unsigned int m_nHeight;
@@ -130,15 +160,17 @@ protected:
 
   unsigned int m_nBytesPerLine;
   unsigned int m_nRowsPerStrip;
-  unsigned int m_nStripSize;
-  unsigned int m_nStripSamples;
-  unsigned int m_nStripsPerSample;
-  unsigned int m_nBytesPerStripLine;
+  unsigned int m_nTileWidth;
+  unsigned int m_nTileHeight;
+
+  unsigned int m_nBandRows;     //Rows in each strip or row of tiles
+  unsigned int m_nCurBand;      //Band currently held in m_pBandBuf (read)
+  unsigned char *m_pBandBuf;    //Contiguous rows of the current band
 
-  unsigned char *m_pStripBuf;
+  unsigned int m_nStripSize;    //Size of the strip or tile in m_pStripBuf
+  unsigned char *m_pStripBuf;   //Encoding layout of one strip or tile, used for separate planes and tiles
 
   unsigned int m_nCurLine;
-  unsigned int m_nCurStrip;
 
   unsigned char *m_pProfile;
   unsigned int m_nProfileLength;
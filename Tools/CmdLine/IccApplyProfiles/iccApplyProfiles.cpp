@@ -71,6 +71,11 @@
 
 
 #include <cstdio>
+#include <cstring>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "IccCmm.h"
 #include "IccUtil.h"
 #include "IccDefs.h"
@@ -96,7 +101,10 @@ void Usage()
 {
   printf("iccApplyProfiles built with IccProfLib version " ICCPROFLIBVER "\n\n");
 
-  printf("Usage: iccApplyProfiles src_tiff_file dst_tiff_file dst_sample_encoding dst_compression dst_planar dst_embed_icc interpolation {{-ENV:sig value} profile_file_path rendering_intent {-PCC connection_conditions_path}}\n\n");
+  printf("Usage: iccApplyProfiles {-threads N} src_tiff_file dst_tiff_file dst_sample_encoding dst_compression dst_planar dst_embed_icc interpolation {{-ENV:sig value} profile_file_path rendering_intent {-PCC connection_conditions_path}}\n\n");
+  printf("  -threads N color manages blocks of rows on N threads while the source image is\n");
+  printf("    read and the destination image is written (0 - one per hardware thread)\n\n");
+
   printf("  For dst_sample_encoding:\n");
   printf("    0 - Same as src\n");
   printf("    1 - icEncode8Bit\n");
@@ -147,9 +155,444 @@ void Usage()
 
 //===================================================
 
+//Target number of source image bytes in each block of rows passed through the pipeline
+#define icApplyBlockBytes 0x100000
+
+//Image layout and encoding information needed to color manage rows of pixels
+typedef struct {
+  bool bDirect;
+  icBufferFormat srcFormat;
+  icBufferFormat dstFormat;
+  unsigned int nWidth;
+  unsigned int nSrcBytesPerLine;
+  unsigned int nDstBytesPerLine;
+  unsigned long sbpp;
+  unsigned long dbpp;
+  unsigned int bps;
+  unsigned int dbps;
+  unsigned int sphoto;
+  unsigned int photo;
+  icColorSpaceSignature SrcspaceSig;
+  icColorSpaceSignature DestSpaceSig;
+  int nSrcSamples;
+  int nSrcColorSamples;
+  int nDestSamples;
+} CApplyRowsInfo;
+
+//Color manages nRows rows of pixels from pSBuf into pDBuf using pApply
+static bool ApplyRows(CIccApplyCmm *pApply, const CApplyRowsInfo &info, unsigned char *pDBuf, unsigned char *pSBuf, unsigned int nRows)
+{
+  if (info.bDirect) {
+    //Use CMM to unpack, convert and pack the whole block of rows
+    return pApply->ApplyBuffer(pDBuf, info.dstFormat, pSBuf, info.srcFormat, info.nWidth, nRows,
+                               info.nDstBytesPerLine, info.nSrcBytesPerLine)==icCmmStatOk;
+  }
+
+  //Allocate pixel buffers for performing encoding transformations
+  CIccPixelBuf SrcPixel(info.nSrcSamples+16), DestPixel(info.nDestSamples+16);
+  unsigned char *sptr, *dptr;
+  unsigned int r, j;
+  int k;
+
+  for (r=0; r<nRows; r++) {
+    for (sptr=pSBuf + r*info.nSrcBytesPerLine, dptr=pDBuf + r*info.nDstBytesPerLine, j=0; j<info.nWidth; j++, sptr+=info.sbpp, dptr+=info.dbpp) {
+
+      //Special conversions need to be made to convert CIELAB and CIEXYZ to internal PCS encoding
+      switch(info.bps) {
+        case 8:
+          if (info.sphoto==PHOTO_CIELAB) {
+            unsigned char *pSPixel = sptr;
+            icFloatNumber *pPixel = SrcPixel;
+            pPixel[0]=(icFloatNumber)pSPixel[0] / 255.0f;
+            pPixel[1]=(icFloatNumber)(pSPixel[1]-128) / 255.0f;
+            pPixel[2]=(icFloatNumber)(pSPixel[2]-128) / 255.0f;
+          }
+          else {
+            unsigned char *pSPixel = sptr;
+            icFloatNumber *pPixel = SrcPixel;
+            for (k=0; k<info.nSrcColorSamples; k++) {
+              pPixel[k] = (icFloatNumber)pSPixel[k] / 255.0f;
+            }
+          }
+          break;
+
+        case 16:
+          if (info.sphoto==PHOTO_CIELAB) {
+            unsigned short *pSPixel = (unsigned short*)sptr;
+            icFloatNumber *pPixel = SrcPixel;
+            pPixel[0]=(icFloatNumber)pSPixel[0] / 65535.0f;
+            pPixel[1]=(icFloatNumber)(pSPixel[1]-0x8000) / 65535.0f;
+            pPixel[2]=(icFloatNumber)(pSPixel[2]-0x8000) / 65535.0f;
+          }
+          else {
+            unsigned short *pSPixel = (unsigned short*)sptr;
+            icFloatNumber *pPixel = SrcPixel;
+            for (k=0; k<info.nSrcColorSamples; k++) {
+              pPixel[k] = (icFloatNumber)pSPixel[k] / 65535.0f;
+            }
+          }
+          break;
+
+        case 32:
+          {
+            if (sizeof(icFloatNumber)==sizeof(icFloat32Number)) {
+              memcpy(SrcPixel.get(), sptr, info.sbpp);
+            }
+            else {
+              icFloat32Number *pSPixel = (icFloat32Number*)sptr;
+              icFloatNumber *pPixel = SrcPixel;
+              for (k=0; k<info.nSrcColorSamples; k++) {
+                pPixel[k] = (icFloatNumber)pSPixel[k];
+              }
+            }
+
+            if (info.sphoto==PHOTO_CIELAB || info.sphoto==PHOTO_ICCLAB) {
+              icLabToPcs(SrcPixel);
+            }
+          }
+          break;
+
+        default:
+          printf("Invalid source bit depth\n");
+          return false;
+      }
+      if (info.sphoto == PHOTO_CIELAB && info.SrcspaceSig==icSigXYZData) {
+        icLabFromPcs(SrcPixel);
+        icLabtoXYZ(SrcPixel);
+        icXyzToPcs(SrcPixel);
+      }
+
+      //Use CMM to convert SrcPixel to DestPixel
+      pApply->Apply(DestPixel, SrcPixel);
+
+      //Special conversions need to be made to convert from internal PCS encoding CIELAB
+      if (info.photo==PHOTO_CIELAB && info.DestSpaceSig==icSigXYZData) {
+        icXyzFromPcs(DestPixel);
+        icXYZtoLab(DestPixel);
+        icLabToPcs(DestPixel);
+      }
+      switch(info.dbps) {
+        case 8:
+          if (info.photo==PHOTO_CIELAB) {
+            unsigned char *pDPixel = dptr;
+            icFloatNumber *pPixel = DestPixel;
+            pDPixel[0]=(icUInt8Number)(UnitClip(pPixel[0]) * 255.0f + 0.5f);
+            pDPixel[1]=(icUInt8Number)(UnitClip(pPixel[1]) * 255.0f + 0.5f)+128;
+            pDPixel[2]=(icUInt8Number)(UnitClip(pPixel[2]) * 255.0f + 0.5f)+128;
+          }
+          else {
+            icUInt8Number *pDPixel = dptr;
+            icFloatNumber *pPixel = DestPixel;
+            for (k=0; k<info.nDestSamples; k++) {
+              pDPixel[k] = (icUInt8Number)(UnitClip(pPixel[k]) * 255.0f + 0.5f);
+            }
+          }
+          break;
+
+        case 16:
+          if (info.photo==PHOTO_CIELAB) {
+            unsigned short *pDPixel = (unsigned short*)dptr;
+            icFloatNumber *pPixel = DestPixel;
+            pDPixel[0]=(icUInt16Number)(UnitClip(pPixel[0]) * 65535.0f + 0.5f);
+            pDPixel[1]=(icUInt16Number)(UnitClip(pPixel[1]) * 65535.0f + 0.5f)+0x8000;
+            pDPixel[2]=(icUInt16Number)(UnitClip(pPixel[2]) * 65535.0f + 0.5f)+0x8000;
+          }
+          else {
+            icUInt16Number *pDPixel = (icUInt16Number*)dptr;
+            icFloatNumber *pPixel = DestPixel;
+            for (k=0; k<info.nDestSamples; k++) {
+              pDPixel[k] = (icUInt16Number)(UnitClip(pPixel[k]) * 65535.0f+0.5f);
+            }
+          }
+          break;
+
+        case 32:
+          {
+            if (info.photo==PHOTO_CIELAB || info.photo==PHOTO_ICCLAB) {
+              icLabFromPcs(SrcPixel);
+            }
+
+            if (sizeof(icFloatNumber)==sizeof(icFloat32Number)) {
+              memcpy(dptr, DestPixel.get(), info.dbpp);
+            }
+            else {
+              icFloat32Number *pDPixel = (icFloat32Number*)dptr;
+              icFloatNumber *pPixel = DestPixel;
+              for (k=0; k<info.nDestSamples; k++) {
+                pDPixel[k] = (icFloat32Number)pPixel[k];
+              }
+            }
+          }
+          break;
+
+        default:
+          printf("Invalid source bit depth\n");
+          return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+//===================================================
+
+//States of a block of rows as it moves through the pipeline
+typedef enum {
+  icBlockFree = 0,    //Available to the reader
+  icBlockRead,        //Source rows decoded, waiting for a transform thread
+  icBlockApplying,    //Being color managed by a transform thread
+  icBlockApplied,     //Destination rows ready to be written
+  icBlockFailed,      //Color management failed
+} icBlockState;
+
+typedef struct {
+  unsigned char *pSBuf;
+  unsigned char *pDBuf;
+  unsigned int nFirstRow;
+  unsigned int nRows;
+  icBlockState nState;
+} CApplyBlock;
+
+/**
+ * Bounded three stage pipeline.  A reader thread decodes blocks of rows from
+ * the source image, nThreads transform threads color manage them (each with
+ * its own CIccApplyCmm), and the calling thread encodes and writes them in
+ * row order.  Block b always uses slot b % nBlocks, so at most nBlocks blocks
+ * are in flight and a slot is only reused after its rows have been written.
+ */
+class CApplyPipeline
+{
+public:
+  CApplyPipeline(CTiffImg &SrcImg, CTiffImg &DstImg, const CApplyRowsInfo &info) :
+    m_SrcImg(SrcImg), m_DstImg(DstImg), m_info(info)
+  {
+    m_nRead = 0;
+    m_nNextApply = 0;
+    m_bReadDone = false;
+    m_bAbort = false;
+  }
+
+  ~CApplyPipeline()
+  {
+    for (size_t i=0; i<m_blocks.size(); i++) {
+      free(m_blocks[i].pSBuf);
+      free(m_blocks[i].pDBuf);
+    }
+  }
+
+  bool Init(unsigned int nBlocks, unsigned int nBlockRows)
+  {
+    m_nBlockRows = nBlockRows;
+    m_blocks.resize(nBlocks);
+    for (unsigned int i=0; i<nBlocks; i++) {
+      m_blocks[i].pSBuf = (unsigned char*)malloc((size_t)m_info.nSrcBytesPerLine * nBlockRows);
+      m_blocks[i].pDBuf = (unsigned char*)malloc((size_t)m_info.nDstBytesPerLine * nBlockRows);
+      m_blocks[i].nFirstRow = 0;
+      m_blocks[i].nRows = 0;
+      m_blocks[i].nState = icBlockFree;
+      if (!m_blocks[i].pSBuf || !m_blocks[i].pDBuf)
+        return false;
+    }
+    return true;
+  }
+
+  void Abort()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bAbort = true;
+    m_cond.notify_all();
+  }
+
+  //Reader stage: decodes source rows into free blocks in row order
+  void Read()
+  {
+    unsigned int nHeight = m_SrcImg.GetHeight();
+    unsigned int nRow = 0;
+    bool bEnd = false;
+
+    for (unsigned int b=0; !bEnd && nRow<nHeight; b++) {
+      CApplyBlock &block = m_blocks[b % m_blocks.size()];
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cond.wait(lock, [&]() { return m_bAbort || block.nState==icBlockFree; });
+        if (m_bAbort)
+          break;
+      }
+
+      //A free block is only touched by the reader so it is filled without holding the lock
+      unsigned int nRows = nHeight - nRow;
+      if (nRows > m_nBlockRows)
+        nRows = m_nBlockRows;
+
+      block.nFirstRow = nRow;
+      block.nRows = m_SrcImg.ReadRows(block.pSBuf, nRows);
+      nRow += block.nRows;
+      if (block.nRows < nRows)
+        bEnd = true;
+
+      if (block.nRows) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        block.nState = icBlockRead;
+        m_nRead = b+1;
+        m_cond.notify_all();
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bReadDone = true;
+    m_cond.notify_all();
+  }
+
+  //Transform stage: color manages blocks as they become available
+  void Apply(CIccApplyCmm *pApply)
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+      m_cond.wait(lock, [&]() { return m_bAbort || m_nNextApply<m_nRead || m_bReadDone; });
+      if (m_bAbort || m_nNextApply>=m_nRead)
+        break;
+
+      CApplyBlock &block = m_blocks[m_nNextApply % m_blocks.size()];
+      m_nNextApply++;
+      block.nState = icBlockApplying;
+      lock.unlock();
+
+      bool bOk = ApplyRows(pApply, m_info, block.pDBuf, block.pSBuf, block.nRows);
+
+      lock.lock();
+      block.nState = bOk ? icBlockApplied : icBlockFailed;
+      m_cond.notify_all();
+    }
+  }
+
+  //Writer stage: encodes and writes blocks in row order
+  void Write()
+  {
+    unsigned int nHeight = m_SrcImg.GetHeight();
+    int lastPer = -1;
+    int curper;
+
+    for (unsigned int b=0; ; b++) {
+      CApplyBlock &block = m_blocks[b % m_blocks.size()];
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cond.wait(lock, [&]() { return m_bAbort || (m_bReadDone && b>=m_nRead) ||
+                                         (b<m_nRead && (block.nState==icBlockApplied || block.nState==icBlockFailed)); });
+        if (m_bAbort || b>=m_nRead)
+          break;
+      }
+
+      if (block.nState==icBlockFailed) {
+        printf("Unable to apply profiles to line %d\n", block.nFirstRow);
+        break;
+      }
+
+      unsigned int r;
+      for (r=0; r<block.nRows; r++) {
+        //Output the converted pixels to the destination image
+        if (!m_DstImg.WriteLine(block.pDBuf + (size_t)r * m_info.nDstBytesPerLine))
+          break;
+
+        //Display status of how much we have accomplished
+        curper = (int)((float)(block.nFirstRow+r+1)*100.0f/(float)nHeight);
+        if (curper !=lastPer) {
+          printf("\r%d%%", curper);
+          lastPer = curper;
+        }
+      }
+      if (r<block.nRows)
+        break;
+
+      std::lock_guard<std::mutex> lock(m_mutex);
+      block.nState = icBlockFree;
+      m_cond.notify_all();
+    }
+    printf("\n");
+
+    //Release the reader and transform threads if writing stopped early
+    Abort();
+  }
+
+protected:
+  CTiffImg &m_SrcImg;
+  CTiffImg &m_DstImg;
+  const CApplyRowsInfo &m_info;
+
+  std::vector<CApplyBlock> m_blocks;
+  unsigned int m_nBlockRows;
+
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+  unsigned int m_nRead;       //Number of blocks handed to the transform stage
+  unsigned int m_nNextApply;  //Next block to be color managed
+  bool m_bReadDone;
+  bool m_bAbort;
+};
+
+//Color manages all rows of SrcImg into DstImg using a reader, nThreads transform threads and a writer
+static bool ApplyPipelined(CIccCmm &theCmm, CTiffImg &SrcImg, CTiffImg &DstImg, const CApplyRowsInfo &info, int nThreads)
+{
+  unsigned int nBlockRows = info.nSrcBytesPerLine ? icApplyBlockBytes / info.nSrcBytesPerLine : 1;
+  if (nBlockRows < 1)
+    nBlockRows = 1;
+  if (nBlockRows > SrcImg.GetHeight())
+    nBlockRows = SrcImg.GetHeight() ? SrcImg.GetHeight() : 1;
+
+  CApplyPipeline pipeline(SrcImg, DstImg, info);
+
+  //Keep every transform thread busy while one block is being read and another written
+  if (!pipeline.Init(2*nThreads + 2, nBlockRows)) {
+    printf("Out of Memory!\n");
+    return false;
+  }
+
+  //Each transform thread needs its own apply object
+  std::vector<CIccApplyCmm*> applies;
+  int i;
+  for (i=0; i<nThreads; i++) {
+    icStatusCMM stat;
+    CIccApplyCmm *pApply = theCmm.GetNewApplyCmm(stat);
+    if (!pApply) {
+      printf("Error %d - Unable to allocate CMM apply object\n", stat);
+      break;
+    }
+    applies.push_back(pApply);
+  }
+
+  bool rv = (int)applies.size()==nThreads;
+  if (rv) {
+    std::vector<std::thread> workers;
+    std::thread reader(&CApplyPipeline::Read, &pipeline);
+    for (i=0; i<nThreads; i++)
+      workers.push_back(std::thread(&CApplyPipeline::Apply, &pipeline, applies[i]));
+
+    pipeline.Write();
+
+    reader.join();
+    for (i=0; i<nThreads; i++)
+      workers[i].join();
+  }
+
+  for (i=0; i<(int)applies.size(); i++)
+    delete applies[i];
+
+  return rv;
+}
+
+//===================================================
+
 int main(int argc, const char** argv)
 {
   int minargs = 2;
+  int nThreads = -1;
+
+  if (argc > 2 && !stricmp(argv[1], "-threads")) {
+    nThreads = atoi(argv[2]);
+    argv += 2;
+    argc -= 2;
+  }
+
   if (argc < minargs) {
     Usage();
     return -1;
@@ -196,10 +639,13 @@ int main(int argc, const char** argv)
     }
   }
 
-  int i, j, k;
+  //Command line thread count overrides configuration
+  if (nThreads >= 0)
+    cfgApply.m_nThreads = nThreads;
+
+  int i;
   unsigned int sn, sen, sphoto, photo, bps, dbps;
   CTiffImg SrcImg, DstImg;
-  unsigned char *sptr, *dptr;
   const char *last_path = NULL;
 
   //Open source image file and get information from it
@@ -450,187 +896,85 @@ int main(int argc, const char** argv)
     }
   }
 
-  //Allocate buffer for reading source image pixels
-  unsigned char *pSBuf = (unsigned char *)malloc(SrcImg.GetBytesPerLine());  
-  if (!pSBuf) {
-    printf("Out of Memory!\n");
-    return -1;
-  }
-
-  //Allocate buffer for putting color managed pixels into that will be sent to output tiff image
-  unsigned char *pDBuf = (unsigned char *)malloc(DstImg.GetBytesPerLine());
-  if (!pDBuf) {
-    printf("Out of Memory!\n");
-    free(pSBuf);
-    return -1;
+  //Describe how rows of source pixels are converted to rows of destination pixels
+  CApplyRowsInfo info;
+  info.bDirect = sphoto!=PHOTO_CIELAB && sphoto!=PHOTO_ICCLAB && photo!=PHOTO_CIELAB && photo!=PHOTO_ICCLAB;
+  info.srcFormat = icBufferFormat(bps==8 ? icBufferUInt8 : (bps==16 ? icBufferUInt16 : icBufferFloat32), (icUInt16Number)(nSrcSamples - nSrcColorSamples));
+  info.dstFormat = icBufferFormat(dbps==8 ? icBufferUInt8 : (dbps==16 ? icBufferUInt16 : icBufferFloat32));
+  info.nWidth = SrcImg.GetWidth();
+  info.nSrcBytesPerLine = SrcImg.GetBytesPerLine();
+  info.nDstBytesPerLine = DstImg.GetBytesPerLine();
+  info.sbpp = sbpp;
+  info.dbpp = dbpp;
+  info.bps = bps;
+  info.dbps = dbps;
+  info.sphoto = sphoto;
+  info.photo = photo;
+  info.SrcspaceSig = SrcspaceSig;
+  info.DestSpaceSig = DestSpaceSig;
+  info.nSrcSamples = nSrcSamples;
+  info.nSrcColorSamples = nSrcColorSamples;
+  info.nDestSamples = nDestSamples;
+
+  nThreads = cfgApply.m_nThreads;
+  if (nThreads <= 0)
+    nThreads = (int)std::thread::hardware_concurrency();
+
+  if (nThreads > 1) {
+    //Overlap decoding, color management and encoding of blocks of rows
+    if (!ApplyPipelined(theCmm, SrcImg, DstImg, info, nThreads)) {
+      return -1;
+    }
   }
-
-  //Allocate pixel buffers for performing encoding transformations
-  CIccPixelBuf SrcPixel(nSrcSamples+16), DestPixel(nDestSamples+16), Pixel(icIntMax(nSrcSamples, nDestSamples)+16);
-  int lastPer = -1;
-  int curper;
-
-  //Read each line
-  for (i=0; i<(int)SrcImg.GetHeight(); i++) {
-    if (!SrcImg.ReadLine(pSBuf)) {
-      break;
+  else {
+    //Allocate buffer for reading source image pixels
+    unsigned char *pSBuf = (unsigned char *)malloc(SrcImg.GetBytesPerLine());
+    if (!pSBuf) {
+      printf("Out of Memory!\n");
+      return -1;
     }
-    for (sptr=pSBuf, dptr=pDBuf, j=0; j<(int)SrcImg.GetWidth(); j++, sptr+=sbpp, dptr+=dbpp) {
 
-      //Special conversions need to be made to convert CIELAB and CIEXYZ to internal PCS encoding
-      switch(bps) {
-        case 8:
-          if (sphoto==PHOTO_CIELAB) {
-            unsigned char *pSPixel = sptr;
-            icFloatNumber *pPixel = SrcPixel;
-            pPixel[0]=(icFloatNumber)pSPixel[0] / 255.0f;
-            pPixel[1]=(icFloatNumber)(pSPixel[1]-128) / 255.0f;
-            pPixel[2]=(icFloatNumber)(pSPixel[2]-128) / 255.0f;
-          }
-          else {
-            unsigned char *pSPixel = sptr;
-            icFloatNumber *pPixel = SrcPixel;
-            for (k=0; k<nSrcColorSamples; k++) {
-              pPixel[k] = (icFloatNumber)pSPixel[k] / 255.0f;
-            }
-          }
-          break;
-
-        case 16:
-          if (sphoto==PHOTO_CIELAB) {
-            unsigned short *pSPixel = (unsigned short*)sptr;
-            icFloatNumber *pPixel = SrcPixel;
-            pPixel[0]=(icFloatNumber)pSPixel[0] / 65535.0f;
-            pPixel[1]=(icFloatNumber)(pSPixel[1]-0x8000) / 65535.0f;
-            pPixel[2]=(icFloatNumber)(pSPixel[2]-0x8000) / 65535.0f;
-          }
-          else {
-            unsigned short *pSPixel = (unsigned short*)sptr;
-            icFloatNumber *pPixel = SrcPixel;
-            for (k=0; k<nSrcColorSamples; k++) {
-              pPixel[k] = (icFloatNumber)pSPixel[k] / 65535.0f;
-            }
-          }
-          break;
-
-        case 32:
-          {
-            if (sizeof(icFloatNumber)==sizeof(icFloat32Number)) {
-              memcpy(SrcPixel.get(), sptr, sbpp);
-            }
-            else {
-              icFloat32Number *pSPixel = (icFloat32Number*)sptr;
-              icFloatNumber *pPixel = SrcPixel;
-              for (k=0; k<nSrcColorSamples; k++) {
-                pPixel[k] = (icFloatNumber)pSPixel[k];
-              }
-            }
+    //Allocate buffer for putting color managed pixels into that will be sent to output tiff image
+    unsigned char *pDBuf = (unsigned char *)malloc(DstImg.GetBytesPerLine());
+    if (!pDBuf) {
+      printf("Out of Memory!\n");
+      free(pSBuf);
+      return -1;
+    }
 
-            if (sphoto==PHOTO_CIELAB || sphoto==PHOTO_ICCLAB) {
-              icLabToPcs(SrcPixel);
-            }
-          }
-          break;
+    int lastPer = -1;
+    int curper;
 
-        default:
-          printf("Invalid source bit depth\n");
-          return -1;
+    //Read each line
+    for (i=0; i<(int)SrcImg.GetHeight(); i++) {
+      if (!SrcImg.ReadLine(pSBuf)) {
+        break;
       }
-      if (sphoto == PHOTO_CIELAB && SrcspaceSig==icSigXYZData) {
-        icLabFromPcs(SrcPixel);
-        icLabtoXYZ(SrcPixel);
-        icXyzToPcs(SrcPixel);
+      if (!ApplyRows(theCmm.GetApply(), info, pDBuf, pSBuf, 1)) {
+        printf("Unable to apply profiles to line %d\n", i);
+        break;
       }
 
-      //Use CMM to convert SrcPixel to DestPixel
-     theCmm.Apply(DestPixel, SrcPixel);
-
-      //Special conversions need to be made to convert from internal PCS encoding CIELAB
-      if (photo==PHOTO_CIELAB && DestSpaceSig==icSigXYZData) {
-        icXyzFromPcs(DestPixel);
-        icXYZtoLab(DestPixel);
-        icLabToPcs(DestPixel);
+      //Output the converted pixels to the destination image
+      if (!DstImg.WriteLine(pDBuf)) {
+        break;
       }
-      switch(dbps) {
-        case 8:
-          if (photo==PHOTO_CIELAB) {
-            unsigned char *pDPixel = dptr;
-            icFloatNumber *pPixel = DestPixel;
-            pDPixel[0]=(icUInt8Number)(UnitClip(pPixel[0]) * 255.0f + 0.5f);
-            pDPixel[1]=(icUInt8Number)(UnitClip(pPixel[1]) * 255.0f + 0.5f)+128;
-            pDPixel[2]=(icUInt8Number)(UnitClip(pPixel[2]) * 255.0f + 0.5f)+128;
-          }
-          else {
-            icUInt8Number *pDPixel = dptr;
-            icFloatNumber *pPixel = DestPixel;
-            for (k=0; k<nDestSamples; k++) {
-              pDPixel[k] = (icUInt8Number)(UnitClip(pPixel[k]) * 255.0f + 0.5f);
-            }
-          }
-          break;
 
-        case 16:
-          if (photo==PHOTO_CIELAB) {
-            unsigned short *pDPixel = (unsigned short*)dptr;
-            icFloatNumber *pPixel = DestPixel;
-            pDPixel[0]=(icUInt16Number)(UnitClip(pPixel[0]) * 65535.0f + 0.5f);
-            pDPixel[1]=(icUInt16Number)(UnitClip(pPixel[1]) * 65535.0f + 0.5f)+0x8000;
-            pDPixel[2]=(icUInt16Number)(UnitClip(pPixel[2]) * 65535.0f + 0.5f)+0x8000;
-          }
-          else {
-            icUInt16Number *pDPixel = (icUInt16Number*)dptr;
-            icFloatNumber *pPixel = DestPixel;
-            for (k=0; k<nDestSamples; k++) {
-              pDPixel[k] = (icUInt16Number)(UnitClip(pPixel[k]) * 65535.0f+0.5f);
-            }
-          }
-          break;
-
-        case 32:
-          {
-            if (photo==PHOTO_CIELAB || photo==PHOTO_ICCLAB) {
-              icLabFromPcs(SrcPixel);
-            }
-
-            if (sizeof(icFloatNumber)==sizeof(icFloat32Number)) {
-              memcpy(dptr, DestPixel.get(), dbpp);
-            }
-            else {
-              icFloat32Number *pDPixel = (icFloat32Number*)dptr;
-              icFloatNumber *pPixel = DestPixel;
-              for (k=0; k<nDestSamples; k++) {
-                pDPixel[k] = (icFloat32Number)pPixel[k];
-              }
-            }
-          }
-          break;
-
-        default:
-          printf("Invalid source bit depth\n");
-          return -1;
+      //Display status of how much we have accomplished
+      curper = (int)((float)(i+1)*100.0f/(float)SrcImg.GetHeight());
+      if (curper !=lastPer) {
+        printf("\r%d%%", curper);
+        lastPer = curper;
       }
     }
+    printf("\n");
 
-    //Output the converted pixels to the destination image
-    if (!DstImg.WriteLine(pDBuf)) {
-      break;
-    }
-
-    //Display status of how much we have accomplished
-    curper = (int)((float)(i+1)*100.0f/(float)SrcImg.GetHeight());
-    if (curper !=lastPer) {
-      printf("\r%d%%", curper);
-      lastPer = curper;
-    }
+    free(pSBuf);
+    free(pDBuf);
   }
-  printf("\n");
 
   //Clean everything up by closeing files and freeing buffers
   SrcImg.Close();
-
-  free(pSBuf);
-  free(pDBuf);
-
   DstImg.Close();
 
   return 0;
@@ -71,6 +71,9 @@
 
 #include <cstdio>
 #include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
 #include "IccCmm.h"
 #include "IccUtil.h"
 #include "IccDefs.h"
@@ -577,12 +580,132 @@ protected:
 
 typedef std::list<CIccProfile*> IccProfilePtrList;
 
+//Number of grid nodes evaluated before they are passed on to the link writer
+#define icLinkSlabNodes   0x10000
+
+//Number of grid nodes each thread evaluates with a single call to the CMM
+#define icLinkChunkNodes  256
+
+/**
+ * Evaluates a slab of consecutive grid nodes on one or more threads.  Nodes
+ * are numbered in the order they are passed to the link writer (last
+ * source sample varying fastest).  Threads take chunks of the slab from a
+ * shared counter and apply them with their own CIccApplyCmm, so the results
+ * do not depend on the number of threads.
+ */
+class CGridSampler
+{
+public:
+  CGridSampler(int nSrcSamples, int nDstSamples, int nLutSize, icFloatNumber loRange, icFloatNumber sizeRange)
+  {
+    m_nSrcSamples = nSrcSamples;
+    m_nDstSamples = nDstSamples;
+    m_nLutSize = nLutSize;
+    m_loRange = loRange;
+    m_sizeRange = sizeRange;
+    m_nFirst = 0;
+    m_nNodes = 0;
+    m_pDst = NULL;
+  }
+
+  //Evaluates nodes [nFirst, nFirst+nNodes) into pDst using up to one thread per apply object
+  bool Sample(std::vector<CIccApplyCmm*> &applies, icFloatNumber *pDst, icUInt32Number nFirst, icUInt32Number nNodes)
+  {
+    m_pDst = pDst;
+    m_nFirst = nFirst;
+    m_nNodes = nNodes;
+    m_nNext = 0;
+    m_bOk = true;
+
+    std::vector<std::thread> workers;
+    size_t i;
+    for (i=1; i<applies.size(); i++) {
+      try {
+        workers.push_back(std::thread(&CGridSampler::Run, this, applies[i]));
+      }
+      catch (...) {
+        //Nodes of workers that could not be started are evaluated by the others
+        break;
+      }
+    }
+
+    Run(applies[0]);
+
+    for (i=0; i<workers.size(); i++)
+      workers[i].join();
+
+    return m_bOk;
+  }
+
+protected:
+  void Run(CIccApplyCmm *pApply)
+  {
+    std::vector<icFloatNumber> src((size_t)icLinkChunkNodes * m_nSrcSamples);
+    std::vector<int> idx(m_nSrcSamples);
+    icUInt32Number maxLut = m_nLutSize - 1;
+
+    for (;;) {
+      icUInt32Number nStart = m_nNext.fetch_add(icLinkChunkNodes);
+      if (nStart >= m_nNodes)
+        break;
+
+      icUInt32Number nCount = m_nNodes - nStart;
+      if (nCount > icLinkChunkNodes)
+        nCount = icLinkChunkNodes;
+
+      //Grid position of the first node in the chunk
+      icUInt32Number nNode = m_nFirst + nStart;
+      int i, j;
+      for (i = m_nSrcSamples - 1; i >= 0; i--) {
+        idx[i] = (int)(nNode % m_nLutSize);
+        nNode /= m_nLutSize;
+      }
+
+      icFloatNumber *srcPixel = &src[0];
+      for (icUInt32Number c = 0; c < nCount; c++, srcPixel += m_nSrcSamples) {
+        for (i = 0; i < m_nSrcSamples; i++) {
+          srcPixel[i] = m_sizeRange * (icFloatNumber)idx[i] / maxLut + m_loRange;
+        }
+
+        for (j = m_nSrcSamples - 1; j >= 0;) {
+          idx[j]++;
+          if (idx[j] >= m_nLutSize) {
+            idx[j] = 0;
+            j--;
+          }
+          else
+            break;
+        }
+      }
+
+      //Use CMM to convert the chunk of source nodes to destination nodes
+      if (pApply->Apply(m_pDst + (size_t)nStart * m_nDstSamples, &src[0], nCount) != icCmmStatOk)
+        m_bOk = false;
+    }
+  }
+
+  int m_nSrcSamples;
+  int m_nDstSamples;
+  int m_nLutSize;
+  icFloatNumber m_loRange;
+  icFloatNumber m_sizeRange;
+
+  icUInt32Number m_nFirst;
+  icUInt32Number m_nNodes;
+  icFloatNumber *m_pDst;
+
+  std::atomic<icUInt32Number> m_nNext;
+  std::atomic<bool> m_bOk;
+};
+
 
 void Usage() 
 {
   printf("iccApplyToLink built with IccProfLib version " ICCPROFLIBVER "\n\n");
 
-  printf("Usage: iccApplyToLink dst_link_file link_type lut_size option title range_min range_max first_transform interp {{-ENV:sig value} profile_file_path rendering_intent {-PCC connection_conditions_path}}\n\n");
+  printf("Usage: iccApplyToLink {-threads N} dst_link_file link_type lut_size option title range_min range_max first_transform interp {{-ENV:sig value} profile_file_path rendering_intent {-PCC connection_conditions_path}}\n\n");
+  printf("  -threads N samples the LUT grid on N threads (default 0 - one per hardware thread)\n\n");
+
   printf("  dst_link_file is path of file to create\n\n");
   
   printf("  For link_type:\n");
@@ -641,6 +764,14 @@ void Usage()
 int main(int argc, icChar* argv[])
 {
   int minargs = 10; // minimum number of arguments
+  int nThreads = 0;
+
+  if (argc > 2 && !stricmp(argv[1], "-threads")) {
+    nThreads = atoi(argv[2]);
+    argv += 2;
+    argc -= 2;
+  }
+
   if(argc<minargs) {
     Usage();
     return -1;
@@ -808,54 +939,70 @@ int main(int argc, icChar* argv[])
   icColorSpaceSignature DestspaceSig = theCmm.GetDestSpace();
   int nDestSamples = icGetSpaceSamples(DestspaceSig);
 
-  int* idx = new int[nSrcSamples];
-  icFloatNumber* srcPixel = new icFloatNumber[nSrcSamples];
-  icFloatNumber* dstPixel = new icFloatNumber[nDestSamples];
-
-  icUInt32Number maxLut = nLutSize - 1;
+  //Each thread that samples the grid needs its own apply object
+  std::vector<CIccApplyCmm*> applies;
+  if (nThreads <= 0)
+    nThreads = (int)std::thread::hardware_concurrency();
+  if (nThreads <= 1) {
+    applies.push_back(theCmm.GetApply());
+  }
+  else {
+    for (i = 0; i < nThreads; i++) {
+      CIccApplyCmm *pApply = theCmm.GetNewApplyCmm(stat);
+      if (!pApply) {
+        printf("Error %d - Unable to allocate CMM apply object\n", stat);
+        return -1;
+      }
+      applies.push_back(pApply);
+    }
+  }
 
   int curPer, lastPer = -1;
 
-  //init idx;
-  int lutCount = 1;
+  icUInt32Number lutCount = 1;
   for (auto i = 0; i < nSrcSamples; i++) {
-    idx[i] = 0;
     lutCount *= nLutSize;
   }
 
-  int j = 0;
-  for (int c = 0; j >= 0; c++) {
+  CGridSampler sampler(nSrcSamples, nDestSamples, nLutSize, loRange, sizeRange);
 
-    for (auto i = 0; i < nSrcSamples; i++) {
-      srcPixel[i] = sizeRange * (icFloatNumber)idx[i] / maxLut + loRange;
-    }
+  icUInt32Number nSlab = lutCount < icLinkSlabNodes ? lutCount : icLinkSlabNodes;
+  icFloatNumber* dstPixels = new icFloatNumber[(size_t)nSlab * nDestSamples];
+  bool bApplied = true;
+
+  //Sample the grid a slab at a time and pass the nodes to the writer in order
+  for (icUInt32Number c = 0; c < lutCount && bApplied; ) {
+    icUInt32Number nNodes = lutCount - c;
+    if (nNodes > nSlab)
+      nNodes = nSlab;
 
-    //Use CMM to convert SrcPixel to DestPixel
-    theCmm.Apply(dstPixel, srcPixel);
+    bApplied = sampler.Sample(applies, dstPixels, c, nNodes);
 
-    pWriter->setNextNode(dstPixel);
+    icFloatNumber* dstPixel = dstPixels;
+    for (icUInt32Number n = 0; n < nNodes && bApplied; n++, c++, dstPixel += nDestSamples) {
+      pWriter->setNextNode(dstPixel);
 
-    for (j = nSrcSamples - 1; j >= 0;) {
-      idx[j]++;
-      if (idx[j] >= nLutSize) {
-        idx[j] = 0;
-        j--;
+      //Display status of how much we have accomplished
+      curPer = (int)((float)(c + 1) * 100.0f / (float)lutCount);
+      if (curPer != lastPer) {
+        printf("\r%d%%", curPer);
+        lastPer = curPer;
       }
-      else
-        break;
     }
+  }
 
-    //Display status of how much we have accomplished
-    curPer = (int)((float)(c + 1) * 100.0f / (float)lutCount);
-    if (curPer != lastPer) {
-      printf("\r%d%%", curPer);
-      lastPer = curPer;
-    }
+  delete[] dstPixels;
+
+  if (applies.size() > 1) {
+    for (size_t n = 0; n < applies.size(); n++)
+      delete applies[n];
+  }
+
+  //A grid node that the CMM could not apply would be left undefined so the link is not written
+  if (!bApplied) {
+    printf("\nUnable to apply profiles to LUT grid\n");
+    return -1;
   }
-  
-  delete[] dstPixel;
-  delete[] srcPixel;
-  delete[] idx;
 
   if (pWriter->finish()) {
     printf("\nLUT successfully written to '%s'\n", argv[1]);
@@ -340,6 +340,7 @@ void CIccCfgImageApply::reset()
   m_dstCompression = icDstBoolTrue;
   m_dstPlanar = icDstBoolFalse;
   m_dstEmbedIcc = icDstBoolTrue;
+  m_nThreads = 1;
 }
 
 int CIccCfgImageApply::fromArgs(const char** args, int nArg, bool bReset)
@@ -412,6 +413,7 @@ bool CIccCfgImageApply::fromJson(json j, bool bReset)
   jsonToValue(j["dstCompression"], m_dstCompression);
   jsonToValue(j["dstPlanar"], m_dstPlanar);
   jsonToValue(j["dstEmbedIcc"], m_dstEmbedIcc);
+  jsonToValue(j["threads"], m_nThreads);
 
   return true;
 }
@@ -429,6 +431,9 @@ void CIccCfgImageApply::toJson(json& j) const
   setDstBool(j, "dstCompression", m_dstCompression);
   setDstBool(j, "dstPlanar", m_dstPlanar);
   setDstBool(j, "dstEmbedIcc", m_dstEmbedIcc);
+
+  if (m_nThreads != 1)
+    j["threads"] = m_nThreads;
 }
 
 CIccCfgCreateLink::CIccCfgCreateLink()
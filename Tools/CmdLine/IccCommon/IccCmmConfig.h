@@ -71,6 +71,7 @@ public:
 	icDstBool m_dstCompression;
 	icDstBool m_dstPlanar;
 	icDstBool m_dstEmbedIcc;
+	int m_nThreads;	//Number of transform threads (1 = single threaded, 0 = one per hardware thread)
 };
 
 typedef enum {
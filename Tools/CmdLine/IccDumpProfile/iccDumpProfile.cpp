@@ -127,16 +127,227 @@ void DumpTagEntry(CIccProfile *pIcc, IccTagEntry &entry, int nVerboseness)
   DumpTagCore( pTag, entry.TagInfo.sig, nVerboseness );
 }
 
+// Check additional details if doing detailed validation:
+// - First tag data offset is immediately after the Tag Table
+// - Tag data offsets are all 4-byte aligned
+// - Tag data should be tightly abutted with adjacent tags (or the end of the Tag Table)
+//   (note that tag data can be reused by multiple tags and tags do NOT have to be order)
+// - Last tag also has to be padded and thus file size is always a multiple of 4. See clause
+//   7.2.1, bullet (c) of ICC.1:2010 and ICC.2:2019 specs.
+// - Tag offset + Tag Size should never go beyond EOF
+// - Multiple tags can reuse data and this is NOT reported as it is perfectly valid and
+//   occurs in real-world ICC profiles
+// - Tags with overlapping tag data are considered highly suspect (but officially valid)
+// - 1-3 padding bytes after each tag's data need to be all zero *** NOT DONE - TODO ***
+void CheckTagLayout(CIccProfile *pIcc, std::string &sReport, icValidateStatus &nStatus)
+{
+  CIccInfo Fmt;
+  icHeader *pHdr = &pIcc->m_Header;
+  int n = (int)pIcc->m_Tags.size();
+  int closest;
+  TagEntryList::iterator i;
+
+  typedef  std::vector<icUInt32Number> offsetVector;
+  offsetVector sortedTagOffsets;
+  sortedTagOffsets.reserve( pIcc->m_Tags.size() );
+  for (i=pIcc->m_Tags.begin(); i!=pIcc->m_Tags.end(); ++i) {
+      sortedTagOffsets.push_back(i->TagInfo.offset);
+  }
+  std::sort( sortedTagOffsets.begin(), sortedTagOffsets.end() );
+
+  const size_t strSize = 256;
+  char str[strSize];
+  int  rndup, smallest_offset = pHdr->size;
+
+  // File size is required to be a multiple of 4 bytes according to clause 7.2.1 bullet (c):
+  // "all tagged element data, including the last, shall be padded by no more than three
+  //  following pad bytes to reach a 4 - byte boundary"
+  if ((pHdr->version >= icVersionNumberV4_2) && (pHdr->size % 4 != 0)) {
+      sReport += icMsgValidateNonCompliant;
+      sReport += "File size is not a multiple of 4 bytes (last tag needs padding?).\n";
+      nStatus = icMaxStatus(nStatus, icValidateNonCompliant);
+  }
+
+  for (i=pIcc->m_Tags.begin(); i!=pIcc->m_Tags.end(); ++i) {
+    rndup = 4 * ((i->TagInfo.size + 3) / 4); // Round up to a 4-byte aligned size as per ICC spec
+    //pad = rndup - i->TagInfo.size;           // Optimal smallest number of bytes of padding for this tag (0-3)
+
+    // Is the Tag offset + Tag Size beyond EOF?
+    if (i->TagInfo.offset + i->TagInfo.size > pHdr->size) {
+        sReport += icMsgValidateNonCompliant;
+        snprintf(str, strSize, "Tag %s (offset %d, size %d) ends beyond EOF.\n",
+                Fmt.GetTagSigName(i->TagInfo.sig), i->TagInfo.offset, i->TagInfo.size);
+        sReport += str;
+        nStatus = icMaxStatus(nStatus, icValidateNonCompliant);
+    }
+
+    // Is it the first tag data in the file?
+    if ((int)i->TagInfo.offset < smallest_offset) {
+        smallest_offset = (int)i->TagInfo.offset;
+    }
+
+    // Find closest tag after this tag, by checking offsets of other tags
+    // use upper_bound to allow for duplicate tags (pointing to the same offset)
+    offsetVector::const_iterator match = std::upper_bound( sortedTagOffsets.cbegin(), sortedTagOffsets.cend(), i->TagInfo.offset );
+    if (match == sortedTagOffsets.cend())
+        closest = (int)pHdr->size;
+    else
+        closest = *match;
+    closest = std::min( closest, (int)pHdr->size );
+
+    // Check if closest tag after this tag is less than offset+size - in which case it overlaps! Ignore last tag.
+    if ((closest < (int)i->TagInfo.offset + (int)i->TagInfo.size) && (closest < (int)pHdr->size)) {
+        sReport += icMsgValidateWarning;
+        snprintf(str, strSize, "Tag %s (offset %d, size %d) overlaps with following tag data starting at offset %d.\n",
+            Fmt.GetTagSigName(i->TagInfo.sig), i->TagInfo.offset, i->TagInfo.size, closest);
+        sReport += str;
+        nStatus = icMaxStatus(nStatus, icValidateWarning);
+    }
+
+    // Check for gaps between tag data (accounting for 4-byte alignment)
+    if (closest > (int)i->TagInfo.offset + rndup) {
+      sReport += icMsgValidateWarning;
+      snprintf(str, strSize, "Tag %s (size %d) is followed by %d unnecessary additional bytes (from offset %d).\n",
+            Fmt.GetTagSigName(i->TagInfo.sig), i->TagInfo.size, closest-(i->TagInfo.offset+rndup), (i->TagInfo.offset+rndup));
+      sReport += str;
+      nStatus = icMaxStatus(nStatus, icValidateWarning);
+    }
+  }
+
+  // Clause 7.2.1, bullet (b): "the first set of tagged element data shall immediately follow the tag table"
+  // 1st tag offset should be = Header (128) + Tag Count (4) + Tag Table (n*12)
+  if ((n > 0) && (smallest_offset > 128 + 4 + (n * 12))) {
+    sReport += icMsgValidateNonCompliant;
+    snprintf(str, strSize, "First tag data is at offset %d rather than immediately after tag table (offset %d).\n",
+        smallest_offset, 128 + 4 + (n * 12));
+    sReport += str;
+    nStatus = icMaxStatus(nStatus, icValidateNonCompliant);
+  }
+}
+
+// Adds the validation status line to sText and returns the exit code for the status
+int GetValidationStatus(std::string &sText, icValidateStatus nStatus, const icHeader *pHdr)
+{
+  CIccInfo Fmt;
+  int nValid = 0;
+
+  switch (nStatus) {
+  case icValidateOK:
+    sText += "Profile is valid";
+    break;
+  case icValidateWarning:
+    sText += "Profile has warning(s)";
+    break;
+  case icValidateNonCompliant:
+    sText += "Profile violates ICC specification";
+    break;
+  case icValidateCriticalError:
+    sText += "Profile has Critical Error(s) that violate ICC specification";
+    nValid = -1;
+    break;
+  default:
+    sText += "Profile has unknown status!";
+    return -2;
+  }
+
+  if (pHdr) {
+    sText += " for version ";
+    sText += Fmt.GetVersionName(pHdr->version);
+  }
+
+  return nValid;
+}
+
 int printUsage(void)
 {
     printf("Usage: iccDumpProfile {-v} {int} profile {tagId to dump/\"ALL\"}\n");
+    printf("       iccDumpProfile -b {threads} profile {profile ...}\n");
     printf("\nThe -v option causes profile validation to be performed.\n"
            "The optional integer parameter specifies verboseness of output (1-100, default=100).\n");
+    printf("\nThe -b option validates several profiles concurrently and prints the validation\n"
+           "report of -v for each profile in the order given.  The optional integer parameter\n"
+           "specifies the number of threads (default=number of hardware threads).\n");
     printf("iccDumpProfile built with IccProfLib version " ICCPROFLIBVER "\n\n");
     return -1;
 }
 
 
+// Prints the validation reports of ValidateIccProfiles() in the format of the -v option
+class CBatchValidateSink : public IIccValidateSink
+{
+public:
+  CBatchValidateSink(const std::vector<std::string> &files) : m_files(files), m_nValid(0) {}
+
+  // Called by the worker threads so the layout checks and formatting run concurrently
+  virtual void Validated(size_t nIndex, CIccProfile *pIcc, icValidateStatus &nStatus, std::string &sReport)
+  {
+    std::string sText;
+
+    if (pIcc) {
+      CheckTagLayout(pIcc, sReport, nStatus);
+      sText = "Profile:            '" + m_files[nIndex] + "'\n";
+    }
+    else {
+      sText = "Unable to parse '" + m_files[nIndex] + "' as ICC profile!\n";
+    }
+
+    sText += "\nValidation Report\n";
+    sText += "-----------------\n";
+    GetValidationStatus(sText, nStatus, pIcc ? &pIcc->m_Header : NULL);
+    sText += "\n\n";
+    sText += sReport;
+    sText += "\n";
+
+    sReport = sText;
+  }
+
+  virtual void Report(size_t /*nIndex*/, icValidateStatus nStatus, const std::string &sReport)
+  {
+    std::string sStatus;
+    int nValid = GetValidationStatus(sStatus, nStatus, NULL);
+
+    if (nValid < m_nValid)
+      m_nValid = nValid;
+
+    fwrite(sReport.c_str(), sReport.length(), 1, stdout);
+  }
+
+  int GetResult() const { return m_nValid; }
+
+protected:
+  const std::vector<std::string> &m_files;
+  int m_nValid;
+};
+
+// Validates the profiles given after the -b option
+int ValidateBatch(int argc, char* argv[])
+{
+  int nArg = 0;
+  icUInt32Number nThreads = 0;
+
+  if (argc > 1) {
+    char *endptr = nullptr;
+    long n = strtol(argv[0], &endptr, 10);
+    if (endptr != argv[0] && *endptr == '\0' && n >= 0) {
+      nThreads = (icUInt32Number)n;
+      nArg++;
+    }
+  }
+
+  if (argc <= nArg)
+    return printUsage();
+
+  std::vector<std::string> files(argv + nArg, argv + argc);
+  CBatchValidateSink sink(files);
+
+  printf("Built with IccProfLib version " ICCPROFLIBVER "\n\n");
+
+  ValidateIccProfiles(files, &sink, nThreads);
+
+  return sink.GetResult();
+}
+
+
 int main(int argc, char* argv[])
 {
 #if defined(MEMORY_LEAK_CHECK) && defined(_DEBUG)
@@ -163,6 +374,9 @@ int main(int argc, char* argv[])
   if (argc <= 1)
     return printUsage();
 
+  if (!strcmp(argv[1], "-b") || !strcmp(argv[1], "-B"))
+    return ValidateBatch(argc - 2, &argv[2]);
+
   CIccProfile *pIcc;
   std::string sReport;
   icValidateStatus nStatus = icValidateOK;
@@ -347,87 +561,8 @@ int main(int argc, char* argv[])
     }
 
 
-    // Check additional details if doing detailed validation:
-    // - First tag data offset is immediately after the Tag Table
-    // - Tag data offsets are all 4-byte aligned
-    // - Tag data should be tightly abutted with adjacent tags (or the end of the Tag Table)
-    //   (note that tag data can be reused by multiple tags and tags do NOT have to be order)
-    // - Last tag also has to be padded and thus file size is always a multiple of 4. See clause
-    //   7.2.1, bullet (c) of ICC.1:2010 and ICC.2:2019 specs.
-    // - Tag offset + Tag Size should never go beyond EOF
-    // - Multiple tags can reuse data and this is NOT reported as it is perfectly valid and
-    //   occurs in real-world ICC profiles
-    // - Tags with overlapping tag data are considered highly suspect (but officially valid)
-    // - 1-3 padding bytes after each tag's data need to be all zero *** NOT DONE - TODO ***
     if (bDumpValidation) {
-      const size_t strSize = 256;
-      char str[strSize];
-      int  rndup, smallest_offset = pHdr->size;
-
-      // File size is required to be a multiple of 4 bytes according to clause 7.2.1 bullet (c):
-      // "all tagged element data, including the last, shall be padded by no more than three
-      //  following pad bytes to reach a 4 - byte boundary"
-      if ((pHdr->version >= icVersionNumberV4_2) && (pHdr->size % 4 != 0)) {
-          sReport += icMsgValidateNonCompliant;
-          sReport += "File size is not a multiple of 4 bytes (last tag needs padding?).\n";
-          nStatus = icMaxStatus(nStatus, icValidateNonCompliant);
-      }
-
-      for (i=pIcc->m_Tags.begin(); i!=pIcc->m_Tags.end(); ++i) {
-        rndup = 4 * ((i->TagInfo.size + 3) / 4); // Round up to a 4-byte aligned size as per ICC spec
-        //pad = rndup - i->TagInfo.size;           // Optimal smallest number of bytes of padding for this tag (0-3)
-
-        // Is the Tag offset + Tag Size beyond EOF?
-        if (i->TagInfo.offset + i->TagInfo.size > pHdr->size) {
-            sReport += icMsgValidateNonCompliant;
-            snprintf(str, strSize, "Tag %s (offset %d, size %d) ends beyond EOF.\n",
-                    Fmt.GetTagSigName(i->TagInfo.sig), i->TagInfo.offset, i->TagInfo.size);
-            sReport += str;
-            nStatus = icMaxStatus(nStatus, icValidateNonCompliant);
-        }
-
-        // Is it the first tag data in the file?
-        if ((int)i->TagInfo.offset < smallest_offset) {
-            smallest_offset = (int)i->TagInfo.offset;
-        }
-
-        // Find closest tag after this tag, by checking offsets of other tags
-        // use upper_bound to allow for duplicate tags (pointing to the same offset)
-        offsetVector::const_iterator match = std::upper_bound( sortedTagOffsets.cbegin(), sortedTagOffsets.cend(), i->TagInfo.offset );
-        if (match == sortedTagOffsets.cend())
-            closest = (int)pHdr->size;
-        else
-            closest = *match;
-        closest = std::min( closest, (int)pHdr->size );
-
-        // Check if closest tag after this tag is less than offset+size - in which case it overlaps! Ignore last tag.
-        if ((closest < (int)i->TagInfo.offset + (int)i->TagInfo.size) && (closest < (int)pHdr->size)) {
-            sReport += icMsgValidateWarning;
-            snprintf(str, strSize, "Tag %s (offset %d, size %d) overlaps with following tag data starting at offset %d.\n",
-                Fmt.GetTagSigName(i->TagInfo.sig), i->TagInfo.offset, i->TagInfo.size, closest);
-            sReport += str;
-            nStatus = icMaxStatus(nStatus, icValidateWarning);
-        }
-
-        // Check for gaps between tag data (accounting for 4-byte alignment)
-        if (closest > (int)i->TagInfo.offset + rndup) {
-          sReport += icMsgValidateWarning;
-          snprintf(str, strSize, "Tag %s (size %d) is followed by %d unnecessary additional bytes (from offset %d).\n",
-                Fmt.GetTagSigName(i->TagInfo.sig), i->TagInfo.size, closest-(i->TagInfo.offset+rndup), (i->TagInfo.offset+rndup));
-          sReport += str;
-          nStatus = icMaxStatus(nStatus, icValidateWarning);
-        }
-      }
-
-      // Clause 7.2.1, bullet (b): "the first set of tagged element data shall immediately follow the tag table"
-      // 1st tag offset should be = Header (128) + Tag Count (4) + Tag Table (n*12)
-      if ((n > 0) && (smallest_offset > 128 + 4 + (n * 12))) {
-        sReport += icMsgValidateNonCompliant;
-        snprintf(str, strSize, "First tag data is at offset %d rather than immediately after tag table (offset %d).\n",
-            smallest_offset, 128 + 4 + (n * 12));
-        sReport += str;
-        nStatus = icMaxStatus(nStatus, icValidateNonCompliant);
-      }
+      CheckTagLayout(pIcc, sReport, nStatus);
     }
 
     if (argc>nArg+1) {
@@ -447,33 +582,9 @@ int main(int argc, char* argv[])
   if (bDumpValidation) {
     printf("\nValidation Report\n");
     printf(  "-----------------\n");
-    switch (nStatus) {
-    case icValidateOK:
-      printf("Profile is valid");
-      if (pHdr)
-        printf(" for version %s", Fmt.GetVersionName(pHdr->version));
-      break;
-    case icValidateWarning:
-      printf("Profile has warning(s)");
-      if (pHdr)
-        printf(" for version %s", Fmt.GetVersionName(pHdr->version));
-      break;
-    case icValidateNonCompliant:
-      printf("Profile violates ICC specification");
-      if (pHdr)
-        printf(" for version %s", Fmt.GetVersionName(pHdr->version));
-      break;
-    case icValidateCriticalError:
-      printf("Profile has Critical Error(s) that violate ICC specification");
-      if (pHdr)
-        printf(" for version %s", Fmt.GetVersionName(pHdr->version));
-      nValid = -1;
-      break;
-    default:
-      printf("Profile has unknown status!");
-      nValid = -2;
-      break;
-    }
+    std::string sStatus;
+    nValid = GetValidationStatus(sStatus, nStatus, pHdr);
+    fwrite(sStatus.c_str(), sStatus.length(), 1, stdout);
   }
   printf("\n\n");
 
@@ -70,14 +70,31 @@
 
 
 #include <cstdio>
+#include <cstring>
 #include <string>
+#include <charconv>
+#if !defined(__cpp_lib_to_chars)
+//Floating point from_chars is missing (e.g. Apple libc++ before LLVM 20) so strtod_l is used instead
+#include <cctype>
+#include <cerrno>
+#include <clocale>
+#include <cstdlib>
+#if defined(__APPLE__)
+#include <xlocale.h>
+#endif
+#endif
 #include "IccProfile.h"
 #include "IccTagBasic.h"
+#include "IccTagLut.h"
 #include "IccTagMPE.h"
 #include "IccMpeBasic.h"
+#include "IccIO.h"
 #include "IccProfLibVer.h"
 #include "IccUtil.h"
 
+//Largest number of grid points per dimension that a CIccCLUT can hold
+#define MAX_CUBE_GRID 255
+
 class CubeFile
 {
 public:
@@ -89,9 +106,8 @@ public:
 
   void close()
   {
-    if (m_f)
-      fclose(m_f);
-    m_f = nullptr;
+    m_io.Close();
+    m_pStart = m_pPos = m_pEnd = nullptr;
   }
 
   bool parseHeader()
@@ -107,15 +123,19 @@ public:
 
     bool bAddBlankLine = false;
     while (!isEOF()) {
-      long pos = ftell(m_f);
-      std::string line = getNextLine();
+      const char* eol = lineEnd(m_pPos);
 
-      if (line[0] == '-' || line[0] == '.' || (line[0] >= '0' && line[0] <= '9')) {
-        //undo getNextLine so it can be 3D table can be parsed
-        fseek(m_f, pos, SEEK_SET);
+      if (*m_pPos == '-' || *m_pPos == '+' || *m_pPos == '.' || (*m_pPos >= '0' && *m_pPos <= '9')) {
+        //leave position at start of line so 3D table can be parsed
         break;
       }
 
+      std::string line(m_pPos, trimEnd(m_pPos, eol));
+      const char* szLine = line.c_str();
+      const char* szEnd = szLine + line.size();
+      int nLine = m_nLine;
+      nextLine(eol);
+
       if (!line.size()) {
         if (m_comments.size()) {
           bAddBlankLine = true;
@@ -125,64 +145,51 @@ public:
         if (m_title.size()) {
           m_title += "\n";
         }
-        m_title += getTitle(line.c_str() + 6);
+        m_title += getTitle(szLine + 6);
       }
       else if (line[0] == '#') {
         if (bAddBlankLine) {
           m_comments += "\n";
         }
         if (line[1]==' ')
-          m_comments += line.c_str() + 2;
+          m_comments += szLine + 2;
         else
-          m_comments += line.c_str() + 1;
+          m_comments += szLine + 1;
         m_comments += '\n';
 
         bAddBlankLine = false;
       }
-      else if (line.substr(0, 12) == "LUT_1D_SiZE ") {
-        printf("1DLUTs are not supported\n");
+      else if (line.substr(0, 12) == "LUT_1D_SIZE " || line.substr(0, 12) == "LUT_1D_SiZE ") {
+        printf("Line %d: 1DLUTs are not supported\n", nLine);
         return false;
       }
       else if (line.substr(0, 12) == "LUT_3D_SIZE ") {
-        m_sizeLut3D = atoi(line.c_str() + 12);
+        const char* str = skipSpace(szLine + 12, szEnd);
+        std::from_chars_result rv = std::from_chars(str, szEnd, m_sizeLut3D);
+        if (rv.ec != std::errc() || skipSpace(rv.ptr, szEnd) != szEnd || m_sizeLut3D < 2 || m_sizeLut3D > MAX_CUBE_GRID) {
+          printf("Line %d: LUT_3D_SIZE must be between 2 and %d\n", nLine, MAX_CUBE_GRID);
+          return false;
+        }
       }
       else if (line.substr(0, 19) == "LUT_3D_INPUT_RANGE ") {
-        m_fMinInput[0] = m_fMinInput[1] = m_fMinInput[2] = (icFloatNumber)atof(line.c_str() + 19);
-        const char* next = getNext(line.c_str() + 19);
-        if (next) {
-          m_fMaxInput[0] = m_fMaxInput[1] = m_fMaxInput[2] = (icFloatNumber)atof(next);
+        icFloatNumber range[2];
+        if (parseValues(szLine + 19, szEnd, range, 2) != 2) {
+          printf("Line %d: Invalid LUT_3D_INPUT_RANGE\n", nLine);
+          return false;
         }
+        m_fMinInput[0] = m_fMinInput[1] = m_fMinInput[2] = range[0];
+        m_fMaxInput[0] = m_fMaxInput[1] = m_fMaxInput[2] = range[1];
       }
       else if (line.substr(0, 11) == "DOMAIN_MIN ") {
-        m_fMinInput[0] = (icFloatNumber)atof(line.c_str() + 11);
-        const char* next = getNext(line.c_str());
-        if (next) {
-          m_fMinInput[1] = (icFloatNumber)atof(next);
-          next = getNext(next);
-          if (next) {
-            m_fMinInput[2] = (icFloatNumber)atof(next);
-          }
-          else
-            m_fMinInput[2] = m_fMinInput[1];
-        }
-        else {
-          m_fMinInput[1] = m_fMinInput[2] = m_fMinInput[0];
+        if (!parseDomain(szLine + 11, szEnd, m_fMinInput)) {
+          printf("Line %d: Invalid DOMAIN_MIN\n", nLine);
+          return false;
         }
       }
       else if (line.substr(0, 11) == "DOMAIN_MAX ") {
-        m_fMaxInput[0] = (icFloatNumber)atof(line.c_str() + 11);
-        const char* next = getNext(line.c_str());
-        if (next) {
-          m_fMaxInput[1] = (icFloatNumber)atof(next);
-          next = getNext(next);
-          if (next) {
-            m_fMaxInput[2] = (icFloatNumber)atof(next);
-          }
-          else
-            m_fMaxInput[2] = m_fMaxInput[1];
-        }
-        else {
-          m_fMaxInput[1] = m_fMaxInput[2] = m_fMaxInput[0];
+        if (!parseDomain(szLine + 11, szEnd, m_fMaxInput)) {
+          printf("Line %d: Invalid DOMAIN_MAX\n", nLine);
+          return false;
         }
       }
       else if (line.substr(0, 18) == "LUT_IN_VIDEO_RANGE")
@@ -190,7 +197,7 @@ public:
       else if (line.substr(0, 19) == "LUT_OUT_VIDEO_RANGE")
         m_bLutOutVideoRange = true;
       else {
-        printf("Unknown keyword '%s'\n", line.c_str());
+        printf("Line %d: Unknown keyword '%s'\n", nLine, szLine);
         return false;
       }
     }
@@ -213,6 +220,8 @@ public:
   }
 
   int sizeLut3D() { return m_sizeLut3D; }
+
+  //Parses table entries that follow the header directly into toLut
   bool parse3DTable(icFloatNumber* toLut, icUInt32Number nSizeLut)
   {
     icUInt32Number num = m_sizeLut3D * m_sizeLut3D * m_sizeLut3D;
@@ -221,29 +230,43 @@ public:
     if (!m_sizeLut3D || nSizeLut != num*3)
       return false;
 
-    const char* next;
-    for (auto n = 0u; n < num && !isEOF();) {
-      std::string line = getNextLine();
+    icUInt32Number n;
+    for (n = 0; n < num && !isEOF();) {
+      const char* eol = lineEnd(m_pPos);
+      const char* str = skipSpace(m_pPos, eol);
 
       //Skip empty and commented lines
-      if (line[0] == '#' || line.size() == 0)
+      if (str == eol || *str == '#') {
+        nextLine(eol);
         continue;
-      *toLut++ = (icFloatNumber)atof(line.c_str());
-      next = getNext(line.c_str());
-      if (!next) {
-        printf("Invalid 3DLUT entry\n");
-        return false;
       }
-      *toLut++ = (icFloatNumber)atof(next);
-      next = getNext(next);
-      if (!next) {
-        printf("Invalid 3DLUT entry\n");
+
+      for (int i = 0; i < 3; i++) {
+        if (i)
+          str = skipSpace(str, eol);
+        str = parseValue(str, eol, toLut[i]);
+        if (!str) {
+          printf("Line %d: Invalid 3DLUT entry\n", m_nLine);
+          return false;
+        }
+      }
+
+      str = skipSpace(str, eol);
+      if (str != eol && *str != '#') {
+        printf("Line %d: Unexpected data after 3DLUT entry\n", m_nLine);
         return false;
       }
-      *toLut++ = (icFloatNumber)atof(next);
 
+      toLut += 3;
       n++;
+      nextLine(eol);
     }
+
+    if (n < num) {
+      printf("Line %d: 3DLUT has %u of %u entries\n", m_nLine, n, num);
+      return false;
+    }
+
     return true;
   }
 
@@ -252,13 +275,16 @@ protected:
   
   bool open()
   {
-    if (!m_f) {
-      m_f = fopen(m_sFilename.c_str(), "rb");
-    }
-    else {
-      fseek(m_f, 0, SEEK_SET);
+    if (!m_pStart) {
+      if (!m_io.Open(m_sFilename.c_str()))
+        return false;
+      m_pStart = (const char*)m_io.GetData();
+      m_pEnd = m_pStart + m_io.GetLength();
     }
-    return m_f != nullptr;
+    m_pPos = m_pStart;
+    m_nLine = 1;
+
+    return m_pStart != nullptr;
   }
 
   std::string getTitle(const char* str)
@@ -276,48 +302,123 @@ protected:
     return rv;
   }
 
-  const char* getNext(const char* str)
+  static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+  static const char* skipSpace(const char* str, const char* end)
   {
-    while (*str && *str == ' ') str++;
-    while (*str && *str != ' ') str++;
-    while (*str && *str == ' ') str++;
+    while (str < end && isSpace(*str)) str++;
 
     return str;
   }
 
-  std::string toEnd(const char* str)
+  //Returns end of line that starts at str (not including carriage return or newline)
+  const char* lineEnd(const char* str)
   {
-    std::string rv;
-    while (*str && *str != '\"') {
-      rv += *str++;
-    }
+    const char* eol = (const char*)memchr(str, '\n', m_pEnd - str);
 
-    return rv;
+    return eol ? eol : m_pEnd;
   }
 
-  bool isEOF() { return m_f ? feof(m_f)!=0 : true; }
+  static const char* trimEnd(const char* str, const char* end)
+  {
+    while (end > str && end[-1] == '\r') end--;
 
-#define MAX_LINE_LEN 255
+    return end;
+  }
 
-  std::string getNextLine()
+  void nextLine(const char* eol)
   {
-    std::string rv;
-    for (int n=0; n<MAX_LINE_LEN && !isEOF(); n++) {
-      char c = fgetc(m_f);
+    m_pPos = eol < m_pEnd ? eol + 1 : m_pEnd;
+    m_nLine++;
+  }
 
-      if ((c < 0 && feof(m_f)) || c == '\n')
-        break;
+  //Converts number at str independent of locale.  Returns end of number or nullptr if invalid
+  static const char* parseValue(const char* str, const char* end, icFloatNumber& val)
+  {
+    if (str < end && *str == '+')
+      str++;
 
-      if (c == '\r') //skip unsupported carriage returns
-        continue;
+    double d;
+#if defined(__cpp_lib_to_chars)
+    std::from_chars_result rv = std::from_chars(str, end, d);
+    if (rv.ec != std::errc() || (rv.ptr < end && !isSpace(*rv.ptr) && *rv.ptr != '#'))
+      return nullptr;
+
+    val = (icFloatNumber)d;
+
+    return rv.ptr;
+#else
+    //The mapped file is not null terminated so the number is copied first
+    char buf[64];
+    size_t n = 0;
+    while (str + n < end && !isSpace(str[n]) && str[n] != '#' && str[n] != '\n') {
+      if (n + 1 >= sizeof(buf))
+        return nullptr;
+      buf[n] = str[n];
+      n++;
+    }
+    buf[n] = '\0';
+
+    //strtod also accepts leading space, a second sign and hex numbers
+    if (!n || isspace((unsigned char)buf[0]) || buf[0] == '+' || (buf[0] == '-' && buf[1] == '+') ||
+        strpbrk(buf, "xX"))
+      return nullptr;
+
+    char* szNumEnd;
+    errno = 0;
+#if defined(_WIN32)
+    static _locale_t cLocale = _create_locale(LC_ALL, "C");
+    d = _strtod_l(buf, &szNumEnd, cLocale);
+#else
+    static locale_t cLocale = newlocale(LC_ALL_MASK, "C", (locale_t)0);
+    d = strtod_l(buf, &szNumEnd, cLocale);
+#endif
+    if (szNumEnd != buf + n || errno == ERANGE)
+      return nullptr;
+
+    val = (icFloatNumber)d;
+
+    return str + n;
+#endif
+  }
 
-      rv += (unsigned char)c;
+  //Parses up to nMax whitespace separated values returning the number parsed (or -1 if invalid)
+  static int parseValues(const char* str, const char* end, icFloatNumber* vals, int nMax)
+  {
+    int n;
+    for (n = 0; n < nMax; n++) {
+      str = skipSpace(str, end);
+      if (str == end)
+        break;
+      str = parseValue(str, end, vals[n]);
+      if (!str)
+        return -1;
     }
 
-    return rv;
+    return skipSpace(str, end) == end ? n : -1;
+  }
+
+  //Parses one to three domain values with missing values copied from the last value found
+  static bool parseDomain(const char* str, const char* end, icFloatNumber* vals)
+  {
+    icFloatNumber v[3];
+    int n = parseValues(str, end, v, 3);
+    if (n <= 0)
+      return false;
+
+    for (int i = 0; i < 3; i++)
+      vals[i] = v[i < n ? i : n - 1];
+
+    return true;
   }
 
-  FILE* m_f=nullptr;
+  bool isEOF() { return m_pPos >= m_pEnd; }
+
+  CIccMappedIO m_io;
+  const char* m_pStart = nullptr;
+  const char* m_pPos = nullptr;
+  const char* m_pEnd = nullptr;
+  int m_nLine = 0;
 
   int m_sizeLut3D = 0;
   icFloatNumber m_fMinInput[3] = { 0.0f, 0.0f, 0.0f };
@@ -330,10 +431,32 @@ protected:
   bool m_bLutOutVideoRange = false;
 };
 
+//Returns a curve that maps device values in the range fMin to fMax onto the 0.0 to 1.0 range of a 16-bit CLUT
+static CIccTagParametricCurve* NewDomainCurve(icFloatNumber fMin, icFloatNumber fMax)
+{
+  CIccTagParametricCurve* pCurve = new CIccTagParametricCurve();
+
+  pCurve->SetFunctionType(0x0001);
+  (*pCurve)[0] = 1.0;
+  (*pCurve)[1] = 1.0f / (fMax - fMin);
+  (*pCurve)[2] = -fMin / (fMax - fMin);
+
+  return pCurve;
+}
+
 int main(int argc, char* argv[])
 {
+  bool b16Bit = false;
+
+  if (argc > 1 && !stricmp(argv[1], "-16bit")) {
+    b16Bit = true;
+    argv++;
+    argc--;
+  }
+
   if (argc <= 2) {
-    printf("Usage: iccFromCube cube_file output_icc_file\n");
+    printf("Usage: iccFromCube {-16bit} cube_file output_icc_file\n");
+    printf("  -16bit creates a version 4 device link with a 16-bit CLUT (values are clipped to 0.0-1.0)\n");
     printf("Built with IccProfLib version " ICCPROFLIBVER "\n");
 
     return -1;
@@ -352,68 +475,98 @@ int main(int argc, char* argv[])
   }
 
   CIccProfile profile;
+  CIccCLUT* pCLUT;
 
   //Initialize profile header
   profile.InitHeader();
-  profile.m_Header.version = icVersionNumberV5;
   profile.m_Header.colorSpace = icSigRgbData;
   profile.m_Header.pcs = icSigRgbData;
   profile.m_Header.deviceClass = icSigLinkClass;
 
-  //Create A2B0 Tag with LUT
-  CIccTagMultiProcessElement* pTag = new CIccTagMultiProcessElement(3, 3);
-  if (cube.isCustomInputRange()) {
+  if (b16Bit) {
+    profile.m_Header.version = icVersionNumberV4_3;
+
+    //Create A2B0 Tag with 16-bit CLUT
+    CIccTagLutAtoB* pTagLut = new CIccTagLutAtoB();
+    pTagLut->Init(3, 3);
+
+    LPIccCurve* pCurves = pTagLut->NewCurvesA();
     icFloatNumber* minVal = cube.getMinInput();
     icFloatNumber* maxVal = cube.getMaxInput();
-    CIccMpeCurveSet* pCurves = new CIccMpeCurveSet(3);
-    CIccSingleSampledCurve* pCurve0 = new CIccSingleSampledCurve(minVal[0], maxVal[0]);
-    
-    pCurve0->SetSize(2);
-    pCurve0->GetSamples()[0] = 0;
-    pCurve0->GetSamples()[1] = 1;
-
-    pCurves->SetCurve(0, pCurve0);
-
-    CIccSingleSampledCurve* pCurve1 = pCurve0;
-    if (minVal[1] != minVal[0] || maxVal[1] != maxVal[0]) {
-      pCurve1 = new CIccSingleSampledCurve(minVal[1], maxVal[1]);
-
-      pCurve1->SetSize(2);
-      pCurve1->GetSamples()[0] = 0;
-      pCurve1->GetSamples()[1] = 1;
+    bool bCustomRange = cube.isCustomInputRange();
+    for (int i = 0; i < 3; i++) {
+      if (bCustomRange)
+        pCurves[i] = NewDomainCurve(minVal[i], maxVal[i]);
+      else
+        pCurves[i] = new CIccTagCurve();
+    }
+    pCurves = pTagLut->NewCurvesB();
+    for (int i = 0; i < 3; i++) {
+      pCurves[i] = new CIccTagCurve();
     }
 
-    pCurves->SetCurve(1, pCurve1);
+    pCLUT = pTagLut->NewCLUT((icUInt8Number)cube.sizeLut3D());
 
-    CIccSingleSampledCurve* pCurve2 = pCurve0;
+    profile.AttachTag(icSigAToB0Tag, pTagLut);
+  }
+  else {
+    profile.m_Header.version = icVersionNumberV5;
+
+    //Create A2B0 Tag with LUT
+    CIccTagMultiProcessElement* pTag = new CIccTagMultiProcessElement(3, 3);
+    if (cube.isCustomInputRange()) {
+      icFloatNumber* minVal = cube.getMinInput();
+      icFloatNumber* maxVal = cube.getMaxInput();
+      CIccMpeCurveSet* pCurves = new CIccMpeCurveSet(3);
+      CIccSingleSampledCurve* pCurve0 = new CIccSingleSampledCurve(minVal[0], maxVal[0]);
+      
+      pCurve0->SetSize(2);
+      pCurve0->GetSamples()[0] = 0;
+      pCurve0->GetSamples()[1] = 1;
+
+      pCurves->SetCurve(0, pCurve0);
+
+      CIccSingleSampledCurve* pCurve1 = pCurve0;
+      if (minVal[1] != minVal[0] || maxVal[1] != maxVal[0]) {
+        pCurve1 = new CIccSingleSampledCurve(minVal[1], maxVal[1]);
+
+        pCurve1->SetSize(2);
+        pCurve1->GetSamples()[0] = 0;
+        pCurve1->GetSamples()[1] = 1;
+      }
 
-    if (minVal[2] != minVal[0] || maxVal[2] != maxVal[0]) {
-      if (minVal[2] == minVal[1] && maxVal[2] == maxVal[1])
-        pCurve2 = pCurve1;
-      else {
-        pCurve2 = new CIccSingleSampledCurve(minVal[2], maxVal[2]);
+      pCurves->SetCurve(1, pCurve1);
 
-        pCurve2->SetSize(2);
-        pCurve2->GetSamples()[0] = 0;
-        pCurve2->GetSamples()[1] = 1;
+      CIccSingleSampledCurve* pCurve2 = pCurve0;
+
+      if (minVal[2] != minVal[0] || maxVal[2] != maxVal[0]) {
+        if (minVal[2] == minVal[1] && maxVal[2] == maxVal[1])
+          pCurve2 = pCurve1;
+        else {
+          pCurve2 = new CIccSingleSampledCurve(minVal[2], maxVal[2]);
+
+          pCurve2->SetSize(2);
+          pCurve2->GetSamples()[0] = 0;
+          pCurve2->GetSamples()[1] = 1;
+        }
       }
+
+      pCurves->SetCurve(2, pCurve2);
+
+      pTag->Attach(pCurves);
     }
 
-    pCurves->SetCurve(2, pCurve2);
+    CIccMpeCLUT* pMpeCLUT = new CIccMpeCLUT();
+    pCLUT = new CIccCLUT(3, 3);
+    pCLUT->Init(cube.sizeLut3D());
+    pMpeCLUT->SetCLUT(pCLUT);
+    pTag->Attach(pMpeCLUT);
 
-    pTag->Attach(pCurves);
+    profile.AttachTag(icSigAToB0Tag, pTag);
   }
 
-  CIccMpeCLUT* pMpeCLUT = new CIccMpeCLUT();
-  CIccCLUT* pCLUT = new CIccCLUT(3, 3);
-  pCLUT->Init(cube.sizeLut3D());
   bool bSuccess = cube.parse3DTable(pCLUT->GetData(0), pCLUT->NumPoints()*3);
 
-  pMpeCLUT->SetCLUT(pCLUT);
-  pTag->Attach(pMpeCLUT);
-
-  profile.AttachTag(icSigAToB0Tag, pTag);
-
   cube.close();
 
   if (!bSuccess) {
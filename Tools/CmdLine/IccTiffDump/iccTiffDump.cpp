@@ -208,6 +208,10 @@ int main(int argc, icChar* argv[])
     printf("ExtraSamples:      %d\n", nExtra);
   printf("Photometric:       %s\n", GetId(SrcImg.GetPhoto(), photo_types));
   printf("BytesPerLine:      %d\n", SrcImg.GetBytesPerLine());
+  if (SrcImg.IsTiled())
+    printf("Tiles:             (%d x %d) pixels\n", SrcImg.GetTileWidth(), SrcImg.GetTileHeight());
+  else
+    printf("RowsPerStrip:      %d\n", SrcImg.GetRowsPerStrip());
   printf("Resolution:        (%lf x %lf) pixels per/inch\n", SrcImg.GetXRes(), SrcImg.GetYRes());
   printf("Compression:       %s\n", GetId(SrcImg.GetCompress(), compression_types));
 